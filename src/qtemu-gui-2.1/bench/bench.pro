@@ -0,0 +1,92 @@
+##
+## QtEmu - A front-end for qemu emulator
+##
+## Copyright (C) 2006-2008 Urs Wolfer <uwolfer @ fwo.ch> and Ben Klopfenstein <benklop gmail com>
+## Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+##
+## This program is free software; you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation; either version 2 of the License, or
+## (at your option) any later version.
+##
+## This program is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU Library General Public License
+## along with this library; see the file COPYING.LIB.  If not, write to
+## the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+## Boston, MA 02110-1301, USA.
+##
+##-------------------------------------------------
+##
+## Project created by the awesome QtCreator
+##
+##-------------------------------------------------
+
+message("Generating Makefile for the QtEmu benchmarks... $$escape_expand(\\n)")
+
+QT += core gui widgets network
+
+TARGET = qtemu-bench
+
+TEMPLATE = app
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../src
+
+SOURCES +=  qtemubench.cpp \
+            ../src/boot.cpp \
+            ../src/machine.cpp \
+            ../src/machineutils.cpp \
+            ../src/media.cpp \
+            ../src/qemu.cpp \
+            ../src/qemucapabilities.cpp \
+            ../src/qemubinaryscanner.cpp \
+            ../src/qemubinaryregistry.cpp \
+            ../src/serialconsole.cpp \
+            ../src/qmpclient.cpp \
+            ../src/utils/logger.cpp \
+            ../src/utils/logwriter.cpp \
+            ../src/utils/seriallog.cpp \
+            ../src/utils/eventtimeline.cpp \
+            ../src/utils/systemutils.cpp \
+            ../src/utils/tracer.cpp \
+            ../src/bootmonitor.cpp \
+            ../src/utils/boothistory.cpp \
+            ../src/machinesupervisor.cpp \
+            ../src/admissioncontroller.cpp \
+            ../src/machinecgroup.cpp \
+            ../src/networkcard.cpp \
+            ../src/hostportregistry.cpp \
+            ../src/localnetworks.cpp
+
+HEADERS  += ../src/boot.h \
+            ../src/machine.h \
+            ../src/machineutils.h \
+            ../src/media.h \
+            ../src/qemu.h \
+            ../src/qemucapabilities.h \
+            ../src/qemubinaryscanner.h \
+            ../src/qemubinaryregistry.h \
+            ../src/serialconsole.h \
+            ../src/qmpclient.h \
+            ../src/utils/logger.h \
+            ../src/utils/logwriter.h \
+            ../src/utils/seriallog.h \
+            ../src/utils/eventtimeline.h \
+            ../src/utils/systemutils.h \
+            ../src/utils/tracer.h \
+            ../src/bootmonitor.h \
+            ../src/utils/boothistory.h \
+            ../src/machinesupervisor.h \
+            ../src/admissioncontroller.h \
+            ../src/machinecgroup.h \
+            ../src/networkcard.h \
+            ../src/hostportregistry.h \
+            ../src/localnetworks.h
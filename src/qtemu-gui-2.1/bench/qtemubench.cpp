@@ -0,0 +1,506 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Qt
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QDir>
+#include <QFile>
+#include <QUuid>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVector>
+
+// C++ standard library
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+// Local
+#include "machine.h"
+#include "machineutils.h"
+#include "qemubinaryscanner.h"
+#include "utils/logger.h"
+
+/**
+ * @brief Result of one benchmark for one fleet size
+ */
+struct BenchmarkResult {
+    QString name;
+    int fleet;
+    int operations;
+    QVector<qint64> samples;
+};
+
+static bool verboseOutput = false;
+
+/**
+ * @brief Message handler that drops the debug messages
+ * @param type, type of the message
+ * @param context, context of the message
+ * @param message, text of the message
+ *
+ * The core objects print a line each time they are created or destroyed,
+ * which would dominate the timings
+ */
+static void benchMessageHandler(QtMsgType type,
+                                const QMessageLogContext &context,
+                                const QString &message)
+{
+    Q_UNUSED(context);
+
+    if (type == QtDebugMsg && !verboseOutput) {
+        return;
+    }
+
+    std::cerr << qPrintable(message) << std::endl;
+}
+
+/**
+ * @brief Create a machine with a typical configuration
+ * @param dataPath, folder where the machines are created
+ * @param index, number of the machine inside the fleet
+ * @return the machine object
+ *
+ * Create a machine with a typical configuration
+ */
+static Machine *createMachine(const QString &dataPath, int index)
+{
+    QString name = QString("bench-machine-%1").arg(index);
+    QString path = QDir::toNativeSeparators(dataPath + "/" + name);
+    QDir().mkpath(path);
+
+    Machine *machine = new Machine();
+    machine->setName(name);
+    machine->setOSType("GNU/Linux");
+    machine->setOSVersion("Debian");
+    machine->setType("pc");
+    machine->setDescription("Machine created by the QtEmu benchmarks");
+    machine->setPath(path);
+    machine->setConfigPath(QDir::toNativeSeparators(path + "/" + name + ".json"));
+    machine->setUuid(QUuid::createUuid().toString());
+    machine->setState(Machine::Stopped);
+    machine->setCPUType("qemu64");
+    machine->setCPUCount(2);
+    machine->setSocketCount(1);
+    machine->setCoresSocket(2);
+    machine->setThreadsCore(1);
+    machine->setMaxHotCPU(2);
+    machine->setGPUType("std");
+    machine->setKeyboard("en-us");
+    machine->setRAM(1024);
+    machine->setAudio(QStringList() << "ac97");
+    machine->setHostSoundSystem("alsa");
+    machine->setUseNetwork(true);
+    machine->setAccelerator(QStringList() << "kvm" << "tcg");
+
+    Boot *machineBoot = new Boot(machine);
+    machineBoot->setBootMenu(false);
+    machineBoot->setKernelBootEnabled(false);
+    machineBoot->setBootOrder(QStringList() << "cdrom" << "hdd");
+    machine->setBoot(machineBoot);
+
+    Media *media = new Media(machine);
+    media->setName(name);
+    media->setPath(QDir::toNativeSeparators(path + "/" + name + ".qcow2"));
+    media->setSize(20);
+    media->setType("hdd");
+    media->setFormat("qcow2");
+    media->setDriveInterface("hda");
+    media->setCache("none");
+    media->setIO("threads");
+    media->setUuid(QUuid::createUuid());
+    machine->addMedia(media);
+
+    return machine;
+}
+
+/**
+ * @brief Create a fleet of machines and save them
+ * @param dataPath, folder where the machines are created
+ * @param fleet, number of machines
+ * @return list with the machines
+ *
+ * Create a fleet of machines and save them
+ */
+static QList<Machine *> createFleet(const QString &dataPath, int fleet)
+{
+    QList<Machine *> machines;
+    for (int i = 0; i < fleet; ++i) {
+        Machine *machine = createMachine(dataPath, i);
+        machine->saveMachine();
+        machines.append(machine);
+    }
+
+    return machines;
+}
+
+/**
+ * @brief Remove the fleet and the catalog
+ * @param dataPath, folder where the machines are created
+ * @param machines, list with the machines
+ *
+ * Remove the fleet and the catalog
+ */
+static void destroyFleet(const QString &dataPath, QList<Machine *> &machines)
+{
+    qDeleteAll(machines);
+    machines.clear();
+
+    QDir dataDirectory(dataPath);
+    for (const QString &machineDirectory : dataDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QDir(dataDirectory.filePath(machineDirectory)).removeRecursively();
+    }
+    QFile::remove(dataDirectory.filePath("qtemu.json"));
+}
+
+/**
+ * @brief Create a tree with fake QEMU binaries
+ * @param binariesPath, root of the tree
+ * @param fleet, number of directories of the tree
+ *
+ * Every directory of the tree contains one qemu-system-* script that
+ * answers to --version like the real binary does
+ */
+static void createBinariesTree(const QString &binariesPath, int fleet)
+{
+    const QStringList architectures = QStringList() << "x86_64" << "i386" << "aarch64"
+                                                    << "arm" << "ppc64" << "riscv64";
+
+    QDir(binariesPath).removeRecursively();
+    for (int i = 0; i < fleet; ++i) {
+        QString directoryPath = QDir::toNativeSeparators(QString("%1/%2/bin").arg(binariesPath).arg(i));
+        QDir().mkpath(directoryPath);
+
+        QFile binary(QDir(directoryPath).filePath("qemu-system-" + architectures.at(i % architectures.size())));
+        if (!binary.open(QFile::WriteOnly)) {
+            continue;
+        }
+        binary.write("#!/bin/sh\necho \"QEMU emulator version 4.2.0\"\n");
+        binary.close();
+        binary.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+    }
+}
+
+/**
+ * @brief Run the binaries scanner and wait for it
+ * @param binariesPath, root of the tree
+ * @param previousScan, result of the previous scan
+ * @return result of the scan
+ *
+ * Run the binaries scanner and wait for it
+ */
+static QJsonObject runScanner(const QString &binariesPath, const QJsonObject &previousScan)
+{
+    QJsonObject scan;
+    QEMUBinaryScanner scanner(binariesPath, previousScan);
+    QObject::connect(&scanner, &QEMUBinaryScanner::scanFinishedSignal,
+                     &scanner, [&scan](const QJsonObject &result) {
+        scan = result;
+    }, Qt::DirectConnection);
+
+    scanner.start();
+    scanner.wait();
+
+    return scan;
+}
+
+/**
+ * @brief Run one benchmark
+ * @param name, name of the benchmark
+ * @param fleet, number of machines
+ * @param operations, number of operations done by every iteration
+ * @param iterations, number of iterations
+ * @param iteration, function that runs one iteration and returns the elapsed nanoseconds
+ * @return result of the benchmark
+ *
+ * Run one benchmark
+ */
+static BenchmarkResult runBenchmark(const QString &name, int fleet, int operations,
+                                    int iterations, const std::function<qint64()> &iteration)
+{
+    BenchmarkResult result;
+    result.name = name;
+    result.fleet = fleet;
+    result.operations = operations;
+
+    for (int i = 0; i < iterations; ++i) {
+        result.samples.append(iteration());
+    }
+    std::sort(result.samples.begin(), result.samples.end());
+
+    return result;
+}
+
+/**
+ * @brief Run all the benchmarks for one fleet size
+ * @param dataPath, folder where the machines are created
+ * @param fleet, number of machines
+ * @param iterations, number of iterations
+ * @param filter, names of the benchmarks to run, all if empty
+ * @return results of the benchmarks
+ *
+ * Run all the benchmarks for one fleet size
+ */
+static QList<BenchmarkResult> runFleet(const QString &dataPath, int fleet,
+                                       int iterations, const QStringList &filter)
+{
+    QList<BenchmarkResult> results;
+    QString machinesPath = QDir::toNativeSeparators(dataPath + "/machines");
+    QString catalogPath = QDir::toNativeSeparators(dataPath + "/machines/qtemu.json");
+
+    QSettings settings;
+    settings.beginGroup("DataFolder");
+    settings.setValue("QtEmuData", QDir::toNativeSeparators(machinesPath + "/"));
+    settings.setValue("QtEmuLogs", QDir::toNativeSeparators(dataPath + "/logs"));
+    settings.endGroup();
+    settings.sync();
+
+    QList<Machine *> machines = createFleet(machinesPath, fleet);
+
+    if (filter.isEmpty() || filter.contains("load")) {
+        results.append(runBenchmark("load", fleet, fleet, iterations, [&machines]() {
+            QElapsedTimer timer;
+            timer.start();
+            for (Machine *savedMachine : machines) {
+                Machine machine;
+                QJsonObject machineJSON = MachineUtils::readMachineFile(savedMachine->getConfigPath());
+                MachineUtils::fillMachineObject(&machine, machineJSON, savedMachine->getConfigPath());
+            }
+            return timer.nsecsElapsed();
+        }));
+    }
+
+    if (filter.isEmpty() || filter.contains("save")) {
+        results.append(runBenchmark("save", fleet, fleet, iterations, [&machines]() {
+            QElapsedTimer timer;
+            timer.start();
+            for (Machine *machine : machines) {
+                machine->saveMachine();
+            }
+            return timer.nsecsElapsed();
+        }));
+    }
+
+    if (filter.isEmpty() || filter.contains("command")) {
+        results.append(runBenchmark("command", fleet, fleet, iterations, [&machines]() {
+            QElapsedTimer timer;
+            timer.start();
+            for (Machine *machine : machines) {
+                machine->generateMachineCommand();
+            }
+            return timer.nsecsElapsed();
+        }));
+    }
+
+    if (filter.isEmpty() || filter.contains("catalog-insert")) {
+        results.append(runBenchmark("catalog-insert", fleet, fleet, iterations, [&machines, &catalogPath]() {
+            QFile::remove(catalogPath);
+
+            QElapsedTimer timer;
+            timer.start();
+            for (Machine *machine : machines) {
+                machine->insertMachineConfigFile();
+            }
+            return timer.nsecsElapsed();
+        }));
+    }
+
+    if (filter.isEmpty() || filter.contains("catalog-delete")) {
+        results.append(runBenchmark("catalog-delete", fleet, fleet, iterations, [&]() {
+            // Deleting a machine also removes its folder, so the fleet is recreated
+            destroyFleet(machinesPath, machines);
+            machines = createFleet(machinesPath, fleet);
+            for (Machine *machine : machines) {
+                machine->insertMachineConfigFile();
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+            for (Machine *machine : machines) {
+                MachineUtils::deleteMachine(QUuid(machine->getUuid()));
+            }
+            return timer.nsecsElapsed();
+        }));
+    }
+
+    if (filter.isEmpty() || filter.contains("console")) {
+        QByteArray consoleOutput("\x1b[K(qemu) info status\r\n"
+                                 "\x1b[D\x1b[D\x1b[K"
+                                 "VM status: running\r\n"
+                                 "\x1b[K(qemu) ");
+        results.append(runBenchmark("console", fleet, fleet, iterations, [&consoleOutput, fleet]() {
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < fleet; ++i) {
+                MachineUtils::cleanMonitorOutput(consoleOutput);
+            }
+            return timer.nsecsElapsed();
+        }));
+    }
+
+    destroyFleet(machinesPath, machines);
+
+#ifndef Q_OS_WIN
+    if (filter.isEmpty() || filter.contains("binaries-cold") || filter.contains("binaries-warm")) {
+        QString binariesPath = QDir::toNativeSeparators(dataPath + "/binaries");
+        createBinariesTree(binariesPath, fleet);
+
+        QJsonObject previousScan;
+        if (filter.isEmpty() || filter.contains("binaries-cold")) {
+            results.append(runBenchmark("binaries-cold", fleet, fleet, iterations, [&]() {
+                QElapsedTimer timer;
+                timer.start();
+                previousScan = runScanner(binariesPath, QJsonObject());
+                return timer.nsecsElapsed();
+            }));
+        }
+
+        if (filter.isEmpty() || filter.contains("binaries-warm")) {
+            if (previousScan.isEmpty()) {
+                previousScan = runScanner(binariesPath, QJsonObject());
+            }
+            results.append(runBenchmark("binaries-warm", fleet, fleet, iterations, [&]() {
+                QElapsedTimer timer;
+                timer.start();
+                runScanner(binariesPath, previousScan);
+                return timer.nsecsElapsed();
+            }));
+        }
+
+        QDir(binariesPath).removeRecursively();
+    }
+#endif
+
+    return results;
+}
+
+/**
+ * @brief Print one result
+ * @param result, result of the benchmark
+ * @param format, json or csv
+ *
+ * Print one result
+ */
+static void printResult(const BenchmarkResult &result, const QString &format)
+{
+    qint64 minimum = result.samples.first();
+    qint64 median = result.samples.at(result.samples.size() / 2);
+    qint64 maximum = result.samples.last();
+    double perOperation = result.operations > 0 ? double(median) / result.operations / 1000.0 : 0.0;
+
+    if (format == "csv") {
+        std::cout << qPrintable(QString("%1,%2,%3,%4,%5,%6,%7,%8")
+                                .arg(result.name)
+                                .arg(result.fleet)
+                                .arg(result.operations)
+                                .arg(result.samples.size())
+                                .arg(minimum / 1e6, 0, 'f', 3)
+                                .arg(median / 1e6, 0, 'f', 3)
+                                .arg(maximum / 1e6, 0, 'f', 3)
+                                .arg(perOperation, 0, 'f', 3)) << std::endl;
+        return;
+    }
+
+    QJsonObject resultJSON;
+    resultJSON["benchmark"]  = result.name;
+    resultJSON["fleet"]      = result.fleet;
+    resultJSON["operations"] = result.operations;
+    resultJSON["iterations"] = result.samples.size();
+    resultJSON["min_ms"]     = minimum / 1e6;
+    resultJSON["median_ms"]  = median / 1e6;
+    resultJSON["max_ms"]     = maximum / 1e6;
+    resultJSON["per_op_us"]  = perOperation;
+
+    std::cout << QJsonDocument(resultJSON).toJson(QJsonDocument::Compact).constData() << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    // The core still shows QMessageBox on errors, so a QApplication is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication benchApp(argc, argv);
+    benchApp.setApplicationName("QtEmu-bench");
+    benchApp.setApplicationVersion("2.1");
+    benchApp.setOrganizationName("QtEmu");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks of the QtEmu core");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("fleet", "Comma separated list of fleet sizes.",
+                                        "sizes", "10,100,1000"));
+    parser.addOption(QCommandLineOption("iterations", "Number of iterations of every benchmark.",
+                                        "count", "5"));
+    parser.addOption(QCommandLineOption("format", "Output format, json or csv.",
+                                        "format", "json"));
+    parser.addOption(QCommandLineOption("benchmark", "Comma separated list of benchmarks: load, save, "
+                                                     "command, catalog-insert, catalog-delete, console, "
+                                                     "binaries-cold, binaries-warm.",
+                                        "names"));
+    parser.addOption(QCommandLineOption("verbose", "Show the debug messages of the core."));
+    parser.process(benchApp);
+
+    verboseOutput = parser.isSet("verbose");
+    qInstallMessageHandler(benchMessageHandler);
+
+    QList<int> fleets;
+    for (const QString &size : parser.value("fleet").split(",", QString::SkipEmptyParts)) {
+        bool validSize = false;
+        int fleet = size.trimmed().toInt(&validSize);
+        if (!validSize || fleet <= 0) {
+            std::cerr << "Invalid fleet size: " << qPrintable(size) << std::endl;
+            return 1;
+        }
+        fleets.append(fleet);
+    }
+
+    int iterations = qMax(1, parser.value("iterations").toInt());
+    QString format = parser.value("format");
+    QStringList filter = parser.value("benchmark").split(",", QString::SkipEmptyParts);
+
+    // Keep the settings and the machines of the user untouched
+    QTemporaryDir dataDirectory;
+    if (!dataDirectory.isValid()) {
+        std::cerr << "Cannot create the temporary folder" << std::endl;
+        return 1;
+    }
+    QSettings::setDefaultFormat(QSettings::IniFormat);
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, dataDirectory.path());
+
+    if (format == "csv") {
+        std::cout << "benchmark,fleet,operations,iterations,min_ms,median_ms,max_ms,per_op_us" << std::endl;
+    }
+
+    for (int fleet : fleets) {
+        for (const BenchmarkResult &result : runFleet(dataDirectory.path(), fleet, iterations, filter)) {
+            printResult(result, format);
+        }
+    }
+
+    Logger::stop();
+
+    return 0;
+}
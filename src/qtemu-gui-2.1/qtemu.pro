@@ -54,6 +54,14 @@ TEMPLATE = app
 CONFIG += c++14
 
 DEFINES += QT_DEPRECATED_WARNINGS
+
+# zlib decodes the Tight and ZRLE encodings of the display
+unix {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += zlib
+}
+win32: LIBS += -lzlib
+
 QMAKE_CFLAGS_DEBUG += -MTd
 QMAKE_CXXFLAGS_DEBUG += -MTd
 QMAKE_CFLAGS_RELEASE += -MT
@@ -99,7 +107,40 @@ SOURCES +=  src/main.cpp\
             src/export-import/importdestinationpage.cpp \
             src/export-import/exportdetailspage.cpp \
             src/export-import/importdetailspage.cpp \
-            src/export-import/importmediapage.cpp
+            src/export-import/importmediapage.cpp \
+            src/utils/machinewatcher.cpp \
+            src/qemucapabilities.cpp \
+            src/qemubinaryscanner.cpp \
+            src/qemubinaryregistry.cpp \
+            src/utils/tracer.cpp \
+            src/utils/logwriter.cpp \
+            src/utils/seriallog.cpp \
+            src/serialconsole.cpp \
+            src/machineconfig/machineconfigserial.cpp \
+            src/metricsexporter.cpp \
+            src/qmpclient.cpp \
+            src/utils/eventtimeline.cpp \
+            src/bootmonitor.cpp \
+            src/utils/boothistory.cpp \
+            src/commandline.cpp \
+            src/controlserver.cpp \
+            src/machinesupervisor.cpp \
+            src/admissioncontroller.cpp \
+            src/balloonmanager.cpp \
+            src/ksmmonitor.cpp \
+            src/memorysharingwidget.cpp \
+            src/templates/templatelibrary.cpp \
+            src/templates/batchprovisioner.cpp \
+            src/templates/provisionwidget.cpp \
+            src/machinepool.cpp \
+            src/machinecgroup.cpp \
+            src/networkcard.cpp \
+            src/hostportregistry.cpp \
+            src/localnetworks.cpp \
+            src/linktest.cpp \
+            src/localnetworkswidget.cpp \
+            src/vncclient.cpp \
+            src/vncviewer.cpp
 
 HEADERS  += src/mainwindow.h \
             src/components/customfilter.h \
@@ -141,7 +182,40 @@ HEADERS  += src/mainwindow.h \
             src/export-import/importdestinationpage.h \
             src/export-import/exportdetailspage.h \
             src/export-import/importdetailspage.h \
-            src/export-import/importmediapage.h
+            src/export-import/importmediapage.h \
+            src/utils/machinewatcher.h \
+            src/qemucapabilities.h \
+            src/qemubinaryscanner.h \
+            src/qemubinaryregistry.h \
+            src/utils/tracer.h \
+            src/utils/logwriter.h \
+            src/utils/seriallog.h \
+            src/serialconsole.h \
+            src/machineconfig/machineconfigserial.h \
+            src/metricsexporter.h \
+            src/qmpclient.h \
+            src/utils/eventtimeline.h \
+            src/bootmonitor.h \
+            src/utils/boothistory.h \
+            src/commandline.h \
+            src/controlserver.h \
+            src/machinesupervisor.h \
+            src/admissioncontroller.h \
+            src/balloonmanager.h \
+            src/ksmmonitor.h \
+            src/memorysharingwidget.h \
+            src/templates/templatelibrary.h \
+            src/templates/batchprovisioner.h \
+            src/templates/provisionwidget.h \
+            src/machinepool.h \
+            src/machinecgroup.h \
+            src/networkcard.h \
+            src/hostportregistry.h \
+            src/localnetworks.h \
+            src/linktest.h \
+            src/localnetworkswidget.h \
+            src/vncclient.h \
+            src/vncviewer.h
 
 OTHER_FILES += \
     CHANGELOG \
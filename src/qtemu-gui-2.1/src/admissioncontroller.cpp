@@ -0,0 +1,471 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "admissioncontroller.h"
+#include "machine.h"
+#include "utils/logger.h"
+#include "utils/systemutils.h"
+
+// UNIX
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+// Interval in ms between two checks of the queued machines
+static const int QUEUE_INTERVAL = 5000;
+
+/**
+ * @brief Admission controller of the machines
+ * @param QEMUGlobalObject, QEMU global object, used to launch the queued machines
+ *
+ * Checks the resources of the host before a machine is launched.
+ * The RAM, vCPUs and huge pages of the running machines are summed
+ * and compared with the live capacity of the host, read from
+ * /proc/meminfo and the online CPU count. The Admission settings
+ * group has:
+ * policy: off, warn, queue or refuse when the host can't hold the machine
+ * reserveMemory: MiB of RAM kept free for the host
+ * memoryOvercommit: ratio of the host RAM the machines can commit
+ * cpuOvercommit: vCPUs per online CPU of the host
+ */
+AdmissionController::AdmissionController(QEMU *QEMUGlobalObject) : QObject(QEMUGlobalObject)
+{
+    this->m_QEMUGlobalObject = QEMUGlobalObject;
+
+    this->m_queueTimer = new QTimer(this);
+    this->m_queueTimer->setInterval(QUEUE_INTERVAL);
+    connect(m_queueTimer, &QTimer::timeout,
+            this, &AdmissionController::processQueue);
+
+    this->loadSettings();
+
+    qDebug() << "AdmissionController object created";
+}
+
+AdmissionController::~AdmissionController()
+{
+    qDebug() << "AdmissionController object destroyed";
+}
+
+/**
+ * @brief Get the policy from the saved string
+ * @param policy, name of the policy
+ * @return the policy, Warn if unknown
+ *
+ * Get the policy from the saved string
+ */
+AdmissionController::Policy AdmissionController::policyFromString(const QString &policy)
+{
+    if (policy == "off") {
+        return AdmissionController::Off;
+    } else if (policy == "queue") {
+        return AdmissionController::Queue;
+    } else if (policy == "refuse") {
+        return AdmissionController::Refuse;
+    }
+
+    return AdmissionController::Warn;
+}
+
+/**
+ * @brief Get the string saved for the policy
+ * @param policy, admission policy
+ * @return name of the policy
+ *
+ * Get the string saved for the policy
+ */
+QString AdmissionController::policyToString(AdmissionController::Policy policy)
+{
+    switch (policy) {
+        case AdmissionController::Off:
+            return "off";
+        case AdmissionController::Queue:
+            return "queue";
+        case AdmissionController::Refuse:
+            return "refuse";
+        default:
+            return "warn";
+    }
+}
+
+/**
+ * @brief Get the admission policy
+ * @return admission policy
+ *
+ * Get the admission policy
+ */
+AdmissionController::Policy AdmissionController::policy() const
+{
+    return this->m_policy;
+}
+
+/**
+ * @brief Get the capacity of the host
+ * @return memory in MiB, online CPUs and free huge pages
+ *
+ * Read the live capacity of the host. The memory values
+ * are 0 when the system doesn't give them
+ */
+AdmissionController::HostCapacity AdmissionController::hostCapacity() const
+{
+    HostCapacity capacity;
+    capacity.memoryTotal = 0;
+    capacity.memoryAvailable = 0;
+    capacity.CPUCount = QThread::idealThreadCount();
+    capacity.hugePagesFree = 0;
+    capacity.hugePageSize = 0;
+
+#ifdef Q_OS_UNIX
+    long onlineCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    if (onlineCPUs > 0) {
+        capacity.CPUCount = static_cast<int>(onlineCPUs);
+    }
+#endif
+
+#ifdef Q_OS_LINUX
+    QFile meminfoFile("/proc/meminfo");
+    if (meminfoFile.open(QFile::ReadOnly)) {
+        // Ex: MemAvailable:    3969420 kB
+        foreach (const QByteArray &line, meminfoFile.readAll().split('\n')) {
+            QList<QByteArray> fields = line.simplified().split(' ');
+            if (fields.size() < 2) {
+                continue;
+            }
+
+            qint64 value = fields.at(1).toLongLong();
+            if (fields.at(0) == "MemTotal:") {
+                capacity.memoryTotal = value / 1024;
+            } else if (fields.at(0) == "MemAvailable:") {
+                capacity.memoryAvailable = value / 1024;
+            } else if (fields.at(0) == "HugePages_Free:") {
+                capacity.hugePagesFree = value;
+            } else if (fields.at(0) == "Hugepagesize:") {
+                capacity.hugePageSize = value;
+            }
+        }
+    }
+#endif
+
+    if (capacity.memoryTotal == 0) {
+        int totalRAM = 0;
+        SystemUtils::getTotalMemory(totalRAM);
+        capacity.memoryTotal = totalRAM;
+    }
+
+    return capacity;
+}
+
+/**
+ * @brief Get the RAM committed to the machines
+ * @return MiB of RAM of the launched machines
+ *
+ * Get the RAM committed to the machines
+ */
+qint64 AdmissionController::committedMemory() const
+{
+    qint64 memory = 0;
+    foreach (const Reservation &reservation, this->m_reservations) {
+        memory += reservation.memory;
+    }
+
+    return memory;
+}
+
+/**
+ * @brief Get the vCPUs committed to the machines
+ * @return vCPUs of the launched machines
+ *
+ * Get the vCPUs committed to the machines
+ */
+int AdmissionController::committedCPUs() const
+{
+    int CPUs = 0;
+    foreach (const Reservation &reservation, this->m_reservations) {
+        CPUs += reservation.CPUs;
+    }
+
+    return CPUs;
+}
+
+/**
+ * @brief Get if the machine waits in the queue
+ * @param machine, machine
+ * @return true if the machine is queued
+ *
+ * Get if the machine waits in the queue
+ */
+bool AdmissionController::isQueued(Machine *machine) const
+{
+    return this->m_queue.contains(QPointer<Machine>(machine));
+}
+
+/**
+ * @brief Get the reason of the last decision
+ * @param machine, machine
+ * @return resources missing in the host, empty if the machine fits
+ *
+ * Get the reason of the last decision
+ */
+QString AdmissionController::reason(Machine *machine) const
+{
+    return this->m_reasons.value(machine->getUuid());
+}
+
+/**
+ * @brief Check if the host can hold the machine
+ * @param machine, machine to be launched
+ * @return true if nothing is queued and the host has room
+ *
+ * Check the capacity without reserving anything, whatever
+ * the policy. Used by the background launches, that must
+ * never take the room of the user launches
+ */
+bool AdmissionController::fits(Machine *machine)
+{
+    this->loadSettings();
+
+    return this->m_queue.isEmpty() && this->checkCapacity(machine).isEmpty();
+}
+
+/**
+ * @brief Decide if the machine is launched
+ * @param machine, machine to be launched
+ * @return decision of the controller
+ *
+ * When the host can hold the machine its resources are reserved
+ * until the machine finishes. Otherwise the policy decides:
+ * the machine is launched anyway, queued until there's room
+ * or refused
+ */
+AdmissionController::Decision AdmissionController::admit(Machine *machine)
+{
+    this->loadSettings();
+
+    QString uuid = machine->getUuid();
+    if (this->isQueued(machine)) {
+        return AdmissionController::Queued;
+    }
+
+    this->m_reasons.remove(uuid);
+
+    QString missingResources;
+    if (this->m_policy != AdmissionController::Off) {
+        missingResources = this->checkCapacity(machine);
+    }
+
+    if (missingResources.isEmpty()) {
+        this->reserve(machine);
+        return AdmissionController::Admitted;
+    }
+
+    this->m_reasons.insert(uuid, missingResources);
+
+    Decision decision;
+    switch (this->m_policy) {
+        case AdmissionController::Queue:
+            decision = AdmissionController::Queued;
+            this->m_queue.append(QPointer<Machine>(machine));
+            this->m_queueTimer->start();
+            break;
+        case AdmissionController::Refuse:
+            decision = AdmissionController::Refused;
+            break;
+        default:
+            decision = AdmissionController::Warned;
+            this->reserve(machine);
+            break;
+    }
+
+    qDebug() << "Admission of" << machine->getName() << decision << missingResources;
+    emit(admissionSignal(machine, decision, missingResources));
+
+    return decision;
+}
+
+/**
+ * @brief Release the resources of the machine
+ * @param machine, finished machine
+ *
+ * Release the resources of the machine, the queued
+ * machines are checked again
+ */
+void AdmissionController::release(Machine *machine)
+{
+    if (this->m_reservations.remove(machine->getUuid()) > 0 && !this->m_queue.isEmpty()) {
+        QTimer::singleShot(0, this, &AdmissionController::processQueue);
+    }
+}
+
+/**
+ * @brief Remove the machine from the queue
+ * @param machine, queued machine
+ *
+ * Remove the machine from the queue
+ */
+void AdmissionController::cancel(Machine *machine)
+{
+    this->m_queue.removeAll(QPointer<Machine>(machine));
+    this->m_reasons.remove(machine->getUuid());
+
+    if (this->m_queue.isEmpty()) {
+        this->m_queueTimer->stop();
+    }
+}
+
+/**
+ * @brief Launch the queued machines
+ *
+ * The machines are launched in order while the host
+ * can hold the first one of the queue
+ */
+void AdmissionController::processQueue()
+{
+    while (!this->m_queue.isEmpty()) {
+        QPointer<Machine> machine = this->m_queue.first();
+
+        // Deleted or launched by other way
+        if (machine.isNull() || machine->getState() != Machine::Stopped) {
+            this->m_queue.removeFirst();
+            continue;
+        }
+
+        if (!this->checkCapacity(machine).isEmpty()) {
+            break;
+        }
+
+        this->m_queue.removeFirst();
+        this->m_reasons.remove(machine->getUuid());
+
+        Logger::logMachineAction(machine->getPath(), machine->getName(), machine->getUuid(),
+                                 "Machine launched from the admission queue");
+        machine->runMachine(this->m_QEMUGlobalObject);
+    }
+
+    if (this->m_queue.isEmpty()) {
+        this->m_queueTimer->stop();
+    }
+}
+
+/**
+ * @brief Load the settings of the admission control
+ *
+ * Load the settings of the admission control
+ */
+void AdmissionController::loadSettings()
+{
+    QSettings settings;
+    settings.beginGroup("Admission");
+    this->m_policy = AdmissionController::policyFromString(settings.value("policy", "warn").toString());
+    this->m_reserveMemory = qMax(0LL, settings.value("reserveMemory", 512).toLongLong());
+    this->m_memoryOvercommit = qMax(0.1, settings.value("memoryOvercommit", 1.0).toDouble());
+    this->m_CPUOvercommit = qMax(1.0, settings.value("cpuOvercommit", 4.0).toDouble());
+    settings.endGroup();
+}
+
+/**
+ * @brief Get the resources requested by the machine
+ * @param machine, machine
+ * @param hugePageSize, size of the huge pages of the host in KiB
+ * @return resources requested
+ *
+ * Get the resources requested by the machine
+ */
+AdmissionController::Reservation AdmissionController::reservationFor(Machine *machine,
+                                                                     qint64 hugePageSize) const
+{
+    Reservation reservation;
+    reservation.memory = machine->getRAM();
+    reservation.CPUs = qMax(1, machine->getCPUCount());
+    reservation.hugePages = 0;
+
+    if (machine->getHugePages() && hugePageSize > 0) {
+        reservation.hugePages = (reservation.memory * 1024 + hugePageSize - 1) / hugePageSize;
+    }
+
+    return reservation;
+}
+
+/**
+ * @brief Check if the host can hold the machine
+ * @param machine, machine to be launched
+ * @return resources missing in the host, empty if the machine fits
+ *
+ * The RAM must be available now and, with the RAM committed to the
+ * other machines, inside the overcommit limit. The vCPUs and the
+ * huge pages are checked in the same way
+ */
+QString AdmissionController::checkCapacity(Machine *machine) const
+{
+    HostCapacity host = this->hostCapacity();
+    Reservation request = this->reservationFor(machine, host.hugePageSize);
+
+    QStringList missingResources;
+
+    if (host.memoryAvailable > 0 &&
+        request.memory > host.memoryAvailable - this->m_reserveMemory) {
+        missingResources << tr("%1 MiB of RAM requested, %2 MiB available")
+                            .arg(request.memory)
+                            .arg(qMax(0LL, host.memoryAvailable - this->m_reserveMemory));
+    }
+
+    if (host.memoryTotal > 0) {
+        qint64 memoryLimit = static_cast<qint64>(host.memoryTotal * this->m_memoryOvercommit) - this->m_reserveMemory;
+        qint64 committed = this->committedMemory();
+        if (committed + request.memory > memoryLimit) {
+            missingResources << tr("%1 MiB of RAM committed to the machines, the limit is %2 MiB")
+                                .arg(committed + request.memory)
+                                .arg(memoryLimit);
+        }
+    }
+
+    int CPULimit = qMax(1, static_cast<int>(host.CPUCount * this->m_CPUOvercommit));
+    int committedCPUs = this->committedCPUs();
+    if (committedCPUs + request.CPUs > CPULimit) {
+        missingResources << tr("%1 vCPUs committed to the machines, the limit is %2 for %3 online CPUs")
+                            .arg(committedCPUs + request.CPUs)
+                            .arg(CPULimit)
+                            .arg(host.CPUCount);
+    }
+
+    if (machine->getHugePages()) {
+        if (host.hugePageSize == 0) {
+            missingResources << tr("The host has no huge pages");
+        } else if (request.hugePages > host.hugePagesFree) {
+            missingResources << tr("%1 huge pages requested, %2 free")
+                                .arg(request.hugePages)
+                                .arg(host.hugePagesFree);
+        }
+    }
+
+    return missingResources.join("; ");
+}
+
+/**
+ * @brief Reserve the resources of the machine
+ * @param machine, launched machine
+ *
+ * Reserve the resources of the machine
+ */
+void AdmissionController::reserve(Machine *machine)
+{
+    HostCapacity host = this->hostCapacity();
+    this->m_reservations.insert(machine->getUuid(), this->reservationFor(machine, host.hugePageSize));
+}
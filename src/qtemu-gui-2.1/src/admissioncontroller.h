@@ -0,0 +1,118 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef ADMISSIONCONTROLLER_H
+#define ADMISSIONCONTROLLER_H
+
+// Qt
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QPointer>
+#include <QTimer>
+#include <QSettings>
+#include <QFile>
+#include <QThread>
+
+#include <QDebug>
+
+class Machine;
+class QEMU;
+
+class AdmissionController : public QObject {
+    Q_OBJECT
+
+    public:
+        enum Policy {
+            Off, Warn, Queue, Refuse
+        };
+
+        enum Decision {
+            Admitted, Warned, Queued, Refused
+        };
+        Q_ENUM(Decision)
+
+        struct HostCapacity {
+            qint64 memoryTotal;
+            qint64 memoryAvailable;
+            int CPUCount;
+            qint64 hugePagesFree;
+            qint64 hugePageSize;
+        };
+
+        explicit AdmissionController(QEMU *QEMUGlobalObject);
+        ~AdmissionController();
+
+        static Policy policyFromString(const QString &policy);
+        static QString policyToString(Policy policy);
+
+        Policy policy() const;
+        HostCapacity hostCapacity() const;
+
+        qint64 committedMemory() const;
+        int committedCPUs() const;
+        bool isQueued(Machine *machine) const;
+        QString reason(Machine *machine) const;
+        bool fits(Machine *machine);
+
+        Decision admit(Machine *machine);
+        void release(Machine *machine);
+        void cancel(Machine *machine);
+
+    signals:
+        void admissionSignal(Machine *machine,
+                             AdmissionController::Decision decision,
+                             const QString &reason);
+
+    public slots:
+
+    private slots:
+        void processQueue();
+
+    protected:
+
+    private:
+        struct Reservation {
+            qint64 memory;
+            int CPUs;
+            qint64 hugePages;
+        };
+
+        QEMU *m_QEMUGlobalObject;
+        QHash<QString, Reservation> m_reservations;
+        QHash<QString, QString> m_reasons;
+        QList<QPointer<Machine>> m_queue;
+        QTimer *m_queueTimer;
+
+        // Settings
+        Policy m_policy;
+        qint64 m_reserveMemory;
+        double m_memoryOvercommit;
+        double m_CPUOvercommit;
+
+        // Methods
+        void loadSettings();
+        Reservation reservationFor(Machine *machine, qint64 hugePageSize) const;
+        QString checkCapacity(Machine *machine) const;
+        void reserve(Machine *machine);
+};
+
+#endif // ADMISSIONCONTROLLER_H
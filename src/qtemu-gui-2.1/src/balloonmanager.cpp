@@ -0,0 +1,249 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "balloonmanager.h"
+
+// QOM path of the balloon device added by Machine::generateMachineCommand
+static const char BALLOON_PATH[] = "/machine/peripheral/balloon0";
+
+static const qint64 MIB = 1024 * 1024;
+
+/**
+ * @brief Balloon manager
+ * @param machines, machines of QtEmu
+ * @param QEMUGlobalObject, QEMU global object, used to read the host capacity
+ * @param parent, parent object
+ *
+ * Moves the memory between the running machines with a virtio-balloon
+ * device. The balloon of the idle guests is inflated when the host is
+ * short of memory and the busy guests get their memory back, always
+ * between the floor and the ceiling of every machine. The Balloon
+ * settings group has:
+ * enabled: balance the memory of the machines
+ * interval: ms between two checks
+ * hostLowMemory: MiB of available memory below which the host is short of memory
+ * hostHighMemory: MiB of available memory above which the guests get their memory back
+ * step: MiB of memory moved in every check
+ * idleFree: percent of free memory above which a guest is idle
+ * busyFree: percent of free memory below which a guest is busy
+ */
+BalloonManager::BalloonManager(const QList<Machine *> *machines,
+                               QEMU *QEMUGlobalObject,
+                               QObject *parent) : QObject(parent)
+{
+    this->m_machines = machines;
+    this->m_QEMUGlobalObject = QEMUGlobalObject;
+
+    this->m_balanceTimer = new QTimer(this);
+    connect(m_balanceTimer, &QTimer::timeout,
+            this, &BalloonManager::balanceMemory);
+
+    this->loadSettings();
+
+    qDebug() << "BalloonManager object created";
+}
+
+BalloonManager::~BalloonManager()
+{
+    qDebug() << "BalloonManager object destroyed";
+}
+
+/**
+ * @brief Load the settings of the manager
+ *
+ * Load the settings of the manager and start
+ * or stop the checks
+ */
+void BalloonManager::loadSettings()
+{
+    QSettings settings;
+    settings.beginGroup("Balloon");
+    bool enabled = settings.value("enabled", true).toBool();
+    this->m_interval = qMax(1000, settings.value("interval", 5000).toInt());
+    this->m_hostLowMemory = settings.value("hostLowMemory", 2048).toLongLong();
+    this->m_hostHighMemory = qMax(this->m_hostLowMemory, settings.value("hostHighMemory", 8192).toLongLong());
+    this->m_step = qMax(1LL, settings.value("step", 128).toLongLong());
+    this->m_idleFree = qBound(1, settings.value("idleFree", 25).toInt(), 100);
+    this->m_busyFree = qBound(0, settings.value("busyFree", 10).toInt(), this->m_idleFree);
+    settings.endGroup();
+
+    if (enabled) {
+        this->m_balanceTimer->start(this->m_interval);
+    } else {
+        this->m_balanceTimer->stop();
+    }
+}
+
+/**
+ * @brief Get the memory of the guest
+ * @param machine, machine
+ * @return MiB of RAM left to the guest by the balloon, -1 if unknown
+ *
+ * Get the memory of the guest in the last check
+ */
+qint64 BalloonManager::balloonSize(const Machine *machine) const
+{
+    return this->m_balloonSizes.value(machine->getUuid(), -1);
+}
+
+/**
+ * @brief Balance the memory of the machines
+ *
+ * Check the available memory of the host and
+ * the balloon of every running machine
+ */
+void BalloonManager::balanceMemory()
+{
+    AdmissionController::HostCapacity host = this->m_QEMUGlobalObject->admissionController()->hostCapacity();
+    bool hostLow = host.memoryAvailable > 0 && host.memoryAvailable < this->m_hostLowMemory;
+    bool hostHigh = host.memoryAvailable > this->m_hostHighMemory;
+
+    foreach (Machine *machine, *this->m_machines) {
+        if (machine->getState() == Machine::Stopped) {
+            this->m_balloonSizes.remove(machine->getUuid());
+            continue;
+        }
+
+        if (machine->getBalloon() && machine->getState() == Machine::Started) {
+            this->balanceMachine(machine, hostLow, hostHigh);
+        }
+    }
+}
+
+/**
+ * @brief Balance the memory of a machine
+ * @param machine, running machine
+ * @param hostLow, the host is short of memory
+ * @param hostHigh, the host has plenty of memory
+ *
+ * Ask QEMU for the size of the balloon and the memory
+ * stats of the guest
+ */
+void BalloonManager::balanceMachine(Machine *machine, bool hostLow, bool hostHigh)
+{
+    QMPClient *qmpClient = machine->getQMPClient();
+    if (qmpClient == nullptr || !qmpClient->isReady()) {
+        return;
+    }
+
+    // The guest sends its stats only after the polling is enabled, once per process
+    QString uuid = machine->getUuid();
+    qint64 processId = machine->getProcessId();
+    if (this->m_statsProcesses.value(uuid, -1) != processId) {
+        QJsonObject pollingArguments;
+        pollingArguments["path"] = BALLOON_PATH;
+        pollingArguments["property"] = "guest-stats-polling-interval";
+        pollingArguments["value"] = qMax(1, this->m_interval / 1000);
+        qmpClient->execute("qom-set", pollingArguments);
+
+        this->m_statsProcesses.insert(uuid, processId);
+    }
+
+    QPointer<Machine> machinePointer(machine);
+    qmpClient->execute("query-balloon", QJsonObject(),
+                       [this, machinePointer, hostLow, hostHigh](const QJsonObject &reply) {
+        if (machinePointer.isNull() || !reply.contains("return")) {
+            return;
+        }
+
+        qint64 actual = static_cast<qint64>(reply["return"].toObject()["actual"].toDouble()) / MIB;
+
+        QJsonObject statsArguments;
+        statsArguments["path"] = BALLOON_PATH;
+        statsArguments["property"] = "guest-stats";
+        machinePointer->getQMPClient()->execute("qom-get", statsArguments,
+                                                [this, machinePointer, actual, hostLow, hostHigh](const QJsonObject &statsReply) {
+            if (machinePointer.isNull() || !statsReply.contains("return")) {
+                return;
+            }
+
+            this->resizeBalloon(machinePointer, actual,
+                                statsReply["return"].toObject()["stats"].toObject(),
+                                hostLow, hostHigh);
+        });
+    });
+}
+
+/**
+ * @brief Resize the balloon of a machine
+ * @param machine, running machine
+ * @param actual, MiB of RAM left to the guest
+ * @param stats, memory stats of the guest
+ * @param hostLow, the host is short of memory
+ * @param hostHigh, the host has plenty of memory
+ *
+ * A busy guest gets one step of memory back unless the host is short
+ * of memory. An idle guest gives one step, keeping its idle free memory,
+ * when the host is short of memory. Without stats, or when the host has
+ * plenty of memory, the guest grows back to its ceiling
+ */
+void BalloonManager::resizeBalloon(Machine *machine, qint64 actual, const QJsonObject &stats,
+                                   bool hostLow, bool hostHigh)
+{
+    this->m_balloonSizes.insert(machine->getUuid(), actual);
+
+    qint64 ceiling = machine->getRAM();
+    if (machine->getBalloonMaximum() > 0) {
+        ceiling = qMin(ceiling, machine->getBalloonMaximum());
+    }
+    qint64 floor = qMin(machine->getBalloonMinimum(), ceiling);
+
+    // The stats are -1 when the guest driver doesn't give them
+    qint64 guestFree = static_cast<qint64>(stats["stat-available-memory"].toDouble(-1));
+    if (guestFree < 0) {
+        guestFree = static_cast<qint64>(stats["stat-free-memory"].toDouble(-1));
+    }
+
+    qint64 target = actual;
+    if (guestFree < 0) {
+        if (hostHigh) {
+            target = actual + this->m_step;
+        }
+    } else {
+        guestFree /= MIB;
+        qint64 idleFree = actual * this->m_idleFree / 100;
+
+        if (guestFree * 100 < actual * this->m_busyFree) {
+            if (!hostLow) {
+                target = actual + this->m_step;
+            }
+        } else if (hostLow && guestFree > idleFree) {
+            target = actual - qMin(this->m_step, guestFree - idleFree);
+        } else if (hostHigh) {
+            target = actual + this->m_step;
+        }
+    }
+
+    target = qBound(floor, target, ceiling);
+    if (target == actual) {
+        return;
+    }
+
+    QJsonObject arguments;
+    arguments["value"] = static_cast<double>(target * MIB);
+    machine->getQMPClient()->execute("balloon", arguments);
+
+    this->m_balloonSizes.insert(machine->getUuid(), target);
+
+    Logger::logMachineAction(machine->getPath(), machine->getName(), machine->getUuid(),
+                             QString("Balloon resized from %1 MiB to %2 MiB").arg(actual).arg(target));
+    emit(balloonChangedSignal(machine, target));
+}
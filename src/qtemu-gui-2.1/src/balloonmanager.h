@@ -0,0 +1,81 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef BALLOONMANAGER_H
+#define BALLOONMANAGER_H
+
+// Qt
+#include <QObject>
+#include <QTimer>
+#include <QSettings>
+#include <QHash>
+#include <QPointer>
+#include <QJsonObject>
+
+#include <QDebug>
+
+// Local
+#include "machine.h"
+
+class BalloonManager : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit BalloonManager(const QList<Machine *> *machines,
+                                QEMU *QEMUGlobalObject,
+                                QObject *parent = nullptr);
+        ~BalloonManager();
+
+        void loadSettings();
+        qint64 balloonSize(const Machine *machine) const;
+
+    signals:
+        void balloonChangedSignal(Machine *machine, qint64 size);
+
+    public slots:
+        void balanceMemory();
+
+    private slots:
+
+    protected:
+
+    private:
+        const QList<Machine *> *m_machines;
+        QEMU *m_QEMUGlobalObject;
+        QTimer *m_balanceTimer;
+
+        QHash<QString, qint64> m_statsProcesses;
+        QHash<QString, qint64> m_balloonSizes;
+
+        // Settings
+        int m_interval;
+        qint64 m_hostLowMemory;
+        qint64 m_hostHighMemory;
+        qint64 m_step;
+        int m_idleFree;
+        int m_busyFree;
+
+        // Methods
+        void balanceMachine(Machine *machine, bool hostLow, bool hostHigh);
+        void resizeBalloon(Machine *machine, qint64 actual, const QJsonObject &stats,
+                           bool hostLow, bool hostHigh);
+};
+
+#endif // BALLOONMANAGER_H
@@ -28,6 +28,8 @@
  */
 Boot::Boot(QObject *parent) : QObject(parent)
 {
+    this->m_fastBoot = false;
+
     qDebug() << "Boot object created";
 }
 
@@ -143,6 +145,30 @@ void Boot::setKernelArgs(const QString &kernelArgs)
     m_kernelArgs = kernelArgs;
 }
 
+/**
+ * @brief Get if the fast boot profile is enabled
+ * @return true if the fast boot profile is enabled
+ *
+ * Get if the fast boot profile is enabled.
+ * Only used with the direct kernel boot
+ */
+bool Boot::fastBoot() const
+{
+    return m_fastBoot;
+}
+
+/**
+ * @brief Enable the fast boot profile
+ * @param fastBoot, true enable the fast boot profile
+ *
+ * Enable the fast boot profile, the machine is launched as a
+ * microvm with only the virtio devices
+ */
+void Boot::setFastBoot(bool fastBoot)
+{
+    m_fastBoot = fastBoot;
+}
+
 /**
  * @brief Get the boot order
  * @return list with the boot order
@@ -48,6 +48,9 @@ class Boot: public QObject {
         QString kernelArgs() const;
         void setKernelArgs(const QString &kernelArgs);
 
+        bool fastBoot() const;
+        void setFastBoot(bool fastBoot);
+
         QStringList bootOrder() const;
         void setBootOrder(const QStringList &bootOrder);
 
@@ -64,6 +67,7 @@ class Boot: public QObject {
         QString m_kernelPath;
         QString m_initrdPath;
         QString m_kernelArgs;
+        bool m_fastBoot;
         QStringList m_bootOrder;
 
 };
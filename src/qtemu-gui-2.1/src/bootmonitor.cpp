@@ -0,0 +1,407 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "bootmonitor.h"
+
+// Bytes of serial output kept to match a pattern split between reads
+static const int SERIAL_TAIL_SIZE = 4096;
+
+/**
+ * @brief Boot monitor of a machine
+ * @param machinePath, path of the machine
+ * @param machineUuid, uuid of the machine
+ * @param parent, parent object
+ *
+ * Measures the time since QEMU is launched until the guest is ready.
+ * The guest is ready when the serial console prints a pattern, when
+ * the QEMU guest agent answers a ping or when a TCP port of the host,
+ * usually forwarded to the guest, accepts connections
+ */
+BootMonitor::BootMonitor(const QString &machinePath,
+                         const QString &machineUuid,
+                         QObject *parent) : QObject(parent)
+{
+    this->m_agentServerName = BootMonitor::agentServerName(machinePath, machineUuid);
+
+    this->m_mode = BootMonitor::None;
+    this->m_TCPPort = 0;
+    this->m_timeout = 600;
+    this->m_agentPingSent = false;
+    this->m_running = false;
+
+    this->m_agentSocket = new QLocalSocket(this);
+    connect(m_agentSocket, &QLocalSocket::readyRead,
+            this, &BootMonitor::readAgentReply);
+
+    this->m_TCPSocket = new QTcpSocket(this);
+    connect(m_TCPSocket, &QTcpSocket::connected,
+            this, &BootMonitor::TCPConnected);
+    connect(m_TCPSocket, &QTcpSocket::readyRead,
+            this, &BootMonitor::guestReady);
+
+    this->m_TCPCheckTimer = new QTimer(this);
+    this->m_TCPCheckTimer->setSingleShot(true);
+    this->m_TCPCheckTimer->setInterval(1000);
+    connect(m_TCPCheckTimer, &QTimer::timeout,
+            this, &BootMonitor::TCPCheckConnection);
+
+    this->m_pollTimer = new QTimer(this);
+    this->m_pollTimer->setInterval(500);
+    connect(m_pollTimer, &QTimer::timeout,
+            this, &BootMonitor::poll);
+
+    qDebug() << "BootMonitor object created";
+}
+
+BootMonitor::~BootMonitor()
+{
+    this->stop();
+
+    qDebug() << "BootMonitor object destroyed";
+}
+
+/**
+ * @brief Get the mode from the saved string
+ * @param mode, name of the mode
+ * @return the mode, None if unknown
+ *
+ * Get the mode from the saved string
+ */
+BootMonitor::Mode BootMonitor::modeFromString(const QString &mode)
+{
+    if (mode == "serial") {
+        return BootMonitor::SerialPattern;
+    } else if (mode == "agent") {
+        return BootMonitor::GuestAgent;
+    } else if (mode == "tcp") {
+        return BootMonitor::TCPPort;
+    }
+
+    return BootMonitor::None;
+}
+
+/**
+ * @brief Get the string saved for the mode
+ * @param mode, mode of the monitor
+ * @return name of the mode
+ *
+ * Get the string saved for the mode
+ */
+QString BootMonitor::modeToString(BootMonitor::Mode mode)
+{
+    switch (mode) {
+        case BootMonitor::SerialPattern:
+            return "serial";
+        case BootMonitor::GuestAgent:
+            return "agent";
+        case BootMonitor::TCPPort:
+            return "tcp";
+        default:
+            return "none";
+    }
+}
+
+/**
+ * @brief Get the server name of the guest agent
+ * @param machinePath, path of the machine
+ * @param machineUuid, uuid of the machine
+ * @return local socket or named pipe of the guest agent
+ *
+ * Get the server name of the guest agent channel
+ */
+QString BootMonitor::agentServerName(const QString &machinePath, const QString &machineUuid)
+{
+    QString uuid(machineUuid);
+    uuid.remove("{").remove("}");
+
+#ifdef Q_OS_WIN
+    // Named pipe \\.\pipe\qtemu-qga-<uuid>
+    Q_UNUSED(machinePath);
+    return "qtemu-qga-" + uuid;
+#else
+    Q_UNUSED(uuid);
+    return QDir(machinePath).filePath("qga.sock");
+#endif
+}
+
+/**
+ * @brief Get the mode
+ * @return how the readiness of the guest is detected
+ *
+ * Get the mode
+ */
+BootMonitor::Mode BootMonitor::mode() const
+{
+    return this->m_mode;
+}
+
+/**
+ * @brief Set the mode
+ * @param mode, how the readiness of the guest is detected
+ *
+ * Set the mode
+ */
+void BootMonitor::setMode(BootMonitor::Mode mode)
+{
+    this->m_mode = mode;
+}
+
+/**
+ * @brief Set the serial pattern
+ * @param pattern, regular expression printed by the guest when ready
+ *
+ * Set the serial pattern, login: if the pattern is empty
+ */
+void BootMonitor::setSerialPattern(const QString &pattern)
+{
+    this->m_serialPattern.setPattern(pattern.isEmpty() ? QString("login:") : pattern);
+    this->m_serialPattern.setPatternOptions(QRegularExpression::MultilineOption);
+}
+
+/**
+ * @brief Set the TCP port
+ * @param port, port of the host opened when the guest is ready
+ *
+ * Set the TCP port
+ */
+void BootMonitor::setTCPPort(int port)
+{
+    this->m_TCPPort = port;
+}
+
+/**
+ * @brief Set the timeout
+ * @param timeout, seconds waiting for the guest
+ *
+ * Set the timeout
+ */
+void BootMonitor::setTimeout(int timeout)
+{
+    this->m_timeout = timeout;
+}
+
+/**
+ * @brief Get the QEMU arguments
+ * @return arguments that add the guest agent channel
+ *
+ * Only the guest agent mode needs arguments
+ */
+QStringList BootMonitor::QEMUArguments() const
+{
+    QStringList arguments;
+
+    if (this->m_mode != BootMonitor::GuestAgent) {
+        return arguments;
+    }
+
+#ifdef Q_OS_WIN
+    QString chardev = QString("pipe,id=qga0,path=%1").arg(this->m_agentServerName);
+#else
+    QString chardev = QString("socket,id=qga0,path=%1,server,nowait").arg(this->m_agentServerName);
+#endif
+
+    arguments << "-chardev" << chardev
+              << "-device" << "virtio-serial"
+              << "-device" << "virtserialport,chardev=qga0,name=org.qemu.guest_agent.0";
+
+    return arguments;
+}
+
+/**
+ * @brief Start the monitor
+ *
+ * Called when QEMU is launched, the boot time is measured from here
+ */
+void BootMonitor::start()
+{
+    this->stop();
+
+    if (this->m_mode == BootMonitor::None) {
+        return;
+    }
+
+    if (this->m_mode == BootMonitor::SerialPattern && !this->m_serialPattern.isValid()) {
+        qDebug() << "Invalid boot pattern" << this->m_serialPattern.pattern();
+        return;
+    }
+
+    this->m_serialTail.clear();
+    this->m_agentBuffer.clear();
+    this->m_agentPingSent = false;
+    this->m_running = true;
+    this->m_bootTimer.start();
+
+    // The serial console pushes its data, the other modes are polled
+    this->m_pollTimer->start();
+}
+
+/**
+ * @brief Watch the serial console
+ * @param serialConsole, serial console of the machine
+ *
+ * Watch the serial console
+ */
+void BootMonitor::watchSerialConsole(SerialConsole *serialConsole)
+{
+    if (serialConsole == nullptr || this->m_mode != BootMonitor::SerialPattern) {
+        return;
+    }
+
+    connect(serialConsole, &SerialConsole::serialDataSignal,
+            this, &BootMonitor::serialData, Qt::UniqueConnection);
+}
+
+/**
+ * @brief Stop the monitor
+ *
+ * Stop the monitor
+ */
+void BootMonitor::stop()
+{
+    this->m_running = false;
+    this->m_pollTimer->stop();
+    this->m_TCPCheckTimer->stop();
+    this->m_agentSocket->abort();
+    this->m_TCPSocket->abort();
+}
+
+/**
+ * @brief Check if the monitor is waiting for the guest
+ * @return true if the guest is not ready yet
+ *
+ * Check if the monitor is waiting for the guest
+ */
+bool BootMonitor::isRunning() const
+{
+    return this->m_running;
+}
+
+/**
+ * @brief Look for the pattern in the serial data
+ * @param data, data read from the serial console
+ *
+ * Look for the pattern in the serial data
+ */
+void BootMonitor::serialData(const QByteArray &data)
+{
+    if (!this->m_running) {
+        return;
+    }
+
+    this->m_serialTail.append(data);
+    if (this->m_serialTail.size() > SERIAL_TAIL_SIZE) {
+        this->m_serialTail.remove(0, this->m_serialTail.size() - SERIAL_TAIL_SIZE);
+    }
+
+    if (this->m_serialPattern.match(QString::fromUtf8(this->m_serialTail)).hasMatch()) {
+        this->guestReady();
+    }
+}
+
+/**
+ * @brief Poll the guest
+ *
+ * Ping the guest agent or try to connect to the TCP port
+ */
+void BootMonitor::poll()
+{
+    if (this->m_bootTimer.elapsed() > static_cast<qint64>(this->m_timeout) * 1000) {
+        qDebug() << "The guest was not ready after" << this->m_timeout << "seconds";
+        this->stop();
+        emit guestTimeoutSignal();
+        return;
+    }
+
+    if (this->m_mode == BootMonitor::GuestAgent) {
+        if (this->m_agentSocket->state() == QLocalSocket::UnconnectedState) {
+            this->m_agentPingSent = false;
+            this->m_agentSocket->connectToServer(this->m_agentServerName, QIODevice::ReadWrite);
+        }
+
+        // The agent answers the ping once it is running inside the guest
+        if (this->m_agentSocket->state() == QLocalSocket::ConnectedState && !this->m_agentPingSent) {
+            this->m_agentSocket->write("{\"execute\": \"guest-ping\"}\n");
+            this->m_agentPingSent = true;
+        }
+    } else if (this->m_mode == BootMonitor::TCPPort && this->m_TCPPort > 0) {
+        if (this->m_TCPSocket->state() == QAbstractSocket::UnconnectedState) {
+            this->m_TCPSocket->connectToHost("127.0.0.1", static_cast<quint16>(this->m_TCPPort));
+        }
+    }
+}
+
+/**
+ * @brief Read the reply of the guest agent
+ *
+ * Read the reply of the guest agent
+ */
+void BootMonitor::readAgentReply()
+{
+    this->m_agentBuffer.append(this->m_agentSocket->readAll());
+
+    if (this->m_agentBuffer.contains("\"return\"")) {
+        this->guestReady();
+    }
+}
+
+/**
+ * @brief The TCP port accepted the connection
+ *
+ * The user network of QEMU accepts the connections of the forwarded
+ * ports even when nothing listens inside the guest, and closes them
+ * right after. The port is open if the connection survives a second
+ * or the guest sends something, like a SSH banner
+ */
+void BootMonitor::TCPConnected()
+{
+    this->m_TCPCheckTimer->start();
+}
+
+/**
+ * @brief Check if the TCP connection is still open
+ *
+ * Check if the TCP connection is still open
+ */
+void BootMonitor::TCPCheckConnection()
+{
+    if (this->m_TCPSocket->state() == QAbstractSocket::ConnectedState) {
+        this->guestReady();
+    } else {
+        this->m_TCPSocket->abort();
+    }
+}
+
+/**
+ * @brief The guest is ready
+ *
+ * Stop the monitor and emit the boot time
+ */
+void BootMonitor::guestReady()
+{
+    if (!this->m_running) {
+        return;
+    }
+
+    qint64 bootTime = this->m_bootTimer.elapsed();
+    this->stop();
+
+    emit guestReadySignal(bootTime);
+}
@@ -0,0 +1,106 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef BOOTMONITOR_H
+#define BOOTMONITOR_H
+
+// Qt
+#include <QObject>
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QDir>
+
+#include <QDebug>
+
+// Local
+#include "serialconsole.h"
+
+class BootMonitor : public QObject {
+    Q_OBJECT
+
+    public:
+        enum Mode {
+            None, SerialPattern, GuestAgent, TCPPort
+        };
+
+        explicit BootMonitor(const QString &machinePath,
+                             const QString &machineUuid,
+                             QObject *parent = nullptr);
+        ~BootMonitor();
+
+        static Mode modeFromString(const QString &mode);
+        static QString modeToString(Mode mode);
+        static QString agentServerName(const QString &machinePath, const QString &machineUuid);
+
+        Mode mode() const;
+        void setMode(Mode mode);
+        void setSerialPattern(const QString &pattern);
+        void setTCPPort(int port);
+        void setTimeout(int timeout);
+
+        QStringList QEMUArguments() const;
+
+        void start();
+        void watchSerialConsole(SerialConsole *serialConsole);
+        void stop();
+        bool isRunning() const;
+
+    signals:
+        void guestReadySignal(qint64 bootTime);
+        void guestTimeoutSignal();
+
+    public slots:
+
+    private slots:
+        void serialData(const QByteArray &data);
+        void poll();
+        void readAgentReply();
+        void TCPConnected();
+        void TCPCheckConnection();
+
+    protected:
+
+    private:
+        Mode m_mode;
+        QRegularExpression m_serialPattern;
+        QByteArray m_serialTail;
+        int m_TCPPort;
+        int m_timeout;
+
+        QString m_agentServerName;
+        QLocalSocket *m_agentSocket;
+        QByteArray m_agentBuffer;
+        bool m_agentPingSent;
+
+        QTcpSocket *m_TCPSocket;
+        QTimer *m_TCPCheckTimer;
+
+        QTimer *m_pollTimer;
+        QElapsedTimer m_bootTimer;
+        bool m_running;
+
+        // Methods
+        void guestReady();
+};
+
+#endif // BOOTMONITOR_H
@@ -0,0 +1,423 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Qt
+#include <QEventLoop>
+#include <QTimer>
+#include <QSet>
+
+// C++ standard library
+#include <iostream>
+
+// Local
+#include "commandline.h"
+#include "machine.h"
+#include "machineutils.h"
+#include "qemubinaryregistry.h"
+#include "qmpclient.h"
+#include "controlserver.h"
+#include "balloonmanager.h"
+#include "ksmmonitor.h"
+#include "machinepool.h"
+#include "utils/logger.h"
+
+// UNIX
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#endif
+
+/**
+ * @brief Command line mode
+ * @param parent, parent object
+ *
+ * Lists, starts and stops the machines, or serves the control
+ * socket, without the GUI. No widget is created, it runs
+ * under a QCoreApplication
+ */
+CommandLine::CommandLine(QObject *parent) : QObject(parent)
+{
+    QSettings settings;
+    settings.beginGroup("DataFolder");
+    this->m_dataDirectoryPath = settings.value("QtEmuData",
+                                               QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/")).toString();
+    settings.endGroup();
+
+    qDebug() << "CommandLine object created";
+}
+
+CommandLine::~CommandLine()
+{
+    qDebug() << "CommandLine object destroyed";
+}
+
+/**
+ * @brief Check if the arguments ask for the command line mode
+ * @param argc, number of arguments
+ * @param argv, arguments
+ * @return true if there's a --list, --start, --stop or --daemon argument
+ *
+ * Checked before the application is created, the
+ * command line mode doesn't need a QApplication
+ */
+bool CommandLine::isCommand(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        QString argument = QString::fromLocal8Bit(argv[i]);
+        if (argument == "--list" || argument == "--daemon" ||
+            argument == "--start" || argument.startsWith("--start=") ||
+            argument == "--stop" || argument.startsWith("--stop=")) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Run the command
+ * @param arguments, arguments of the application
+ * @return exit code
+ *
+ * Run the command
+ */
+int CommandLine::exec(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("QtEmu command line mode"));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption(QCommandLineOption("list", tr("List the machines.")));
+    parser.addOption(QCommandLineOption("start", tr("Start the machine."), tr("name|uuid")));
+    parser.addOption(QCommandLineOption("stop", tr("Stop the machine."), tr("name|uuid")));
+    parser.addOption(QCommandLineOption("headless", tr("Start the machine without display.")));
+    parser.addOption(QCommandLineOption("force", tr("Quit QEMU instead of powering down the guest.")));
+    parser.addOption(QCommandLineOption("daemon", tr("Serve the control socket without GUI.")));
+    parser.process(arguments);
+
+    int exitCode = 0;
+    if (parser.isSet("list")) {
+        exitCode = this->listMachines();
+    } else if (parser.isSet("start")) {
+        exitCode = this->startMachine(parser.value("start"), parser.isSet("headless"));
+    } else if (parser.isSet("stop")) {
+        exitCode = this->stopMachine(parser.value("stop"), parser.isSet("force"));
+    } else if (parser.isSet("daemon")) {
+        exitCode = this->runDaemon();
+    }
+
+    Logger::stop();
+
+    return exitCode;
+}
+
+/**
+ * @brief List the machines
+ * @return exit code
+ *
+ * Print the name, uuid and state of every machine
+ */
+int CommandLine::listMachines()
+{
+    QJsonArray machines = this->catalogMachines();
+
+    for (int i = 0; i < machines.size(); ++i) {
+        QJsonObject machineJSON = machines.at(i).toObject();
+        qint64 pid = this->runningProcessId(machineJSON);
+
+        std::cout << qPrintable(QString("%1\t%2\t%3")
+                                .arg(machineJSON["name"].toString())
+                                .arg(machineJSON["uuid"].toString())
+                                .arg(pid > 0 ? QString("running (%1)").arg(pid) : QString("stopped")))
+                  << std::endl;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Start a machine
+ * @param machine, name or uuid of the machine
+ * @param headless, true to start the machine without display
+ * @return exit code
+ *
+ * Start a machine detached from QtEmu
+ */
+int CommandLine::startMachine(const QString &machine, bool headless)
+{
+    QJsonObject machineJSON = this->findMachine(machine);
+    if (machineJSON.isEmpty()) {
+        std::cerr << qPrintable(tr("Machine not found: %1").arg(machine)) << std::endl;
+        return 1;
+    }
+
+    qint64 runningPid = this->runningProcessId(machineJSON);
+    if (runningPid > 0) {
+        std::cerr << qPrintable(tr("The machine is already running with PID %1").arg(runningPid)) << std::endl;
+        return 1;
+    }
+
+    QString program = this->QEMUBinary(machineJSON["binary"].toString("qemu-system-x86_64"));
+    if (program.isEmpty()) {
+        std::cerr << qPrintable(tr("QEMU binary not found")) << std::endl;
+        return 1;
+    }
+
+    Machine machineObject;
+    MachineUtils::fillMachineObject(&machineObject,
+                                    machineJSON,
+                                    machineJSON["configpath"].toString());
+
+    qint64 pid = 0;
+    if (!machineObject.launchDetached(program, headless, &pid)) {
+        std::cerr << qPrintable(tr("Cannot launch %1").arg(program)) << std::endl;
+        return 1;
+    }
+
+    std::cout << pid << std::endl;
+
+    return 0;
+}
+
+/**
+ * @brief Stop a machine
+ * @param machine, name or uuid of the machine
+ * @param force, true to quit QEMU instead of powering down the guest
+ * @return exit code
+ *
+ * Stop a machine with the QMP socket
+ */
+int CommandLine::stopMachine(const QString &machine, bool force)
+{
+    QJsonObject machineJSON = this->findMachine(machine);
+    if (machineJSON.isEmpty()) {
+        std::cerr << qPrintable(tr("Machine not found: %1").arg(machine)) << std::endl;
+        return 1;
+    }
+
+    bool stopped = false;
+    QEventLoop eventLoop;
+
+    QMPClient qmpClient(machineJSON["path"].toString(), machineJSON["uuid"].toString());
+    connect(&qmpClient, &QMPClient::readySignal, &eventLoop, [&]() {
+        qmpClient.execute(force ? "quit" : "system_powerdown", QJsonObject(),
+                          [&](const QJsonObject &reply) {
+            stopped = reply.contains("return");
+            eventLoop.quit();
+        });
+    });
+    connect(&qmpClient, &QMPClient::disconnectedSignal,
+            &eventLoop, &QEventLoop::quit);
+
+    QTimer::singleShot(5000, &eventLoop, &QEventLoop::quit);
+    qmpClient.connectToMachine();
+    eventLoop.exec();
+
+    if (!stopped) {
+        std::cerr << qPrintable(tr("Cannot connect to the machine, is it running?")) << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Run the control server
+ * @return exit code
+ *
+ * Load all the machines and serve the control socket
+ * until QtEmu is killed
+ */
+int CommandLine::runDaemon()
+{
+    this->loadNewMachines();
+
+    QEMU *qemuGlobalObject = new QEMU(this);
+    ControlServer *controlServer = new ControlServer(&this->m_machines, qemuGlobalObject, this);
+    if (!controlServer->isListening()) {
+        std::cerr << qPrintable(tr("Cannot serve the control socket")) << std::endl;
+        return 1;
+    }
+
+    new BalloonManager(&this->m_machines, qemuGlobalObject, this);
+    new KSMMonitor(&this->m_machines, qemuGlobalObject, this);
+
+    MachinePool *machinePool = new MachinePool(&this->m_machines, qemuGlobalObject, this);
+    connect(machinePool, &MachinePool::machinesProvisionedSignal,
+            this, &CommandLine::loadNewMachines);
+
+    std::cout << qPrintable(controlServer->serverName()) << std::endl;
+
+    return QCoreApplication::exec();
+}
+
+/**
+ * @brief Load the new machines of the catalog
+ *
+ * Load the machines of the catalog that
+ * are not loaded yet
+ */
+void CommandLine::loadNewMachines()
+{
+    QSet<QString> loadedUuids;
+    foreach (Machine *machine, this->m_machines) {
+        loadedUuids.insert(machine->getUuid());
+    }
+
+    QJsonArray machines = this->catalogMachines();
+    for (int i = 0; i < machines.size(); ++i) {
+        QJsonObject machineJSON = machines.at(i).toObject();
+        if (loadedUuids.contains(machineJSON["uuid"].toString())) {
+            continue;
+        }
+
+        Machine *machine = new Machine(this);
+        MachineUtils::fillMachineObject(machine,
+                                        machineJSON,
+                                        machineJSON["configpath"].toString());
+        this->m_machines.append(machine);
+    }
+}
+
+/**
+ * @brief Get the machines of the catalog
+ * @return machines with the data of their config files
+ *
+ * Read the qtemu.json file and the config file of every machine
+ */
+QJsonArray CommandLine::catalogMachines() const
+{
+    QJsonArray machines;
+
+    QFile machinesFile(QDir(this->m_dataDirectoryPath).filePath("qtemu.json"));
+    if (!machinesFile.open(QFile::ReadOnly)) {
+        return machines;
+    }
+
+    QJsonArray catalog = QJsonDocument::fromJson(machinesFile.readAll())["machines"].toArray();
+    for (int i = 0; i < catalog.size(); ++i) {
+        QJsonObject catalogMachine = catalog.at(i).toObject();
+
+        QFile machineFile(catalogMachine["configpath"].toString());
+        if (!machineFile.open(QFile::ReadOnly)) {
+            continue;
+        }
+
+        QJsonObject machineJSON = QJsonDocument::fromJson(machineFile.readAll()).object();
+        machineJSON["configpath"] = catalogMachine["configpath"];
+        machines.append(machineJSON);
+    }
+
+    return machines;
+}
+
+/**
+ * @brief Find a machine
+ * @param machine, name or uuid of the machine
+ * @return data of the machine, empty if not found
+ *
+ * Find a machine
+ */
+QJsonObject CommandLine::findMachine(const QString &machine) const
+{
+    QJsonArray machines = this->catalogMachines();
+    QString machineUuid = QUuid(machine).toString();
+
+    for (int i = 0; i < machines.size(); ++i) {
+        QJsonObject machineJSON = machines.at(i).toObject();
+        if (machineJSON["name"].toString() == machine ||
+            (!QUuid(machine).isNull() && machineJSON["uuid"].toString() == machineUuid)) {
+            return machineJSON;
+        }
+    }
+
+    return QJsonObject();
+}
+
+/**
+ * @brief Get the process of a running machine
+ * @param machineJSON, data of the machine
+ * @return PID of QEMU, 0 if the machine isn't running
+ *
+ * QEMU writes the PID file of the machine when it starts
+ * and removes it when it exits
+ */
+qint64 CommandLine::runningProcessId(const QJsonObject &machineJSON) const
+{
+    QString pidFilePath = QDir(machineJSON["path"].toString())
+                          .filePath(machineJSON["name"].toString() + ".pid");
+
+    QFile pidFile(pidFilePath);
+    if (!pidFile.open(QFile::ReadOnly)) {
+        return 0;
+    }
+
+    qint64 pid = pidFile.readAll().trimmed().toLongLong();
+    if (pid <= 0) {
+        return 0;
+    }
+
+#ifdef Q_OS_UNIX
+    // The PID file of a killed QEMU isn't removed
+    if (kill(static_cast<pid_t>(pid), 0) != 0) {
+        return 0;
+    }
+#endif
+
+    return pid;
+}
+
+/**
+ * @brief Get the path of a QEMU binary
+ * @param binary, name of the binary
+ * @return path of the binary, empty if not found
+ *
+ * Use the binaries found by the last scan of the GUI, without
+ * scanning again, or look for the binary in the configured path
+ */
+QString CommandLine::QEMUBinary(const QString &binary) const
+{
+    QSettings settings;
+    settings.beginGroup("Configuration");
+#ifdef Q_OS_FREEBSD
+    QString binariesPath = settings.value("qemuBinaryPath", QDir::toNativeSeparators("/usr/local/bin/")).toString();
+#else
+    QString binariesPath = settings.value("qemuBinaryPath", QDir::toNativeSeparators("/usr/bin")).toString();
+#endif
+    settings.endGroup();
+
+    QString binaryName = binary;
+#ifdef Q_OS_WIN
+    if (!binaryName.endsWith(".exe")) {
+        binaryName.append(".exe");
+    }
+#endif
+
+    QEMUBinaryRegistry binaryRegistry;
+    binaryRegistry.setPath(binariesPath);
+
+    QString binaryPath = binaryRegistry.binaries().value(binaryName);
+    if (!binaryPath.isEmpty()) {
+        return binaryPath;
+    }
+
+    binaryPath = QDir(binariesPath).filePath(binaryName);
+
+    return QFile::exists(binaryPath) ? binaryPath : QString();
+}
@@ -0,0 +1,75 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+// Qt
+#include <QObject>
+#include <QCommandLineParser>
+#include <QSettings>
+#include <QDir>
+#include <QFile>
+#include <QUuid>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <QDebug>
+
+class Machine; // Forward declaration
+
+class CommandLine : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit CommandLine(QObject *parent = nullptr);
+        ~CommandLine();
+
+        static bool isCommand(int argc, char *argv[]);
+
+        int exec(const QStringList &arguments);
+
+    signals:
+
+    public slots:
+
+    private slots:
+        void loadNewMachines();
+
+    protected:
+
+    private:
+        QString m_dataDirectoryPath;
+        QList<Machine *> m_machines;
+
+        // Methods
+        int listMachines();
+        int startMachine(const QString &machine, bool headless);
+        int stopMachine(const QString &machine, bool force);
+        int runDaemon();
+
+        QJsonArray catalogMachines() const;
+        QJsonObject findMachine(const QString &machine) const;
+        qint64 runningProcessId(const QJsonObject &machineJSON) const;
+        QString QEMUBinary(const QString &binary) const;
+};
+
+#endif // COMMANDLINE_H
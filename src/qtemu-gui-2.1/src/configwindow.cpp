@@ -39,6 +39,8 @@ ConfigWindow::ConfigWindow(QEMU *QEMUGlobalObject, QWidget *parent) : QWidget(pa
     this->setMinimumSize(640, 520);
 
     this->m_QEMUObject = QEMUGlobalObject;
+    connect(m_QEMUObject, &QEMU::QEMUBinariesChangedSignal,
+            this, &ConfigWindow::insertBinariesInTree);
 
     this->createGeneralPage();
     this->createUpdatePage();
@@ -420,12 +422,13 @@ void ConfigWindow::createQEMUPage()
             this, &ConfigWindow::findBinaries);
 
     QStringList labels;
-    labels << "Name" << "Path";
+    labels << "Name" << "Version" << "Path";
 
     m_binariesTableWidget = new QTableWidget(this);
-    m_binariesTableWidget->setColumnCount(2);
+    m_binariesTableWidget->setColumnCount(3);
     m_binariesTableWidget->setColumnWidth(0, 150);
-    m_binariesTableWidget->setColumnWidth(1, 220);
+    m_binariesTableWidget->setColumnWidth(1, 70);
+    m_binariesTableWidget->setColumnWidth(2, 220);
     m_binariesTableWidget->setLayoutDirection(Qt::LeftToRight);
     m_binariesTableWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
     m_binariesTableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -493,8 +496,11 @@ void ConfigWindow::insertBinariesInTree()
         QTableWidgetItem *binaryItem = new QTableWidgetItem(iterator.key());
         this->m_binariesTableWidget->setItem(this->m_binariesTableWidget->rowCount()-1, 0, binaryItem);
 
-        binaryItem = new QTableWidgetItem(iterator.value());
+        binaryItem = new QTableWidgetItem(this->m_QEMUObject->binaryRegistry()->binaryVersion(iterator.key()));
         this->m_binariesTableWidget->setItem(this->m_binariesTableWidget->rowCount()-1, 1, binaryItem);
+
+        binaryItem = new QTableWidgetItem(iterator.value());
+        this->m_binariesTableWidget->setItem(this->m_binariesTableWidget->rowCount()-1, 2, binaryItem);
     }
 }
 
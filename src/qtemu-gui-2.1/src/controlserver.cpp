@@ -0,0 +1,605 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "controlserver.h"
+
+// Bytes of a request line, longer lines close the connection
+static const int MAX_REQUEST_SIZE = 1024 * 1024;
+
+/**
+ * @brief Control server
+ * @param machines, machines of QtEmu
+ * @param QEMUGlobalObject, QEMU global object
+ * @param parent, parent object
+ *
+ * JSON-RPC 2.0 service in a local socket, one request or
+ * response per line. The requests of a connection are pipelined,
+ * every response carries the id of its request and the slow ones,
+ * like the QMP commands, can arrive out of order. The Control
+ * settings group has the options:
+ * enabled: serve the control socket
+ * socketPath: path of the socket
+ */
+ControlServer::ControlServer(QList<Machine *> *machines,
+                             QEMU *QEMUGlobalObject,
+                             QObject *parent) : QObject(parent)
+{
+    this->m_machines = machines;
+    this->m_qemuGlobalObject = QEMUGlobalObject;
+
+    QSettings settings;
+    settings.beginGroup("DataFolder");
+    QString dataDirectoryPath = settings.value("QtEmuData",
+                                               QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/")).toString();
+    settings.endGroup();
+
+    settings.beginGroup("Control");
+    bool enabled = settings.value("enabled", true).toBool();
+#ifdef Q_OS_WIN
+    QString socketPath = settings.value("socketPath", "qtemu-control").toString();
+#else
+    QString socketPath = settings.value("socketPath", dataDirectoryPath + "control.sock").toString();
+#endif
+    settings.endGroup();
+
+    this->m_localServer = new QLocalServer(this);
+    this->m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_localServer, &QLocalServer::newConnection,
+            this, &ControlServer::newConnection);
+
+    if (enabled) {
+        // Don't steal the socket of other QtEmu, only remove a stale one
+        QLocalSocket probeSocket;
+        probeSocket.connectToServer(socketPath);
+        if (probeSocket.waitForConnected(100)) {
+            qDebug() << "The control socket is served by other QtEmu" << socketPath;
+        } else {
+            QLocalServer::removeServer(socketPath);
+            if (!this->m_localServer->listen(socketPath)) {
+                qDebug() << "Cannot serve the control socket" << socketPath << this->m_localServer->errorString();
+            }
+        }
+    }
+
+    this->watchMachines();
+
+    qDebug() << "ControlServer object created";
+}
+
+ControlServer::~ControlServer()
+{
+    this->m_localServer->close();
+
+    qDebug() << "ControlServer object destroyed";
+}
+
+/**
+ * @brief Get the server name
+ * @return path of the socket or name of the pipe
+ *
+ * Get the server name
+ */
+QString ControlServer::serverName() const
+{
+    return this->m_localServer->fullServerName();
+}
+
+/**
+ * @brief Know if the server is listening
+ * @return true if the clients can connect
+ *
+ * Know if the server is listening
+ */
+bool ControlServer::isListening() const
+{
+    return this->m_localServer->isListening();
+}
+
+/**
+ * @brief Watch the machines
+ *
+ * Connect to the signals of the machines not watched yet,
+ * called when the list of machines changes
+ */
+void ControlServer::watchMachines()
+{
+    foreach (Machine *machine, *this->m_machines) {
+        if (this->m_watchedMachines.contains(machine)) {
+            continue;
+        }
+
+        this->m_watchedMachines.insert(machine);
+        connect(machine, &Machine::machineStateChangedSignal,
+                this, &ControlServer::machineStateChanged);
+        connect(machine, &Machine::machineEventSignal,
+                this, &ControlServer::machineEvent);
+        connect(machine, &Machine::machineBootedSignal,
+                this, &ControlServer::machineBooted);
+        connect(machine, &QObject::destroyed, this, [this, machine]() {
+            this->m_watchedMachines.remove(machine);
+        });
+    }
+}
+
+/**
+ * @brief New client
+ *
+ * New client
+ */
+void ControlServer::newConnection()
+{
+    while (this->m_localServer->hasPendingConnections()) {
+        QLocalSocket *socket = this->m_localServer->nextPendingConnection();
+
+        Client client;
+        client.subscribedAll = false;
+        this->m_clients.insert(socket, client);
+
+        connect(socket, &QLocalSocket::readyRead,
+                this, &ControlServer::readRequests);
+        connect(socket, &QLocalSocket::disconnected,
+                this, &ControlServer::clientDisconnected);
+    }
+}
+
+/**
+ * @brief Read the requests of a client
+ *
+ * Every complete line is a request
+ */
+void ControlServer::readRequests()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(this->sender());
+    if (socket == nullptr || !this->m_clients.contains(socket)) {
+        return;
+    }
+
+    QByteArray &buffer = this->m_clients[socket].buffer;
+    buffer.append(socket->readAll());
+
+    int lineStart = 0;
+    int lineEnd;
+    while ((lineEnd = buffer.indexOf('\n', lineStart)) != -1) {
+        QByteArray line = buffer.mid(lineStart, lineEnd - lineStart).trimmed();
+        lineStart = lineEnd + 1;
+
+        if (!line.isEmpty()) {
+            this->handleRequest(socket, line);
+        }
+
+        // The request could close the connection
+        if (!this->m_clients.contains(socket)) {
+            return;
+        }
+    }
+
+    QByteArray &pendingBuffer = this->m_clients[socket].buffer;
+    pendingBuffer.remove(0, lineStart);
+
+    if (pendingBuffer.size() > MAX_REQUEST_SIZE) {
+        qDebug() << "Control request too long, closing the connection";
+        socket->abort();
+    }
+}
+
+/**
+ * @brief A client is disconnected
+ *
+ * A client is disconnected
+ */
+void ControlServer::clientDisconnected()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(this->sender());
+    if (socket == nullptr) {
+        return;
+    }
+
+    this->m_clients.remove(socket);
+    socket->deleteLater();
+}
+
+/**
+ * @brief Handle a request
+ * @param socket, socket of the client
+ * @param line, JSON-RPC request
+ *
+ * Methods:
+ * list: machines with their state
+ * start, stop, pause, resume: {"machine": name or uuid}, stop accepts "force"
+ * saveState: {"machine", "tag"}, savevm of the machine
+ * stats: {"machine"}, state and times of the machine
+ * subscribe, unsubscribe: {"machines": [names or uuids]}, all if empty
+ */
+void ControlServer::handleRequest(QLocalSocket *socket, const QByteArray &line)
+{
+    QJsonParseError parseError;
+    QJsonDocument requestDocument = QJsonDocument::fromJson(line, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        this->sendError(socket, QJsonValue(), ParseError, parseError.errorString());
+        return;
+    }
+
+    // value() keeps the id undefined in the notifications
+    QJsonObject request = requestDocument.object();
+    QJsonValue id = request.value("id");
+    QString method = request.value("method").toString();
+    QJsonObject params = request.value("params").toObject();
+
+    // The invalid requests are answered even without id
+    if (!requestDocument.isObject() || method.isEmpty()) {
+        this->sendError(socket, id.isUndefined() ? QJsonValue() : id, InvalidRequest, "Invalid request");
+        return;
+    }
+
+    // Machines created or imported since the last request
+    this->watchMachines();
+
+    if (method == "list") {
+        QJsonArray machines;
+        foreach (const Machine *machine, *this->m_machines) {
+            machines.append(this->machineObject(machine));
+        }
+        this->sendResult(socket, id, machines);
+        return;
+    }
+
+    if (method == "subscribe" || method == "unsubscribe") {
+        Client &client = this->m_clients[socket];
+        QJsonArray machines = params["machines"].toArray();
+        bool subscribe = method == "subscribe";
+
+        if (machines.isEmpty()) {
+            client.subscribedAll = subscribe;
+            if (!subscribe) {
+                client.subscriptions.clear();
+            }
+        }
+
+        for (int i = 0; i < machines.size(); ++i) {
+            Machine *machine = this->findMachine(machines.at(i).toString());
+            if (machine == nullptr) {
+                this->sendError(socket, id, MachineNotFound, "Machine not found: " + machines.at(i).toString());
+                return;
+            }
+
+            if (subscribe) {
+                client.subscriptions.insert(machine->getUuid());
+            } else {
+                client.subscriptions.remove(machine->getUuid());
+            }
+        }
+
+        this->sendResult(socket, id, true);
+        return;
+    }
+
+    if (method != "start" && method != "stop" && method != "pause" &&
+        method != "resume" && method != "saveState" && method != "stats") {
+        this->sendError(socket, id, MethodNotFound, "Method not found: " + method);
+        return;
+    }
+
+    if (!params["machine"].isString()) {
+        this->sendError(socket, id, InvalidParams, "The machine param is required");
+        return;
+    }
+
+    Machine *machine = this->findMachine(params["machine"].toString());
+    if (machine == nullptr) {
+        this->sendError(socket, id, MachineNotFound, "Machine not found: " + params["machine"].toString());
+        return;
+    }
+
+    if (method == "stats") {
+        QJsonObject stats = this->machineObject(machine);
+        stats["uptime"]        = machine->getUptime();
+        stats["launchLatency"] = machine->getLaunchLatency();
+        stats["lastBootTime"]  = machine->getLastBootTime();
+        stats["restartPolicy"] = machine->getRestartPolicy();
+        stats["restartPending"] = machine->getSupervisor()->isRestartPending();
+        stats["crashCount"]    = machine->getSupervisor()->crashCount();
+        stats["pooled"]        = machine->getPooled();
+        stats["prewarmed"]     = machine->isPrewarmed();
+        this->sendResult(socket, id, stats);
+    } else if (method == "start") {
+        if (machine->getState() != Machine::Stopped) {
+            this->sendError(socket, id, InvalidState, "The machine is not stopped");
+            return;
+        }
+        AdmissionController *admissionController = this->m_qemuGlobalObject->admissionController();
+        if (!machine->runMachine(this->m_qemuGlobalObject) && !admissionController->isQueued(machine)) {
+            this->sendError(socket, id, AdmissionRefused,
+                            "The machine is not launched: " + admissionController->reason(machine));
+            return;
+        }
+        QJsonObject result = this->machineObject(machine);
+        result["queued"] = admissionController->isQueued(machine);
+        result["admission"] = admissionController->reason(machine);
+        this->sendResult(socket, id, result);
+    } else if (method == "stop") {
+        if (this->m_qemuGlobalObject->admissionController()->isQueued(machine)) {
+            this->m_qemuGlobalObject->admissionController()->cancel(machine);
+            this->sendResult(socket, id, this->machineObject(machine));
+            return;
+        }
+        if (machine->getState() == Machine::Stopped) {
+            this->sendError(socket, id, InvalidState, "The machine is stopped");
+            return;
+        }
+        machine->getSupervisor()->stopRequested();
+        this->executeQMP(socket, id, machine, params["force"].toBool() ? "quit" : "system_powerdown");
+    } else if (method == "pause" || method == "resume") {
+        Machine::States expectedState = method == "pause" ? Machine::Started : Machine::Paused;
+        if (machine->getState() != expectedState) {
+            this->sendError(socket, id, InvalidState,
+                            "The machine is " + ControlServer::stateName(machine->getState()));
+            return;
+        }
+        machine->pauseMachine();
+        this->sendResult(socket, id, this->machineObject(machine));
+    } else if (method == "saveState") {
+        if (machine->getState() == Machine::Stopped) {
+            this->sendError(socket, id, InvalidState, "The machine is stopped");
+            return;
+        }
+        QString tag = params["tag"].toString("qtemu");
+        QJsonObject arguments;
+        arguments["command-line"] = "savevm " + tag;
+        this->executeQMP(socket, id, machine, "human-monitor-command", arguments);
+    }
+}
+
+/**
+ * @brief Execute a QMP command and reply with its result
+ * @param socket, socket of the client
+ * @param id, id of the request
+ * @param machine, machine
+ * @param command, QMP command
+ * @param arguments, arguments of the command
+ *
+ * Execute a QMP command and reply with its result
+ */
+void ControlServer::executeQMP(QLocalSocket *socket, const QJsonValue &id, Machine *machine,
+                               const QString &command, const QJsonObject &arguments)
+{
+    QMPClient *qmpClient = machine->getQMPClient();
+    if (qmpClient == nullptr || !qmpClient->isReady()) {
+        this->sendError(socket, id, QMPError, "The QMP connection of the machine is not ready");
+        return;
+    }
+
+    QPointer<QLocalSocket> client(socket);
+    qmpClient->execute(command, arguments, [this, client, id](const QJsonObject &reply) {
+        if (client.isNull() || !this->m_clients.contains(client.data())) {
+            return;
+        }
+
+        if (reply.contains("error")) {
+            this->sendError(client.data(), id, QMPError,
+                            reply["error"].toObject()["desc"].toString());
+        } else {
+            this->sendResult(client.data(), id, reply["return"]);
+        }
+    });
+}
+
+/**
+ * @brief Send a result
+ * @param socket, socket of the client
+ * @param id, id of the request
+ * @param result, result of the request
+ *
+ * Requests without id are notifications and get no response
+ */
+void ControlServer::sendResult(QLocalSocket *socket, const QJsonValue &id, const QJsonValue &result)
+{
+    if (id.isUndefined()) {
+        return;
+    }
+
+    QJsonObject response;
+    response["jsonrpc"] = "2.0";
+    response["id"]      = id;
+    response["result"]  = result;
+
+    socket->write(QJsonDocument(response).toJson(QJsonDocument::Compact).append('\n'));
+}
+
+/**
+ * @brief Send an error
+ * @param socket, socket of the client
+ * @param id, id of the request, null if it couldn't be read
+ * @param code, JSON-RPC error code
+ * @param message, description of the error
+ *
+ * Send an error. Requests without id are notifications
+ * and get no response, the parse errors and the invalid
+ * requests are answered with a null id
+ */
+void ControlServer::sendError(QLocalSocket *socket, const QJsonValue &id,
+                              ControlServer::ErrorCode code, const QString &message)
+{
+    if (id.isUndefined()) {
+        return;
+    }
+
+    QJsonObject error;
+    error["code"]    = code;
+    error["message"] = message;
+
+    QJsonObject response;
+    response["jsonrpc"] = "2.0";
+    response["id"]      = id;
+    response["error"]   = error;
+
+    socket->write(QJsonDocument(response).toJson(QJsonDocument::Compact).append('\n'));
+}
+
+/**
+ * @brief Send a notification to the subscribed clients
+ * @param machine, machine of the notification
+ * @param method, name of the notification
+ * @param params, params of the notification
+ *
+ * Send a notification to the subscribed clients
+ */
+void ControlServer::sendNotification(Machine *machine, const QString &method, const QJsonObject &params)
+{
+    QByteArray notificationData;
+
+    QHash<QLocalSocket *, Client>::const_iterator it;
+    for (it = this->m_clients.constBegin(); it != this->m_clients.constEnd(); ++it) {
+        if (!it.value().subscribedAll && !it.value().subscriptions.contains(machine->getUuid())) {
+            continue;
+        }
+
+        // Serialized once for all the clients
+        if (notificationData.isEmpty()) {
+            QJsonObject notificationParams(params);
+            notificationParams["machine"] = machine->getUuid();
+            notificationParams["name"]    = machine->getName();
+
+            QJsonObject notification;
+            notification["jsonrpc"] = "2.0";
+            notification["method"]  = method;
+            notification["params"]  = notificationParams;
+            notificationData = QJsonDocument(notification).toJson(QJsonDocument::Compact).append('\n');
+        }
+
+        it.key()->write(notificationData);
+    }
+}
+
+/**
+ * @brief The state of a machine changed
+ * @param newState, new state of the machine
+ *
+ * Send a machine.state notification
+ */
+void ControlServer::machineStateChanged(Machine::States newState)
+{
+    Machine *machine = qobject_cast<Machine *>(this->sender());
+    if (machine == nullptr) {
+        return;
+    }
+
+    QJsonObject params;
+    params["state"] = ControlServer::stateName(newState);
+    this->sendNotification(machine, "machine.state", params);
+}
+
+/**
+ * @brief A machine sent a QMP event
+ * @param event, name of the event
+ * @param data, data of the event
+ *
+ * Send a machine.event notification
+ */
+void ControlServer::machineEvent(const QString &event, const QJsonObject &data)
+{
+    Machine *machine = qobject_cast<Machine *>(this->sender());
+    if (machine == nullptr) {
+        return;
+    }
+
+    QJsonObject params;
+    params["event"] = event;
+    params["data"]  = data;
+    this->sendNotification(machine, "machine.event", params);
+}
+
+/**
+ * @brief The guest of a machine is ready
+ * @param bootTime, boot time of the machine
+ *
+ * Send a machine.booted notification
+ */
+void ControlServer::machineBooted(qint64 bootTime)
+{
+    Machine *machine = qobject_cast<Machine *>(this->sender());
+    if (machine == nullptr) {
+        return;
+    }
+
+    QJsonObject params;
+    params["bootTime"] = bootTime;
+    this->sendNotification(machine, "machine.booted", params);
+}
+
+/**
+ * @brief Find a machine
+ * @param machine, name or uuid of the machine
+ * @return the machine, nullptr if not found
+ *
+ * Find a machine
+ */
+Machine *ControlServer::findMachine(const QString &machine) const
+{
+    QUuid machineUuid(machine);
+
+    foreach (Machine *machineObject, *this->m_machines) {
+        if (machineObject->getName() == machine ||
+            (!machineUuid.isNull() && machineObject->getUuid() == machineUuid.toString())) {
+            return machineObject;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Get the data of a machine
+ * @param machine, machine
+ * @return name, uuid, state and process id of the machine
+ *
+ * Get the data of a machine
+ */
+QJsonObject ControlServer::machineObject(const Machine *machine) const
+{
+    QJsonObject machineJSON;
+    machineJSON["name"]  = machine->getName();
+    machineJSON["uuid"]  = machine->getUuid();
+    machineJSON["state"] = ControlServer::stateName(machine->getState());
+    machineJSON["pid"]   = machine->getProcessId();
+
+    return machineJSON;
+}
+
+/**
+ * @brief Get the name of a state
+ * @param state, state of a machine
+ * @return name of the state
+ *
+ * Get the name of a state
+ */
+QString ControlServer::stateName(Machine::States state)
+{
+    switch (state) {
+        case Machine::Started:
+            return "started";
+        case Machine::Paused:
+            return "paused";
+        case Machine::Saved:
+            return "saved";
+        default:
+            return "stopped";
+    }
+}
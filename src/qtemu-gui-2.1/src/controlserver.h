@@ -0,0 +1,109 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+// Qt
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QSettings>
+#include <QHash>
+#include <QSet>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <QDebug>
+
+// Local
+#include "machine.h"
+#include "qemu.h"
+
+class ControlServer : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit ControlServer(QList<Machine *> *machines,
+                               QEMU *QEMUGlobalObject,
+                               QObject *parent = nullptr);
+        ~ControlServer();
+
+        enum ErrorCode {
+            ParseError = -32700,
+            InvalidRequest = -32600,
+            MethodNotFound = -32601,
+            InvalidParams = -32602,
+            MachineNotFound = -32000,
+            InvalidState = -32001,
+            QMPError = -32002,
+            AdmissionRefused = -32003
+        };
+
+        QString serverName() const;
+        bool isListening() const;
+        void watchMachines();
+
+    signals:
+
+    public slots:
+
+    private slots:
+        void newConnection();
+        void readRequests();
+        void clientDisconnected();
+        void machineStateChanged(Machine::States newState);
+        void machineEvent(const QString &event, const QJsonObject &data);
+        void machineBooted(qint64 bootTime);
+
+    protected:
+
+    private:
+        struct Client {
+            QByteArray buffer;
+            bool subscribedAll;
+            QSet<QString> subscriptions;
+        };
+
+        QList<Machine *> *m_machines;
+        QEMU *m_qemuGlobalObject;
+
+        QLocalServer *m_localServer;
+        QHash<QLocalSocket *, Client> m_clients;
+        QSet<Machine *> m_watchedMachines;
+
+        // Methods
+        void handleRequest(QLocalSocket *socket, const QByteArray &line);
+        void sendResult(QLocalSocket *socket, const QJsonValue &id, const QJsonValue &result);
+        void sendError(QLocalSocket *socket, const QJsonValue &id,
+                       ErrorCode code, const QString &message);
+        void sendNotification(Machine *machine, const QString &method, const QJsonObject &params);
+        void executeQMP(QLocalSocket *socket, const QJsonValue &id, Machine *machine,
+                        const QString &command, const QJsonObject &arguments = QJsonObject());
+
+        Machine *findMachine(const QString &machine) const;
+        QJsonObject machineObject(const Machine *machine) const;
+        static QString stateName(Machine::States state);
+};
+
+#endif // CONTROLSERVER_H
@@ -0,0 +1,283 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "hostportregistry.h"
+#include "machine.h"
+
+/**
+ * @brief Registry of the host ports of the machines
+ * @param parent, parent object
+ *
+ * Registry of the host ports forwarded to the machines with
+ * the user mode network. The ports of a machine are reserved
+ * when it's launched, a port reserved by other machine or
+ * used by other program of the host is a conflict and the
+ * machine isn't launched.
+ * The rules use the hostfwd syntax of QEMU
+ * Ex: tcp:127.0.0.1:2222-:22
+ */
+HostPortRegistry::HostPortRegistry(QObject *parent) : QObject(parent)
+{
+    qDebug() << "HostPortRegistry object created";
+}
+
+HostPortRegistry::~HostPortRegistry()
+{
+    qDebug() << "HostPortRegistry object destroyed";
+}
+
+/**
+ * @brief Parse the host part of a rule
+ * @param rule, port forwarding rule
+ * @param hostPort, host protocol, address and port of the rule
+ * @return true if the rule is valid
+ *
+ * Parse the host part of a rule, the protocol is tcp
+ * if it's omitted
+ * Ex: tcp:127.0.0.1:2222-:22, udp::5353-10.0.2.15:53
+ */
+bool HostPortRegistry::parseRule(const QString &rule, HostPort *hostPort)
+{
+    QStringList sides = rule.split("-");
+    if (sides.size() != 2) {
+        return false;
+    }
+
+    QStringList host = sides.at(0).split(":");
+    if (host.size() == 2) {
+        host.prepend("tcp");
+    }
+    if (host.size() != 3 || (host.at(0) != "tcp" && host.at(0) != "udp")) {
+        return false;
+    }
+
+    bool validHostPort = false;
+    bool validGuestPort = false;
+    int port = host.at(2).toInt(&validHostPort);
+    int guestPort = sides.at(1).section(":", -1).toInt(&validGuestPort);
+    if (!validHostPort || !validGuestPort || port <= 0 || port > 65535 || guestPort <= 0 || guestPort > 65535) {
+        return false;
+    }
+
+    hostPort->protocol = host.at(0);
+    hostPort->address = host.at(1);
+    hostPort->port = port;
+
+    return true;
+}
+
+/**
+ * @brief Get the argument of hostfwd_remove
+ * @param rule, port forwarding rule
+ * @return host part of the rule
+ *
+ * Get the argument of hostfwd_remove, the rule without the guest
+ * Ex: tcp:127.0.0.1:2222
+ */
+QString HostPortRegistry::removeArgument(const QString &rule)
+{
+    return rule.section("-", 0, 0);
+}
+
+/**
+ * @brief Get the conflict of a rule
+ * @param machine, machine of the rule
+ * @param rule, port forwarding rule
+ * @return description of the conflict, empty if there's no conflict
+ *
+ * Get the conflict of a rule with the ports reserved by
+ * other machines and with the ports used in the host
+ */
+QString HostPortRegistry::conflict(Machine *machine, const QString &rule) const
+{
+    HostPort hostPort;
+    if (!HostPortRegistry::parseRule(rule, &hostPort)) {
+        return tr("%1 is not a valid rule").arg(rule);
+    }
+
+    QHash<QString, QStringList>::const_iterator it;
+    for (it = this->m_reservations.constBegin(); it != this->m_reservations.constEnd(); ++it) {
+        if (it.key() == machine->getUuid()) {
+            continue;
+        }
+
+        for (int i = 0; i < it.value().size(); ++i) {
+            HostPort reserved;
+            if (HostPortRegistry::parseRule(it.value().at(i), &reserved) && this->overlaps(hostPort, reserved)) {
+                return tr("%1 port %2 is used by the machine %3").arg(hostPort.protocol.toUpper())
+                                                                 .arg(hostPort.port)
+                                                                 .arg(this->m_machineNames.value(it.key()));
+            }
+        }
+    }
+
+    // The running machine already has its own ports
+    if (this->m_reservations.value(machine->getUuid()).contains(rule)) {
+        return QString();
+    }
+
+    if (!this->isBindable(hostPort)) {
+        return tr("%1 port %2 is used in the host").arg(hostPort.protocol.toUpper()).arg(hostPort.port);
+    }
+
+    return QString();
+}
+
+/**
+ * @brief Reserve the ports of the machine
+ * @param machine, machine to be launched
+ * @param conflicts, conflicts of the rules, separated by "; "
+ * @return true if all the ports are reserved
+ *
+ * Reserve the ports of all the rules of the machine.
+ * Nothing is reserved if a rule has a conflict
+ */
+bool HostPortRegistry::reserve(Machine *machine, QString *conflicts)
+{
+    QStringList rules = machine->getPortForwards();
+    QStringList conflictList;
+
+    for (int i = 0; i < rules.size(); ++i) {
+        QString ruleConflict = this->conflict(machine, rules.at(i));
+
+        // Two rules of the same machine can't use the same port
+        HostPort hostPort;
+        if (ruleConflict.isEmpty() && HostPortRegistry::parseRule(rules.at(i), &hostPort)) {
+            for (int j = 0; j < i; ++j) {
+                HostPort previous;
+                if (HostPortRegistry::parseRule(rules.at(j), &previous) && this->overlaps(hostPort, previous)) {
+                    ruleConflict = tr("%1 port %2 is used twice").arg(hostPort.protocol.toUpper()).arg(hostPort.port);
+                }
+            }
+        }
+
+        if (!ruleConflict.isEmpty()) {
+            conflictList.append(ruleConflict);
+        }
+    }
+
+    if (!conflictList.isEmpty()) {
+        *conflicts = conflictList.join("; ");
+        return false;
+    }
+
+    if (!rules.isEmpty()) {
+        this->m_reservations.insert(machine->getUuid(), rules);
+        this->m_machineNames.insert(machine->getUuid(), machine->getName());
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reserve the port of a rule
+ * @param machine, running machine
+ * @param rule, new port forwarding rule
+ * @param conflict, conflict of the rule
+ * @return true if the port is reserved
+ *
+ * Reserve the port of a rule added to a running machine
+ */
+bool HostPortRegistry::reserveRule(Machine *machine, const QString &rule, QString *conflict)
+{
+    *conflict = this->conflict(machine, rule);
+    if (!conflict->isEmpty()) {
+        return false;
+    }
+
+    this->m_reservations[machine->getUuid()].append(rule);
+    this->m_machineNames.insert(machine->getUuid(), machine->getName());
+
+    return true;
+}
+
+/**
+ * @brief Release the port of a rule
+ * @param machine, running machine
+ * @param rule, removed port forwarding rule
+ *
+ * Release the port of a rule removed from a running machine
+ */
+void HostPortRegistry::releaseRule(Machine *machine, const QString &rule)
+{
+    if (!this->m_reservations.contains(machine->getUuid())) {
+        return;
+    }
+
+    this->m_reservations[machine->getUuid()].removeAll(rule);
+}
+
+/**
+ * @brief Release the ports of the machine
+ * @param machine, stopped machine
+ *
+ * Release the ports of all the rules of the machine
+ */
+void HostPortRegistry::release(Machine *machine)
+{
+    this->m_reservations.remove(machine->getUuid());
+    this->m_machineNames.remove(machine->getUuid());
+}
+
+/**
+ * @brief Get if two host ports overlap
+ * @param first, first host port
+ * @param second, second host port
+ * @return true if both can't be bound at the same time
+ *
+ * Get if two host ports overlap. An empty address
+ * is any address of the host
+ */
+bool HostPortRegistry::overlaps(const HostPort &first, const HostPort &second) const
+{
+    if (first.protocol != second.protocol || first.port != second.port) {
+        return false;
+    }
+
+    return first.address.isEmpty() || second.address.isEmpty() ||
+           first.address == "0.0.0.0" || second.address == "0.0.0.0" ||
+           first.address == second.address;
+}
+
+/**
+ * @brief Get if the host port is free
+ * @param hostPort, host port
+ * @return true if the port can be bound
+ *
+ * Bind the port and release it, to know if other program
+ * of the host uses it
+ */
+bool HostPortRegistry::isBindable(const HostPort &hostPort) const
+{
+    QHostAddress address = hostPort.address.isEmpty() ? QHostAddress(QHostAddress::AnyIPv4)
+                                                      : QHostAddress(hostPort.address);
+    if (address.isNull()) {
+        return false;
+    }
+
+    if (hostPort.protocol == "udp") {
+        QUdpSocket socket;
+        return socket.bind(address, static_cast<quint16>(hostPort.port));
+    }
+
+    QTcpServer server;
+    return server.listen(address, static_cast<quint16>(hostPort.port));
+}
@@ -0,0 +1,75 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef HOSTPORTREGISTRY_H
+#define HOSTPORTREGISTRY_H
+
+// Qt
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QUdpSocket>
+
+#include <QDebug>
+
+class Machine;
+
+class HostPortRegistry : public QObject {
+    Q_OBJECT
+
+    public:
+        struct HostPort {
+            QString protocol;
+            QString address;
+            int port;
+        };
+
+        explicit HostPortRegistry(QObject *parent = nullptr);
+        ~HostPortRegistry();
+
+        static bool parseRule(const QString &rule, HostPort *hostPort);
+        static QString removeArgument(const QString &rule);
+
+        QString conflict(Machine *machine, const QString &rule) const;
+        bool reserve(Machine *machine, QString *conflicts);
+        bool reserveRule(Machine *machine, const QString &rule, QString *conflict);
+        void releaseRule(Machine *machine, const QString &rule);
+        void release(Machine *machine);
+
+    signals:
+
+    public slots:
+
+    private slots:
+
+    protected:
+
+    private:
+        QHash<QString, QStringList> m_reservations;
+        QHash<QString, QString> m_machineNames;
+
+        // Methods
+        bool overlaps(const HostPort &first, const HostPort &second) const;
+        bool isBindable(const HostPort &hostPort) const;
+};
+
+#endif // HOSTPORTREGISTRY_H
@@ -0,0 +1,380 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "ksmmonitor.h"
+
+// UNIX
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+// Directory of the counters and the tuning of the kernel same-page merging
+static const char KSM_PATH[] = "/sys/kernel/mm/ksm/";
+
+/**
+ * @brief KSM monitor
+ * @param machines, machines of QtEmu
+ * @param QEMUGlobalObject, QEMU global object, used to read the host capacity
+ * @param parent, parent object
+ *
+ * Reads the counters of the kernel same-page merging (KSM) and estimates
+ * the memory saved by every group of machines with the same OS. In dense
+ * mode the merging is started and scans faster while the host is short
+ * of memory, the previous tuning is restored later. The MemorySharing
+ * settings group has:
+ * denseMode: tune KSM when the host is short of memory
+ * interval: ms between two checks of the memory of the host
+ * pressureMemory: MiB of available memory below which KSM is tuned
+ * reliefMemory: MiB of available memory above which the tuning is restored
+ * pagesToScan: pages scanned in every run of KSM in dense mode
+ * sleepMillisecs: ms between two runs of KSM in dense mode
+ */
+KSMMonitor::KSMMonitor(const QList<Machine *> *machines,
+                       QEMU *QEMUGlobalObject,
+                       QObject *parent) : QObject(parent)
+{
+    this->m_machines = machines;
+    this->m_QEMUGlobalObject = QEMUGlobalObject;
+    this->m_denseActive = false;
+
+    this->m_pressureTimer = new QTimer(this);
+    connect(m_pressureTimer, &QTimer::timeout,
+            this, &KSMMonitor::checkPressure);
+
+    this->loadSettings();
+
+    qDebug() << "KSMMonitor object created";
+}
+
+KSMMonitor::~KSMMonitor()
+{
+    if (this->m_denseActive) {
+        this->restoreTuning();
+    }
+
+    qDebug() << "KSMMonitor object destroyed";
+}
+
+/**
+ * @brief Load the settings of the monitor
+ *
+ * Load the settings of the monitor
+ */
+void KSMMonitor::loadSettings()
+{
+    QSettings settings;
+    settings.beginGroup("MemorySharing");
+    this->m_denseMode = settings.value("denseMode", false).toBool();
+    int interval = qMax(1000, settings.value("interval", 10000).toInt());
+    this->m_pressureMemory = settings.value("pressureMemory", 2048).toLongLong();
+    this->m_reliefMemory = qMax(this->m_pressureMemory, settings.value("reliefMemory", 4096).toLongLong());
+    this->m_densePagesToScan = qMax(1, settings.value("pagesToScan", 1000).toInt());
+    this->m_denseSleepMillisecs = qMax(0, settings.value("sleepMillisecs", 20).toInt());
+    settings.endGroup();
+
+#ifdef Q_OS_LINUX
+    this->m_pressureTimer->start(interval);
+#else
+    Q_UNUSED(interval);
+#endif
+}
+
+/**
+ * @brief Get the counters of KSM
+ * @return counters, available is false without KSM
+ *
+ * Read the counters of KSM from /sys/kernel/mm/ksm
+ */
+KSMMonitor::Counters KSMMonitor::counters() const
+{
+    Counters counters;
+    counters.available      = QDir(KSM_PATH).exists();
+    counters.running        = KSMMonitor::readCounter("run") == 1;
+    counters.pagesShared    = KSMMonitor::readCounter("pages_shared");
+    counters.pagesSharing   = KSMMonitor::readCounter("pages_sharing");
+    counters.pagesUnshared  = KSMMonitor::readCounter("pages_unshared");
+    counters.pagesVolatile  = KSMMonitor::readCounter("pages_volatile");
+    counters.fullScans      = KSMMonitor::readCounter("full_scans");
+    counters.pagesToScan    = KSMMonitor::readCounter("pages_to_scan");
+    counters.sleepMillisecs = KSMMonitor::readCounter("sleep_millisecs");
+
+    return counters;
+}
+
+/**
+ * @brief Get the size of a memory page
+ * @return bytes of a page of the host
+ *
+ * Get the size of a memory page
+ */
+qint64 KSMMonitor::pageSize() const
+{
+#ifdef Q_OS_UNIX
+    long size = sysconf(_SC_PAGESIZE);
+    if (size > 0) {
+        return size;
+    }
+#endif
+
+    return 4096;
+}
+
+/**
+ * @brief Get the memory saved by KSM
+ * @param counters, counters of KSM
+ * @return bytes saved in the host
+ *
+ * Every sharing page is a page that would be
+ * allocated without the merging
+ */
+qint64 KSMMonitor::savedBytes(const KSMMonitor::Counters &counters) const
+{
+    return qMax(0LL, counters.pagesSharing) * this->pageSize();
+}
+
+/**
+ * @brief Get the memory saved by every group of machines
+ * @param counters, counters of KSM
+ * @param perProcess, variable to store if the merged pages of every process are known
+ * @return groups of running machines with the same OS
+ *
+ * The memory saved in the host is split between the groups. With
+ * a kernel that gives the merged pages of every process, Linux 6.1
+ * or newer, the split follows the merged pages, otherwise it follows
+ * the RAM of the machines
+ */
+QList<KSMMonitor::GroupSaving> KSMMonitor::groupSavings(const KSMMonitor::Counters &counters,
+                                                       bool *perProcess) const
+{
+    QMap<QString, GroupSaving> groups;
+    bool mergedPagesKnown = true;
+    qint64 totalMergedPages = 0;
+    qint64 totalMemory = 0;
+
+    foreach (Machine *machine, *this->m_machines) {
+        if (machine->getState() == Machine::Stopped || !machine->getMemMerge()) {
+            continue;
+        }
+
+        QString groupName = QString("%1 %2").arg(machine->getOSType(), machine->getOSVersion()).trimmed();
+        if (!groups.contains(groupName)) {
+            GroupSaving group;
+            group.group = groupName;
+            group.machines = 0;
+            group.memory = 0;
+            group.mergedPages = 0;
+            group.savedBytes = 0;
+            groups.insert(groupName, group);
+        }
+
+        qint64 mergedPages = -1;
+#ifdef Q_OS_LINUX
+        QFile mergedPagesFile(QString("/proc/%1/ksm_merging_pages").arg(machine->getProcessId()));
+        if (machine->getProcessId() > 0 && mergedPagesFile.open(QFile::ReadOnly)) {
+            mergedPages = mergedPagesFile.readAll().trimmed().toLongLong();
+        }
+#endif
+        if (mergedPages < 0) {
+            mergedPagesKnown = false;
+        }
+
+        GroupSaving &group = groups[groupName];
+        group.machines++;
+        group.memory += machine->getRAM();
+        group.mergedPages += qMax(0LL, mergedPages);
+
+        totalMergedPages += qMax(0LL, mergedPages);
+        totalMemory += machine->getRAM();
+    }
+
+    mergedPagesKnown = mergedPagesKnown && totalMergedPages > 0;
+    qint64 saved = this->savedBytes(counters);
+
+    QList<GroupSaving> savings;
+    foreach (GroupSaving group, groups) {
+        if (mergedPagesKnown) {
+            group.savedBytes = static_cast<qint64>(static_cast<double>(saved) * group.mergedPages / totalMergedPages);
+        } else if (totalMemory > 0) {
+            group.savedBytes = static_cast<qint64>(static_cast<double>(saved) * group.memory / totalMemory);
+        }
+        savings.append(group);
+    }
+
+    if (perProcess != nullptr) {
+        *perProcess = mergedPagesKnown;
+    }
+
+    return savings;
+}
+
+/**
+ * @brief Get if the dense mode is enabled
+ * @return true if KSM is tuned when the host is short of memory
+ *
+ * Get if the dense mode is enabled
+ */
+bool KSMMonitor::denseMode() const
+{
+    return this->m_denseMode;
+}
+
+/**
+ * @brief Enable or disable the dense mode
+ * @param enabled, true to tune KSM when the host is short of memory
+ *
+ * Enable or disable the dense mode, saved in the settings
+ */
+void KSMMonitor::setDenseMode(bool enabled)
+{
+    QSettings settings;
+    settings.beginGroup("MemorySharing");
+    settings.setValue("denseMode", enabled);
+    settings.endGroup();
+
+    this->m_denseMode = enabled;
+    this->checkPressure();
+}
+
+/**
+ * @brief Get if KSM is tuned now
+ * @return true if the dense mode tuning is applied
+ *
+ * Get if KSM is tuned now
+ */
+bool KSMMonitor::isDenseActive() const
+{
+    return this->m_denseActive;
+}
+
+/**
+ * @brief Check the memory of the host
+ *
+ * Apply the dense mode tuning when the host is short of memory
+ * and restore the previous tuning when the host recovers
+ */
+void KSMMonitor::checkPressure()
+{
+    if (!this->m_denseMode) {
+        if (this->m_denseActive) {
+            this->restoreTuning();
+        }
+        return;
+    }
+
+    AdmissionController::HostCapacity host = this->m_QEMUGlobalObject->admissionController()->hostCapacity();
+
+    if (!this->m_denseActive && host.memoryAvailable > 0 && host.memoryAvailable < this->m_pressureMemory) {
+        this->activateDenseMode();
+    } else if (this->m_denseActive && host.memoryAvailable > this->m_reliefMemory) {
+        this->restoreTuning();
+    }
+}
+
+/**
+ * @brief Apply the dense mode tuning
+ *
+ * Start the merging and scan faster. Writing the
+ * tuning of KSM needs root permissions
+ */
+void KSMMonitor::activateDenseMode()
+{
+    QStringList tuning;
+    tuning << "run" << "pages_to_scan" << "sleep_millisecs";
+
+    this->m_savedTuning.clear();
+    foreach (const QString &name, tuning) {
+        QFile tuningFile(KSM_PATH + name);
+        if (tuningFile.open(QFile::ReadOnly)) {
+            this->m_savedTuning.insert(name, tuningFile.readAll().trimmed());
+        }
+    }
+
+    if (!KSMMonitor::writeCounter("pages_to_scan", QByteArray::number(this->m_densePagesToScan)) ||
+        !KSMMonitor::writeCounter("sleep_millisecs", QByteArray::number(this->m_denseSleepMillisecs)) ||
+        !KSMMonitor::writeCounter("run", "1")) {
+        qDebug() << "Cannot tune KSM, the dense mode needs write permissions in" << KSM_PATH;
+        this->restoreTuning();
+        return;
+    }
+
+    this->m_denseActive = true;
+    qDebug() << "KSM dense mode applied";
+    emit(denseActiveChangedSignal(true));
+}
+
+/**
+ * @brief Restore the tuning of KSM
+ *
+ * Restore the tuning saved before the dense mode
+ */
+void KSMMonitor::restoreTuning()
+{
+    QMapIterator<QString, QByteArray> tuningIterator(this->m_savedTuning);
+    while (tuningIterator.hasNext()) {
+        tuningIterator.next();
+        KSMMonitor::writeCounter(tuningIterator.key(), tuningIterator.value());
+    }
+    this->m_savedTuning.clear();
+
+    if (this->m_denseActive) {
+        this->m_denseActive = false;
+        qDebug() << "KSM dense mode restored";
+        emit(denseActiveChangedSignal(false));
+    }
+}
+
+/**
+ * @brief Read a counter of KSM
+ * @param name, name of the file of the counter
+ * @return value of the counter, -1 if it can't be read
+ *
+ * Read a counter of KSM
+ */
+qint64 KSMMonitor::readCounter(const QString &name)
+{
+    QFile counterFile(KSM_PATH + name);
+    if (!counterFile.open(QFile::ReadOnly)) {
+        return -1;
+    }
+
+    bool ok = false;
+    qint64 value = counterFile.readAll().trimmed().toLongLong(&ok);
+
+    return ok ? value : -1;
+}
+
+/**
+ * @brief Write a tuning value of KSM
+ * @param name, name of the file
+ * @param value, new value
+ * @return true if the value is written
+ *
+ * Write a tuning value of KSM
+ */
+bool KSMMonitor::writeCounter(const QString &name, const QByteArray &value)
+{
+    QFile tuningFile(KSM_PATH + name);
+    if (!tuningFile.open(QFile::WriteOnly)) {
+        return false;
+    }
+
+    return tuningFile.write(value) == value.size();
+}
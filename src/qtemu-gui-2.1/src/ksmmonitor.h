@@ -0,0 +1,109 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KSMMONITOR_H
+#define KSMMONITOR_H
+
+// Qt
+#include <QObject>
+#include <QTimer>
+#include <QSettings>
+#include <QFile>
+#include <QDir>
+#include <QMap>
+
+#include <QDebug>
+
+// Local
+#include "machine.h"
+
+class KSMMonitor : public QObject {
+    Q_OBJECT
+
+    public:
+        struct Counters {
+            bool available;
+            bool running;
+            qint64 pagesShared;
+            qint64 pagesSharing;
+            qint64 pagesUnshared;
+            qint64 pagesVolatile;
+            qint64 fullScans;
+            qint64 pagesToScan;
+            qint64 sleepMillisecs;
+        };
+
+        struct GroupSaving {
+            QString group;
+            int machines;
+            qint64 memory;
+            qint64 mergedPages;
+            qint64 savedBytes;
+        };
+
+        explicit KSMMonitor(const QList<Machine *> *machines,
+                            QEMU *QEMUGlobalObject,
+                            QObject *parent = nullptr);
+        ~KSMMonitor();
+
+        void loadSettings();
+
+        Counters counters() const;
+        qint64 pageSize() const;
+        qint64 savedBytes(const Counters &counters) const;
+        QList<GroupSaving> groupSavings(const Counters &counters, bool *perProcess = nullptr) const;
+
+        bool denseMode() const;
+        void setDenseMode(bool enabled);
+        bool isDenseActive() const;
+
+    signals:
+        void denseActiveChangedSignal(bool active);
+
+    public slots:
+        void checkPressure();
+
+    private slots:
+
+    protected:
+
+    private:
+        const QList<Machine *> *m_machines;
+        QEMU *m_QEMUGlobalObject;
+        QTimer *m_pressureTimer;
+
+        bool m_denseActive;
+        QMap<QString, QByteArray> m_savedTuning;
+
+        // Settings
+        bool m_denseMode;
+        qint64 m_pressureMemory;
+        qint64 m_reliefMemory;
+        int m_densePagesToScan;
+        int m_denseSleepMillisecs;
+
+        // Methods
+        void activateDenseMode();
+        void restoreTuning();
+        static qint64 readCounter(const QString &name);
+        static bool writeCounter(const QString &name, const QByteArray &value);
+};
+
+#endif // KSMMONITOR_H
@@ -0,0 +1,482 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "linktest.h"
+#include "machine.h"
+#include "bootmonitor.h"
+#include "utils/logger.h"
+
+// Max time in ms of the whole test
+static const int TEST_TIMEOUT = 90000;
+
+// Interval in ms between two checks of a guest command
+static const int EXEC_POLL_INTERVAL = 500;
+
+/**
+ * @brief Throughput and latency test of a local network
+ * @param source, machine that sends the traffic
+ * @param target, machine that receives the traffic
+ * @param localNetwork, local network of both machines
+ * @param parent, parent object
+ *
+ * Measure the link between two running machines of a local network
+ * with the guest agent of both machines. The address of the target is
+ * read from its card of the network, then the source runs ping and
+ * an iperf3 client against an iperf3 server started in the target.
+ * The guests need the QEMU guest agent, ping and iperf3, and the
+ * machines the agent readiness mode, that adds the agent channel
+ */
+LinkTest::LinkTest(Machine *source,
+                   Machine *target,
+                   const QString &localNetwork,
+                   QObject *parent) : QObject(parent)
+{
+    this->m_source = source;
+    this->m_target = target;
+    this->m_localNetwork = localNetwork;
+    this->m_latency = 0;
+    this->m_throughput = 0;
+    this->m_finished = false;
+    this->m_pendingAgents = 0;
+
+    this->m_sourceAgent = new QLocalSocket(this);
+    connect(m_sourceAgent, &QLocalSocket::connected,
+            this, &LinkTest::agentConnected);
+    connect(m_sourceAgent, QOverload<QLocalSocket::LocalSocketError>::of(&QLocalSocket::error),
+            this, &LinkTest::agentError);
+    connect(m_sourceAgent, &QLocalSocket::readyRead,
+            this, &LinkTest::readReply);
+
+    this->m_targetAgent = new QLocalSocket(this);
+    connect(m_targetAgent, &QLocalSocket::connected,
+            this, &LinkTest::agentConnected);
+    connect(m_targetAgent, QOverload<QLocalSocket::LocalSocketError>::of(&QLocalSocket::error),
+            this, &LinkTest::agentError);
+    connect(m_targetAgent, &QLocalSocket::readyRead,
+            this, &LinkTest::readReply);
+
+    this->m_timeoutTimer = new QTimer(this);
+    this->m_timeoutTimer->setSingleShot(true);
+    this->m_timeoutTimer->setInterval(TEST_TIMEOUT);
+    connect(m_timeoutTimer, &QTimer::timeout,
+            this, &LinkTest::testTimeout);
+
+    qDebug() << "LinkTest object created";
+}
+
+LinkTest::~LinkTest()
+{
+    qDebug() << "LinkTest object destroyed";
+}
+
+/**
+ * @brief Start the test
+ *
+ * Connect to the guest agents, the test starts when
+ * both are synced. The result is emitted with finishedSignal
+ */
+void LinkTest::start()
+{
+    if (this->m_source->getState() != Machine::Started || this->m_target->getState() != Machine::Started) {
+        this->finish(false, tr("Both machines must be running"));
+        return;
+    }
+
+    if (this->cardMACAddress(this->m_source).isEmpty() || this->cardMACAddress(this->m_target).isEmpty()) {
+        this->finish(false, tr("Both machines need a card with a MAC address in the network %1")
+                            .arg(this->m_localNetwork));
+        return;
+    }
+
+    if (this->m_source->getBootReadinessMode() != "agent" || this->m_target->getBootReadinessMode() != "agent") {
+        this->finish(false, tr("Cannot connect to the guest agents, the machines need "
+                               "the guest agent readiness mode"));
+        return;
+    }
+
+    emit(progressSignal(tr("Connecting to the guest agents")));
+
+    this->m_timeoutTimer->start();
+    this->m_pendingAgents = 2;
+    this->connectAgent(this->m_sourceAgent, this->m_source);
+    this->connectAgent(this->m_targetAgent, this->m_target);
+}
+
+/**
+ * @brief A guest agent is connected
+ *
+ * Sync the guest agent before the first command
+ */
+void LinkTest::agentConnected()
+{
+    QLocalSocket *agent = qobject_cast<QLocalSocket *>(this->sender());
+    if (agent == nullptr) {
+        return;
+    }
+
+    this->syncAgent(agent);
+}
+
+/**
+ * @brief A guest agent failed
+ * @param socketError, error of the socket
+ *
+ * Stop the test, the agent is not reachable
+ */
+void LinkTest::agentError(QLocalSocket::LocalSocketError socketError)
+{
+    Q_UNUSED(socketError);
+
+    QLocalSocket *agent = qobject_cast<QLocalSocket *>(this->sender());
+    if (agent == nullptr) {
+        return;
+    }
+
+    this->finish(false, tr("Cannot connect to the guest agent of %1: %2")
+                        .arg(agent == this->m_sourceAgent ? this->m_source->getName() : this->m_target->getName())
+                        .arg(agent->errorString()));
+}
+
+/**
+ * @brief Read the replies of the guest agents
+ *
+ * Read the replies of the guest agents, one JSON per line
+ */
+void LinkTest::readReply()
+{
+    QLocalSocket *agent = qobject_cast<QLocalSocket *>(this->sender());
+    if (agent == nullptr) {
+        return;
+    }
+
+    this->m_buffers[agent].append(agent->readAll());
+
+    int lineEnd = this->m_buffers[agent].indexOf('\n');
+    while (lineEnd >= 0) {
+        QByteArray line = this->m_buffers[agent].left(lineEnd).trimmed();
+        this->m_buffers[agent].remove(0, lineEnd + 1);
+
+        QJsonDocument replyDocument = QJsonDocument::fromJson(line);
+
+        // Until the sync reply arrives, the replies are left
+        // over from other clients of the agent, like BootMonitor
+        if (replyDocument.isObject() && this->m_syncIds.contains(agent) &&
+            replyDocument.object()["return"].toVariant().toLongLong() != this->m_syncIds.value(agent)) {
+            qDebug() << "Stale guest agent reply discarded" << line;
+        } else if (replyDocument.isObject() && this->m_callbacks.contains(agent)) {
+            ReplyCallback callback = this->m_callbacks.take(agent);
+            callback(replyDocument.object());
+        }
+
+        lineEnd = this->m_buffers[agent].indexOf('\n');
+    }
+}
+
+/**
+ * @brief The test took too long
+ *
+ * The test took too long
+ */
+void LinkTest::testTimeout()
+{
+    this->finish(false, tr("The test timed out"));
+}
+
+/**
+ * @brief Get the MAC address of the card in the network
+ * @param machine, machine of the test
+ * @return MAC address, empty if the machine has no card in the network
+ *
+ * Get the MAC address of the card in the local network
+ */
+QString LinkTest::cardMACAddress(Machine *machine) const
+{
+    QList<NetworkCard *> networkCards = machine->getNetworkCards();
+    for (int i = 0; i < networkCards.size(); ++i) {
+        if (networkCards.at(i)->backend() == "local" &&
+            networkCards.at(i)->localNetwork() == this->m_localNetwork) {
+            return networkCards.at(i)->MACAddress().toLower();
+        }
+    }
+
+    return QString();
+}
+
+/**
+ * @brief Connect to the guest agent of the machine
+ * @param agent, socket of the agent
+ * @param machine, machine of the test
+ *
+ * Connect to the guest agent of the machine without blocking,
+ * agentConnected or agentError are called after
+ */
+void LinkTest::connectAgent(QLocalSocket *agent, Machine *machine)
+{
+    agent->connectToServer(BootMonitor::agentServerName(machine->getPath(), machine->getUuid()),
+                           QIODevice::ReadWrite);
+}
+
+/**
+ * @brief Sync the guest agent
+ * @param agent, socket of the agent
+ *
+ * Send guest-sync with a random id, the replies before the one
+ * with the same id are discarded. The test starts when both
+ * agents are synced
+ */
+void LinkTest::syncAgent(QLocalSocket *agent)
+{
+    qint64 syncId = QRandomGenerator::global()->bounded(1, 2147483647);
+    this->m_syncIds.insert(agent, syncId);
+
+    QJsonObject syncArguments;
+    syncArguments["id"] = syncId;
+
+    this->execute(agent, "guest-sync", syncArguments, [this, agent](const QJsonObject &reply) {
+        Q_UNUSED(reply);
+        this->m_syncIds.remove(agent);
+
+        --this->m_pendingAgents;
+        if (this->m_pendingAgents == 0) {
+            this->findTargetAddress();
+        }
+    });
+}
+
+/**
+ * @brief Execute a command of the guest agent
+ * @param agent, socket of the agent
+ * @param command, guest agent command
+ * @param arguments, arguments of the command
+ * @param callback, called with the reply
+ *
+ * Execute a command of the guest agent, one command
+ * per agent at the same time
+ */
+void LinkTest::execute(QLocalSocket *agent,
+                       const QString &command,
+                       const QJsonObject &arguments,
+                       ReplyCallback callback)
+{
+    if (this->m_finished) {
+        return;
+    }
+
+    QJsonObject message;
+    message["execute"] = command;
+    if (!arguments.isEmpty()) {
+        message["arguments"] = arguments;
+    }
+
+    this->m_callbacks.insert(agent, callback);
+    agent->write(QJsonDocument(message).toJson(QJsonDocument::Compact).append('\n'));
+}
+
+/**
+ * @brief Run a program in the guest
+ * @param agent, socket of the agent
+ * @param path, program
+ * @param arguments, arguments of the program
+ * @param callback, called with the exit code and the output
+ *
+ * Run a program in the guest with guest-exec
+ */
+void LinkTest::guestExec(QLocalSocket *agent,
+                         const QString &path,
+                         const QStringList &arguments,
+                         ExecCallback callback)
+{
+    QJsonObject execArguments;
+    execArguments["path"] = path;
+    execArguments["arg"] = QJsonArray::fromStringList(arguments);
+    execArguments["capture-output"] = true;
+
+    this->execute(agent, "guest-exec", execArguments, [this, agent, path, callback](const QJsonObject &reply) {
+        if (reply.contains("error")) {
+            this->finish(false, tr("Cannot run %1 in the guest: %2").arg(path)
+                                .arg(reply["error"].toObject()["desc"].toString()));
+            return;
+        }
+
+        this->waitGuestExec(agent, reply["return"].toObject()["pid"].toVariant().toLongLong(), callback);
+    });
+}
+
+/**
+ * @brief Wait for a program of the guest
+ * @param agent, socket of the agent
+ * @param pid, pid of the program in the guest
+ * @param callback, called with the exit code and the output
+ *
+ * Check the program with guest-exec-status until it exits
+ */
+void LinkTest::waitGuestExec(QLocalSocket *agent, qint64 pid, ExecCallback callback)
+{
+    QJsonObject statusArguments;
+    statusArguments["pid"] = pid;
+
+    this->execute(agent, "guest-exec-status", statusArguments, [this, agent, pid, callback](const QJsonObject &reply) {
+        QJsonObject status = reply["return"].toObject();
+        if (!status["exited"].toBool()) {
+            QTimer::singleShot(EXEC_POLL_INTERVAL, this, [this, agent, pid, callback]() {
+                this->waitGuestExec(agent, pid, callback);
+            });
+            return;
+        }
+
+        QString output = QString::fromUtf8(QByteArray::fromBase64(status["out-data"].toString().toLatin1()));
+        callback(status["exitcode"].toInt(), output);
+    });
+}
+
+/**
+ * @brief Find the address of the target
+ *
+ * Find the IPv4 address of the card of the target
+ * in the network
+ */
+void LinkTest::findTargetAddress()
+{
+    emit(progressSignal(tr("Looking for the address of %1").arg(this->m_target->getName())));
+
+    QString MACAddress = this->cardMACAddress(this->m_target);
+    this->execute(this->m_targetAgent, "guest-network-get-interfaces", QJsonObject(),
+                  [this, MACAddress](const QJsonObject &reply) {
+        QJsonArray interfaces = reply["return"].toArray();
+        for (int i = 0; i < interfaces.size() && this->m_targetAddress.isEmpty(); ++i) {
+            QJsonObject guestInterface = interfaces.at(i).toObject();
+            if (guestInterface["hardware-address"].toString().toLower() != MACAddress) {
+                continue;
+            }
+
+            QJsonArray addresses = guestInterface["ip-addresses"].toArray();
+            for (int j = 0; j < addresses.size(); ++j) {
+                if (addresses.at(j).toObject()["ip-address-type"].toString() == "ipv4") {
+                    this->m_targetAddress = addresses.at(j).toObject()["ip-address"].toString();
+                    break;
+                }
+            }
+        }
+
+        if (this->m_targetAddress.isEmpty()) {
+            this->finish(false, tr("The card of %1 in the network has no IPv4 address")
+                                .arg(this->m_target->getName()));
+            return;
+        }
+
+        this->measureLatency();
+    });
+}
+
+/**
+ * @brief Measure the latency
+ *
+ * Ping the target from the source, the latency
+ * is the average round trip time
+ */
+void LinkTest::measureLatency()
+{
+    emit(progressSignal(tr("Measuring the latency to %1").arg(this->m_targetAddress)));
+
+    QStringList arguments;
+    arguments << "-c" << "20" << "-i" << "0.2" << "-q" << this->m_targetAddress;
+
+    this->guestExec(this->m_sourceAgent, "ping", arguments, [this](int exitCode, const QString &output) {
+        // rtt min/avg/max/mdev = 0.210/0.290/0.412/0.051 ms
+        QRegularExpression roundTrip("= [0-9.]+/([0-9.]+)/");
+        QRegularExpressionMatch roundTripMatch = roundTrip.match(output);
+
+        if (exitCode != 0 || !roundTripMatch.hasMatch()) {
+            this->finish(false, tr("The target doesn't answer the ping"));
+            return;
+        }
+
+        this->m_latency = roundTripMatch.captured(1).toDouble();
+        this->measureThroughput();
+    });
+}
+
+/**
+ * @brief Measure the throughput
+ *
+ * Start a one-off iperf3 server in the target and
+ * run the iperf3 client in the source
+ */
+void LinkTest::measureThroughput()
+{
+    emit(progressSignal(tr("Measuring the throughput to %1").arg(this->m_targetAddress)));
+
+    QStringList serverArguments;
+    serverArguments << "-s" << "-1" << "-D";
+
+    this->guestExec(this->m_targetAgent, "iperf3", serverArguments, [this](int exitCode, const QString &output) {
+        Q_UNUSED(output);
+        if (exitCode != 0) {
+            this->finish(false, tr("Cannot start iperf3 in the target"));
+            return;
+        }
+
+        QStringList clientArguments;
+        clientArguments << "-c" << this->m_targetAddress << "-t" << "5" << "-J";
+
+        this->guestExec(this->m_sourceAgent, "iperf3", clientArguments, [this](int exitCode, const QString &output) {
+            QJsonObject result = QJsonDocument::fromJson(output.toUtf8()).object();
+            double bitsPerSecond = result["end"].toObject()["sum_received"].toObject()["bits_per_second"].toDouble();
+
+            if (exitCode != 0 || bitsPerSecond <= 0) {
+                this->finish(false, tr("iperf3 failed in the source: %1").arg(result["error"].toString()));
+                return;
+            }
+
+            this->m_throughput = bitsPerSecond / 1000000;
+            Logger::logMachineAction(this->m_source->getPath(), this->m_source->getName(), this->m_source->getUuid(),
+                                     QString("Link test to %1 in %2: %3 ms, %4 Mbit/s")
+                                     .arg(this->m_target->getName())
+                                     .arg(this->m_localNetwork)
+                                     .arg(this->m_latency)
+                                     .arg(this->m_throughput, 0, 'f', 1));
+            this->finish(true, QString());
+        });
+    });
+}
+
+/**
+ * @brief Finish the test
+ * @param succeeded, true if the test finished
+ * @param error, reason of the failure
+ *
+ * Close the agents and emit the result
+ */
+void LinkTest::finish(bool succeeded, const QString &error)
+{
+    if (this->m_finished) {
+        return;
+    }
+
+    this->m_finished = true;
+    this->m_timeoutTimer->stop();
+    this->m_callbacks.clear();
+    this->m_syncIds.clear();
+    this->m_sourceAgent->abort();
+    this->m_targetAgent->abort();
+
+    emit(finishedSignal(succeeded, this->m_latency, this->m_throughput, error));
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef LINKTEST_H
+#define LINKTEST_H
+
+// Qt
+#include <QObject>
+#include <QLocalSocket>
+#include <QTimer>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QRandomGenerator>
+
+#include <QDebug>
+
+// C++ standard library
+#include <functional>
+
+class Machine;
+
+class LinkTest : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit LinkTest(Machine *source,
+                          Machine *target,
+                          const QString &localNetwork,
+                          QObject *parent = nullptr);
+        ~LinkTest();
+
+        void start();
+
+    signals:
+        void progressSignal(const QString &step);
+        void finishedSignal(bool succeeded,
+                            double latency,
+                            double throughput,
+                            const QString &error);
+
+    public slots:
+
+    private slots:
+        void agentConnected();
+        void agentError(QLocalSocket::LocalSocketError socketError);
+        void readReply();
+        void testTimeout();
+
+    protected:
+
+    private:
+        typedef std::function<void(const QJsonObject &reply)> ReplyCallback;
+        typedef std::function<void(int exitCode, const QString &output)> ExecCallback;
+
+        Machine *m_source;
+        Machine *m_target;
+        QString m_localNetwork;
+
+        QLocalSocket *m_sourceAgent;
+        QLocalSocket *m_targetAgent;
+        QHash<QLocalSocket *, QByteArray> m_buffers;
+        QHash<QLocalSocket *, ReplyCallback> m_callbacks;
+        QHash<QLocalSocket *, qint64> m_syncIds;
+        int m_pendingAgents;
+
+        QTimer *m_timeoutTimer;
+        QString m_targetAddress;
+        double m_latency;
+        double m_throughput;
+        bool m_finished;
+
+        // Methods
+        QString cardMACAddress(Machine *machine) const;
+        void connectAgent(QLocalSocket *agent, Machine *machine);
+        void syncAgent(QLocalSocket *agent);
+        void execute(QLocalSocket *agent,
+                     const QString &command,
+                     const QJsonObject &arguments,
+                     ReplyCallback callback);
+        void guestExec(QLocalSocket *agent,
+                       const QString &path,
+                       const QStringList &arguments,
+                       ExecCallback callback);
+        void waitGuestExec(QLocalSocket *agent, qint64 pid, ExecCallback callback);
+        void findTargetAddress();
+        void measureLatency();
+        void measureThroughput();
+        void finish(bool succeeded, const QString &error);
+};
+
+#endif // LINKTEST_H
@@ -0,0 +1,152 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "localnetworks.h"
+
+// First UDP port of the local networks
+static const int FIRST_PORT = 11000;
+
+/*
+ * Local networks connect the machines of the host at L2 without
+ * root privileges. Every network is a multicast group of the loopback,
+ * used by the socket netdev of QEMU, so all the cards of the network
+ * see the frames of the others. The LocalNetworks settings group has
+ * a group per network with:
+ * address: multicast address of the network
+ * port: UDP port of the network
+ * mtu: MTU of the virtio-net cards
+ * rxQueueSize: size of the virtio-net RX queue
+ */
+
+/**
+ * @brief Get the names of the local networks
+ * @return names of the networks
+ *
+ * Get the names of the local networks
+ */
+QStringList LocalNetworks::names()
+{
+    QSettings settings;
+    settings.beginGroup("LocalNetworks");
+    QStringList names = settings.childGroups();
+    settings.endGroup();
+
+    return names;
+}
+
+/**
+ * @brief Get if the local network exists
+ * @param name, network name
+ * @return true if the network exists
+ *
+ * Get if the local network exists
+ */
+bool LocalNetworks::contains(const QString &name)
+{
+    return LocalNetworks::names().contains(name);
+}
+
+/**
+ * @brief Get a local network
+ * @param name, network name
+ * @return network, with port 0 if it doesn't exist
+ *
+ * Get a local network
+ */
+LocalNetworks::Network LocalNetworks::network(const QString &name)
+{
+    QSettings settings;
+    settings.beginGroup("LocalNetworks");
+
+    LocalNetworks::Network network;
+    network.name = name;
+
+    settings.beginGroup(name);
+    network.port = settings.value("port", 0).toInt();
+    network.address = settings.value("address", "230.0.0.1").toString();
+    network.MTU = settings.value("mtu", 1500).toInt();
+    network.rxQueueSize = settings.value("rxQueueSize", 256).toInt();
+    settings.endGroup();
+
+    settings.endGroup();
+
+    return network;
+}
+
+/**
+ * @brief Get if the name is valid
+ * @param name, network name
+ * @return true if the name is valid
+ *
+ * Get if the name is valid, only letters,
+ * numbers, - and _ are allowed
+ */
+bool LocalNetworks::isValidName(const QString &name)
+{
+    QRegularExpression validName("^[A-Za-z0-9_-]+$");
+
+    return validName.match(name).hasMatch();
+}
+
+/**
+ * @brief Save a local network
+ * @param network, new or changed network
+ *
+ * Save a local network. A network without port
+ * gets the next free port
+ */
+void LocalNetworks::saveNetwork(const Network &network)
+{
+    int port = network.port;
+    if (port <= 0) {
+        port = FIRST_PORT;
+        QStringList networks = LocalNetworks::names();
+        for (int i = 0; i < networks.size(); ++i) {
+            port = qMax(port, LocalNetworks::network(networks.at(i)).port + 1);
+        }
+    }
+
+    QSettings settings;
+    settings.beginGroup("LocalNetworks");
+    settings.beginGroup(network.name);
+    settings.setValue("address", network.address);
+    settings.setValue("port", port);
+    settings.setValue("mtu", network.MTU);
+    settings.setValue("rxQueueSize", network.rxQueueSize);
+    settings.endGroup();
+    settings.endGroup();
+    settings.sync();
+}
+
+/**
+ * @brief Remove a local network
+ * @param name, network name
+ *
+ * Remove a local network
+ */
+void LocalNetworks::removeNetwork(const QString &name)
+{
+    QSettings settings;
+    settings.beginGroup("LocalNetworks");
+    settings.remove(name);
+    settings.endGroup();
+    settings.sync();
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef LOCALNETWORKS_H
+#define LOCALNETWORKS_H
+
+// Qt
+#include <QSettings>
+#include <QStringList>
+#include <QRegularExpression>
+
+#include <QDebug>
+
+class LocalNetworks {
+
+    public:
+        struct Network {
+            QString name;
+            QString address;
+            int port;
+            int MTU;
+            int rxQueueSize;
+        };
+
+        static QStringList names();
+        static bool contains(const QString &name);
+        static Network network(const QString &name);
+        static bool isValidName(const QString &name);
+        static void saveNetwork(const Network &network);
+        static void removeNetwork(const QString &name);
+};
+
+#endif // LOCALNETWORKS_H
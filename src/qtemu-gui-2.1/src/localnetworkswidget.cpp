@@ -0,0 +1,446 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "localnetworkswidget.h"
+
+/**
+ * @brief Local networks window
+ * @param machinesList, machines of QtEmu
+ * @param parent, widget parent
+ *
+ * Window with the local networks, the machines connected
+ * to every network and the link test between two
+ * running machines of a network
+ */
+LocalNetworksWidget::LocalNetworksWidget(const QList<Machine *> *machinesList,
+                                         QWidget *parent) : QWidget(parent)
+{
+    this->setWindowTitle(tr("Local networks") + " - QtEmu");
+    this->setWindowIcon(QIcon::fromTheme("qtemu",
+                                         QIcon(":/images/qtemu.png")));
+    this->setWindowFlag(Qt::Window);
+    this->setMinimumSize(600, 500);
+
+    this->m_machinesList = machinesList;
+    this->m_linkTest = nullptr;
+
+    m_networksList = new QListWidget(this);
+    m_networksList->setMaximumWidth(200);
+    connect(m_networksList, &QListWidget::currentRowChanged,
+            this, &LocalNetworksWidget::fillNetworkDetails);
+
+    m_newNetworkButton = new QPushButton(tr("New"), this);
+    connect(m_newNetworkButton, &QAbstractButton::clicked,
+            this, &LocalNetworksWidget::newNetwork);
+
+    m_removeNetworkButton = new QPushButton(QIcon::fromTheme("remove",
+                                                             QIcon(QPixmap(":/images/icons/breeze/32x32/remove.svg"))),
+                                            tr("Remove"),
+                                            this);
+    connect(m_removeNetworkButton, &QAbstractButton::clicked,
+            this, &LocalNetworksWidget::removeNetwork);
+
+    m_networksButtonsLayout = new QHBoxLayout();
+    m_networksButtonsLayout->addWidget(m_newNetworkButton);
+    m_networksButtonsLayout->addWidget(m_removeNetworkButton);
+
+    m_networksListLayout = new QVBoxLayout();
+    m_networksListLayout->addWidget(m_networksList);
+    m_networksListLayout->addLayout(m_networksButtonsLayout);
+
+    m_nameLineEdit = new QLineEdit(this);
+    m_nameLineEdit->setToolTip(tr("Letters, numbers, - and _"));
+
+    m_addressLineEdit = new QLineEdit(this);
+    m_addressLineEdit->setText("230.0.0.1");
+    m_addressLineEdit->setToolTip(tr("Multicast address of the network, in the loopback of the host"));
+
+    m_portSpinBox = new QSpinBox(this);
+    m_portSpinBox->setMinimum(0);
+    m_portSpinBox->setMaximum(65535);
+    m_portSpinBox->setSpecialValueText(tr("Automatic"));
+
+    m_MTUSpinBox = new QSpinBox(this);
+    m_MTUSpinBox->setMinimum(576);
+    m_MTUSpinBox->setMaximum(65535);
+    m_MTUSpinBox->setValue(1500);
+
+    m_rxQueueComboBox = new QComboBox(this);
+    QStringList queueSizes;
+    queueSizes << "256" << "512" << "1024";
+    m_rxQueueComboBox->addItems(queueSizes);
+
+    m_saveNetworkButton = new QPushButton(QIcon::fromTheme("document-save",
+                                                           QIcon(QPixmap(":/images/icons/breeze/32x32/document-save.svg"))),
+                                          tr("Save"),
+                                          this);
+    connect(m_saveNetworkButton, &QAbstractButton::clicked,
+            this, &LocalNetworksWidget::saveNetwork);
+
+    QStringList header;
+    header << tr("Machine") << tr("State") << tr("MAC address");
+
+    m_machinesTree = new QTreeWidget(this);
+    m_machinesTree->setColumnCount(3);
+    m_machinesTree->setRootIsDecorated(false);
+    m_machinesTree->setHeaderLabels(header);
+
+    m_networkDetailsLayout = new QFormLayout();
+    m_networkDetailsLayout->addRow(tr("Name") + ":", m_nameLineEdit);
+    m_networkDetailsLayout->addRow(tr("Address") + ":", m_addressLineEdit);
+    m_networkDetailsLayout->addRow(tr("Port") + ":", m_portSpinBox);
+    m_networkDetailsLayout->addRow(tr("MTU") + ":", m_MTUSpinBox);
+    m_networkDetailsLayout->addRow(tr("RX queue size") + ":", m_rxQueueComboBox);
+    m_networkDetailsLayout->addRow("", m_saveNetworkButton);
+    m_networkDetailsLayout->addRow(m_machinesTree);
+
+    m_networksLayout = new QHBoxLayout();
+    m_networksLayout->addLayout(m_networksListLayout);
+    m_networksLayout->addLayout(m_networkDetailsLayout, 1);
+
+    m_networksGroup = new QGroupBox(tr("Networks"), this);
+    m_networksGroup->setLayout(m_networksLayout);
+
+    m_sourceComboBox = new QComboBox(this);
+    m_targetComboBox = new QComboBox(this);
+
+    m_linkTestButton = new QPushButton(tr("Run test"), this);
+    connect(m_linkTestButton, &QAbstractButton::clicked,
+            this, &LocalNetworksWidget::runLinkTest);
+
+    m_linkTestLabel = new QLabel(this);
+    m_linkTestLabel->setWordWrap(true);
+    m_linkTestLabel->setText(tr("The machines need the QEMU guest agent, ping and iperf3, "
+                                "and the guest agent readiness mode"));
+
+    m_linkTestLayout = new QFormLayout();
+    m_linkTestLayout->addRow(tr("From") + ":", m_sourceComboBox);
+    m_linkTestLayout->addRow(tr("To") + ":", m_targetComboBox);
+    m_linkTestLayout->addRow("", m_linkTestButton);
+    m_linkTestLayout->addRow(m_linkTestLabel);
+
+    m_linkTestGroup = new QGroupBox(tr("Link test"), this);
+    m_linkTestGroup->setLayout(m_linkTestLayout);
+
+    m_closeButton = new QPushButton(QIcon::fromTheme("window-close",
+                                                     QIcon(QPixmap(":/images/icons/breeze/32x32/window-close.svg"))),
+                                    tr("&Close"),
+                                    this);
+    connect(m_closeButton, &QAbstractButton::clicked,
+            this, &QWidget::hide);
+
+    QList<QKeySequence> closeShortcuts;
+    closeShortcuts << QKeySequence(Qt::Key_Escape);
+    m_closeAction = new QAction(this);
+    m_closeAction->setShortcuts(closeShortcuts);
+    connect(m_closeAction, &QAction::triggered,
+            this, &QWidget::hide);
+    this->addAction(m_closeAction);
+
+    m_mainLayout = new QVBoxLayout(this);
+    m_mainLayout->addWidget(m_networksGroup, 1);
+    m_mainLayout->addWidget(m_linkTestGroup);
+    m_mainLayout->addWidget(m_closeButton, 0, Qt::AlignRight);
+
+    qDebug() << "LocalNetworksWidget created";
+}
+
+LocalNetworksWidget::~LocalNetworksWidget()
+{
+    qDebug() << "LocalNetworksWidget destroyed";
+}
+
+/**
+ * @brief Refresh the networks
+ *
+ * Read the networks and select the first one
+ */
+void LocalNetworksWidget::refresh()
+{
+    QString selectedNetwork = this->m_nameLineEdit->text();
+
+    this->m_networksList->clear();
+    this->m_networksList->addItems(LocalNetworks::names());
+
+    QList<QListWidgetItem *> selectedItems = this->m_networksList->findItems(selectedNetwork, Qt::MatchExactly);
+    if (!selectedItems.isEmpty()) {
+        this->m_networksList->setCurrentItem(selectedItems.first());
+    } else {
+        this->m_networksList->setCurrentRow(0);
+    }
+    this->fillNetworkDetails();
+}
+
+/**
+ * @brief Fill the details of the network
+ *
+ * Fill the settings of the selected network, the machines
+ * connected to it and the machines of the link test
+ */
+void LocalNetworksWidget::fillNetworkDetails()
+{
+    this->m_machinesTree->clear();
+    this->m_sourceComboBox->clear();
+    this->m_targetComboBox->clear();
+
+    QListWidgetItem *networkItem = this->m_networksList->currentItem();
+    this->m_removeNetworkButton->setEnabled(networkItem != nullptr);
+    this->m_linkTestButton->setEnabled(networkItem != nullptr && this->m_linkTest == nullptr);
+
+    if (networkItem == nullptr) {
+        return;
+    }
+
+    LocalNetworks::Network network = LocalNetworks::network(networkItem->text());
+    this->m_nameLineEdit->setText(network.name);
+    this->m_addressLineEdit->setText(network.address);
+    this->m_portSpinBox->setValue(network.port);
+    this->m_MTUSpinBox->setValue(network.MTU);
+    this->m_rxQueueComboBox->setCurrentText(QString::number(network.rxQueueSize));
+
+    QList<Machine *> machines = this->networkMachines(network.name);
+    for (int i = 0; i < machines.size(); ++i) {
+        QString MACAddress;
+        QList<NetworkCard *> networkCards = machines.at(i)->getNetworkCards();
+        for (int j = 0; j < networkCards.size(); ++j) {
+            if (networkCards.at(j)->backend() == "local" && networkCards.at(j)->localNetwork() == network.name) {
+                MACAddress = networkCards.at(j)->MACAddress();
+            }
+        }
+
+        bool running = machines.at(i)->getState() == Machine::Started;
+
+        QTreeWidgetItem *machineItem = new QTreeWidgetItem(this->m_machinesTree, QTreeWidgetItem::Type);
+        machineItem->setText(0, machines.at(i)->getName());
+        machineItem->setText(1, running ? tr("Running") : tr("Stopped"));
+        machineItem->setText(2, MACAddress);
+
+        if (running) {
+            this->m_sourceComboBox->addItem(machines.at(i)->getName(), machines.at(i)->getUuid());
+            this->m_targetComboBox->addItem(machines.at(i)->getName(), machines.at(i)->getUuid());
+        }
+    }
+
+    if (this->m_targetComboBox->count() > 1) {
+        this->m_targetComboBox->setCurrentIndex(1);
+    }
+}
+
+/**
+ * @brief Prepare a new network
+ *
+ * Clear the fields for a new network
+ */
+void LocalNetworksWidget::newNetwork()
+{
+    this->m_networksList->clearSelection();
+    this->m_networksList->setCurrentItem(nullptr);
+
+    this->m_nameLineEdit->clear();
+    this->m_addressLineEdit->setText("230.0.0.1");
+    this->m_portSpinBox->setValue(0);
+    this->m_MTUSpinBox->setValue(1500);
+    this->m_rxQueueComboBox->setCurrentText("256");
+    this->m_nameLineEdit->setFocus();
+}
+
+/**
+ * @brief Save the network
+ *
+ * Save the network of the fields, a new network
+ * if the name is new
+ */
+void LocalNetworksWidget::saveNetwork()
+{
+    QString name = this->m_nameLineEdit->text().trimmed();
+    if (!LocalNetworks::isValidName(name)) {
+        SystemUtils::showMessage(tr("QtEmu - Local networks"),
+                                 tr("<p>The name of the network can only have letters, numbers, - and _</p>"),
+                                 QMessageBox::Warning);
+        return;
+    }
+
+    LocalNetworks::Network network;
+    network.name = name;
+    network.address = this->m_addressLineEdit->text().trimmed();
+    network.port = this->m_portSpinBox->value();
+    network.MTU = this->m_MTUSpinBox->value();
+    network.rxQueueSize = this->m_rxQueueComboBox->currentText().toInt();
+
+    // The port of other network would join both networks
+    QStringList networks = LocalNetworks::names();
+    for (int i = 0; i < networks.size(); ++i) {
+        LocalNetworks::Network otherNetwork = LocalNetworks::network(networks.at(i));
+        if (otherNetwork.name != name && network.port > 0 &&
+            otherNetwork.port == network.port && otherNetwork.address == network.address) {
+            SystemUtils::showMessage(tr("QtEmu - Local networks"),
+                                     tr("<p>The network %1 uses the same address and port</p>").arg(otherNetwork.name),
+                                     QMessageBox::Warning);
+            return;
+        }
+    }
+
+    LocalNetworks::saveNetwork(network);
+    this->refresh();
+}
+
+/**
+ * @brief Remove the selected network
+ *
+ * Remove the selected network. The cards of the
+ * machines keep the network name
+ */
+void LocalNetworksWidget::removeNetwork()
+{
+    QListWidgetItem *networkItem = this->m_networksList->currentItem();
+    if (networkItem == nullptr) {
+        return;
+    }
+
+    if (!this->networkMachines(networkItem->text()).isEmpty()) {
+        SystemUtils::showMessage(tr("QtEmu - Local networks"),
+                                 tr("<p>The network %1 has machines connected</p>").arg(networkItem->text()),
+                                 QMessageBox::Warning);
+        return;
+    }
+
+    LocalNetworks::removeNetwork(networkItem->text());
+    this->m_nameLineEdit->clear();
+    this->refresh();
+}
+
+/**
+ * @brief Run the link test
+ *
+ * Measure the latency and the throughput between
+ * the two selected machines
+ */
+void LocalNetworksWidget::runLinkTest()
+{
+    Machine *source = this->findMachine(this->m_sourceComboBox->currentData().toString());
+    Machine *target = this->findMachine(this->m_targetComboBox->currentData().toString());
+
+    if (source == nullptr || target == nullptr || source == target) {
+        this->m_linkTestLabel->setText(tr("Select two running machines of the network"));
+        return;
+    }
+
+    this->m_linkTest = new LinkTest(source, target, this->m_networksList->currentItem()->text(), this);
+    connect(m_linkTest, &LinkTest::progressSignal,
+            this, &LocalNetworksWidget::linkTestProgress);
+    connect(m_linkTest, &LinkTest::finishedSignal,
+            this, &LocalNetworksWidget::linkTestFinished);
+
+    this->m_linkTestButton->setEnabled(false);
+    this->m_linkTest->start();
+}
+
+/**
+ * @brief Show the step of the link test
+ * @param step, step of the test
+ *
+ * Show the step of the link test
+ */
+void LocalNetworksWidget::linkTestProgress(const QString &step)
+{
+    this->m_linkTestLabel->setText(step);
+}
+
+/**
+ * @brief Show the result of the link test
+ * @param succeeded, true if the test finished
+ * @param latency, average round trip time in ms
+ * @param throughput, throughput in Mbit/s
+ * @param error, reason of the failure
+ *
+ * Show the result of the link test
+ */
+void LocalNetworksWidget::linkTestFinished(bool succeeded,
+                                           double latency,
+                                           double throughput,
+                                           const QString &error)
+{
+    if (succeeded) {
+        this->m_linkTestLabel->setText(tr("Latency: %1 ms, throughput: %2 Mbit/s")
+                                       .arg(latency, 0, 'f', 3)
+                                       .arg(throughput, 0, 'f', 1));
+    } else {
+        this->m_linkTestLabel->setText(error);
+    }
+
+    this->m_linkTest->deleteLater();
+    this->m_linkTest = nullptr;
+    this->m_linkTestButton->setEnabled(this->m_networksList->currentItem() != nullptr);
+}
+
+void LocalNetworksWidget::closeEvent(QCloseEvent *event)
+{
+    this->hide();
+    event->ignore();
+}
+
+void LocalNetworksWidget::showEvent(QShowEvent *event)
+{
+    this->refresh();
+    event->accept();
+}
+
+/**
+ * @brief Get the machines of a network
+ * @param name, network name
+ * @return machines with a card in the network
+ *
+ * Get the machines with a card in the network
+ */
+QList<Machine *> LocalNetworksWidget::networkMachines(const QString &name) const
+{
+    QList<Machine *> machines;
+
+    for (int i = 0; i < this->m_machinesList->size(); ++i) {
+        QList<NetworkCard *> networkCards = this->m_machinesList->at(i)->getNetworkCards();
+        for (int j = 0; j < networkCards.size(); ++j) {
+            if (networkCards.at(j)->backend() == "local" && networkCards.at(j)->localNetwork() == name) {
+                machines.append(this->m_machinesList->at(i));
+                break;
+            }
+        }
+    }
+
+    return machines;
+}
+
+/**
+ * @brief Find a machine
+ * @param uuid, uuid of the machine
+ * @return machine, nullptr if it doesn't exist
+ *
+ * Find a machine of QtEmu by its uuid
+ */
+Machine *LocalNetworksWidget::findMachine(const QString &uuid) const
+{
+    for (int i = 0; i < this->m_machinesList->size(); ++i) {
+        if (this->m_machinesList->at(i)->getUuid() == uuid) {
+            return this->m_machinesList->at(i);
+        }
+    }
+
+    return nullptr;
+}
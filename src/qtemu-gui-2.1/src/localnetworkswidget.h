@@ -0,0 +1,118 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef LOCALNETWORKSWIDGET_H
+#define LOCALNETWORKSWIDGET_H
+
+// Qt
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QPushButton>
+#include <QAction>
+#include <QCloseEvent>
+#include <QShowEvent>
+#include <QLabel>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QComboBox>
+#include <QListWidget>
+#include <QTreeWidget>
+
+#include <QDebug>
+
+// Local
+#include "machine.h"
+#include "localnetworks.h"
+#include "linktest.h"
+#include "utils/systemutils.h"
+
+class LocalNetworksWidget : public QWidget {
+    Q_OBJECT
+
+    public:
+        explicit LocalNetworksWidget(const QList<Machine *> *machinesList,
+                                     QWidget *parent = nullptr);
+        ~LocalNetworksWidget();
+
+    signals:
+
+    public slots:
+        void refresh();
+
+    private slots:
+        void fillNetworkDetails();
+        void newNetwork();
+        void saveNetwork();
+        void removeNetwork();
+        void runLinkTest();
+        void linkTestProgress(const QString &step);
+        void linkTestFinished(bool succeeded,
+                              double latency,
+                              double throughput,
+                              const QString &error);
+
+    protected:
+        virtual void closeEvent(QCloseEvent *event);
+        virtual void showEvent(QShowEvent *event);
+
+    private:
+        const QList<Machine *> *m_machinesList;
+        LinkTest *m_linkTest;
+
+        QVBoxLayout *m_mainLayout;
+        QHBoxLayout *m_networksLayout;
+        QVBoxLayout *m_networksListLayout;
+        QHBoxLayout *m_networksButtonsLayout;
+        QFormLayout *m_networkDetailsLayout;
+        QFormLayout *m_linkTestLayout;
+
+        QGroupBox *m_networksGroup;
+        QGroupBox *m_linkTestGroup;
+
+        QListWidget *m_networksList;
+        QTreeWidget *m_machinesTree;
+
+        QLineEdit *m_nameLineEdit;
+        QLineEdit *m_addressLineEdit;
+        QSpinBox *m_portSpinBox;
+        QSpinBox *m_MTUSpinBox;
+        QComboBox *m_rxQueueComboBox;
+
+        QPushButton *m_newNetworkButton;
+        QPushButton *m_saveNetworkButton;
+        QPushButton *m_removeNetworkButton;
+
+        QComboBox *m_sourceComboBox;
+        QComboBox *m_targetComboBox;
+        QPushButton *m_linkTestButton;
+        QLabel *m_linkTestLabel;
+
+        QPushButton *m_closeButton;
+        QAction *m_closeAction;
+
+        // Methods
+        QList<Machine *> networkMachines(const QString &name) const;
+        Machine *findMachine(const QString &uuid) const;
+};
+
+#endif // LOCALNETWORKSWIDGET_H
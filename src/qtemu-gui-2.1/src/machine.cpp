@@ -30,6 +30,34 @@
 Machine::Machine(QObject *parent) : QObject(parent)
 {
     this->m_machineProcess = new QProcess(this);
+    this->m_serialConsole = nullptr;
+    this->hugePages = false;
+    this->memMerge = true;
+    this->balloon = false;
+    this->balloonMinimum = 256;
+    this->balloonMaximum = 0;
+    this->cgroup = false;
+    this->CPUMax = 0;
+    this->CPUWeight = 100;
+    this->memoryMax = 0;
+    this->memoryHigh = 0;
+    this->m_cgroup = nullptr;
+    this->serialCapture = false;
+    this->serialLogSize = 1024;
+    this->bootReadinessMode = "none";
+    this->bootReadinessPort = 0;
+    this->m_bootMonitor = nullptr;
+    this->m_bootHistory = nullptr;
+    this->m_lastBootTime = -1;
+    this->restartPolicy = "never";
+    this->m_supervisor = nullptr;
+    this->m_QEMUGlobalObject = nullptr;
+    this->m_launchLatency = -1;
+    this->m_qmpClient = nullptr;
+    this->m_eventTimeline = nullptr;
+    this->pooled = false;
+    this->m_prewarmed = false;
+    this->m_prewarmDiscarded = false;
 
 #ifdef Q_OS_WIN
     this->m_machineTcpSocket = new QTcpSocket(this);
@@ -50,6 +78,11 @@ Machine::Machine(QObject *parent) : QObject(parent)
 
 Machine::~Machine()
 {
+    this->discardPrewarm();
+
+    delete this->m_eventTimeline;
+    delete this->m_bootHistory;
+
     qDebug() << "Machine object destroyed";
 }
 
@@ -446,393 +479,1654 @@ void Machine::setRAM(const qlonglong &value)
 }
 
 /**
- * @brief Get the audio cards of the machine
+ * @brief Get if the RAM is backed by huge pages
+ * @return true if the machine uses huge pages
  *
- * Get the audio cards of the machine
- * Ex: ac97, es1370, hda...
+ * Get if the RAM of the machine is allocated
+ * from the huge pages of the host
  */
-QStringList Machine::getAudio() const
+bool Machine::getHugePages() const
 {
-    return audio;
+    return hugePages;
 }
 
 /**
- * @brief Set the audio cards of the machine
+ * @brief Set if the RAM is backed by huge pages
+ * @param value, true to use huge pages
  *
- * Set the audio cards of the machine
- * Ex: ac97, es1370, hda...
+ * Set if the RAM of the machine is allocated
+ * from the huge pages of the host
  */
-void Machine::setAudio(const QStringList &value)
+void Machine::setHugePages(bool value)
 {
-    audio = value;
+    hugePages = value;
 }
 
 /**
- * @brief Get if the machine have network
+ * @brief Get if the memory pages are merged
+ * @return true if the identical pages can be merged by KSM
  *
- * Get if the machine have network
+ * Get if the identical memory pages of the machine can be
+ * shared with other machines by the kernel same-page merging
  */
-bool Machine::getUseNetwork() const
+bool Machine::getMemMerge() const
 {
-    return useNetwork;
+    return memMerge;
 }
 
 /**
- * @brief Set if the machine have network
+ * @brief Set if the memory pages are merged
+ * @param value, true to let KSM merge the identical pages
  *
- * Set if the machine have network
+ * Set if the identical memory pages of the machine can be
+ * shared with other machines by the kernel same-page merging
  */
-void Machine::setUseNetwork(bool value)
+void Machine::setMemMerge(bool value)
 {
-    useNetwork = value;
+    memMerge = value;
 }
 
 /**
- * @brief Get the list of media
- * @return media list
+ * @brief Get if the machine has a memory balloon
+ * @return true if the machine has a virtio-balloon device
  *
- * Get the list of media of the machine
+ * Get if the RAM of the machine is adjusted
+ * by the balloon manager while it's running
  */
-QList<Media *> Machine::getMedia() const
+bool Machine::getBalloon() const
 {
-    return media;
+    return balloon;
 }
 
 /**
- * @brief Add media to the media list
- * @param value, new media
+ * @brief Set if the machine has a memory balloon
+ * @param value, true to add a virtio-balloon device
  *
- * Add media to the media list
+ * Set if the RAM of the machine is adjusted
+ * by the balloon manager while it's running
  */
-void Machine::addMedia(Media *media)
+void Machine::setBalloon(bool value)
 {
-    this->media.append(media);
+    balloon = value;
 }
 
 /**
- * @brief Get the accelerator machine
+ * @brief Get the floor of the balloon
+ * @return MiB of RAM the guest keeps always
  *
- * Get the accelerator machine
- * Ex: kvm, xen...
+ * Get the floor of the balloon
  */
-QStringList Machine::getAccelerator() const
+qlonglong Machine::getBalloonMinimum() const
 {
-    return accelerator;
+    return balloonMinimum;
 }
 
 /**
- * @brief Set the accelerator machine
+ * @brief Set the floor of the balloon
+ * @param value, MiB of RAM the guest keeps always
  *
- * Set the accelerator machine
- * Ex: kvm, xen...
+ * Set the floor of the balloon
  */
-void Machine::setAccelerator(const QStringList &value)
+void Machine::setBalloonMinimum(const qlonglong &value)
 {
-    accelerator = value;
+    balloonMinimum = value;
 }
 
 /**
- * @brief Get the machine boot
+ * @brief Get the ceiling of the balloon
+ * @return MiB of RAM the guest can get, 0 for all the RAM of the machine
  *
- * Get the machine boot
+ * Get the ceiling of the balloon
  */
-Boot *Machine::getBoot() const
+qlonglong Machine::getBalloonMaximum() const
 {
-    return boot;
+    return balloonMaximum;
 }
 
 /**
- * @brief Set the machine boot
+ * @brief Set the ceiling of the balloon
+ * @param value, MiB of RAM the guest can get, 0 for all the RAM of the machine
  *
- * Set the machine boot
+ * Set the ceiling of the balloon
  */
-void Machine::setBoot(Boot *value)
+void Machine::setBalloonMaximum(const qlonglong &value)
 {
-    boot = value;
+    balloonMaximum = value;
 }
 
 /**
- * @brief Get the host sound system
- * @return the host sound system
+ * @brief Get if the machine has its own cgroup
+ * @return true if QEMU is placed in its own cgroup with the limits
  *
- * Get the host sound system
- * In GNU/Linux: Alsa, pa, etc...
- * In Windows: wav...
+ * Get if the machine has its own cgroup
  */
-QString Machine::getHostSoundSystem() const
+bool Machine::getCGroup() const
 {
-    return hostSoundSystem;
+    return cgroup;
 }
 
 /**
- * @brief Set the host sound system
- * @param value, new host sound system
+ * @brief Set if the machine has its own cgroup
+ * @param value, true to place QEMU in its own cgroup with the limits
  *
- * Set the host sound system
+ * Set if the machine has its own cgroup
  */
-void Machine::setHostSoundSystem(const QString &value)
+void Machine::setCGroup(bool value)
 {
-    hostSoundSystem = value;
+    cgroup = value;
 }
 
-// Methods
 /**
- * @brief Add the audio card to the list
- * @param audio, audio card to be added
+ * @brief Get the CPU limit
+ * @return percent of one host CPU the machine can use, 0 without limit
  *
- * Add the audio card to the list
+ * Get the CPU limit, cpu.max of the cgroup
  */
-void Machine::addAudio(const QString audio)
+int Machine::getCPUMax() const
 {
-    if (!this->audio.contains(audio)) {
-        this->audio.append(audio);
-    }
+    return CPUMax;
 }
 
 /**
- * @brief Remove the audio card from the list
- * @param audio, audio card to be removed
+ * @brief Set the CPU limit
+ * @param value, percent of one host CPU the machine can use, 0 without limit
  *
- * Remove the audio card from the list
+ * Set the CPU limit, cpu.max of the cgroup
  */
-void Machine::removeAudio(const QString audio)
+void Machine::setCPUMax(int value)
 {
-    if (this->audio.contains(audio)) {
-        this->audio.removeOne(audio);
-    }
+    CPUMax = value;
 }
 
 /**
- * @brief Remove all audio cards
+ * @brief Get the CPU weight
+ * @return weight of the machine against the others, 100 by default
  *
- * Remove all audio cards of the machine
+ * Get the CPU weight, cpu.weight of the cgroup
  */
-void Machine::removeAllAudioCards()
+int Machine::getCPUWeight() const
 {
-    this->audio.clear();
+    return CPUWeight;
 }
 
 /**
- * @brief Add an accelerator to the list
- * @param accel code of the accelerator
+ * @brief Set the CPU weight
+ * @param value, weight of the machine against the others, from 1 to 10000
  *
- * Add an accelerator to the list
+ * Set the CPU weight, cpu.weight of the cgroup
  */
-void Machine::addAccelerator(const QString accel)
+void Machine::setCPUWeight(int value)
 {
-    if (!this->accelerator.contains(accel)) {
-        this->accelerator.append(accel);
-    }
+    CPUWeight = value;
 }
 
 /**
- * @brief Remove an accelerator from the list
- * @param accel code of the accelerator
+ * @brief Get the memory limit
+ * @return MiB of memory of the QEMU process, 0 without limit
  *
- * Remove an accelerator from the list if exists
+ * Get the memory limit, memory.max of the cgroup.
+ * Over the limit the kernel kills QEMU
  */
-void Machine::removeAccelerator(const QString accel)
+qlonglong Machine::getMemoryMax() const
 {
-    if(this->accelerator.contains(accel)){
-        this->accelerator.removeOne(accel);
-    }
+    return memoryMax;
 }
 
 /**
- * @brief Remove all accelerators
+ * @brief Set the memory limit
+ * @param value, MiB of memory of the QEMU process, 0 without limit
  *
- * Remove all accelerators of the machine
+ * Set the memory limit, memory.max of the cgroup
  */
-void Machine::removeAllAccelerators()
+void Machine::setMemoryMax(const qlonglong &value)
 {
-    this->accelerator.clear();
+    memoryMax = value;
 }
 
 /**
- * @brief Remove all media
+ * @brief Get the memory throttle
+ * @return MiB of memory above which QEMU is reclaimed, 0 without throttle
  *
- * Remove all media
+ * Get the memory throttle, memory.high of the cgroup
  */
-void Machine::removeAllMedia()
+qlonglong Machine::getMemoryHigh() const
 {
-    this->media.clear();
+    return memoryHigh;
 }
 
 /**
- * @brief Get all the audio cards separated by commas
- * @return Audio cards separated by commas
+ * @brief Set the memory throttle
+ * @param value, MiB of memory above which QEMU is reclaimed, 0 without throttle
  *
- * Get all the audio cards separated by commas
- * Ex: ac97, es1370, hda
+ * Set the memory throttle, memory.high of the cgroup
  */
-QString Machine::getAudioLabel()
+void Machine::setMemoryHigh(const qlonglong &value)
 {
-    QHash<QString, QString> soundCardsHash = SystemUtils::getSoundCards();
-    QStringList audioCards = this->audio;
-    for(int i = 0; i < audioCards.size(); ++i) {
-        audioCards.replace(i, soundCardsHash.value(audioCards.at(i)));
-    }
-    QString audioLabel = audioCards.join(",");
+    memoryHigh = value;
+}
 
-    return audioLabel;
+/**
+ * @brief Get the IO limits
+ * @return one limit per device, like "/dev/sda rbps=1048576 wiops=100"
+ *
+ * Get the IO limits, io.max of the cgroup
+ */
+QStringList Machine::getIOMax() const
+{
+    return IOMax;
 }
 
 /**
- * @brief Get all the accelerators separated by commas
- * @return Accelerators separated by commas
+ * @brief Set the IO limits
+ * @param value, one limit per device, like "/dev/sda rbps=1048576 wiops=100"
  *
- * Get all the accelerators separated by commas
- * Ex: kvm,tcg
+ * Set the IO limits, io.max of the cgroup
  */
-QString Machine::getAcceleratorLabel()
+void Machine::setIOMax(const QStringList &value)
 {
-    QHash<QString, QString> acceleratorsHash = SystemUtils::getAccelerators();
-    QStringList accel = this->accelerator;
-    for(int i = 0; i < accel.size(); ++i) {
-        accel.replace(i, acceleratorsHash.value(accel.at(i)));
+    IOMax = value;
+}
+
+/**
+ * @brief Apply the limits to the running machine
+ * @return true if the limits are applied
+ *
+ * Change the limits of the cgroup of the running machine.
+ * A stopped machine gets the limits when it's launched
+ */
+bool Machine::applyResourceLimits()
+{
+    if (this->m_cgroup == nullptr || this->m_machineProcess->state() == QProcess::NotRunning) {
+        return true;
     }
-    QString acceleratorLabel = accel.join(",");
 
-    return acceleratorLabel;
+    this->m_cgroup->setLimits(this->resourceLimits());
+
+    bool applied = this->m_cgroup->apply();
+    Logger::logMachineAction(this->path, this->name, this->uuid,
+                             applied ? "Resource limits changed" : "Cannot change the resource limits");
+
+    return applied;
 }
 
 /**
- * @brief Run the machine in QEMU
+ * @brief Apply the throttle limits of the media to the running machine
+ * @param media, throttled media
+ * @return true if the limits are sent to QEMU
  *
- * Run the machine in QEMU process
+ * Change the throttle limits of the drive with block_set_io_throttle.
+ * A stopped machine gets the limits in the drive definition
  */
-void Machine::runMachine(QEMU *QEMUGlobalObject)
+bool Machine::applyIOThrottle(Media *media)
 {
-    QStringList args = this->generateMachineCommand();
+    if (this->m_machineProcess->state() == QProcess::NotRunning) {
+        return true;
+    }
 
-    QString program;
-    #ifdef Q_OS_LINUX
-    program.append(QEMUGlobalObject->getQEMUBinary("qemu-system-x86_64"));
-    #endif
-    #ifdef Q_OS_WIN
-    program.append(QEMUGlobalObject->getQEMUBinary("qemu-system-x86_64.exe"));
-    #endif
-    #ifdef Q_OS_MACOS
-    program.append(QEMUGlobalObject->getQEMUBinary("qemu-system-x86_64"));
-    #endif
-    #ifdef Q_OS_FREEBSD
-    program.append(QEMUGlobalObject->getQEMUBinary("qemu-system-x86_64"));
-    #endif
+    if (this->m_qmpClient == nullptr || !this->m_qmpClient->isReady()) {
+        return false;
+    }
 
-    if (program.isEmpty()) {
-        SystemUtils::showMessage(tr("QEMU - Binary not found"),
-                                 tr("QEMU binary not found"),
-                                 QMessageBox::Information);
+    // QMP uses other names, iops-read-max is iops_rd_max
+    QJsonObject arguments;
+    arguments["device"] = this->driveId(media);
+
+    QStringList throttleKeys = Media::throttleKeys();
+    for (int i = 0; i < throttleKeys.size(); ++i) {
+        QString argument = throttleKeys.at(i);
+        argument.replace("-total", "").replace("-read", "_rd")
+                .replace("-write", "_wr").replace("-max", "_max");
+        arguments[argument] = media->throttle(throttleKeys.at(i));
     }
 
-    this->m_machineProcess->start(program, args);
-#ifdef Q_OS_WIN
-    QSettings settings;
-    settings.beginGroup("Configuration");
+    if (!media->throttleGroup().isEmpty()) {
+        arguments["group"] = media->throttleGroup();
+    }
 
-    QString monitorHostName = settings.value("qemuMonitorHost", "localhost").toString();
-    quint16 monitorSocket = static_cast<quint16>(settings.value("qemuMonitorPort", 6000).toInt());
+    QString mediaName = media->name();
+    this->m_qmpClient->execute("block_set_io_throttle", arguments, [this, mediaName](const QJsonObject &reply) {
+        if (reply.contains("error")) {
+            Logger::logMachineAction(this->path, this->name, this->uuid,
+                                     "Cannot change the throttle limits of " + mediaName + ": " +
+                                     reply["error"].toObject()["desc"].toString());
+            return;
+        }
 
-    this->m_machineTcpSocket->connectToHost(monitorHostName, monitorSocket, QIODevice::ReadWrite);
-#endif
+        Logger::logMachineAction(this->path, this->name, this->uuid,
+                                 "Throttle limits of " + mediaName + " changed");
+    });
+
+    return true;
 }
 
 /**
- * @brief Stop the machine
+ * @brief Add a port forwarding rule to the running machine
+ * @param rule, new rule, with the hostfwd syntax
+ * @param error, reason if the rule isn't added
+ * @return true if the rule is sent to QEMU
  *
- * Stop the machine
+ * Reserve the host port and add the rule with hostfwd_add.
+ * A stopped machine gets the rules when it's launched
  */
-void Machine::stopMachine()
+bool Machine::addPortForward(const QString &rule, QString *error)
 {
-#ifdef Q_OS_WIN
-    if (this->m_machineTcpSocket->state() != QAbstractSocket::ConnectedState) {
-        this->failConnectMachine();
-    } else {
-        this->m_machineTcpSocket->write(qPrintable("system_powerdown\n"));
+    if (this->m_machineProcess->state() == QProcess::NotRunning) {
+        return true;
     }
-#else
-    this->m_machineProcess->write(qPrintable("system_reset\n"));
-#endif
-    this->state = Machine::Stopped;
 
-    emit(machineStateChangedSignal(Machine::Stopped));
+    if (this->portForwardCard() < 0) {
+        *error = tr("The machine has no user mode network card");
+        return false;
+    }
+
+    if (this->m_qmpClient == nullptr || !this->m_qmpClient->isReady()) {
+        *error = tr("The machine is not connected");
+        return false;
+    }
+
+    HostPortRegistry *hostPortRegistry = this->m_QEMUGlobalObject->hostPortRegistry();
+    if (!hostPortRegistry->reserveRule(this, rule, error)) {
+        return false;
+    }
+
+    // hostfwd_add is only a monitor command
+    QJsonObject arguments;
+    arguments["command-line"] = QString("hostfwd_add net%1 %2").arg(this->portForwardCard()).arg(rule);
+
+    this->m_qmpClient->execute("human-monitor-command", arguments, [this, rule, hostPortRegistry](const QJsonObject &reply) {
+        QString output = reply["return"].toString().trimmed();
+        if (reply.contains("error") || !output.isEmpty()) {
+            hostPortRegistry->releaseRule(this, rule);
+            Logger::logMachineAction(this->path, this->name, this->uuid,
+                                     "Cannot add the port forwarding " + rule + ": " +
+                                     (output.isEmpty() ? reply["error"].toObject()["desc"].toString() : output));
+            return;
+        }
+
+        Logger::logMachineAction(this->path, this->name, this->uuid, "Port forwarding " + rule + " added");
+    });
+
+    return true;
 }
 
 /**
- * @brief Reset the machine
+ * @brief Remove a port forwarding rule from the running machine
+ * @param rule, removed rule, with the hostfwd syntax
+ * @return true if the rule is sent to QEMU
  *
- * Reset the machine
+ * Remove the rule with hostfwd_remove and release the host port
  */
-void Machine::resetMachine()
+bool Machine::removePortForward(const QString &rule)
 {
-#ifdef Q_OS_WIN
-    if (this->m_machineTcpSocket->state() != QAbstractSocket::ConnectedState) {
-        this->failConnectMachine();
-    } else {
-        this->m_machineTcpSocket->write(qPrintable("system_reset\n"));
+    if (this->m_machineProcess->state() == QProcess::NotRunning) {
+        return true;
     }
-#else
-    this->m_machineProcess->write(qPrintable("system_reset\n"));
-#endif
+
+    if (this->portForwardCard() < 0 || this->m_qmpClient == nullptr || !this->m_qmpClient->isReady()) {
+        return false;
+    }
+
+    QJsonObject arguments;
+    arguments["command-line"] = QString("hostfwd_remove net%1 %2").arg(this->portForwardCard())
+                                                                  .arg(HostPortRegistry::removeArgument(rule));
+
+    this->m_qmpClient->execute("human-monitor-command", arguments, [this, rule](const QJsonObject &reply) {
+        Q_UNUSED(reply);
+        Logger::logMachineAction(this->path, this->name, this->uuid, "Port forwarding " + rule + " removed");
+    });
+
+    this->m_QEMUGlobalObject->hostPortRegistry()->releaseRule(this, rule);
+
+    return true;
 }
 
 /**
- * @brief Pause the machine
+ * @brief Get the limits of the cgroup
+ * @return limits of the machine
  *
- * If the machine is started, paused it
- * If the machine if paused, started it
+ * Get the limits of the cgroup of the machine
  */
-void Machine::pauseMachine()
+MachineCGroup::Limits Machine::resourceLimits() const
 {
-    if (state == Machine::Started) {
-
-#ifdef Q_OS_WIN
-        if (this->m_machineTcpSocket->state() != QAbstractSocket::ConnectedState) {
-            this->failConnectMachine();
-        } else {
-            this->m_machineTcpSocket->write(qPrintable("stop\n"));
-        }
-#else
-        this->m_machineProcess->write(qPrintable("stop\n"));
-#endif
-        this->state = Machine::Paused;
+    MachineCGroup::Limits limits;
+    limits.CPUMax = this->CPUMax;
+    limits.CPUWeight = this->CPUWeight;
+    limits.memoryMax = this->memoryMax;
+    limits.memoryHigh = this->memoryHigh;
+    limits.IOMax = this->IOMax;
 
-        emit(machineStateChangedSignal(Machine::Paused));
-    } else if (state == Machine::Paused) {
+    return limits;
+}
 
-#ifdef Q_OS_WIN
-        if (this->m_machineTcpSocket->state() != QAbstractSocket::ConnectedState) {
-            this->failConnectMachine();
-        } else {
-            this->m_machineTcpSocket->write(qPrintable("cont\n"));
+/**
+ * @brief Get the drive id of the media
+ * @param media, media of the machine
+ * @return drive id, the device for QMP
+ *
+ * Get the drive id of the media. The fast boot profile names
+ * the disks, the others use the ids that QEMU gives to
+ * -hda, -cdrom, -fda...
+ */
+QString Machine::driveId(const Media *media) const
+{
+    if (this->isFastBoot()) {
+        int disk = 0;
+        for (int i = 0; i < this->media.size() && this->media.at(i) != media; ++i) {
+            if (this->media.at(i)->type() == "hdd") {
+                ++disk;
+            }
         }
-#else
-        this->m_machineProcess->write(qPrintable("cont\n"));
-#endif
-        this->state = Machine::Started;
 
-        emit(machineStateChangedSignal(Machine::Started));
+        return QString("disk%1").arg(disk);
     }
+
+    QHash<QString, QString> driveIds;
+    driveIds.insert("hda", "ide0-hd0");
+    driveIds.insert("hdb", "ide0-hd1");
+    driveIds.insert("hdc", "ide1-hd0");
+    driveIds.insert("hdd", "ide1-hd1");
+    driveIds.insert("cdrom", "ide1-cd0");
+    driveIds.insert("fda", "floppy0");
+    driveIds.insert("fdb", "floppy1");
+
+    return driveIds.value(media->driveInterface());
 }
 
 /**
- * @brief Read standard output
+ * @brief Get the card of the port forwarding
+ * @return index of the first user mode card, -1 if there's none
  *
- * Read the machine standard output
+ * Get the card of the port forwarding, the rules
+ * are added to the first user mode card
  */
-void Machine::readMachineStandardOut()
+int Machine::portForwardCard() const
 {
-    QByteArray rawStandardOut;
+    if (!this->useNetwork) {
+        return -1;
+    }
+
+    for (int i = 0; i < this->networkCards.size(); ++i) {
+        if (this->networkCards.at(i)->backend() == "user") {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Get the port forwarding options of the netdev
+ * @return options to append to the user mode -netdev
+ *
+ * Get the port forwarding options of the netdev
+ * Ex: ,hostfwd=tcp:127.0.0.1:2222-:22,hostfwd=udp::5353-:53
+ */
+QString Machine::hostForwards() const
+{
+    QString hostForwards;
+    for (int i = 0; i < this->portForwards.size(); ++i) {
+        hostForwards.append(",hostfwd=").append(this->portForwards.at(i));
+    }
+
+    return hostForwards;
+}
+
+/**
+ * @brief Get the throttling options of the drive
+ * @param media, media of the machine
+ * @return options to append to -drive, empty if the media isn't throttled
+ *
+ * Get the throttling options of the drive
+ * Ex: ,throttling.iops-total=500,throttling.group=backup
+ */
+QString Machine::driveThrottling(const Media *media) const
+{
+    QString throttling;
+
+    QStringList throttleKeys = Media::throttleKeys();
+    for (int i = 0; i < throttleKeys.size(); ++i) {
+        if (media->throttle(throttleKeys.at(i)) > 0) {
+            throttling.append(QString(",throttling.%1=%2").arg(throttleKeys.at(i))
+                                                           .arg(media->throttle(throttleKeys.at(i))));
+        }
+    }
+
+    if (!media->throttleGroup().isEmpty()) {
+        throttling.append(",throttling.group=").append(media->throttleGroup());
+    }
+
+    return throttling;
+}
+
+/**
+ * @brief Get the audio cards of the machine
+ *
+ * Get the audio cards of the machine
+ * Ex: ac97, es1370, hda...
+ */
+QStringList Machine::getAudio() const
+{
+    return audio;
+}
+
+/**
+ * @brief Set the audio cards of the machine
+ *
+ * Set the audio cards of the machine
+ * Ex: ac97, es1370, hda...
+ */
+void Machine::setAudio(const QStringList &value)
+{
+    audio = value;
+}
+
+/**
+ * @brief Get if the machine have network
+ *
+ * Get if the machine have network
+ */
+bool Machine::getUseNetwork() const
+{
+    return useNetwork;
+}
+
+/**
+ * @brief Set if the machine have network
+ *
+ * Set if the machine have network
+ */
+void Machine::setUseNetwork(bool value)
+{
+    useNetwork = value;
+}
+
+/**
+ * @brief Get if the serial console is captured
+ * @return true if the serial console is captured
+ *
+ * Get if the output of the first serial port is saved
+ * in the serial log of the machine
+ */
+bool Machine::getSerialCapture() const
+{
+    return serialCapture;
+}
+
+/**
+ * @brief Set if the serial console is captured
+ * @param value, true if the serial console is captured
+ *
+ * Set if the output of the first serial port is saved
+ * in the serial log of the machine
+ */
+void Machine::setSerialCapture(bool value)
+{
+    serialCapture = value;
+}
+
+/**
+ * @brief Get the size of the serial log
+ * @return size of the serial log in KiB
+ *
+ * Get the size of the serial log, the oldest output
+ * is overwritten when the log is full
+ */
+int Machine::getSerialLogSize() const
+{
+    return serialLogSize;
+}
+
+/**
+ * @brief Set the size of the serial log
+ * @param value, size of the serial log in KiB
+ *
+ * Set the size of the serial log, the oldest output
+ * is overwritten when the log is full
+ */
+void Machine::setSerialLogSize(int value)
+{
+    serialLogSize = value;
+}
+
+/**
+ * @brief Get how the readiness of the guest is detected
+ * @return none, serial, agent or tcp
+ *
+ * Get how the readiness of the guest is detected
+ */
+QString Machine::getBootReadinessMode() const
+{
+    return bootReadinessMode;
+}
+
+/**
+ * @brief Set how the readiness of the guest is detected
+ * @param value, none, serial, agent or tcp
+ *
+ * Set how the readiness of the guest is detected
+ */
+void Machine::setBootReadinessMode(const QString &value)
+{
+    bootReadinessMode = value;
+}
+
+/**
+ * @brief Get the readiness pattern
+ * @return regular expression printed in the serial console when the guest is ready
+ *
+ * Get the readiness pattern
+ */
+QString Machine::getBootReadinessPattern() const
+{
+    return bootReadinessPattern;
+}
+
+/**
+ * @brief Set the readiness pattern
+ * @param value, regular expression printed in the serial console when the guest is ready
+ *
+ * Set the readiness pattern
+ */
+void Machine::setBootReadinessPattern(const QString &value)
+{
+    bootReadinessPattern = value;
+}
+
+/**
+ * @brief Get the readiness port
+ * @return TCP port of the host opened when the guest is ready
+ *
+ * Get the readiness port
+ */
+int Machine::getBootReadinessPort() const
+{
+    return bootReadinessPort;
+}
+
+/**
+ * @brief Set the readiness port
+ * @param value, TCP port of the host opened when the guest is ready
+ *
+ * Set the readiness port
+ */
+void Machine::setBootReadinessPort(int value)
+{
+    bootReadinessPort = value;
+}
+
+/**
+ * @brief Get if the machine is pooled
+ * @return true if the machine is kept launched and paused
+ *
+ * Get if the machine is kept launched and paused
+ * by the pool, so it starts instantly
+ */
+bool Machine::getPooled() const
+{
+    return pooled;
+}
+
+/**
+ * @brief Set if the machine is pooled
+ * @param value, true to keep the machine launched and paused
+ *
+ * Set if the machine is kept launched and paused by the pool
+ */
+void Machine::setPooled(bool value)
+{
+    pooled = value;
+}
+
+/**
+ * @brief Get the template of the pool
+ * @return name of the template, empty if the machine isn't from a pooled template
+ *
+ * Get the template that keeps this machine in its pool
+ */
+QString Machine::getPoolTemplate() const
+{
+    return poolTemplate;
+}
+
+/**
+ * @brief Set the template of the pool
+ * @param value, name of the template
+ *
+ * Set the template that keeps this machine in its pool
+ */
+void Machine::setPoolTemplate(const QString &value)
+{
+    poolTemplate = value;
+}
+
+/**
+ * @brief Get if the machine is prewarmed
+ * @return true if QEMU is launched and paused waiting for the start
+ *
+ * Get if the machine is prewarmed. The state is
+ * still stopped until the machine is started
+ */
+bool Machine::isPrewarmed() const
+{
+    return this->m_prewarmed;
+}
+
+/**
+ * @brief Get the restart policy
+ * @return never, on-failure or always
+ *
+ * Get if the machine is launched again when it finishes
+ */
+QString Machine::getRestartPolicy() const
+{
+    return restartPolicy;
+}
+
+/**
+ * @brief Set the restart policy
+ * @param value, never, on-failure or always
+ *
+ * Set if the machine is launched again when it finishes
+ */
+void Machine::setRestartPolicy(const QString &value)
+{
+    restartPolicy = value;
+
+    if (this->m_supervisor != nullptr) {
+        this->m_supervisor->setRestartPolicy(MachineSupervisor::policyFromString(value));
+    }
+}
+
+/**
+ * @brief Get the serial console
+ * @return serial console, nullptr if it isn't captured
+ *
+ * Get the serial console of the running machine
+ */
+SerialConsole *Machine::getSerialConsole() const
+{
+    return m_serialConsole;
+}
+
+/**
+ * @brief Get the QMP client
+ * @return QMP client, nullptr if the machine was never launched
+ *
+ * Get the QMP client of the machine. Commands can be
+ * executed when the client is ready
+ */
+QMPClient *Machine::getQMPClient() const
+{
+    return m_qmpClient;
+}
+
+/**
+ * @brief Get the hash of the config file
+ * @return SHA-1 of the config file saved or loaded last
+ *
+ * Get the hash of the content of the config file that
+ * QtEmu saved or loaded last
+ */
+QByteArray Machine::getConfigHash() const
+{
+    return this->m_configHash;
+}
+
+/**
+ * @brief Set the hash of the config file
+ * @param value, SHA-1 of the config file
+ *
+ * Set the hash of the content of the config file loaded
+ */
+void Machine::setConfigHash(const QByteArray &value)
+{
+    this->m_configHash = value;
+}
+
+/**
+ * @brief Get the display server name
+ * @return local socket of the VNC server
+ *
+ * Get the local socket where QEMU serves the display
+ * of the machine, vnc.sock inside the machine folder
+ */
+QString Machine::getDisplayServerName() const
+{
+    return QDir(this->path).filePath("vnc.sock");
+}
+
+/**
+ * @brief Get if the machine has an embedded display
+ * @return true if the display is shown in QtEmu
+ *
+ * The display is served with VNC in a local socket, not
+ * available on Windows. The fast boot profile has no display
+ */
+bool Machine::hasEmbeddedDisplay() const
+{
+#ifdef Q_OS_WIN
+    return false;
+#else
+    return !this->isFastBoot();
+#endif
+}
+
+/**
+ * @brief Get the event timeline
+ * @return timeline with the QMP events of the machine
+ *
+ * Get the event timeline, stored in the events.bin
+ * file of the machine
+ */
+EventTimeline *Machine::getEventTimeline() const
+{
+    return m_eventTimeline;
+}
+
+/**
+ * @brief Get the process id of the machine
+ * @return pid of the QEMU process, 0 if the machine isn't running
+ *
+ * Get the process id of the machine
+ */
+qint64 Machine::getProcessId() const
+{
+    return this->m_machineProcess->processId();
+}
+
+/**
+ * @brief Get the uptime of the machine
+ * @return milliseconds since the QEMU process started, 0 if it isn't running
+ *
+ * Get the uptime of the machine
+ */
+qint64 Machine::getUptime() const
+{
+    return this->m_startedTimer.isValid() ? this->m_startedTimer.elapsed() : 0;
+}
+
+/**
+ * @brief Get the launch latency of the machine
+ * @return milliseconds between the launch and the start of the process,
+ * -1 if the machine was never launched
+ *
+ * Get the launch latency of the last launch of the machine
+ */
+qint64 Machine::getLaunchLatency() const
+{
+    return m_launchLatency;
+}
+
+/**
+ * @brief Get the boot time of the last boot
+ * @return milliseconds between the launch and the guest being ready,
+ * -1 if the guest never was ready
+ *
+ * Get the boot time of the last boot of the machine
+ */
+qint64 Machine::getLastBootTime() const
+{
+    return m_lastBootTime;
+}
+
+/**
+ * @brief Get the boot history
+ * @return history with the boot times of the machine
+ *
+ * Get the boot history, stored in the boots.json
+ * file of the machine
+ */
+BootHistory *Machine::getBootHistory()
+{
+    if (this->m_bootHistory == nullptr) {
+        this->m_bootHistory = new BootHistory(QDir(this->path).filePath("boots.json"));
+    }
+
+    return m_bootHistory;
+}
+
+/**
+ * @brief Get the supervisor
+ * @return supervisor that restarts the machine and saves its crashes
+ *
+ * Get the supervisor of the machine
+ */
+MachineSupervisor *Machine::getSupervisor()
+{
+    if (this->m_supervisor == nullptr) {
+        this->m_supervisor = new MachineSupervisor(this->path, this);
+        this->m_supervisor->setRestartPolicy(MachineSupervisor::policyFromString(this->restartPolicy));
+        connect(m_supervisor, &MachineSupervisor::restartSignal,
+                this, &Machine::restartMachine);
+        connect(m_supervisor, &MachineSupervisor::crashLoopSignal,
+                this, &Machine::crashLoop);
+    }
+
+    return m_supervisor;
+}
+
+/**
+ * @brief Get the boot configuration
+ * @return options of the machine that change the boot time
+ *
+ * Get the options of the machine that change the boot time,
+ * used to compare the boots done with different options
+ */
+QJsonObject Machine::getBootConfig() const
+{
+    QStringList diskInterfaces;
+    for (int i = 0; i < this->media.size(); ++i) {
+        diskInterfaces.append(this->media.at(i)->driveInterface());
+    }
+
+    QJsonObject bootConfig;
+    bootConfig["machineType"]   = this->type;
+    bootConfig["CPUType"]       = this->CPUType;
+    bootConfig["CPUCount"]      = this->CPUCount;
+    bootConfig["RAM"]           = this->RAM;
+    bootConfig["hugePages"]     = this->hugePages;
+    bootConfig["GPUType"]       = this->GPUType;
+    bootConfig["accelerator"]   = this->accelerator.join(",");
+    bootConfig["diskInterface"] = diskInterfaces.join(",");
+    bootConfig["fastBoot"]      = this->isFastBoot();
+
+    return bootConfig;
+}
+
+/**
+ * @brief Get the network cards
+ * @return network cards of the machine
+ *
+ * Get the network cards of the machine
+ */
+QList<NetworkCard *> Machine::getNetworkCards() const
+{
+    return networkCards;
+}
+
+/**
+ * @brief Add a network card
+ * @param networkCard, new network card
+ *
+ * Add a network card to the machine
+ */
+void Machine::addNetworkCard(NetworkCard *networkCard)
+{
+    this->networkCards.append(networkCard);
+}
+
+/**
+ * @brief Get the port forwarding rules
+ * @return rules, with the hostfwd syntax
+ *
+ * Get the port forwarding rules of the user mode network
+ * Ex: tcp:127.0.0.1:2222-:22
+ */
+QStringList Machine::getPortForwards() const
+{
+    return portForwards;
+}
+
+/**
+ * @brief Set the port forwarding rules
+ * @param value, rules, with the hostfwd syntax
+ *
+ * Set the port forwarding rules of the user mode network
+ */
+void Machine::setPortForwards(const QStringList &value)
+{
+    portForwards = value;
+}
+
+/**
+ * @brief Get the list of media
+ * @return media list
+ *
+ * Get the list of media of the machine
+ */
+QList<Media *> Machine::getMedia() const
+{
+    return media;
+}
+
+/**
+ * @brief Add media to the media list
+ * @param value, new media
+ *
+ * Add media to the media list
+ */
+void Machine::addMedia(Media *media)
+{
+    this->media.append(media);
+}
+
+/**
+ * @brief Get the accelerator machine
+ *
+ * Get the accelerator machine
+ * Ex: kvm, xen...
+ */
+QStringList Machine::getAccelerator() const
+{
+    return accelerator;
+}
+
+/**
+ * @brief Set the accelerator machine
+ *
+ * Set the accelerator machine
+ * Ex: kvm, xen...
+ */
+void Machine::setAccelerator(const QStringList &value)
+{
+    accelerator = value;
+}
+
+/**
+ * @brief Get the machine boot
+ *
+ * Get the machine boot
+ */
+Boot *Machine::getBoot() const
+{
+    return boot;
+}
+
+/**
+ * @brief Set the machine boot
+ *
+ * Set the machine boot
+ */
+void Machine::setBoot(Boot *value)
+{
+    boot = value;
+}
+
+/**
+ * @brief Get the host sound system
+ * @return the host sound system
+ *
+ * Get the host sound system
+ * In GNU/Linux: Alsa, pa, etc...
+ * In Windows: wav...
+ */
+QString Machine::getHostSoundSystem() const
+{
+    return hostSoundSystem;
+}
+
+/**
+ * @brief Set the host sound system
+ * @param value, new host sound system
+ *
+ * Set the host sound system
+ */
+void Machine::setHostSoundSystem(const QString &value)
+{
+    hostSoundSystem = value;
+}
+
+// Methods
+/**
+ * @brief Add the audio card to the list
+ * @param audio, audio card to be added
+ *
+ * Add the audio card to the list
+ */
+void Machine::addAudio(const QString audio)
+{
+    if (!this->audio.contains(audio)) {
+        this->audio.append(audio);
+    }
+}
+
+/**
+ * @brief Remove the audio card from the list
+ * @param audio, audio card to be removed
+ *
+ * Remove the audio card from the list
+ */
+void Machine::removeAudio(const QString audio)
+{
+    if (this->audio.contains(audio)) {
+        this->audio.removeOne(audio);
+    }
+}
+
+/**
+ * @brief Remove all audio cards
+ *
+ * Remove all audio cards of the machine
+ */
+void Machine::removeAllAudioCards()
+{
+    this->audio.clear();
+}
+
+/**
+ * @brief Add an accelerator to the list
+ * @param accel code of the accelerator
+ *
+ * Add an accelerator to the list
+ */
+void Machine::addAccelerator(const QString accel)
+{
+    if (!this->accelerator.contains(accel)) {
+        this->accelerator.append(accel);
+    }
+}
+
+/**
+ * @brief Remove an accelerator from the list
+ * @param accel code of the accelerator
+ *
+ * Remove an accelerator from the list if exists
+ */
+void Machine::removeAccelerator(const QString accel)
+{
+    if(this->accelerator.contains(accel)){
+        this->accelerator.removeOne(accel);
+    }
+}
+
+/**
+ * @brief Remove all accelerators
+ *
+ * Remove all accelerators of the machine
+ */
+void Machine::removeAllAccelerators()
+{
+    this->accelerator.clear();
+}
+
+/**
+ * @brief Remove all media
+ *
+ * Remove all media
+ */
+void Machine::removeAllMedia()
+{
+    this->media.clear();
+}
+
+/**
+ * @brief Remove all network cards
+ *
+ * Remove all network cards. The cards aren't
+ * deleted, the caller frees them
+ */
+void Machine::removeAllNetworkCards()
+{
+    this->networkCards.clear();
+}
+
+/**
+ * @brief Get all the audio cards separated by commas
+ * @return Audio cards separated by commas
+ *
+ * Get all the audio cards separated by commas
+ * Ex: ac97, es1370, hda
+ */
+QString Machine::getAudioLabel()
+{
+    QHash<QString, QString> soundCardsHash = SystemUtils::getSoundCards();
+    QStringList audioCards = this->audio;
+    for(int i = 0; i < audioCards.size(); ++i) {
+        audioCards.replace(i, soundCardsHash.value(audioCards.at(i)));
+    }
+    QString audioLabel = audioCards.join(",");
+
+    return audioLabel;
+}
+
+/**
+ * @brief Get all the accelerators separated by commas
+ * @return Accelerators separated by commas
+ *
+ * Get all the accelerators separated by commas
+ * Ex: kvm,tcg
+ */
+QString Machine::getAcceleratorLabel()
+{
+    QHash<QString, QString> acceleratorsHash = SystemUtils::getAccelerators();
+    QStringList accel = this->accelerator;
+    for(int i = 0; i < accel.size(); ++i) {
+        accel.replace(i, acceleratorsHash.value(accel.at(i)));
+    }
+    QString acceleratorLabel = accel.join(",");
+
+    return acceleratorLabel;
+}
+
+/**
+ * @brief Run the machine in QEMU
+ * @param QEMUGlobalObject, QEMU global object
+ * @return true if the machine is launched
+ *
+ * Run the machine in QEMU process. A prewarmed machine
+ * only continues the paused CPUs
+ */
+bool Machine::runMachine(QEMU *QEMUGlobalObject)
+{
+    if (this->m_prewarmed && this->m_machineProcess->state() == QProcess::Running) {
+        return this->resumePrewarmed();
+    }
+
+    return this->launchMachine(QEMUGlobalObject, false);
+}
+
+/**
+ * @brief Prewarm the machine
+ * @param QEMUGlobalObject, QEMU global object
+ * @return true if the machine is launched
+ *
+ * Launch QEMU with the CPUs paused. The devices and the firmware
+ * are ready and the machine starts instantly with runMachine
+ */
+bool Machine::prewarmMachine(QEMU *QEMUGlobalObject)
+{
+    // QEMU failed to start in the last prewarm
+    if (this->m_prewarmed && this->m_machineProcess->state() == QProcess::NotRunning) {
+        this->m_prewarmed = false;
+    }
+
+    if (this->state != Machine::Stopped || this->m_prewarmed ||
+        this->m_machineProcess->state() != QProcess::NotRunning) {
+        return false;
+    }
+
+    return this->launchMachine(QEMUGlobalObject, true);
+}
+
+/**
+ * @brief Discard the prewarmed machine
+ *
+ * Kill the paused QEMU process of the machine, used when the
+ * configuration changes or the machine is removed from the pool
+ */
+void Machine::discardPrewarm()
+{
+    if (!this->m_prewarmed) {
+        return;
+    }
+
+    Logger::logMachineAction(this->path, this->name, this->uuid, "Prewarmed machine discarded");
+
+    if (this->m_machineProcess->state() != QProcess::NotRunning) {
+        this->m_prewarmDiscarded = true;
+        this->m_machineProcess->kill();
+        this->m_machineProcess->waitForFinished(2000);
+    }
+}
+
+/**
+ * @brief Launch the machine in QEMU
+ * @param QEMUGlobalObject, QEMU global object
+ * @param paused, true to launch the machine with the CPUs paused
+ * @return true if the machine is launched
+ *
+ * Launch the QEMU process. Before, the admission
+ * controller checks that the host can hold the machine
+ */
+bool Machine::launchMachine(QEMU *QEMUGlobalObject, bool paused)
+{
+    this->m_QEMUGlobalObject = QEMUGlobalObject;
+
+    AdmissionController *admissionController = QEMUGlobalObject->admissionController();
+    AdmissionController::Decision decision = admissionController->admit(this);
+    if (decision == AdmissionController::Queued || decision == AdmissionController::Refused) {
+        Logger::logMachineAction(this->path, this->name, this->uuid,
+                                 QString("Machine launch %1: %2")
+                                 .arg(decision == AdmissionController::Queued ? "queued" : "refused")
+                                 .arg(admissionController->reason(this)));
+        return false;
+    }
+
+    // A card of a deleted local network would join the port 0
+    if (this->useNetwork) {
+        QStringList missingNetworks;
+        for (int i = 0; i < this->networkCards.size(); ++i) {
+            QString localNetwork = this->networkCards.at(i)->localNetwork();
+            if (this->networkCards.at(i)->backend() != "local" || LocalNetworks::contains(localNetwork)) {
+                continue;
+            }
+            if (localNetwork.isEmpty()) {
+                localNetwork = tr("(no network chosen)");
+            }
+            if (!missingNetworks.contains(localNetwork)) {
+                missingNetworks.append(localNetwork);
+            }
+        }
+
+        if (!missingNetworks.isEmpty()) {
+            Logger::logMachineAction(this->path, this->name, this->uuid,
+                                     "Machine launch refused, unknown local networks: " + missingNetworks.join(", "));
+            SystemUtils::showMessage(tr("QtEmu - Local networks"),
+                                     tr("The machine <b>%1</b> is not launched, "
+                                        "these local networks don't exist:").arg(this->name) +
+                                     QString("<br>").append(missingNetworks.join("<br>")) +
+                                     QString("<br>").append(tr("Choose other network in the machine configuration")),
+                                     QMessageBox::Critical);
+            admissionController->release(this);
+            return false;
+        }
+    }
+
+    // A port used by other machine or program makes QEMU fail
+    QString portConflicts;
+    HostPortRegistry *hostPortRegistry = QEMUGlobalObject->hostPortRegistry();
+    if (this->portForwardCard() >= 0 && !hostPortRegistry->reserve(this, &portConflicts)) {
+        Logger::logMachineAction(this->path, this->name, this->uuid,
+                                 "Machine launch refused, port conflicts: " + portConflicts);
+        SystemUtils::showMessage(tr("QtEmu - Port forwarding"),
+                                 tr("The machine <b>%1</b> is not launched:").arg(this->name) +
+                                 QString("<br>").append(portConflicts.replace("; ", "<br>")),
+                                 QMessageBox::Critical);
+        admissionController->release(this);
+        return false;
+    }
+
+    if (this->m_serialConsole != nullptr) {
+        delete this->m_serialConsole;
+        this->m_serialConsole = nullptr;
+    }
+
+    BootMonitor::Mode bootReadiness = BootMonitor::modeFromString(this->bootReadinessMode);
+
+    // The serial pattern needs the serial console even if it isn't captured
+    if (this->serialCapture || bootReadiness == BootMonitor::SerialPattern) {
+        this->m_serialConsole = new SerialConsole(this->path, this->uuid,
+                                                  static_cast<qint64>(this->serialLogSize) * 1024, this);
+    }
+
+    if (this->m_qmpClient != nullptr) {
+        delete this->m_qmpClient;
+    }
+
+    this->m_qmpClient = new QMPClient(this->path, this->uuid, this);
+    connect(m_qmpClient, &QMPClient::eventSignal,
+            this, &Machine::machineEvent);
+
+    if (this->m_eventTimeline == nullptr) {
+        this->m_eventTimeline = new EventTimeline(QDir(this->path).filePath("events.bin"));
+    }
+    this->m_eventTimeline->open();
+
+    if (this->m_bootMonitor != nullptr) {
+        delete this->m_bootMonitor;
+        this->m_bootMonitor = nullptr;
+    }
+
+    if (bootReadiness != BootMonitor::None) {
+        this->m_bootMonitor = new BootMonitor(this->path, this->uuid, this);
+        this->m_bootMonitor->setMode(bootReadiness);
+        this->m_bootMonitor->setSerialPattern(this->bootReadinessPattern);
+        this->m_bootMonitor->setTCPPort(this->bootReadinessPort);
+        this->m_bootMonitor->watchSerialConsole(this->m_serialConsole);
+        connect(m_bootMonitor, &BootMonitor::guestReadySignal,
+                this, &Machine::guestReady);
+    }
+
+    QStringList args = this->generateMachineCommand();
+
+    // Wait for the cont command before running the CPUs
+    if (paused) {
+        args << "-S";
+    }
+
+    QString program;
+    #ifdef Q_OS_LINUX
+    program.append(QEMUGlobalObject->getQEMUBinary("qemu-system-x86_64"));
+    #endif
+    #ifdef Q_OS_WIN
+    program.append(QEMUGlobalObject->getQEMUBinary("qemu-system-x86_64.exe"));
+    #endif
+    #ifdef Q_OS_MACOS
+    program.append(QEMUGlobalObject->getQEMUBinary("qemu-system-x86_64"));
+    #endif
+    #ifdef Q_OS_FREEBSD
+    program.append(QEMUGlobalObject->getQEMUBinary("qemu-system-x86_64"));
+    #endif
+
+    if (program.isEmpty()) {
+        SystemUtils::showMessage(tr("QEMU - Binary not found"),
+                                 tr("QEMU binary not found"),
+                                 QMessageBox::Information);
+        admissionController->release(this);
+        hostPortRegistry->release(this);
+        return false;
+    }
+
+    if (this->m_cgroup != nullptr) {
+        delete this->m_cgroup;
+        this->m_cgroup = nullptr;
+    }
+
+    if (this->cgroup) {
+        this->m_cgroup = new MachineCGroup(this->uuid, this);
+        this->m_cgroup->setLimits(this->resourceLimits());
+        this->m_cgroup->wrapCommand(program, args);
+    }
+
+    Logger::logMachineAction(this->path, this->name, this->uuid,
+                             QString("Machine %1: ").arg(paused ? "prewarmed" : "launched") +
+                             program + " " + args.join(" "));
+
+    // The boot of a prewarmed machine begins when it's started
+    this->m_prewarmed = paused;
+    if (!paused) {
+        this->getSupervisor()->machineLaunched();
+
+        this->m_launchTimer.start();
+        if (this->m_bootMonitor != nullptr) {
+            this->m_bootMonitor->start();
+        }
+    }
+    this->m_machineProcess->start(program, args);
+#ifdef Q_OS_WIN
+    QSettings settings;
+    settings.beginGroup("Configuration");
+
+    QString monitorHostName = settings.value("qemuMonitorHost", "localhost").toString();
+    quint16 monitorSocket = static_cast<quint16>(settings.value("qemuMonitorPort", 6000).toInt());
+
+    this->m_machineTcpSocket->connectToHost(monitorHostName, monitorSocket, QIODevice::ReadWrite);
+#endif
+
+    return true;
+}
+
+/**
+ * @brief Start the prewarmed machine
+ * @return true if the machine is started
+ *
+ * Continue the paused CPUs with QMP, or with the monitor
+ * when QMP isn't connected yet
+ */
+bool Machine::resumePrewarmed()
+{
+    this->m_prewarmed = false;
+    this->getSupervisor()->machineLaunched();
+
+    this->m_launchTimer.start();
+    if (this->m_bootMonitor != nullptr) {
+        this->m_bootMonitor->start();
+    }
+
+    if (this->m_qmpClient != nullptr && this->m_qmpClient->isReady()) {
+        this->m_qmpClient->execute("cont", QJsonObject(), [this](const QJsonObject &reply) {
+            Q_UNUSED(reply);
+            this->m_launchLatency = this->m_launchTimer.elapsed();
+        });
+    } else {
+#ifdef Q_OS_WIN
+        this->m_machineTcpSocket->write(qPrintable("cont\n"));
+#else
+        this->m_machineProcess->write(qPrintable("cont\n"));
+#endif
+        this->m_launchLatency = this->m_launchTimer.elapsed();
+    }
+
+    this->state = Machine::Started;
+    this->m_startedTimer.start();
+
+    Logger::logMachineAction(this->path, this->name, this->uuid, "Machine started from the pool");
+    emit(machineStateChangedSignal(Machine::Started));
+
+    return true;
+}
+
+/**
+ * @brief Launch the machine detached from QtEmu
+ * @param program, path of the QEMU binary
+ * @param headless, true to launch the machine without display
+ * @param pid, variable to store the process id
+ * @return true if the machine is launched
+ *
+ * The machine keeps running when QtEmu exits. It has no
+ * monitor, it's controlled with the QMP socket
+ */
+bool Machine::launchDetached(const QString &program, bool headless, qint64 *pid)
+{
+    if (this->m_qmpClient == nullptr) {
+        this->m_qmpClient = new QMPClient(this->path, this->uuid, this);
+    }
+
+    QStringList args = this->generateMachineCommand();
+
+    // Nobody reads the standard input of a detached process
+    int monitorPos = args.indexOf("-monitor");
+    if (monitorPos != -1 && monitorPos + 1 < args.size()) {
+        args[monitorPos + 1] = "none";
+    }
+
+    if (headless) {
+        args << "-display" << "none";
+    }
+
+    QString launchProgram(program);
+    MachineCGroup machineCGroup(this->uuid);
+    if (this->cgroup) {
+        machineCGroup.setLimits(this->resourceLimits());
+        machineCGroup.wrapCommand(launchProgram, args);
+    }
+
+    Logger::logMachineAction(this->path, this->name, this->uuid,
+                             "Machine launched detached: " + launchProgram + " " + args.join(" "));
+
+    qint64 processId = 0;
+    bool launched = QProcess::startDetached(launchProgram, args, this->path, &processId);
+    if (launched && this->cgroup && !machineCGroup.attach(processId)) {
+        Logger::logMachineAction(this->path, this->name, this->uuid,
+                                 "Cannot place the machine in its cgroup, it runs without limits");
+    }
+
+    if (pid != nullptr) {
+        *pid = processId;
+    }
+
+    return launched;
+}
+
+/**
+ * @brief Stop the machine
+ *
+ * Stop the machine
+ */
+void Machine::stopMachine()
+{
+#ifdef Q_OS_WIN
+    if (this->m_machineTcpSocket->state() != QAbstractSocket::ConnectedState) {
+        this->failConnectMachine();
+    } else {
+        this->m_machineTcpSocket->write(qPrintable("system_powerdown\n"));
+    }
+#else
+    this->m_machineProcess->write(qPrintable("system_reset\n"));
+#endif
+    this->state = Machine::Stopped;
+    this->getSupervisor()->stopRequested();
+
+    Logger::logMachineAction(this->path, this->name, this->uuid, "Machine stopped");
+
+    emit(machineStateChangedSignal(Machine::Stopped));
+}
+
+/**
+ * @brief Reset the machine
+ *
+ * Reset the machine
+ */
+void Machine::resetMachine()
+{
+#ifdef Q_OS_WIN
+    if (this->m_machineTcpSocket->state() != QAbstractSocket::ConnectedState) {
+        this->failConnectMachine();
+    } else {
+        this->m_machineTcpSocket->write(qPrintable("system_reset\n"));
+    }
+#else
+    this->m_machineProcess->write(qPrintable("system_reset\n"));
+#endif
+}
+
+/**
+ * @brief Pause the machine
+ *
+ * If the machine is started, paused it
+ * If the machine if paused, started it
+ */
+void Machine::pauseMachine()
+{
+    if (state == Machine::Started) {
+
+#ifdef Q_OS_WIN
+        if (this->m_machineTcpSocket->state() != QAbstractSocket::ConnectedState) {
+            this->failConnectMachine();
+        } else {
+            this->m_machineTcpSocket->write(qPrintable("stop\n"));
+        }
+#else
+        this->m_machineProcess->write(qPrintable("stop\n"));
+#endif
+        this->state = Machine::Paused;
+
+        Logger::logMachineAction(this->path, this->name, this->uuid, "Machine paused");
+
+        emit(machineStateChangedSignal(Machine::Paused));
+    } else if (state == Machine::Paused) {
+
+#ifdef Q_OS_WIN
+        if (this->m_machineTcpSocket->state() != QAbstractSocket::ConnectedState) {
+            this->failConnectMachine();
+        } else {
+            this->m_machineTcpSocket->write(qPrintable("cont\n"));
+        }
+#else
+        this->m_machineProcess->write(qPrintable("cont\n"));
+#endif
+        this->state = Machine::Started;
+
+        Logger::logMachineAction(this->path, this->name, this->uuid, "Machine resumed");
+
+        emit(machineStateChangedSignal(Machine::Started));
+    }
+}
+
+/**
+ * @brief Read standard output
+ *
+ * Read the machine standard output
+ */
+void Machine::readMachineStandardOut()
+{
+    QByteArray rawStandardOut;
 #ifdef Q_OS_WIN
     rawStandardOut = this->m_machineTcpSocket->readAll();
 #else
     rawStandardOut = this->m_machineProcess->readAllStandardOutput();
 #endif
-    QString standardOut = rawStandardOut;
-    QStringList splitStandardOut = standardOut.split("[K");
-    QString cleanStandardOut = splitStandardOut.last().remove(QRegExp("\\[[KD]."));
-    // Remove space characters, included \r \t \n
-    cleanStandardOut = cleanStandardOut.simplified();
+    QString cleanStandardOut = MachineUtils::cleanMonitorOutput(rawStandardOut);
 
     if (cleanStandardOut.isEmpty() ||
         cleanStandardOut.contains("(qemu)") ||
@@ -862,7 +2156,17 @@ void Machine::readMachineErrorOut()
     QString errorOutput = rawErrorOutput;
     if (errorOutput.isEmpty()) {
         return;
-    }   
+    }
+
+    this->getSupervisor()->appendErrorOutput(rawErrorOutput);
+
+    // Nobody would close the message of a supervised machine
+    if (this->getSupervisor()->restartPolicy() != MachineSupervisor::Never) {
+        Logger::logMachineAction(this->path, this->name, this->uuid,
+                                 "QEMU error output: " + errorOutput.trimmed());
+        return;
+    }
+
     SystemUtils::showMessage(tr("QEMU - Error Out"),
                              errorOutput,
                              QMessageBox::Critical);
@@ -875,7 +2179,33 @@ void Machine::readMachineErrorOut()
  */
 void Machine::machineStarted()
 {
+    if (this->m_cgroup != nullptr && !this->m_cgroup->attach(this->m_machineProcess->processId())) {
+        Logger::logMachineAction(this->path, this->name, this->uuid,
+                                 "Cannot place the machine in its cgroup, it runs without limits");
+    }
+
+    if (this->m_prewarmed) {
+        if (this->m_serialConsole != nullptr) {
+            this->m_serialConsole->start();
+        }
+
+        this->m_qmpClient->connectToMachine();
+
+        Logger::logMachineAction(this->path, this->name, this->uuid, "Machine prewarmed and paused");
+        return;
+    }
+
     this->state = Machine::Started;
+    this->m_launchLatency = this->m_launchTimer.isValid() ? this->m_launchTimer.elapsed() : -1;
+    this->m_startedTimer.start();
+
+    if (this->m_serialConsole != nullptr) {
+        this->m_serialConsole->start();
+    }
+
+    this->m_qmpClient->connectToMachine();
+
+    Logger::logMachineAction(this->path, this->name, this->uuid, "Machine started");
     emit(machineStateChangedSignal(Machine::Started));
 }
 
@@ -887,8 +2217,111 @@ void Machine::machineStarted()
 void Machine::machineFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     qDebug() << "Exit code: " << exitCode << " exit status: " << exitStatus;
+    bool prewarmed = this->m_prewarmed;
+    this->m_prewarmed = false;
+    qint64 uptime = this->getUptime();
     this->state = Machine::Stopped;
+    this->m_startedTimer.invalidate();
+
+    if (this->m_serialConsole != nullptr) {
+        this->m_serialConsole->stop();
+    }
+
+    if (this->m_qmpClient != nullptr) {
+        this->m_qmpClient->disconnectFromMachine();
+    }
+
+    if (this->m_bootMonitor != nullptr) {
+        this->m_bootMonitor->stop();
+    }
+
+    if (this->m_cgroup != nullptr) {
+        this->m_cgroup->detach();
+    }
+
+    Logger::logMachineAction(this->path, this->name, this->uuid,
+                             QString("Machine finished with exit code %1%2")
+                             .arg(exitCode)
+                             .arg(exitStatus == QProcess::CrashExit ? ", crashed" : ""));
     emit(machineStateChangedSignal(Machine::Stopped));
+
+    if (this->m_QEMUGlobalObject != nullptr) {
+        this->m_QEMUGlobalObject->admissionController()->release(this);
+        this->m_QEMUGlobalObject->hostPortRegistry()->release(this);
+    }
+
+    // The pool launches it again, it isn't a crash of a running machine
+    if (prewarmed) {
+        bool discarded = this->m_prewarmDiscarded;
+        this->m_prewarmDiscarded = false;
+        emit(prewarmFinishedSignal(discarded));
+        return;
+    }
+
+    this->getSupervisor()->machineFinished(exitCode, exitStatus, uptime);
+}
+
+/**
+ * @brief Restart the machine
+ *
+ * Launch the machine again after a crash or an exit,
+ * following the restart policy
+ */
+void Machine::restartMachine()
+{
+    if (this->state != Machine::Stopped || this->m_QEMUGlobalObject == nullptr) {
+        return;
+    }
+
+    Logger::logMachineAction(this->path, this->name, this->uuid, "Machine restarted by the supervisor");
+    this->runMachine(this->m_QEMUGlobalObject);
+}
+
+/**
+ * @brief The machine is in a crash loop
+ * @param crashes, crashes inside the crash loop window
+ *
+ * The supervisor doesn't restart the machine anymore
+ */
+void Machine::crashLoop(int crashes)
+{
+    Logger::logMachineAction(this->path, this->name, this->uuid,
+                             QString("Crash loop, %1 crashes, the machine is not restarted").arg(crashes));
+}
+
+/**
+ * @brief Machine event
+ * @param event, name of the QMP event
+ * @param data, data of the event
+ * @param timestamp, QEMU timestamp of the event
+ *
+ * Save the QMP event in the timeline of the machine
+ */
+void Machine::machineEvent(const QString &event,
+                           const QJsonObject &data,
+                           const QJsonObject &timestamp)
+{
+    if (this->m_eventTimeline != nullptr) {
+        this->m_eventTimeline->append(event, data, timestamp);
+    }
+
+    emit(machineEventSignal(event, data));
+}
+
+/**
+ * @brief The guest is ready
+ * @param bootTime, milliseconds since the machine was launched
+ *
+ * Save the boot time in the boot history of the machine
+ */
+void Machine::guestReady(qint64 bootTime)
+{
+    this->m_lastBootTime = bootTime;
+    this->getBootHistory()->append(bootTime, this->getBootConfig());
+
+    Logger::logMachineAction(this->path, this->name, this->uuid,
+                             QString("Guest ready after %1 ms").arg(bootTime));
+    emit(machineBootedSignal(bootTime));
 }
 
 /**
@@ -899,6 +2332,10 @@ void Machine::machineFinished(int exitCode, QProcess::ExitStatus exitStatus)
  */
 QStringList Machine::generateMachineCommand()
 {
+    if (this->isFastBoot()) {
+        return this->generateFastBootCommand();
+    }
+
     QStringList qemuCommand;
 
     #ifdef Q_OS_WIN
@@ -920,6 +2357,10 @@ QStringList Machine::generateMachineCommand()
         qemuCommand << this->type;
     }
 
+    // The memory is marked as mergeable with madvise
+    qemuCommand << "-machine";
+    qemuCommand << QString("mem-merge=%1").arg(this->memMerge ? "on" : "off");
+
     QString uuid(this->uuid);
     qemuCommand << "-uuid";
     qemuCommand << uuid.remove("{").remove("}");
@@ -985,12 +2426,31 @@ QStringList Machine::generateMachineCommand()
     qemuCommand << "-m";
     qemuCommand << QString::number(this->RAM);
 
+#ifdef Q_OS_LINUX
+    if (this->hugePages) {
+        qemuCommand << "-mem-path";
+        qemuCommand << "/dev/hugepages";
+        qemuCommand << "-mem-prealloc";
+    }
+#endif
+
     qemuCommand << "-k";
     qemuCommand << this->keyboard;
 
     qemuCommand << "-vga";
     qemuCommand << this->GPUType;
 
+    // The display is shown by QtEmu, the tablet keeps the pointer in sync
+    if (this->hasEmbeddedDisplay()) {
+        qemuCommand << "-display";
+        qemuCommand << "none";
+        qemuCommand << "-vnc";
+        qemuCommand << "unix:" + this->getDisplayServerName();
+        qemuCommand << "-usb";
+        qemuCommand << "-device";
+        qemuCommand << "usb-tablet";
+    }
+
     qemuCommand << "-cpu";
     qemuCommand << this->CPUType;
 
@@ -1017,19 +2477,66 @@ QStringList Machine::generateMachineCommand()
     qemuCommand << "-pidfile";
     qemuCommand << pipe;
 
-    // Network
-    if (this->useNetwork) {
-        qemuCommand << "-net";
-        qemuCommand << "nic";
+    // QMP
+    if (this->m_qmpClient != nullptr) {
+        qemuCommand << this->m_qmpClient->QEMUArguments();
+    }
 
-        qemuCommand << "-net";
-        qemuCommand << "user";
+    // Serial console
+    if (this->m_serialConsole != nullptr) {
+        qemuCommand << this->m_serialConsole->QEMUArguments();
+    }
+
+    // Guest agent channel
+    if (this->m_bootMonitor != nullptr) {
+        qemuCommand << this->m_bootMonitor->QEMUArguments();
+    }
+
+    // Memory balloon
+    if (this->balloon) {
+        qemuCommand << "-device";
+        qemuCommand << "virtio-balloon-pci,id=balloon0,deflate-on-oom=on";
+    }
+
+    // Network
+    if (this->useNetwork && !this->networkCards.isEmpty()) {
+        for (int i = 0; i < this->networkCards.size(); ++i) {
+            QString netdevId = QString("net%1").arg(i);
+
+            qemuCommand << "-netdev";
+            if (i == this->portForwardCard()) {
+                qemuCommand << this->networkCards.at(i)->netdev(netdevId).append(this->hostForwards());
+            } else {
+                qemuCommand << this->networkCards.at(i)->netdev(netdevId);
+            }
+
+            qemuCommand << "-device";
+            qemuCommand << this->networkCards.at(i)->device(netdevId);
+        }
     } else {
         qemuCommand << "-net";
         qemuCommand << "none";
     }
 
+    // The throttled media need -drive, the ids are the same of -hda...
+    QHash<QString, QString> throttledDrives;
+    throttledDrives.insert("hda", "if=ide,index=0,media=disk");
+    throttledDrives.insert("hdb", "if=ide,index=1,media=disk");
+    throttledDrives.insert("hdc", "if=ide,index=2,media=disk");
+    throttledDrives.insert("hdd", "if=ide,index=3,media=disk");
+    throttledDrives.insert("cdrom", "if=ide,index=2,media=cdrom");
+    throttledDrives.insert("fda", "if=floppy,index=0");
+    throttledDrives.insert("fdb", "if=floppy,index=1");
+
     for (int i = 0; i < media.size(); ++i) {
+        if (media.at(i)->isThrottled() && throttledDrives.contains(media.at(i)->driveInterface())) {
+            qemuCommand << "-drive";
+            qemuCommand << QString("file=%1,%2%3").arg(media.at(i)->path())
+                                                  .arg(throttledDrives.value(media.at(i)->driveInterface()))
+                                                  .arg(this->driveThrottling(media.at(i)));
+            continue;
+        }
+
         QString driveInterface("-");
         driveInterface.append(media.at(i)->driveInterface());
 
@@ -1042,6 +2549,208 @@ QStringList Machine::generateMachineCommand()
     return qemuCommand;
 }
 
+/**
+ * @brief Get if the machine boots with the fast boot profile
+ * @return true if the fast boot profile is used
+ *
+ * The fast boot profile is only used with the direct kernel boot
+ * and a kernel selected, otherwise there is nothing to boot without firmware
+ */
+bool Machine::isFastBoot() const
+{
+    return this->boot->fastBoot() &&
+           this->boot->kernelBootEnabled() &&
+           !this->boot->kernelPath().isEmpty();
+}
+
+/**
+ * @brief Generate the fast boot machine command
+ * @return List with all the commands
+ *
+ * Generate the command of the fast boot profile: a microvm machine
+ * (or q35 when the binary has no microvm) without default devices,
+ * firmware menu or option ROMs, and only virtio block, net and
+ * console devices. The kernel is loaded directly by QEMU
+ */
+QStringList Machine::generateFastBootCommand()
+{
+    QStringList qemuCommand;
+
+    #ifdef Q_OS_WIN
+    QSettings settings;
+    settings.beginGroup("Configuration");
+    qemuCommand << "-monitor" << QString("tcp:%1:%2,server,nowait")
+                                        .arg(settings.value("qemuMonitorHost", "localhost").toString())
+                                        .arg(settings.value("qemuMonitorPort", 6000).toInt());
+    settings.endGroup();
+    #else
+    qemuCommand << "-monitor" << "stdio";
+    #endif
+
+    qemuCommand << "-name";
+    qemuCommand << this->name;
+
+    // microvm is used unless the probed binary doesn't have it
+    bool microvm = true;
+    if (this->m_QEMUGlobalObject != nullptr &&
+        this->m_QEMUGlobalObject->capabilities()->isProbed() &&
+        !this->m_QEMUGlobalObject->capabilities()->machineTypes().contains("microvm")) {
+        microvm = false;
+    }
+
+    QString memMerge = QString("mem-merge=%1").arg(this->memMerge ? "on" : "off");
+    qemuCommand << "-machine";
+    if (microvm) {
+        qemuCommand << "microvm,x-option-roms=off,pit=off,pic=off,rtc=off," + memMerge;
+    } else {
+        qemuCommand << "q35," + memMerge;
+        qemuCommand << "-boot";
+        qemuCommand << "menu=off";
+    }
+
+    qemuCommand << "-nodefaults";
+    qemuCommand << "-no-user-config";
+    qemuCommand << "-display";
+    qemuCommand << "none";
+    qemuCommand << "-no-reboot";
+
+    QString uuid(this->uuid);
+    qemuCommand << "-uuid";
+    qemuCommand << uuid.remove("{").remove("}");
+
+    // -accel takes one accelerator, the next ones are the fallbacks
+    for (int i = 0; i < this->accelerator.size(); ++i) {
+        qemuCommand << "-accel";
+        qemuCommand << this->accelerator.at(i).trimmed();
+    }
+
+    qemuCommand << "-cpu";
+    qemuCommand << this->CPUType;
+
+    qemuCommand << "-smp";
+    qemuCommand << QString::number(this->CPUCount);
+
+    qemuCommand << "-m";
+    qemuCommand << QString::number(this->RAM);
+
+#ifdef Q_OS_LINUX
+    if (this->hugePages) {
+        qemuCommand << "-mem-path";
+        qemuCommand << "/dev/hugepages";
+        qemuCommand << "-mem-prealloc";
+    }
+#endif
+
+    qemuCommand << "-kernel";
+    qemuCommand << this->boot->kernelPath();
+
+    if (!this->boot->initrdPath().isEmpty()) {
+        qemuCommand << "-initrd";
+        qemuCommand << this->boot->initrdPath();
+    }
+
+    // Without arguments the kernel logs to the serial port and
+    // QEMU exits instead of rebooting after a panic
+    qemuCommand << "-append";
+    if (this->boot->kernelArgs().isEmpty()) {
+        qemuCommand << "console=ttyS0 reboot=t panic=-1";
+    } else {
+        qemuCommand << this->boot->kernelArgs();
+    }
+
+    QString pipe = this->path;
+    pipe.append(QDir::toNativeSeparators("/")).append(this->name).append(".pid");
+    qemuCommand << "-pidfile";
+    qemuCommand << pipe;
+
+    QString virtioBus = microvm ? "device" : "pci";
+
+    // QMP
+    if (this->m_qmpClient != nullptr) {
+        qemuCommand << this->m_qmpClient->QEMUArguments();
+    }
+
+    // Serial console, without capture the kernel console is kept
+    // in console.log so the boot messages and the panics aren't lost
+    if (this->m_serialConsole != nullptr) {
+        qemuCommand << this->m_serialConsole->QEMUArguments();
+    } else {
+        qemuCommand << "-chardev";
+        qemuCommand << QString("file,id=serial0,path=%1").arg(QDir(this->path).filePath("console.log"));
+        qemuCommand << "-serial";
+        qemuCommand << "chardev:serial0";
+    }
+
+    // Guest agent channel, microvm only has the virtio-mmio transport
+    if (this->m_bootMonitor != nullptr) {
+        QStringList agentArguments = this->m_bootMonitor->QEMUArguments();
+        int serialIndex = agentArguments.indexOf("virtio-serial");
+        if (microvm && serialIndex != -1) {
+            agentArguments[serialIndex] = "virtio-serial-device";
+        }
+        qemuCommand << agentArguments;
+    }
+
+    // Memory balloon
+    if (this->balloon) {
+        qemuCommand << "-device";
+        qemuCommand << QString("virtio-balloon-%1,id=balloon0,deflate-on-oom=on").arg(virtioBus);
+    }
+
+    // Network, always virtio-net
+    if (this->useNetwork) {
+        for (int i = 0; i < this->networkCards.size(); ++i) {
+            QString netdevId = QString("net%1").arg(i);
+
+            qemuCommand << "-netdev";
+            if (i == this->portForwardCard()) {
+                qemuCommand << this->networkCards.at(i)->netdev(netdevId).append(this->hostForwards());
+            } else {
+                qemuCommand << this->networkCards.at(i)->netdev(netdevId);
+            }
+
+            qemuCommand << "-device";
+            if (microvm) {
+                qemuCommand << this->networkCards.at(i)->device(netdevId, "virtio-net-device");
+            } else {
+                qemuCommand << this->networkCards.at(i)->device(netdevId, "virtio-net-pci").append(",romfile=");
+            }
+        }
+    }
+
+    // Disks, the cdroms are not attached
+    int disk = 0;
+    for (int i = 0; i < media.size(); ++i) {
+        if (media.at(i)->type() != "hdd") {
+            continue;
+        }
+
+        QString drive = QString("file=%1,if=none,id=disk%2").arg(media.at(i)->path()).arg(disk);
+        if (!media.at(i)->format().isEmpty()) {
+            drive.append(",format=").append(media.at(i)->format());
+        }
+        if (!media.at(i)->cache().isEmpty()) {
+            drive.append(",cache=").append(media.at(i)->cache());
+        }
+        if (!media.at(i)->IO().isEmpty()) {
+            drive.append(",aio=").append(media.at(i)->IO());
+        }
+        drive.append(this->driveThrottling(media.at(i)));
+
+        qemuCommand << "-drive";
+        qemuCommand << drive;
+
+        qemuCommand << "-device";
+        qemuCommand << QString("virtio-blk-%1,drive=disk%2").arg(virtioBus).arg(disk);
+
+        ++disk;
+    }
+
+    qDebug() << "Command " << qemuCommand;
+
+    return qemuCommand;
+}
+
 /**
  * @brief Show a message when cannot connect to the machine
  *
@@ -1086,6 +2795,8 @@ bool Machine::saveMachine()
     machineJSONObject["type"]        = this->type;
     machineJSONObject["description"] = this->description;
     machineJSONObject["RAM"]         = this->RAM;
+    machineJSONObject["hugePages"]   = this->hugePages;
+    machineJSONObject["memMerge"]    = this->memMerge;
     machineJSONObject["network"]     = this->useNetwork;
     machineJSONObject["path"]        = this->path;
     machineJSONObject["uuid"]        = this->uuid;
@@ -1115,16 +2826,52 @@ bool Machine::saveMachine()
         disk["interface"] = this->media.at(i)->driveInterface();
         disk["uuid"] = QUuid::createUuid().toString();
 
+        if (this->media.at(i)->isThrottled()) {
+            QJsonObject throttle;
+            QStringList throttleKeys = Media::throttleKeys();
+            for (int j = 0; j < throttleKeys.size(); ++j) {
+                if (this->media.at(i)->throttle(throttleKeys.at(j)) > 0) {
+                    throttle[throttleKeys.at(j)] = this->media.at(i)->throttle(throttleKeys.at(j));
+                }
+            }
+            if (!this->media.at(i)->throttleGroup().isEmpty()) {
+                throttle["group"] = this->media.at(i)->throttleGroup();
+            }
+            disk["throttle"] = throttle;
+        }
+
         media.append(disk);
     }
 
     machineJSONObject["media"] = media;
 
+    QJsonArray networkCards;
+    for (int i = 0; i < this->networkCards.size(); ++i) {
+        QJsonObject card;
+        card["backend"]       = this->networkCards.at(i)->backend();
+        card["model"]         = this->networkCards.at(i)->model();
+        card["queues"]        = this->networkCards.at(i)->queues();
+        card["MAC"]           = this->networkCards.at(i)->MACAddress();
+        card["vhost"]         = this->networkCards.at(i)->vhost();
+        card["ifname"]        = this->networkCards.at(i)->ifname();
+        card["bridge"]        = this->networkCards.at(i)->bridge();
+        card["socketMode"]    = this->networkCards.at(i)->socketMode();
+        card["socketAddress"] = this->networkCards.at(i)->socketAddress();
+        card["localNetwork"]  = this->networkCards.at(i)->localNetwork();
+        card["uuid"]          = this->networkCards.at(i)->uuid().toString();
+
+        networkCards.append(card);
+    }
+
+    machineJSONObject["networkCards"] = networkCards;
+    machineJSONObject["portForwards"] = QJsonArray::fromStringList(this->portForwards);
+
     QJsonObject kernelBoot;
     kernelBoot["enabled"] = this->boot->kernelBootEnabled();
     kernelBoot["kernelPath"] = this->boot->kernelPath();
     kernelBoot["initrdPath"] = this->boot->initrdPath();
     kernelBoot["kernelArgs"] = this->boot->kernelArgs();
+    kernelBoot["fastBoot"] = this->boot->fastBoot();
 
     QJsonObject boot;
     boot["bootMenu"] = this->boot->bootMenu();
@@ -1133,14 +2880,51 @@ bool Machine::saveMachine()
 
     machineJSONObject["boot"] = boot;
 
+    QJsonObject serial;
+    serial["capture"] = this->serialCapture;
+    serial["logSize"] = this->serialLogSize;
+    machineJSONObject["serial"] = serial;
+
+    QJsonObject readiness;
+    readiness["mode"]    = this->bootReadinessMode;
+    readiness["pattern"] = this->bootReadinessPattern;
+    readiness["port"]    = this->bootReadinessPort;
+    machineJSONObject["readiness"] = readiness;
+
+    machineJSONObject["restart"] = this->restartPolicy;
+
+    QJsonObject poolObject;
+    poolObject["enabled"]  = this->pooled;
+    poolObject["template"] = this->poolTemplate;
+    machineJSONObject["pool"] = poolObject;
+
+    QJsonObject balloonObject;
+    balloonObject["enabled"] = this->balloon;
+    balloonObject["minimum"] = this->balloonMinimum;
+    balloonObject["maximum"] = this->balloonMaximum;
+    machineJSONObject["balloon"] = balloonObject;
+
+    QJsonObject cgroupObject;
+    cgroupObject["enabled"]    = this->cgroup;
+    cgroupObject["cpuMax"]     = this->CPUMax;
+    cgroupObject["cpuWeight"]  = this->CPUWeight;
+    cgroupObject["memoryMax"]  = this->memoryMax;
+    cgroupObject["memoryHigh"] = this->memoryHigh;
+    cgroupObject["ioMax"]      = QJsonArray::fromStringList(this->IOMax);
+    machineJSONObject["cgroup"] = cgroupObject;
+
     machineJSONObject["accelerator"] = QJsonArray::fromStringList(this->accelerator);
     machineJSONObject["audio"] = QJsonArray::fromStringList(this->audio);
 
     QJsonDocument machineJSONDocument(machineJSONObject);
 
-    machineFile.write(machineJSONDocument.toJson());
+    QByteArray machineData = machineJSONDocument.toJson();
+    machineFile.write(machineData);
     machineFile.flush();
 
+    // The watcher ignores the files saved by QtEmu
+    this->m_configHash = QCryptographicHash::hash(machineData, QCryptographicHash::Sha1);
+
     if (machineFile.isOpen()) {
         machineFile.close();
     }
@@ -30,13 +30,26 @@
 #include <QMessageBox>
 #include <QSettings>
 #include <QTextCodec>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
 #include <QDebug>
 
 // Local
 #include "qemu.h"
 #include "boot.h"
 #include "media.h"
+#include "networkcard.h"
 #include "machineutils.h"
+#include "utils/logger.h"
+#include "serialconsole.h"
+#include "qmpclient.h"
+#include "utils/eventtimeline.h"
+#include "bootmonitor.h"
+#include "utils/boothistory.h"
+#include "machinesupervisor.h"
+#include "admissioncontroller.h"
+#include "machinecgroup.h"
+#include "hostportregistry.h"
 
 class Machine: public QObject {
     Q_OBJECT
@@ -103,6 +116,39 @@ class Machine: public QObject {
         qlonglong getRAM() const;
         void setRAM(const qlonglong &value);
 
+        bool getHugePages() const;
+        void setHugePages(bool value);
+
+        bool getMemMerge() const;
+        void setMemMerge(bool value);
+
+        bool getBalloon() const;
+        void setBalloon(bool value);
+
+        qlonglong getBalloonMinimum() const;
+        void setBalloonMinimum(const qlonglong &value);
+
+        qlonglong getBalloonMaximum() const;
+        void setBalloonMaximum(const qlonglong &value);
+
+        bool getCGroup() const;
+        void setCGroup(bool value);
+
+        int getCPUMax() const;
+        void setCPUMax(int value);
+
+        int getCPUWeight() const;
+        void setCPUWeight(int value);
+
+        qlonglong getMemoryMax() const;
+        void setMemoryMax(const qlonglong &value);
+
+        qlonglong getMemoryHigh() const;
+        void setMemoryHigh(const qlonglong &value);
+
+        QStringList getIOMax() const;
+        void setIOMax(const QStringList &value);
+
         QStringList getAudio() const;
         void setAudio(const QStringList &value);
 
@@ -112,6 +158,12 @@ class Machine: public QObject {
         bool getUseNetwork() const;
         void setUseNetwork(bool value);
 
+        QList<NetworkCard *> getNetworkCards() const;
+        void addNetworkCard(NetworkCard *networkCard);
+
+        QStringList getPortForwards() const;
+        void setPortForwards(const QStringList &value);
+
         QList<Media *> getMedia() const;
         void addMedia(Media *media);
 
@@ -121,6 +173,50 @@ class Machine: public QObject {
         Boot *getBoot() const;
         void setBoot(Boot *value);
 
+        bool getSerialCapture() const;
+        void setSerialCapture(bool value);
+
+        int getSerialLogSize() const;
+        void setSerialLogSize(int value);
+
+        QString getBootReadinessMode() const;
+        void setBootReadinessMode(const QString &value);
+
+        QString getBootReadinessPattern() const;
+        void setBootReadinessPattern(const QString &value);
+
+        int getBootReadinessPort() const;
+        void setBootReadinessPort(int value);
+
+        QString getRestartPolicy() const;
+        void setRestartPolicy(const QString &value);
+
+        bool getPooled() const;
+        void setPooled(bool value);
+
+        QString getPoolTemplate() const;
+        void setPoolTemplate(const QString &value);
+
+        bool isPrewarmed() const;
+
+        SerialConsole *getSerialConsole() const;
+        QMPClient *getQMPClient() const;
+        QString getDisplayServerName() const;
+        bool hasEmbeddedDisplay() const;
+        EventTimeline *getEventTimeline() const;
+
+        qint64 getProcessId() const;
+        qint64 getUptime() const;
+        qint64 getLaunchLatency() const;
+        qint64 getLastBootTime() const;
+
+        BootHistory *getBootHistory();
+        MachineSupervisor *getSupervisor();
+        QJsonObject getBootConfig() const;
+
+        QByteArray getConfigHash() const;
+        void setConfigHash(const QByteArray &value);
+
         // Methods
         void addAudio(const QString audio);
         void removeAudio(const QString audio);
@@ -131,19 +227,32 @@ class Machine: public QObject {
         void removeAllAccelerators();
 
         void removeAllMedia();
+        void removeAllNetworkCards();
 
         QString getAudioLabel();
         QString getAcceleratorLabel();
 
-        void runMachine(QEMU *QEMUGlobalObject);
+        bool runMachine(QEMU *QEMUGlobalObject);
+        bool prewarmMachine(QEMU *QEMUGlobalObject);
+        void discardPrewarm();
+        bool applyResourceLimits();
+        bool applyIOThrottle(Media *media);
+        bool addPortForward(const QString &rule, QString *error);
+        bool removePortForward(const QString &rule);
+        bool launchDetached(const QString &program, bool headless, qint64 *pid = nullptr);
         void stopMachine();
         void resetMachine();
         void pauseMachine();
         bool saveMachine();
         void insertMachineConfigFile();
+        QStringList generateMachineCommand();
+        bool isFastBoot() const;
 
     signals:
         void machineStateChangedSignal(States newState);
+        void machineEventSignal(const QString &event, const QJsonObject &data);
+        void machineBootedSignal(qint64 bootTime);
+        void prewarmFinishedSignal(bool discarded);
 
     public slots:
 
@@ -152,6 +261,12 @@ class Machine: public QObject {
         void readMachineErrorOut();
         void machineStarted();
         void machineFinished(int exitCode, QProcess::ExitStatus exitStatus);
+        void machineEvent(const QString &event,
+                          const QJsonObject &data,
+                          const QJsonObject &timestamp);
+        void guestReady(qint64 bootTime);
+        void restartMachine();
+        void crashLoop(int crashes);
 
     protected:
 
@@ -181,6 +296,22 @@ class Machine: public QObject {
 
         // Hardware - RAM
         qlonglong RAM;
+        bool hugePages;
+        bool memMerge;
+
+        // Hardware - Memory balloon
+        bool balloon;
+        qlonglong balloonMinimum;
+        qlonglong balloonMaximum;
+
+        // Resource limits
+        bool cgroup;
+        int CPUMax;
+        int CPUWeight;
+        qlonglong memoryMax;
+        qlonglong memoryHigh;
+        QStringList IOMax;
+        MachineCGroup *m_cgroup;
 
         // Hardware - Audio
         QStringList audio;
@@ -188,6 +319,8 @@ class Machine: public QObject {
 
         // Hardware - Network
         bool useNetwork;
+        QList<NetworkCard *> networkCards;
+        QStringList portForwards;
 
         // Hardware - media
         QList<Media *> media;
@@ -198,9 +331,41 @@ class Machine: public QObject {
         // Boot
         Boot *boot;
 
+        // Serial console
+        bool serialCapture;
+        int serialLogSize;
+        SerialConsole *m_serialConsole;
+
+        // Boot readiness
+        QString bootReadinessMode;
+        QString bootReadinessPattern;
+        int bootReadinessPort;
+        BootMonitor *m_bootMonitor;
+        BootHistory *m_bootHistory;
+        qint64 m_lastBootTime;
+
+        // Supervisor
+        QString restartPolicy;
+        MachineSupervisor *m_supervisor;
+        QEMU *m_QEMUGlobalObject;
+
+        // Pool
+        bool pooled;
+        QString poolTemplate;
+        bool m_prewarmed;
+        bool m_prewarmDiscarded;
+        QByteArray m_configHash;
+
         // Process
         QProcess *m_machineProcess;
         QTcpSocket *m_machineTcpSocket;
+        QElapsedTimer m_launchTimer;
+        QElapsedTimer m_startedTimer;
+        qint64 m_launchLatency;
+
+        // QMP
+        QMPClient *m_qmpClient;
+        EventTimeline *m_eventTimeline;
 
         // Messages
         QMessageBox *m_saveMachineMessageBox;
@@ -212,7 +377,14 @@ class Machine: public QObject {
 
         // Methods
         QProcessEnvironment buildEnvironment();
-        QStringList generateMachineCommand();
+        QStringList generateFastBootCommand();
+        bool launchMachine(QEMU *QEMUGlobalObject, bool paused);
+        bool resumePrewarmed();
+        MachineCGroup::Limits resourceLimits() const;
+        QString driveId(const Media *media) const;
+        QString driveThrottling(const Media *media) const;
+        int portForwardCard() const;
+        QString hostForwards() const;
         void failConnectMachine();
 };
 #endif // MACHINE_H
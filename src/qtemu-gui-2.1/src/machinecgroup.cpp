@@ -0,0 +1,401 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "machinecgroup.h"
+
+// UNIX
+#ifdef Q_OS_LINUX
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#endif
+
+// Period in us of cpu.max, the quota is a percent of one CPU in this period
+static const qint64 CPU_PERIOD = 100000;
+
+static const qint64 MIB = 1024 * 1024;
+
+/**
+ * @brief cgroup of a machine
+ * @param machineUuid, uuid of the machine
+ * @param parent, parent object
+ *
+ * Places the QEMU process of a machine in its own cgroup v2 and
+ * sets the CPU, memory and IO limits of the machine, also while
+ * the machine is running. The cgroup is a transient scope created
+ * with systemd-run --user --scope, or a folder created by QtEmu
+ * in a delegated subtree. The CGroups settings group has:
+ * mode: systemd or delegated
+ * mountPoint: cgroup2 mount point, the cgroups of the scopes are read from it
+ * delegatedRoot: folder where the cgroups are created in delegated mode,
+ * any folder can be used to test without a real cgroupfs
+ */
+MachineCGroup::MachineCGroup(const QString &machineUuid,
+                             QObject *parent) : QObject(parent)
+{
+    QString uuid(machineUuid);
+    uuid.remove("{").remove("}");
+
+    this->m_unitName = "qtemu-" + uuid;
+    this->m_attached = false;
+
+    this->m_limits.CPUMax = 0;
+    this->m_limits.CPUWeight = 100;
+    this->m_limits.memoryMax = 0;
+    this->m_limits.memoryHigh = 0;
+
+    QSettings settings;
+    settings.beginGroup("CGroups");
+    this->m_mode = settings.value("mode", "systemd").toString() == "delegated" ?
+                   MachineCGroup::Delegated : MachineCGroup::Systemd;
+    this->m_mountPoint = settings.value("mountPoint", "/sys/fs/cgroup").toString();
+    this->m_delegatedRoot = settings.value("delegatedRoot", "").toString();
+    settings.endGroup();
+
+    qDebug() << "MachineCGroup object created";
+}
+
+MachineCGroup::~MachineCGroup()
+{
+    qDebug() << "MachineCGroup object destroyed";
+}
+
+/**
+ * @brief Get the mode of the cgroup
+ * @return systemd scope or delegated folder
+ *
+ * Get the mode of the cgroup
+ */
+MachineCGroup::Mode MachineCGroup::mode() const
+{
+    return this->m_mode;
+}
+
+/**
+ * @brief Get the name of the cgroup
+ * @return qtemu-<uuid>, name of the scope or the folder
+ *
+ * Get the name of the cgroup
+ */
+QString MachineCGroup::unitName() const
+{
+    return this->m_unitName;
+}
+
+/**
+ * @brief Get the folder of the cgroup
+ * @return path of the cgroup, empty if the machine isn't attached
+ *
+ * Get the folder of the cgroup in the cgroupfs
+ */
+QString MachineCGroup::cgroupPath() const
+{
+    return this->m_cgroupPath;
+}
+
+/**
+ * @brief Set the limits of the machine
+ * @param limits, limits of the machine
+ *
+ * Set the limits, they are written with apply
+ */
+void MachineCGroup::setLimits(const Limits &limits)
+{
+    this->m_limits = limits;
+}
+
+/**
+ * @brief Wrap the QEMU command
+ * @param program, QEMU binary, replaced by systemd-run
+ * @param arguments, QEMU arguments, prefixed by the systemd-run arguments
+ *
+ * In systemd mode QEMU is launched by systemd-run inside a new scope
+ * with the limits of the machine. systemd-run executes QEMU in the
+ * same process, the pid of the process is still QEMU
+ */
+void MachineCGroup::wrapCommand(QString &program, QStringList &arguments) const
+{
+#ifdef Q_OS_LINUX
+    if (this->m_mode != MachineCGroup::Systemd) {
+        return;
+    }
+
+    QStringList systemdArguments;
+    systemdArguments << "--user" << "--scope" << "--collect" << "--quiet"
+                     << "--unit=" + this->m_unitName;
+    foreach (const QString &property, this->systemdProperties()) {
+        systemdArguments << "-p" << property;
+    }
+    systemdArguments << "--" << program;
+
+    arguments = systemdArguments + arguments;
+    program = "systemd-run";
+#else
+    Q_UNUSED(program);
+    Q_UNUSED(arguments);
+#endif
+}
+
+/**
+ * @brief Attach the QEMU process to the cgroup
+ * @param pid, process id of QEMU
+ * @return true if the process is in the cgroup
+ *
+ * In delegated mode the cgroup folder is created, the controllers
+ * are enabled in the root, the limits are written and the process
+ * is moved. In systemd mode the cgroup of the scope is found
+ */
+bool MachineCGroup::attach(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    if (this->m_mode == MachineCGroup::Systemd) {
+        QFile cgroupFile(QString("/proc/%1/cgroup").arg(pid));
+        if (cgroupFile.open(QFile::ReadOnly)) {
+            // cgroup v2 has only the line 0::/path
+            foreach (const QByteArray &line, cgroupFile.readAll().split('\n')) {
+                if (line.startsWith("0::")) {
+                    this->m_cgroupPath = QDir(this->m_mountPoint).filePath(QString::fromUtf8(line.mid(4)));
+                }
+            }
+        }
+        this->m_attached = true;
+
+        return true;
+    }
+
+    if (this->m_delegatedRoot.isEmpty()) {
+        qDebug() << "No delegated cgroup root configured";
+        return false;
+    }
+
+    QDir rootDirectory(this->m_delegatedRoot);
+    this->m_cgroupPath = rootDirectory.filePath(this->m_unitName);
+    if (!rootDirectory.mkpath(this->m_unitName)) {
+        qDebug() << "Cannot create the cgroup" << this->m_cgroupPath;
+        return false;
+    }
+
+    // The controllers may be enabled already, or not delegated at all
+    QFile subtreeFile(rootDirectory.filePath("cgroup.subtree_control"));
+    if (subtreeFile.open(QFile::WriteOnly)) {
+        subtreeFile.write("+cpu +memory +io");
+        subtreeFile.close();
+    }
+
+    this->apply();
+
+    if (!this->writeFile("cgroup.procs", QString::number(pid))) {
+        qDebug() << "Cannot move the process" << pid << "to the cgroup" << this->m_cgroupPath;
+        return false;
+    }
+    this->m_attached = true;
+
+    return true;
+#else
+    Q_UNUSED(pid);
+    return false;
+#endif
+}
+
+/**
+ * @brief Apply the limits
+ * @return true if all the limits are written
+ *
+ * Write the limits in the cgroup of the running machine.
+ * In systemd mode the properties of the scope are changed
+ * with systemctl, only for this run of the scope
+ */
+bool MachineCGroup::apply()
+{
+#ifdef Q_OS_LINUX
+    if (this->m_mode == MachineCGroup::Systemd) {
+        if (!this->m_attached) {
+            return false;
+        }
+
+        QStringList arguments;
+        arguments << "--user" << "set-property" << "--runtime"
+                  << this->m_unitName + ".scope"
+                  << this->systemdProperties();
+
+        return QProcess::execute("systemctl", arguments) == 0;
+    }
+
+    if (this->m_cgroupPath.isEmpty()) {
+        return false;
+    }
+
+    bool applied = true;
+
+    if (this->m_limits.CPUMax > 0) {
+        applied &= this->writeFile("cpu.max", QString("%1 %2")
+                                   .arg(this->m_limits.CPUMax * CPU_PERIOD / 100)
+                                   .arg(CPU_PERIOD));
+    } else {
+        applied &= this->writeFile("cpu.max", QString("max %1").arg(CPU_PERIOD));
+    }
+
+    applied &= this->writeFile("cpu.weight", QString::number(qBound(1, this->m_limits.CPUWeight, 10000)));
+
+    applied &= this->writeFile("memory.max", this->m_limits.memoryMax > 0 ?
+                                             QString::number(this->m_limits.memoryMax * MIB) : "max");
+    applied &= this->writeFile("memory.high", this->m_limits.memoryHigh > 0 ?
+                                              QString::number(this->m_limits.memoryHigh * MIB) : "max");
+
+    // io.max only changes the written devices, the removed ones are reset
+    QStringList IOLines;
+    QStringList IODevices;
+    foreach (const QString &limit, this->m_limits.IOMax) {
+        QStringList fields = limit.simplified().split(" ");
+        QString device = this->IODevice(fields.takeFirst());
+        if (device.isEmpty() || fields.isEmpty()) {
+            qDebug() << "Invalid IO limit" << limit;
+            applied = false;
+            continue;
+        }
+
+        IODevices.append(device);
+        IOLines.append(device + " " + fields.join(" "));
+    }
+
+    foreach (const QString &device, this->m_IODevices) {
+        if (!IODevices.contains(device)) {
+            IOLines.append(device + " rbps=max wbps=max riops=max wiops=max");
+        }
+    }
+    this->m_IODevices = IODevices;
+
+    foreach (const QString &line, IOLines) {
+        applied &= this->writeFile("io.max", line, true);
+    }
+
+    return applied;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Detach the finished machine
+ *
+ * Remove the cgroup folder created in delegated mode,
+ * systemd collects the scope by itself
+ */
+void MachineCGroup::detach()
+{
+    if (this->m_mode == MachineCGroup::Delegated && !this->m_cgroupPath.isEmpty()) {
+        if (!QDir().rmdir(this->m_cgroupPath)) {
+            // A fake cgroupfs has regular files inside the folder
+            QDir(this->m_cgroupPath).removeRecursively();
+        }
+    }
+
+    this->m_cgroupPath.clear();
+    this->m_IODevices.clear();
+    this->m_attached = false;
+}
+
+/**
+ * @brief Get the properties of the scope
+ * @return properties for systemd-run and systemctl set-property
+ *
+ * Translate the limits to the resource control properties of systemd
+ */
+QStringList MachineCGroup::systemdProperties() const
+{
+    QStringList properties;
+
+    properties << (this->m_limits.CPUMax > 0 ?
+                   QString("CPUQuota=%1%").arg(this->m_limits.CPUMax) : QString("CPUQuota="));
+    properties << QString("CPUWeight=%1").arg(qBound(1, this->m_limits.CPUWeight, 10000));
+    properties << (this->m_limits.memoryMax > 0 ?
+                   QString("MemoryMax=%1M").arg(this->m_limits.memoryMax) : QString("MemoryMax=infinity"));
+    properties << (this->m_limits.memoryHigh > 0 ?
+                   QString("MemoryHigh=%1M").arg(this->m_limits.memoryHigh) : QString("MemoryHigh=infinity"));
+
+    foreach (const QString &limit, this->m_limits.IOMax) {
+        QStringList fields = limit.simplified().split(" ");
+        QString device = fields.takeFirst();
+
+        foreach (const QString &field, fields) {
+            QString key = field.section("=", 0, 0);
+            QString value = field.section("=", 1);
+            if (key == "rbps") {
+                properties << QString("IOReadBandwidthMax=%1 %2").arg(device).arg(value);
+            } else if (key == "wbps") {
+                properties << QString("IOWriteBandwidthMax=%1 %2").arg(device).arg(value);
+            } else if (key == "riops") {
+                properties << QString("IOReadIOPSMax=%1 %2").arg(device).arg(value);
+            } else if (key == "wiops") {
+                properties << QString("IOWriteIOPSMax=%1 %2").arg(device).arg(value);
+            }
+        }
+    }
+
+    return properties;
+}
+
+/**
+ * @brief Get the device of an IO limit
+ * @param device, major:minor or path of a block device
+ * @return major:minor of the device, empty if it isn't a block device
+ *
+ * io.max needs the major and minor numbers of the device
+ */
+QString MachineCGroup::IODevice(const QString &device) const
+{
+    if (device.contains(":")) {
+        return device;
+    }
+
+#ifdef Q_OS_LINUX
+    struct stat deviceStat;
+    if (stat(QFile::encodeName(device).constData(), &deviceStat) == 0 && S_ISBLK(deviceStat.st_mode)) {
+        return QString("%1:%2").arg(major(deviceStat.st_rdev)).arg(minor(deviceStat.st_rdev));
+    }
+#endif
+
+    return QString();
+}
+
+/**
+ * @brief Write a file of the cgroup
+ * @param fileName, name of the interface file
+ * @param value, value to be written
+ * @param append, true for the files with one line per write, like io.max
+ * @return true if the value is written
+ *
+ * Write a file of the cgroup, a missing controller fails the write
+ */
+bool MachineCGroup::writeFile(const QString &fileName, const QString &value, bool append) const
+{
+    QIODevice::OpenMode openMode = QFile::WriteOnly;
+    if (append) {
+        openMode |= QFile::Append;
+    }
+
+    QFile cgroupFile(QDir(this->m_cgroupPath).filePath(fileName));
+    if (!cgroupFile.open(openMode)) {
+        qDebug() << "Cannot write" << cgroupFile.fileName() << cgroupFile.errorString();
+        return false;
+    }
+
+    return cgroupFile.write(value.toUtf8() + (append ? "\n" : "")) != -1;
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MACHINECGROUP_H
+#define MACHINECGROUP_H
+
+// Qt
+#include <QObject>
+#include <QSettings>
+#include <QProcess>
+#include <QFile>
+#include <QDir>
+#include <QStringList>
+
+#include <QDebug>
+
+class MachineCGroup : public QObject {
+    Q_OBJECT
+
+    public:
+        enum Mode {
+            Systemd, Delegated
+        };
+
+        struct Limits {
+            int CPUMax;
+            int CPUWeight;
+            qint64 memoryMax;
+            qint64 memoryHigh;
+            QStringList IOMax;
+        };
+
+        explicit MachineCGroup(const QString &machineUuid,
+                               QObject *parent = nullptr);
+        ~MachineCGroup();
+
+        Mode mode() const;
+        QString unitName() const;
+        QString cgroupPath() const;
+
+        void setLimits(const Limits &limits);
+        void wrapCommand(QString &program, QStringList &arguments) const;
+
+        bool attach(qint64 pid);
+        bool apply();
+        void detach();
+
+    signals:
+
+    public slots:
+
+    private slots:
+
+    protected:
+
+    private:
+        QString m_unitName;
+        QString m_cgroupPath;
+        QStringList m_IODevices;
+        Limits m_limits;
+        bool m_attached;
+
+        // Settings
+        Mode m_mode;
+        QString m_mountPoint;
+        QString m_delegatedRoot;
+
+        // Methods
+        QStringList systemdProperties() const;
+        QString IODevice(const QString &device) const;
+        bool writeFile(const QString &fileName, const QString &value, bool append = false) const;
+};
+
+#endif // MACHINECGROUP_H
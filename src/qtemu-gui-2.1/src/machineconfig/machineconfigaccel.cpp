@@ -25,12 +25,14 @@
 /**
  * @brief Accelerator configuration window
  * @param machine, machine to be configured
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param parent, parent widget
  *
  * In this window the user can select what accelerators want to use and
  * it's order
  */
 MachineConfigAccel::MachineConfigAccel(Machine *machine,
+                                       QEMU *QEMUGlobalObject,
                                        QWidget *parent) : QWidget(parent)
 {
     bool enableFields = true;
@@ -55,7 +57,7 @@ MachineConfigAccel::MachineConfigAccel(Machine *machine,
 
     QStringList accelList = machine->getAccelerator();
 
-    QHash<QString, QString> accelHash = SystemUtils::getAccelerators();
+    QHash<QString, QString> accelHash = SystemUtils::getAccelerators(QEMUGlobalObject);
     QHashIterator<QString, QString> i(accelHash);
     while (i.hasNext()) {
         i.next();
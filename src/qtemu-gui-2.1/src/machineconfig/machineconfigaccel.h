@@ -37,6 +37,7 @@ class MachineConfigAccel : public QWidget {
 
     public:
         explicit MachineConfigAccel(Machine *machine,
+                                    QEMU *QEMUGlobalObject,
                                     QWidget *parent = nullptr);
         ~MachineConfigAccel();
         QWidget *m_acceleratorPageWidget;
@@ -25,12 +25,14 @@
 /**
  * @brief Audio configuration window
  * @param machine, machine to be configured
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param parent, parent widget
  *
  * In this window the user can select what audio cards want to use and
  * it's order
  */
 MachineConfigAudio::MachineConfigAudio(Machine *machine,
+                                       QEMU *QEMUGlobalObject,
                                        QWidget *parent) : QWidget(parent)
 {
     bool enableFields = true;
@@ -55,7 +57,7 @@ MachineConfigAudio::MachineConfigAudio(Machine *machine,
 
     QStringList audioList = machine->getAudio();
 
-    QHash<QString, QString> audioHash = SystemUtils::getSoundCards();
+    QHash<QString, QString> audioHash = SystemUtils::getSoundCards(QEMUGlobalObject);
     QHashIterator<QString, QString> i(audioHash);
     while (i.hasNext()) {
         i.next();
@@ -39,6 +39,7 @@ class MachineConfigAudio : public QWidget {
 
     public:
         explicit MachineConfigAudio(Machine *machine,
+                                    QEMU *QEMUGlobalObject,
                                     QWidget *parent = nullptr);
         ~MachineConfigAudio();
         QWidget *m_audioPageWidget;
@@ -110,6 +110,11 @@ MachineConfigBoot::MachineConfigBoot(Machine *machine,
     m_kernelArgsLineEdit->setEnabled(enableFields);
     m_kernelArgsLineEdit->setText(this->m_machine->getBoot()->kernelArgs());
 
+    m_fastBootCheckBox = new QCheckBox(this);
+    m_fastBootCheckBox->setEnabled(enableFields);
+    m_fastBootCheckBox->setText(tr("Fast boot (microvm with only virtio devices, no firmware)"));
+    m_fastBootCheckBox->setChecked(this->m_machine->getBoot()->fastBoot());
+
     m_kernelPathPushButton = new QPushButton(this);
     m_kernelPathPushButton->setEnabled(enableFields);
     m_kernelPathPushButton->setIcon(QIcon::fromTheme("folder-symbolic",
@@ -141,6 +146,7 @@ MachineConfigBoot::MachineConfigBoot(Machine *machine,
     m_kernelLayout->addWidget(m_initrdPushButton,     1, 2, 1, 1);
     m_kernelLayout->addWidget(m_kernelArgsLabel,      2, 0, 1, 1);
     m_kernelLayout->addWidget(m_kernelArgsLineEdit,   2, 1, 1, 1);
+    m_kernelLayout->addWidget(m_fastBootCheckBox,     3, 0, 1, 3);
 
     m_bootPageLayout = new QVBoxLayout();
     m_bootPageLayout->setAlignment(Qt::AlignTop);
@@ -209,6 +215,7 @@ void MachineConfigBoot::selectEnableKernelBoot(bool enableKernelBoot)
     this->m_kernelArgsLineEdit->setEnabled(enableKernelBoot);
     this->m_kernelPathPushButton->setEnabled(enableKernelBoot);
     this->m_initrdPushButton->setEnabled(enableKernelBoot);
+    this->m_fastBootCheckBox->setEnabled(enableKernelBoot);
 }
 
 /**
@@ -253,6 +260,7 @@ void MachineConfigBoot::saveBootData()
     boot->setKernelPath(this->m_kernelPathLineEdit->text());
     boot->setInitrdPath(this->m_initredLineEdit->text());
     boot->setKernelArgs(this->m_kernelArgsLineEdit->text());
+    boot->setFastBoot(this->m_fastBootCheckBox->isChecked());
 
     QTreeWidgetItemIterator it(this->m_bootTree);
     while (*it) {
@@ -67,6 +67,7 @@ class MachineConfigBoot : public QWidget {
 
         QCheckBox *m_bootMenuCheckBox;
         QCheckBox *m_kernelBootCheckBox;
+        QCheckBox *m_fastBootCheckBox;
 
         QToolButton *m_moveUpToolButton;
         QToolButton *m_moveDownToolButton;
@@ -77,5 +77,7 @@ void MachineConfigGeneral::saveGeneralData()
     this->m_machine->setName(this->m_basicTab->getMachineName());
     this->m_machine->setOSType(this->m_basicTab->getMachineType());
     this->m_machine->setOSVersion(this->m_basicTab->getMachineVersion());
+    this->m_machine->setRestartPolicy(this->m_basicTab->getRestartPolicy());
+    this->m_machine->setPooled(this->m_basicTab->getPooled());
     this->m_machine->setDescription(this->m_descriptionTab->getMachineDescription());
 }
@@ -67,6 +67,20 @@ BasicTab::BasicTab(Machine *machine,
     m_machineStatusLabel = new QLabel(this);
     m_machineStatusLabel->setText(BasicTab::getStatusLabel(machine->getState()));
 
+    m_restartPolicy = new QComboBox(this);
+    m_restartPolicy->addItem(tr("Never"), "never");
+    m_restartPolicy->addItem(tr("When QEMU fails"), "on-failure");
+    m_restartPolicy->addItem(tr("Always, unless stopped from QtEmu"), "always");
+    int restartPolicyIndex = m_restartPolicy->findData(machine->getRestartPolicy());
+    m_restartPolicy->setCurrentIndex(restartPolicyIndex != -1 ? restartPolicyIndex : 0);
+
+    m_crashCountLabel = new QLabel(this);
+    m_crashCountLabel->setText(QString::number(machine->getSupervisor()->crashCount()));
+
+    m_pooledCheckBox = new QCheckBox(this);
+    m_pooledCheckBox->setText(tr("Keep launched and paused for an instant start"));
+    m_pooledCheckBox->setChecked(machine->getPooled());
+
     m_basicTabFormLayout = new QFormLayout();
     m_basicTabFormLayout->setAlignment(Qt::AlignTop);
     m_basicTabFormLayout->setLabelAlignment(Qt::AlignLeft);
@@ -77,6 +91,9 @@ BasicTab::BasicTab(Machine *machine,
     m_basicTabFormLayout->addRow(tr("Version") + ":", m_OSVersion);
     m_basicTabFormLayout->addRow(tr("UUID") + ":", m_machineUuidLabel);
     m_basicTabFormLayout->addRow(tr("Status") + ":", m_machineStatusLabel);
+    m_basicTabFormLayout->addRow(tr("Restart") + ":", m_restartPolicy);
+    m_basicTabFormLayout->addRow(tr("Crashes") + ":", m_crashCountLabel);
+    m_basicTabFormLayout->addRow(tr("Pool") + ":", m_pooledCheckBox);
 
     m_basicTabLayout = new QVBoxLayout();
     m_basicTabLayout->addItem(m_basicTabFormLayout);
@@ -200,6 +217,28 @@ QString BasicTab::getMachineVersion() const
     return this->m_OSVersion->currentText();
 }
 
+/**
+ * @brief Get the restart policy
+ * @return never, on-failure or always
+ *
+ * Get the restart policy
+ */
+QString BasicTab::getRestartPolicy() const
+{
+    return this->m_restartPolicy->currentData().toString();
+}
+
+/**
+ * @brief Get if the machine is pooled
+ * @return true if the machine is kept launched and paused
+ *
+ * Get if the machine is pooled
+ */
+bool BasicTab::getPooled() const
+{
+    return this->m_pooledCheckBox->isChecked();
+}
+
 /**
  * @brief Tab with the descripcion
  * @param machine, machine to be configured
@@ -29,6 +29,7 @@
 #include <QPlainTextEdit>
 #include <QComboBox>
 #include <QLineEdit>
+#include <QCheckBox>
 
 // Local
 #include "../machine.h"
@@ -45,6 +46,8 @@ class BasicTab: public QWidget {
         QString getMachineName() const;
         QString getMachineType() const;
         QString getMachineVersion() const;
+        QString getRestartPolicy() const;
+        bool getPooled() const;
 
     signals:
 
@@ -68,6 +71,11 @@ class BasicTab: public QWidget {
         QLabel *m_machineUuidLabel;
         QLabel *m_machineStatusLabel;
 
+        QComboBox *m_restartPolicy;
+        QLabel *m_crashCountLabel;
+
+        QCheckBox *m_pooledCheckBox;
+
         Machine *m_machineConfig;
 };
 
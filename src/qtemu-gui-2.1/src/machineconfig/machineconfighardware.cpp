@@ -25,11 +25,13 @@
 /**
  * @brief Hardware configuration window
  * @param machine, machine to be configured
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param parent, parent widget
  *
  * In this window the user can configure the hardware data
  */
 MachineConfigHardware::MachineConfigHardware(Machine *machine,
+                                             QEMU *QEMUGlobalObject,
                                              QWidget *parent) : QWidget(parent)
 {
     bool enableFields = true;
@@ -44,15 +46,17 @@ MachineConfigHardware::MachineConfigHardware(Machine *machine,
     m_hardwareTabWidget->setSizePolicy(QSizePolicy::MinimumExpanding,
                                        QSizePolicy::MinimumExpanding);
 
-    m_processorConfigTab = new ProcessorConfigTab(machine, enableFields, this);
-    m_graphicsConfigTab = new GraphicsConfigTab(machine, enableFields, this);
+    m_processorConfigTab = new ProcessorConfigTab(machine, QEMUGlobalObject, enableFields, this);
+    m_graphicsConfigTab = new GraphicsConfigTab(machine, QEMUGlobalObject, enableFields, this);
     m_ramConfigTab = new RamConfigTab(machine, enableFields, this);
-    m_machineTypeTab = new MachineTypeTab(machine, enableFields, this);
+    m_machineTypeTab = new MachineTypeTab(machine, QEMUGlobalObject, enableFields, this);
+    m_resourceLimitsTab = new ResourceLimitsTab(machine, enableFields, this);
 
     m_hardwareTabWidget->addTab(this->m_processorConfigTab, tr("CPU"));
     m_hardwareTabWidget->addTab(this->m_graphicsConfigTab, tr("Graphics"));
     m_hardwareTabWidget->addTab(this->m_ramConfigTab, tr("RAM"));
     m_hardwareTabWidget->addTab(this->m_machineTypeTab, tr("Type"));
+    m_hardwareTabWidget->addTab(this->m_resourceLimitsTab, tr("Limits"));
 
     m_hardwarePageLayout = new QVBoxLayout();
     m_hardwarePageLayout->setAlignment(Qt::AlignCenter);
@@ -86,4 +90,15 @@ void MachineConfigHardware::saveHardwareData()
     this->m_machine->setGPUType(this->m_graphicsConfigTab->getGPUType());
     this->m_machine->setKeyboard(this->m_graphicsConfigTab->getKeyboardLayout());
     this->m_machine->setRAM(this->m_ramConfigTab->getAmountRam());
+    this->m_machine->setHugePages(this->m_ramConfigTab->getHugePages());
+    this->m_machine->setMemMerge(this->m_ramConfigTab->getMemMerge());
+    this->m_machine->setBalloon(this->m_ramConfigTab->getBalloon());
+    this->m_machine->setBalloonMinimum(this->m_ramConfigTab->getBalloonMinimum());
+    this->m_machine->setBalloonMaximum(this->m_ramConfigTab->getBalloonMaximum());
+    this->m_machine->setCGroup(this->m_resourceLimitsTab->getCGroup());
+    this->m_machine->setCPUMax(this->m_resourceLimitsTab->getCPUMax());
+    this->m_machine->setCPUWeight(this->m_resourceLimitsTab->getCPUWeight());
+    this->m_machine->setMemoryMax(this->m_resourceLimitsTab->getMemoryMax());
+    this->m_machine->setMemoryHigh(this->m_resourceLimitsTab->getMemoryHigh());
+    this->m_machine->setIOMax(this->m_resourceLimitsTab->getIOMax());
 }
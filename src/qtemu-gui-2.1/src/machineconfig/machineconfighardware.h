@@ -37,6 +37,7 @@ class MachineConfigHardware : public QWidget {
 
     public:
         explicit MachineConfigHardware(Machine *machine,
+                                       QEMU *QEMUGlobalObject,
                                        QWidget *parent = nullptr);
         ~MachineConfigHardware();
         QWidget *m_hardwarePageWidget;
@@ -59,6 +60,7 @@ class MachineConfigHardware : public QWidget {
         ProcessorConfigTab *m_processorConfigTab;
         GraphicsConfigTab *m_graphicsConfigTab;
         RamConfigTab *m_ramConfigTab;
+        ResourceLimitsTab *m_resourceLimitsTab;
         MachineTypeTab *m_machineTypeTab;
 
         Machine *m_machine;
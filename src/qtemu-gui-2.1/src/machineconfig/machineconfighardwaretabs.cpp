@@ -24,12 +24,14 @@
 /**
  * @brief Tab with informacion about the machine CPU options
  * @param machine, machine to be configured
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param enableFields, fields enabled or disabled
  * @param parent, parent widget
  *
  * Tab with informacion about the machine CPU options
  */
 ProcessorConfigTab::ProcessorConfigTab(Machine *machine,
+                                       QEMU *QEMUGlobalObject,
                                        bool enableFields,
                                        QWidget *parent) : QWidget(parent)
 {
@@ -38,7 +40,7 @@ ProcessorConfigTab::ProcessorConfigTab(Machine *machine,
 
     m_CPUType = new QComboBox(this);
     m_CPUType->setEnabled(enableFields);
-    SystemUtils::setCPUTypesx86(m_CPUType);
+    SystemUtils::setCPUTypesx86(m_CPUType, QEMUGlobalObject);
     int cpuTypeIndex = m_CPUType->findData(machine->getCPUType());
     if (cpuTypeIndex != -1) {
        m_CPUType->setCurrentIndex(cpuTypeIndex);
@@ -210,12 +212,14 @@ int ProcessorConfigTab::getMaxHotCPU()
 /**
  * @brief Tab with the GPU and keyboard
  * @param machine, machine to be configured
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param enableFields, fields enabled or disabled
  * @param parent, parent widget
  *
  * Tab with the GPU and keyboard
  */
 GraphicsConfigTab::GraphicsConfigTab(Machine *machine,
+                                     QEMU *QEMUGlobalObject,
                                      bool enableFields,
                                      QWidget *parent) : QWidget(parent)
 {
@@ -223,7 +227,7 @@ GraphicsConfigTab::GraphicsConfigTab(Machine *machine,
     m_GPUTypeLabel->setWordWrap(true);
     m_GPUType = new QComboBox(this);
     m_GPUType->setEnabled(enableFields);
-    SystemUtils::setGPUTypes(m_GPUType);
+    SystemUtils::setGPUTypes(m_GPUType, QEMUGlobalObject);
     int gpuIndex = m_GPUType->findData(machine->getGPUType());
     if (gpuIndex != -1) {
        m_GPUType->setCurrentIndex(gpuIndex);
@@ -328,6 +332,44 @@ RamConfigTab::RamConfigTab(Machine *machine,
     m_minMemoryLabel = new QLabel("1 MiB", this);
     m_maxMemorylabel = new QLabel(QString("%1 MiB").arg(totalRAM), this);
 
+    m_hugePagesCheckBox = new QCheckBox(tr("Allocate the memory from the huge pages of the host"), this);
+    m_hugePagesCheckBox->setChecked(machine->getHugePages());
+    m_hugePagesCheckBox->setEnabled(enableFields);
+#ifndef Q_OS_LINUX
+    m_hugePagesCheckBox->setEnabled(false);
+#endif
+
+    m_memMergeCheckBox = new QCheckBox(tr("Share the identical memory pages with other machines"), this);
+    m_memMergeCheckBox->setChecked(machine->getMemMerge());
+    m_memMergeCheckBox->setEnabled(enableFields);
+
+    m_balloonMinimumLabel = new QLabel(tr("Minimum memory") + ":", this);
+    m_balloonMinimumSpinBox = new QSpinBox(this);
+    m_balloonMinimumSpinBox->setSuffix(" MiB");
+    m_balloonMinimumSpinBox->setMinimum(1);
+    m_balloonMinimumSpinBox->setMaximum(totalRAM);
+    m_balloonMinimumSpinBox->setValue(static_cast<int>(machine->getBalloonMinimum()));
+
+    m_balloonMaximumLabel = new QLabel(tr("Maximum memory") + ":", this);
+    m_balloonMaximumSpinBox = new QSpinBox(this);
+    m_balloonMaximumSpinBox->setSuffix(" MiB");
+    m_balloonMaximumSpinBox->setSpecialValueText(tr("All the memory"));
+    m_balloonMaximumSpinBox->setMinimum(0);
+    m_balloonMaximumSpinBox->setMaximum(totalRAM);
+    m_balloonMaximumSpinBox->setValue(static_cast<int>(machine->getBalloonMaximum()));
+
+    m_balloonLayout = new QGridLayout();
+    m_balloonLayout->addWidget(m_balloonMinimumLabel,   0, 0, 1, 1);
+    m_balloonLayout->addWidget(m_balloonMinimumSpinBox, 0, 1, 1, 1);
+    m_balloonLayout->addWidget(m_balloonMaximumLabel,   1, 0, 1, 1);
+    m_balloonLayout->addWidget(m_balloonMaximumSpinBox, 1, 1, 1, 1);
+
+    m_balloonGroupBox = new QGroupBox(tr("Give the unused memory back to the host"), this);
+    m_balloonGroupBox->setCheckable(true);
+    m_balloonGroupBox->setChecked(machine->getBalloon());
+    m_balloonGroupBox->setEnabled(enableFields);
+    m_balloonGroupBox->setLayout(m_balloonLayout);
+
     m_machineMemoryLayout = new QGridLayout();
     m_machineMemoryLayout->setRowStretch(1, 1);
     m_machineMemoryLayout->setRowStretch(2, 10);
@@ -338,6 +380,9 @@ RamConfigTab::RamConfigTab(Machine *machine,
     m_machineMemoryLayout->addWidget(m_spinBoxMemoryLabel,     1, 4, 1, 1, Qt::AlignTop);
     m_machineMemoryLayout->addWidget(m_minMemoryLabel,         2, 0, 1, 1, Qt::AlignTop);
     m_machineMemoryLayout->addWidget(m_maxMemorylabel,         2, 2, 1, 1, Qt::AlignTop);
+    m_machineMemoryLayout->addWidget(m_hugePagesCheckBox,      3, 0, 1, 5, Qt::AlignTop);
+    m_machineMemoryLayout->addWidget(m_memMergeCheckBox,       4, 0, 1, 5, Qt::AlignTop);
+    m_machineMemoryLayout->addWidget(m_balloonGroupBox,        5, 0, 1, 5, Qt::AlignTop);
 
     this->setLayout(m_machineMemoryLayout);
 
@@ -360,19 +405,237 @@ int RamConfigTab::getAmountRam()
     return this->m_memorySpinBox->value();
 }
 
+/**
+ * @brief Get if the huge pages are used
+ * @return true if the memory is allocated from the huge pages
+ *
+ * Get if the huge pages are used
+ */
+bool RamConfigTab::getHugePages()
+{
+    return this->m_hugePagesCheckBox->isChecked();
+}
+
+/**
+ * @brief Get if the memory pages are merged
+ * @return true if KSM can merge the pages of the machine
+ *
+ * Get if the memory pages are merged
+ */
+bool RamConfigTab::getMemMerge()
+{
+    return this->m_memMergeCheckBox->isChecked();
+}
+
+/**
+ * @brief Get if the machine has a memory balloon
+ * @return true if the balloon is enabled
+ *
+ * Get if the machine has a memory balloon
+ */
+bool RamConfigTab::getBalloon()
+{
+    return this->m_balloonGroupBox->isChecked();
+}
+
+/**
+ * @brief Get the floor of the balloon
+ * @return MiB of RAM the guest keeps always
+ *
+ * Get the floor of the balloon
+ */
+int RamConfigTab::getBalloonMinimum()
+{
+    return this->m_balloonMinimumSpinBox->value();
+}
+
+/**
+ * @brief Get the ceiling of the balloon
+ * @return MiB of RAM the guest can get, 0 for all the RAM
+ *
+ * Get the ceiling of the balloon
+ */
+int RamConfigTab::getBalloonMaximum()
+{
+    return this->m_balloonMaximumSpinBox->value();
+}
+
+/**
+ * @brief Tab with the resource limits
+ * @param machine, machine to be configured
+ * @param enableFields, fields enabled or disabled
+ * @param parent, parent widget
+ *
+ * Tab with the limits of the cgroup of the machine.
+ * The limits can be changed while the machine is running
+ */
+ResourceLimitsTab::ResourceLimitsTab(Machine *machine,
+                                     bool enableFields,
+                                     QWidget *parent) : QWidget(parent)
+{
+    int totalRAM = 0;
+    SystemUtils::getTotalMemory(totalRAM);
+
+    m_cgroupCheckBox = new QCheckBox(tr("Place the machine in its own cgroup"), this);
+    m_cgroupCheckBox->setChecked(machine->getCGroup());
+    m_cgroupCheckBox->setEnabled(enableFields);
+#ifndef Q_OS_LINUX
+    m_cgroupCheckBox->setEnabled(false);
+#endif
+
+    m_limitsDescriptionLabel = new QLabel(tr("The limits are applied to the QEMU process "
+                                             "and can be changed while the machine is running."),
+                                          this);
+    m_limitsDescriptionLabel->setWordWrap(true);
+
+    m_CPUMaxSpinBox = new QSpinBox(this);
+    m_CPUMaxSpinBox->setSuffix(" %");
+    m_CPUMaxSpinBox->setSpecialValueText(tr("No limit"));
+    m_CPUMaxSpinBox->setMinimum(0);
+    m_CPUMaxSpinBox->setMaximum(100 * QThread::idealThreadCount());
+    m_CPUMaxSpinBox->setSingleStep(10);
+    m_CPUMaxSpinBox->setValue(machine->getCPUMax());
+    m_CPUMaxSpinBox->setToolTip(tr("Percent of one host CPU, 200 % are two CPUs"));
+
+    m_CPUWeightSpinBox = new QSpinBox(this);
+    m_CPUWeightSpinBox->setMinimum(1);
+    m_CPUWeightSpinBox->setMaximum(10000);
+    m_CPUWeightSpinBox->setValue(machine->getCPUWeight());
+    m_CPUWeightSpinBox->setToolTip(tr("Share of the CPU against the other machines, 100 by default"));
+
+    m_memoryMaxSpinBox = new QSpinBox(this);
+    m_memoryMaxSpinBox->setSuffix(" MiB");
+    m_memoryMaxSpinBox->setSpecialValueText(tr("No limit"));
+    m_memoryMaxSpinBox->setMinimum(0);
+    m_memoryMaxSpinBox->setMaximum(totalRAM);
+    m_memoryMaxSpinBox->setValue(static_cast<int>(machine->getMemoryMax()));
+    m_memoryMaxSpinBox->setToolTip(tr("Over this memory QEMU is killed"));
+
+    m_memoryHighSpinBox = new QSpinBox(this);
+    m_memoryHighSpinBox->setSuffix(" MiB");
+    m_memoryHighSpinBox->setSpecialValueText(tr("No limit"));
+    m_memoryHighSpinBox->setMinimum(0);
+    m_memoryHighSpinBox->setMaximum(totalRAM);
+    m_memoryHighSpinBox->setValue(static_cast<int>(machine->getMemoryHigh()));
+    m_memoryHighSpinBox->setToolTip(tr("Over this memory QEMU is slowed down and its memory reclaimed"));
+
+    m_IOMaxTextEdit = new QPlainTextEdit(this);
+    m_IOMaxTextEdit->setPlaceholderText("/dev/sda rbps=10485760 wbps=10485760 riops=max wiops=max");
+    m_IOMaxTextEdit->setPlainText(machine->getIOMax().join("\n"));
+    m_IOMaxTextEdit->setMaximumHeight(80);
+
+    m_limitsFormLayout = new QFormLayout();
+    m_limitsFormLayout->addRow(tr("CPU limit") + ":", m_CPUMaxSpinBox);
+    m_limitsFormLayout->addRow(tr("CPU weight") + ":", m_CPUWeightSpinBox);
+    m_limitsFormLayout->addRow(tr("Memory limit") + ":", m_memoryMaxSpinBox);
+    m_limitsFormLayout->addRow(tr("Memory throttle") + ":", m_memoryHighSpinBox);
+    m_limitsFormLayout->addRow(tr("IO limits") + ":", m_IOMaxTextEdit);
+
+    m_limitsLayout = new QVBoxLayout();
+    m_limitsLayout->setAlignment(Qt::AlignTop);
+    m_limitsLayout->addWidget(m_cgroupCheckBox);
+    m_limitsLayout->addWidget(m_limitsDescriptionLabel);
+    m_limitsLayout->addItem(m_limitsFormLayout);
+
+    this->setLayout(m_limitsLayout);
+
+    qDebug() << "ResourceLimitsTab created";
+}
+
+ResourceLimitsTab::~ResourceLimitsTab()
+{
+    qDebug() << "ResourceLimitsTab destroyed";
+}
+
+/**
+ * @brief Get if the machine has its own cgroup
+ * @return true if the machine is placed in its own cgroup
+ *
+ * Get if the machine has its own cgroup
+ */
+bool ResourceLimitsTab::getCGroup()
+{
+    return this->m_cgroupCheckBox->isChecked();
+}
+
+/**
+ * @brief Get the CPU limit
+ * @return percent of one host CPU, 0 without limit
+ *
+ * Get the CPU limit
+ */
+int ResourceLimitsTab::getCPUMax()
+{
+    return this->m_CPUMaxSpinBox->value();
+}
+
+/**
+ * @brief Get the CPU weight
+ * @return weight of the machine against the others
+ *
+ * Get the CPU weight
+ */
+int ResourceLimitsTab::getCPUWeight()
+{
+    return this->m_CPUWeightSpinBox->value();
+}
+
+/**
+ * @brief Get the memory limit
+ * @return MiB of memory of QEMU, 0 without limit
+ *
+ * Get the memory limit
+ */
+int ResourceLimitsTab::getMemoryMax()
+{
+    return this->m_memoryMaxSpinBox->value();
+}
+
+/**
+ * @brief Get the memory throttle
+ * @return MiB of memory of QEMU before the reclaim, 0 without throttle
+ *
+ * Get the memory throttle
+ */
+int ResourceLimitsTab::getMemoryHigh()
+{
+    return this->m_memoryHighSpinBox->value();
+}
+
+/**
+ * @brief Get the IO limits
+ * @return one limit per device
+ *
+ * Get the IO limits, the empty lines are skipped
+ */
+QStringList ResourceLimitsTab::getIOMax()
+{
+    QStringList IOMax;
+    foreach (const QString &line, this->m_IOMaxTextEdit->toPlainText().split("\n")) {
+        if (!line.trimmed().isEmpty()) {
+            IOMax.append(line.simplified());
+        }
+    }
+
+    return IOMax;
+}
+
 /**
  * @brief Machine type configuration tab
  * @param machine, machine to be configured
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param enableFields, fields enabled or disabled
  * @param parent, parent widget
  *
  * In this window the user can select the machine type
  */
 MachineTypeTab::MachineTypeTab(Machine *machine,
+                               QEMU *QEMUGlobalObject,
                                bool enableFields,
                                QWidget *parent) : QWidget(parent)
 {
     this->m_machine = machine;
+    this->m_qemuGlobalObject = QEMUGlobalObject;
 
     customFilter = new CustomFilter(this);
     this->setMachines();
@@ -431,7 +694,9 @@ void MachineTypeTab::textFilterChanged()
 /**
  * @brief Add the machines to the model
  *
- * Add all the machines to the model
+ * Add all the machines to the model.
+ * If the QEMU binary is probed, the machines supported
+ * by the binary are used
  */
 void MachineTypeTab::setMachines()
 {
@@ -440,6 +705,20 @@ void MachineTypeTab::setMachines()
     model->setHeaderData(0, Qt::Horizontal, QObject::tr("Machine"));
     model->setHeaderData(1, Qt::Horizontal, QObject::tr("Description"));
 
+    if (this->m_qemuGlobalObject->capabilities()->isProbed()) {
+        QMap<QString, QString> machineTypes = this->m_qemuGlobalObject->capabilities()->machineTypes();
+        QMapIterator<QString, QString> machinesIterator(machineTypes);
+        while (machinesIterator.hasNext()) {
+            machinesIterator.next();
+            this->addMachine(model, machinesIterator.key(), machinesIterator.value());
+        }
+
+        if (model->rowCount() > 0) {
+            customFilter->setSourceModel(model);
+            return;
+        }
+    }
+
     this->addMachine(model, "pc-q35-2.4", "Standard PC (Q35 + ICH9, 2009)");
     this->addMachine(model, "pc-q35-2.5", "Standard PC (Q35 + ICH9, 2009)");
     this->addMachine(model, "pc-q35-2.6", "Standard PC (Q35 + ICH9, 2009)");
@@ -29,6 +29,10 @@
 #include <QTreeView>
 #include <QStandardItemModel>
 #include <QLineEdit>
+#include <QCheckBox>
+#include <QFormLayout>
+#include <QPlainTextEdit>
+#include <QThread>
 
 // Local
 #include "../components/customfilter.h"
@@ -39,6 +43,7 @@ class ProcessorConfigTab: public QWidget {
 
     public:
         explicit ProcessorConfigTab(Machine *machine,
+                                    QEMU *QEMUGlobalObject,
                                     bool enableFields,
                                     QWidget *parent = nullptr);
         ~ProcessorConfigTab();
@@ -89,6 +94,7 @@ class GraphicsConfigTab: public QWidget {
 
     public:
         explicit GraphicsConfigTab(Machine *machine,
+                                   QEMU *QEMUGlobalObject,
                                    bool enableFields,
                                    QWidget *parent = nullptr);
         ~GraphicsConfigTab();
@@ -127,6 +133,11 @@ class RamConfigTab: public QWidget {
 
         // Methods
         int getAmountRam();
+        bool getHugePages();
+        bool getMemMerge();
+        bool getBalloon();
+        int getBalloonMinimum();
+        int getBalloonMaximum();
 
     signals:
 
@@ -144,6 +155,53 @@ class RamConfigTab: public QWidget {
         QLabel *m_spinBoxMemoryLabel;
         QLabel *m_minMemoryLabel;
         QLabel *m_maxMemorylabel;
+
+        QCheckBox *m_hugePagesCheckBox;
+        QCheckBox *m_memMergeCheckBox;
+
+        QGroupBox *m_balloonGroupBox;
+        QGridLayout *m_balloonLayout;
+        QLabel *m_balloonMinimumLabel;
+        QLabel *m_balloonMaximumLabel;
+        QSpinBox *m_balloonMinimumSpinBox;
+        QSpinBox *m_balloonMaximumSpinBox;
+};
+
+class ResourceLimitsTab : public QWidget {
+    Q_OBJECT
+
+    public:
+        explicit ResourceLimitsTab(Machine *machine,
+                                   bool enableFields,
+                                   QWidget *parent = nullptr);
+        ~ResourceLimitsTab();
+
+        // Methods
+        bool getCGroup();
+        int getCPUMax();
+        int getCPUWeight();
+        int getMemoryMax();
+        int getMemoryHigh();
+        QStringList getIOMax();
+
+    signals:
+
+    public slots:
+
+    protected:
+
+    private:
+        QVBoxLayout *m_limitsLayout;
+        QFormLayout *m_limitsFormLayout;
+
+        QCheckBox *m_cgroupCheckBox;
+        QLabel *m_limitsDescriptionLabel;
+
+        QSpinBox *m_CPUMaxSpinBox;
+        QSpinBox *m_CPUWeightSpinBox;
+        QSpinBox *m_memoryMaxSpinBox;
+        QSpinBox *m_memoryHighSpinBox;
+        QPlainTextEdit *m_IOMaxTextEdit;
 };
 
 class MachineTypeTab : public QWidget {
@@ -151,6 +209,7 @@ class MachineTypeTab : public QWidget {
 
     public:
         explicit MachineTypeTab(Machine *machine,
+                                QEMU *QEMUGlobalObject,
                                 bool enableFields,
                                 QWidget *parent = nullptr);
         ~MachineTypeTab();
@@ -179,6 +238,7 @@ class MachineTypeTab : public QWidget {
         QLineEdit *filterLineEdit;
 
         Machine *m_machine;
+        QEMU *m_qemuGlobalObject;
 
         // Methods
 
@@ -30,7 +30,8 @@
  *
  * Configuration of the machine. Media page.
  * In this page you can add or remove hdd, cdrom and floppy
- * to the machine
+ * to the machine, and change the throttle limits of each media.
+ * The limits can be changed while the machine is running
  */
 MachineConfigMedia::MachineConfigMedia(Machine *machine,
                                        QEMU *QEMUGlobalObject,
@@ -50,8 +51,10 @@ MachineConfigMedia::MachineConfigMedia(Machine *machine,
     m_mediaPathLabel = new QLabel(this);
     m_mediaPathLabel->setWordWrap(true);
 
+    this->m_throttleMedia = nullptr;
+    this->createThrottleSection();
+
     m_mediaTree = new QTreeWidget(this);
-    m_mediaTree->setEnabled(enableFields);
     m_mediaTree->setMaximumHeight(250);
     m_mediaTree->setMaximumWidth(200);
     m_mediaTree->setColumnCount(1);
@@ -77,6 +80,7 @@ MachineConfigMedia::MachineConfigMedia(Machine *machine,
                                                        QIcon(QPixmap(":/images/icons/breeze/32x32/remove.svg"))),
                                       tr("Remove media"),
                                       this);
+    m_removeMediaAction->setEnabled(enableFields);
     connect(m_removeMediaAction, &QAction::triggered,
             this, &MachineConfigMedia::removeMediaFromTree);
 
@@ -172,6 +176,7 @@ MachineConfigMedia::MachineConfigMedia(Machine *machine,
     m_mediaPageLayout->addWidget(m_mediaTree,             0, 0, 1, 1);
     m_mediaPageLayout->addWidget(m_mediaSettingsGroupBox, 0, 1, 1, 1);
     m_mediaPageLayout->addWidget(m_mediaAddGroupBox,      1, 0, 1, 1);
+    m_mediaPageLayout->addWidget(m_throttleGroupBox,      1, 1, 1, 1);
     //m_mediaPageLayout->addWidget(m_mediaOptionsGroupBox,  1, 1, 1, 1); // TODO: In QtEmu 2.1
 
     m_mediaPageWidget = new QWidget();
@@ -202,9 +207,13 @@ void MachineConfigMedia::removeMediaMenu(const QPoint &pos)
  */
 void MachineConfigMedia::fillDetailsSection()
 {
+    this->storeThrottleSection();
+
     if (this->countMedia() <= 0) {
         this->m_mediaNameLabel->setText("");
         this->m_mediaPathLabel->setText("");
+        this->m_throttleMedia = nullptr;
+        this->m_throttleGroupBox->setEnabled(false);
         return;
     }
 
@@ -213,6 +222,117 @@ void MachineConfigMedia::fillDetailsSection()
 
     this->m_mediaNameLabel->setText(selectedMedia->name());
     this->m_mediaPathLabel->setText(selectedMedia->path());
+
+    this->m_throttleMedia = selectedMedia;
+    this->m_throttleGroupBox->setEnabled(true);
+
+    QHash<QString, QSpinBox *>::const_iterator it;
+    for (it = this->m_throttleSpinBoxes.constBegin(); it != this->m_throttleSpinBoxes.constEnd(); ++it) {
+        qlonglong value = selectedMedia->throttle(it.key());
+        if (this->m_pendingThrottle.contains(selectedMedia)) {
+            value = this->m_pendingThrottle.value(selectedMedia).value(it.key(), 0);
+        }
+
+        // The bandwidth is shown in KiB/s
+        if (it.key().startsWith("bps")) {
+            value = value / 1024;
+        }
+        it.value()->setValue(static_cast<int>(qMin<qlonglong>(value, it.value()->maximum())));
+    }
+
+    if (this->m_pendingThrottleGroup.contains(selectedMedia)) {
+        this->m_throttleGroupLineEdit->setText(this->m_pendingThrottleGroup.value(selectedMedia));
+    } else {
+        this->m_throttleGroupLineEdit->setText(selectedMedia->throttleGroup());
+    }
+}
+
+/**
+ * @brief Create the throttle section
+ *
+ * Create the throttle section, the iops and bandwidth limits
+ * of the selected media, total, read and write, with their bursts,
+ * and the throttle group
+ */
+void MachineConfigMedia::createThrottleSection()
+{
+    m_throttleLayout = new QGridLayout();
+    m_throttleLayout->setAlignment(Qt::AlignTop);
+    m_throttleLayout->addWidget(new QLabel(tr("Total"), this), 0, 1, 1, 1);
+    m_throttleLayout->addWidget(new QLabel(tr("Read"), this),  0, 2, 1, 1);
+    m_throttleLayout->addWidget(new QLabel(tr("Write"), this), 0, 3, 1, 1);
+
+    QStringList rowNames;
+    rowNames << tr("IOPS") << tr("Bandwidth") << tr("IOPS burst") << tr("Bandwidth burst");
+
+    QStringList throttleKeys = Media::throttleKeys();
+    for (int i = 0; i < throttleKeys.size(); ++i) {
+        int row = i / 3 + 1;
+        int column = i % 3 + 1;
+
+        if (column == 1) {
+            m_throttleLayout->addWidget(new QLabel(rowNames.at(row - 1) + ":", this), row, 0, 1, 1);
+        }
+
+        QSpinBox *throttleSpinBox = new QSpinBox(this);
+        throttleSpinBox->setMinimum(0);
+        throttleSpinBox->setMaximum(10000000);
+        throttleSpinBox->setSpecialValueText(tr("Unlimited"));
+        if (throttleKeys.at(i).startsWith("bps")) {
+            throttleSpinBox->setSuffix(" KiB/s");
+        }
+
+        this->m_throttleSpinBoxes.insert(throttleKeys.at(i), throttleSpinBox);
+        m_throttleLayout->addWidget(throttleSpinBox, row, column, 1, 1);
+    }
+
+    m_throttleGroupLineEdit = new QLineEdit(this);
+    m_throttleGroupLineEdit->setToolTip(tr("The drives of the same group in this machine share the limits, "
+                                           "other machines with the same group are throttled independently"));
+
+    m_throttleLayout->addWidget(new QLabel(tr("Group") + ":", this), 5, 0, 1, 1);
+    m_throttleLayout->addWidget(m_throttleGroupLineEdit,            5, 1, 1, 3);
+
+    m_throttleGroupBox = new QGroupBox(tr("Throttling"), this);
+    m_throttleGroupBox->setEnabled(false);
+    m_throttleGroupBox->setLayout(m_throttleLayout);
+}
+
+/**
+ * @brief Store the throttle section
+ *
+ * Store the limits of the throttle section for the media
+ * shown. The media get the limits when the data is saved
+ */
+void MachineConfigMedia::storeThrottleSection()
+{
+    if (this->m_throttleMedia == nullptr) {
+        return;
+    }
+
+    QHash<QString, qlonglong> throttle;
+
+    QHash<QString, QSpinBox *>::const_iterator it;
+    for (it = this->m_throttleSpinBoxes.constBegin(); it != this->m_throttleSpinBoxes.constEnd(); ++it) {
+        qlonglong previousValue = this->m_throttleMedia->throttle(it.key());
+        if (this->m_pendingThrottle.contains(this->m_throttleMedia)) {
+            previousValue = this->m_pendingThrottle.value(this->m_throttleMedia).value(it.key(), 0);
+        }
+
+        // The limits not edited keep their exact value, the bandwidth
+        // shown in KiB/s would round down the bytes
+        qlonglong value = it.value()->value();
+        qlonglong shownValue = it.key().startsWith("bps") ? previousValue / 1024 : previousValue;
+        if (value == qBound<qlonglong>(it.value()->minimum(), shownValue, it.value()->maximum())) {
+            value = previousValue;
+        } else if (it.key().startsWith("bps")) {
+            value = value * 1024;
+        }
+        throttle.insert(it.key(), value);
+    }
+
+    this->m_pendingThrottle.insert(this->m_throttleMedia, throttle);
+    this->m_pendingThrottleGroup.insert(this->m_throttleMedia, this->m_throttleGroupLineEdit->text().trimmed());
 }
 
 /**
@@ -485,14 +605,48 @@ int MachineConfigMedia::countMedia()
  */
 void MachineConfigMedia::saveMediaData()
 {
+    this->storeThrottleSection();
+
     // Remove all media from the machine
     this->m_machineOptions->removeAllMedia();
 
+    QList<Media *> throttledMedia;
+
     QTreeWidgetItemIterator it(this->m_mediaTree);
     while (*it) {
         QVariant mediaVariant = (*it)->data(0, Qt::UserRole);
         Media *media = mediaVariant.value<Media *>();
+
+        if (this->m_pendingThrottle.contains(media)) {
+            bool changed = media->throttleGroup() != this->m_pendingThrottleGroup.value(media);
+            media->setThrottleGroup(this->m_pendingThrottleGroup.value(media));
+
+            QHash<QString, qlonglong> throttle = this->m_pendingThrottle.value(media);
+            QHash<QString, qlonglong>::const_iterator limit;
+            for (limit = throttle.constBegin(); limit != throttle.constEnd(); ++limit) {
+                changed = changed || media->throttle(limit.key()) != limit.value();
+                media->setThrottle(limit.key(), limit.value());
+            }
+
+            if (changed) {
+                throttledMedia.append(media);
+            }
+        }
+
         this->m_machineOptions->addMedia(media);
         ++it;
     }
+
+    // Change the limits of the running machine
+    bool applied = true;
+    for (int i = 0; i < throttledMedia.size(); ++i) {
+        applied = this->m_machineOptions->applyIOThrottle(throttledMedia.at(i)) && applied;
+    }
+
+    if (!applied) {
+        SystemUtils::showMessage(tr("Qtemu - Throttling"),
+                                 tr("<p>Cannot change the throttle limits of the running machine</p>"
+                                    "<p>The new limits are used in the next launch</p>"),
+                                 QMessageBox::Warning);
+    }
 }
@@ -37,6 +37,9 @@
 #include <QListWidget>
 #include <QAction>
 #include <QMenu>
+#include <QSpinBox>
+#include <QLineEdit>
+#include <QHash>
 
 // Local
 #include "../machine.h"
@@ -71,6 +74,7 @@ class MachineConfigMedia : public QWidget {
         QGridLayout *m_mediaPageLayout;
         QFormLayout *m_mediaDetailsLayout;
         QFormLayout *m_mediaOptionsLayout;
+        QGridLayout *m_throttleLayout;
         QHBoxLayout *m_mediaAddLayout;
 
         QTreeWidget *m_mediaTree;
@@ -82,6 +86,10 @@ class MachineConfigMedia : public QWidget {
         QGroupBox *m_mediaSettingsGroupBox;
         QGroupBox *m_mediaOptionsGroupBox;
         QGroupBox *m_mediaAddGroupBox;
+        QGroupBox *m_throttleGroupBox;
+
+        QHash<QString, QSpinBox *> m_throttleSpinBoxes;
+        QLineEdit *m_throttleGroupLineEdit;
 
         QComboBox *m_cacheComboBox;
         QComboBox *m_IOComboBox;
@@ -112,6 +120,10 @@ class MachineConfigMedia : public QWidget {
         Machine *m_machineOptions;
         QEMU *m_qemuGlobalObject;
 
+        Media *m_throttleMedia;
+        QHash<Media *, QHash<QString, qlonglong>> m_pendingThrottle;
+        QHash<Media *, QString> m_pendingThrottleGroup;
+
         // Methods
         void fillDetailsSection();
         void addFloppyMedia();
@@ -122,5 +134,7 @@ class MachineConfigMedia : public QWidget {
         void addInterface(const QString driveInterface);
         void removeInterface(const QString driveInterface);
         int countMedia();
+        void createThrottleSection();
+        void storeThrottleSection();
 };
 #endif // MACHINECONFIGMEDIA_H
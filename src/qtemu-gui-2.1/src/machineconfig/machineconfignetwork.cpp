@@ -28,6 +28,11 @@
  * @param parent, parent widget
  *
  * In this window the user can enable or disable the network of the machine
+ * and configure the network cards, the backend, model, queues and MAC address
+ * of each card. The local backend connects the card to a local network
+ * shared with other machines.
+ * The port forwarding of the user mode network can be changed while the
+ * machine is running
  */
 MachineConfigNetwork::MachineConfigNetwork(Machine *machine,
                                            QWidget *parent) : QWidget(parent)
@@ -39,8 +44,10 @@ MachineConfigNetwork::MachineConfigNetwork(Machine *machine,
     }
 
     this->m_machine = machine;
+    this->m_enableFields = enableFields;
+    this->m_selectedCard = nullptr;
 
-    m_withNetworkRadio = new QRadioButton(tr("User Mode Network Connection (Uses the user mode network stack)"), this);
+    m_withNetworkRadio = new QRadioButton(tr("Network Connection (Uses the network cards of the machine)"), this);
     m_withNetworkRadio->setEnabled(enableFields);
     if (machine->getUseNetwork() == true) {
         m_withNetworkRadio->setChecked(true);
@@ -61,8 +68,194 @@ MachineConfigNetwork::MachineConfigNetwork(Machine *machine,
     m_machineNetworkGroup = new QGroupBox(tr("Machine Network"));
     m_machineNetworkGroup->setLayout(m_networkLayout);
 
+    // The cards are copied, the machine gets them when the data is saved
+    for (int i = 0; i < machine->getNetworkCards().size(); ++i) {
+        this->m_networkCards.append(machine->getNetworkCards().at(i)->clone(this));
+    }
+
+    m_cardsList = new QListWidget(this);
+    m_cardsList->setMaximumWidth(200);
+    connect(m_cardsList, &QListWidget::currentRowChanged,
+            this, &MachineConfigNetwork::fillCardDetails);
+
+    m_addCardButton = new QPushButton(QIcon::fromTheme("network-card",
+                                                       QIcon(QPixmap(":/images/icons/breeze/32x32/network-card.svg"))),
+                                      "", this);
+    m_addCardButton->setToolTip(tr("Add network card"));
+    m_addCardButton->setEnabled(enableFields);
+    connect(m_addCardButton, &QAbstractButton::clicked,
+            this, &MachineConfigNetwork::addNetworkCard);
+
+    m_removeCardButton = new QPushButton(QIcon::fromTheme("remove",
+                                                          QIcon(QPixmap(":/images/icons/breeze/32x32/remove.svg"))),
+                                         "", this);
+    m_removeCardButton->setToolTip(tr("Remove network card"));
+    m_removeCardButton->setEnabled(enableFields);
+    connect(m_removeCardButton, &QAbstractButton::clicked,
+            this, &MachineConfigNetwork::removeNetworkCard);
+
+    m_cardsButtonsLayout = new QHBoxLayout();
+    m_cardsButtonsLayout->setAlignment(Qt::AlignLeft);
+    m_cardsButtonsLayout->addWidget(m_addCardButton);
+    m_cardsButtonsLayout->addWidget(m_removeCardButton);
+
+    m_cardsListLayout = new QVBoxLayout();
+    m_cardsListLayout->addWidget(m_cardsList);
+    m_cardsListLayout->addLayout(m_cardsButtonsLayout);
+
+    m_backendComboBox = new QComboBox(this);
+    m_backendComboBox->addItem(tr("User mode"), "user");
+    m_backendComboBox->addItem(tr("Tap with vhost"), "tap");
+    m_backendComboBox->addItem(tr("Bridge helper"), "bridge");
+    m_backendComboBox->addItem(tr("Socket"), "socket");
+    m_backendComboBox->addItem(tr("Local network"), "local");
+
+    m_modelComboBox = new QComboBox(this);
+    m_modelComboBox->addItem("virtio-net-pci");
+    m_modelComboBox->addItem("e1000");
+    m_modelComboBox->addItem("rtl8139");
+
+    m_queuesSpinBox = new QSpinBox(this);
+    m_queuesSpinBox->setMinimum(1);
+    m_queuesSpinBox->setMaximum(16);
+    m_queuesSpinBox->setToolTip(tr("More than one queue needs virtio-net with tap"));
+
+    m_MACLineEdit = new QLineEdit(this);
+    m_MACLineEdit->setInputMask("HH:HH:HH:HH:HH:HH;_");
+
+    m_generateMACButton = new QPushButton(tr("Generate"), this);
+    connect(m_generateMACButton, &QAbstractButton::clicked,
+            this, &MachineConfigNetwork::generateMACAddress);
+
+    m_MACLayout = new QHBoxLayout();
+    m_MACLayout->addWidget(m_MACLineEdit);
+    m_MACLayout->addWidget(m_generateMACButton);
+
+    m_vhostCheckBox = new QCheckBox(this);
+
+    m_ifnameLineEdit = new QLineEdit(this);
+    m_ifnameLineEdit->setPlaceholderText("tap0");
+
+    m_bridgeLineEdit = new QLineEdit(this);
+    m_bridgeLineEdit->setPlaceholderText("br0");
+
+    m_socketModeComboBox = new QComboBox(this);
+    m_socketModeComboBox->addItem(tr("Listen"), "listen");
+    m_socketModeComboBox->addItem(tr("Connect"), "connect");
+    m_socketModeComboBox->addItem(tr("Multicast"), "mcast");
+
+    m_socketAddressLineEdit = new QLineEdit(this);
+    m_socketAddressLineEdit->setPlaceholderText("127.0.0.1:10000");
+
+    m_localNetworkComboBox = new QComboBox(this);
+    m_localNetworkComboBox->addItems(LocalNetworks::names());
+    m_localNetworkComboBox->setToolTip(tr("The local networks are managed in Machine > Local networks"));
+
+    connect(m_backendComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MachineConfigNetwork::updateNetworkCard);
+    connect(m_modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MachineConfigNetwork::updateNetworkCard);
+    connect(m_queuesSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MachineConfigNetwork::updateNetworkCard);
+    connect(m_MACLineEdit, &QLineEdit::textChanged,
+            this, &MachineConfigNetwork::updateNetworkCard);
+    connect(m_vhostCheckBox, &QAbstractButton::toggled,
+            this, &MachineConfigNetwork::updateNetworkCard);
+    connect(m_ifnameLineEdit, &QLineEdit::textChanged,
+            this, &MachineConfigNetwork::updateNetworkCard);
+    connect(m_bridgeLineEdit, &QLineEdit::textChanged,
+            this, &MachineConfigNetwork::updateNetworkCard);
+    connect(m_socketModeComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MachineConfigNetwork::updateNetworkCard);
+    connect(m_socketAddressLineEdit, &QLineEdit::textChanged,
+            this, &MachineConfigNetwork::updateNetworkCard);
+    connect(m_localNetworkComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MachineConfigNetwork::updateNetworkCard);
+
+    m_cardDetailsLayout = new QFormLayout();
+    m_cardDetailsLayout->setAlignment(Qt::AlignTop);
+    m_cardDetailsLayout->setLabelAlignment(Qt::AlignLeft);
+    m_cardDetailsLayout->addRow(tr("Backend") + ":", m_backendComboBox);
+    m_cardDetailsLayout->addRow(tr("Model") + ":", m_modelComboBox);
+    m_cardDetailsLayout->addRow(tr("Queues") + ":", m_queuesSpinBox);
+    m_cardDetailsLayout->addRow(tr("MAC address") + ":", m_MACLayout);
+    m_cardDetailsLayout->addRow(tr("vhost") + ":", m_vhostCheckBox);
+    m_cardDetailsLayout->addRow(tr("Tap interface") + ":", m_ifnameLineEdit);
+    m_cardDetailsLayout->addRow(tr("Bridge") + ":", m_bridgeLineEdit);
+    m_cardDetailsLayout->addRow(tr("Socket mode") + ":", m_socketModeComboBox);
+    m_cardDetailsLayout->addRow(tr("Socket address") + ":", m_socketAddressLineEdit);
+    m_cardDetailsLayout->addRow(tr("Local network") + ":", m_localNetworkComboBox);
+
+    m_cardsLayout = new QHBoxLayout();
+    m_cardsLayout->addLayout(m_cardsListLayout);
+    m_cardsLayout->addLayout(m_cardDetailsLayout);
+
+    m_networkCardsGroup = new QGroupBox(tr("Network Cards"));
+    m_networkCardsGroup->setLayout(m_cardsLayout);
+
+    for (int i = 0; i < this->m_networkCards.size(); ++i) {
+        this->m_cardsList->addItem(this->cardLabel(i));
+    }
+    this->m_cardsList->setCurrentRow(0);
+    this->fillCardDetails();
+
+    m_portForwardTree = new QTreeWidget(this);
+    m_portForwardTree->setColumnCount(4);
+    m_portForwardTree->setHeaderLabels(QStringList() << tr("Protocol") << tr("Host address")
+                                                     << tr("Host port") << tr("Guest port"));
+    m_portForwardTree->setRootIsDecorated(false);
+    m_portForwardTree->setMaximumHeight(150);
+
+    QStringList machinePortForwards = machine->getPortForwards();
+    for (int i = 0; i < machinePortForwards.size(); ++i) {
+        this->addPortForwardToTree(machinePortForwards.at(i));
+    }
+
+    m_protocolComboBox = new QComboBox(this);
+    m_protocolComboBox->addItem("tcp");
+    m_protocolComboBox->addItem("udp");
+
+    m_hostAddressLineEdit = new QLineEdit(this);
+    m_hostAddressLineEdit->setText("127.0.0.1");
+    m_hostAddressLineEdit->setToolTip(tr("Empty to listen in all the addresses of the host"));
+
+    m_hostPortSpinBox = new QSpinBox(this);
+    m_hostPortSpinBox->setMinimum(1);
+    m_hostPortSpinBox->setMaximum(65535);
+    m_hostPortSpinBox->setValue(2222);
+
+    m_guestPortSpinBox = new QSpinBox(this);
+    m_guestPortSpinBox->setMinimum(1);
+    m_guestPortSpinBox->setMaximum(65535);
+    m_guestPortSpinBox->setValue(22);
+
+    m_addPortForwardButton = new QPushButton(tr("Add"), this);
+    connect(m_addPortForwardButton, &QAbstractButton::clicked,
+            this, &MachineConfigNetwork::addPortForward);
+
+    m_removePortForwardButton = new QPushButton(tr("Remove"), this);
+    connect(m_removePortForwardButton, &QAbstractButton::clicked,
+            this, &MachineConfigNetwork::removePortForward);
+
+    m_portForwardInputLayout = new QHBoxLayout();
+    m_portForwardInputLayout->addWidget(m_protocolComboBox);
+    m_portForwardInputLayout->addWidget(m_hostAddressLineEdit);
+    m_portForwardInputLayout->addWidget(m_hostPortSpinBox);
+    m_portForwardInputLayout->addWidget(m_guestPortSpinBox);
+    m_portForwardInputLayout->addWidget(m_addPortForwardButton);
+    m_portForwardInputLayout->addWidget(m_removePortForwardButton);
+
+    m_portForwardLayout = new QVBoxLayout();
+    m_portForwardLayout->addWidget(m_portForwardTree);
+    m_portForwardLayout->addLayout(m_portForwardInputLayout);
+
+    m_portForwardGroup = new QGroupBox(tr("Port Forwarding (User mode network)"));
+    m_portForwardGroup->setLayout(m_portForwardLayout);
+
     m_networkMainLayout = new QVBoxLayout();
     m_networkMainLayout->addWidget(m_machineNetworkGroup);
+    m_networkMainLayout->addWidget(m_networkCardsGroup);
+    m_networkMainLayout->addWidget(m_portForwardGroup);
 
     m_networkPageWidget = new QWidget();
     m_networkPageWidget->setLayout(m_networkMainLayout);
@@ -75,17 +268,280 @@ MachineConfigNetwork::~MachineConfigNetwork()
     qDebug() << "MachineConfigNetwork destroyed";
 }
 
+/**
+ * @brief Add a network card
+ *
+ * Add a user mode virtio-net card with a new MAC address
+ */
+void MachineConfigNetwork::addNetworkCard()
+{
+    NetworkCard *networkCard = new NetworkCard(this);
+    networkCard->setMACAddress(NetworkCard::generateMACAddress());
+    networkCard->setUuid(QUuid::createUuid());
+
+    this->m_networkCards.append(networkCard);
+    this->m_cardsList->addItem(this->cardLabel(this->m_networkCards.size() - 1));
+    this->m_cardsList->setCurrentRow(this->m_networkCards.size() - 1);
+}
+
+/**
+ * @brief Remove the selected network card
+ *
+ * Remove the selected network card
+ */
+void MachineConfigNetwork::removeNetworkCard()
+{
+    int row = this->m_cardsList->currentRow();
+    if (row < 0 || row >= this->m_networkCards.size()) {
+        return;
+    }
+
+    this->m_selectedCard = nullptr;
+    delete this->m_networkCards.takeAt(row);
+    delete this->m_cardsList->takeItem(row);
+
+    // The ids of the next cards change
+    for (int i = 0; i < this->m_networkCards.size(); ++i) {
+        this->m_cardsList->item(i)->setText(this->cardLabel(i));
+    }
+    this->fillCardDetails();
+}
+
+/**
+ * @brief Fill the details of the card
+ *
+ * Fill the details of the selected card. The fields
+ * of other backends are disabled
+ */
+void MachineConfigNetwork::fillCardDetails()
+{
+    this->m_selectedCard = nullptr;
+
+    int row = this->m_cardsList->currentRow();
+    bool selected = row >= 0 && row < this->m_networkCards.size();
+
+    this->m_backendComboBox->setEnabled(selected && this->m_enableFields);
+    this->m_modelComboBox->setEnabled(selected && this->m_enableFields);
+    this->m_queuesSpinBox->setEnabled(selected && this->m_enableFields);
+    this->m_MACLineEdit->setEnabled(selected && this->m_enableFields);
+    this->m_generateMACButton->setEnabled(selected && this->m_enableFields);
+    this->m_vhostCheckBox->setEnabled(selected && this->m_enableFields);
+    this->m_ifnameLineEdit->setEnabled(selected && this->m_enableFields);
+    this->m_bridgeLineEdit->setEnabled(selected && this->m_enableFields);
+    this->m_socketModeComboBox->setEnabled(selected && this->m_enableFields);
+    this->m_socketAddressLineEdit->setEnabled(selected && this->m_enableFields);
+    this->m_localNetworkComboBox->setEnabled(selected && this->m_enableFields);
+
+    if (!selected) {
+        return;
+    }
+
+    NetworkCard *networkCard = this->m_networkCards.at(row);
+
+    this->m_backendComboBox->setCurrentIndex(this->m_backendComboBox->findData(networkCard->backend()));
+    this->m_modelComboBox->setCurrentText(networkCard->model());
+    this->m_queuesSpinBox->setValue(networkCard->queues());
+    this->m_MACLineEdit->setText(networkCard->MACAddress());
+    this->m_vhostCheckBox->setChecked(networkCard->vhost());
+    this->m_ifnameLineEdit->setText(networkCard->ifname());
+    this->m_bridgeLineEdit->setText(networkCard->bridge());
+    this->m_socketModeComboBox->setCurrentIndex(this->m_socketModeComboBox->findData(networkCard->socketMode()));
+    this->m_socketAddressLineEdit->setText(networkCard->socketAddress());
+    this->m_localNetworkComboBox->setCurrentText(networkCard->localNetwork());
+
+    this->m_selectedCard = networkCard;
+    this->updateNetworkCard();
+}
+
+/**
+ * @brief Update the selected card
+ *
+ * Update the selected card with the values of the fields
+ */
+void MachineConfigNetwork::updateNetworkCard()
+{
+    if (this->m_selectedCard == nullptr) {
+        return;
+    }
+
+    QString backend = this->m_backendComboBox->currentData().toString();
+
+    this->m_selectedCard->setBackend(backend);
+    this->m_selectedCard->setModel(this->m_modelComboBox->currentText());
+    this->m_selectedCard->setQueues(this->m_queuesSpinBox->value());
+    this->m_selectedCard->setMACAddress(this->m_MACLineEdit->hasAcceptableInput() ? this->m_MACLineEdit->text() : "");
+    this->m_selectedCard->setVhost(this->m_vhostCheckBox->isChecked());
+    this->m_selectedCard->setIfname(this->m_ifnameLineEdit->text().trimmed());
+    this->m_selectedCard->setBridge(this->m_bridgeLineEdit->text().trimmed());
+    this->m_selectedCard->setSocketMode(this->m_socketModeComboBox->currentData().toString());
+    this->m_selectedCard->setSocketAddress(this->m_socketAddressLineEdit->text().trimmed());
+    this->m_selectedCard->setLocalNetwork(this->m_localNetworkComboBox->currentText());
+
+    this->m_queuesSpinBox->setEnabled(backend == "tap" && this->m_enableFields);
+    this->m_vhostCheckBox->setEnabled(backend == "tap" && this->m_enableFields);
+    this->m_ifnameLineEdit->setEnabled(backend == "tap" && this->m_enableFields);
+    this->m_bridgeLineEdit->setEnabled(backend == "bridge" && this->m_enableFields);
+    this->m_socketModeComboBox->setEnabled(backend == "socket" && this->m_enableFields);
+    this->m_socketAddressLineEdit->setEnabled(backend == "socket" && this->m_enableFields);
+    this->m_localNetworkComboBox->setEnabled(backend == "local" && this->m_enableFields);
+
+    this->m_cardsList->currentItem()->setText(this->cardLabel(this->m_cardsList->currentRow()));
+}
+
+/**
+ * @brief Generate a MAC address
+ *
+ * Generate a new MAC address for the selected card
+ */
+void MachineConfigNetwork::generateMACAddress()
+{
+    this->m_MACLineEdit->setText(NetworkCard::generateMACAddress());
+}
+
+/**
+ * @brief Get the label of the card
+ * @param index, card index
+ * @return label of the card
+ *
+ * Get the label of the card for the list
+ * Ex: net0 - tap (virtio-net-pci)
+ */
+QString MachineConfigNetwork::cardLabel(int index) const
+{
+    NetworkCard *networkCard = this->m_networkCards.at(index);
+
+    return QString("net%1 - %2 (%3)").arg(index).arg(networkCard->backend()).arg(networkCard->model());
+}
+
+/**
+ * @brief Add a port forwarding rule
+ *
+ * Add a rule with the values of the fields
+ */
+void MachineConfigNetwork::addPortForward()
+{
+    QString rule = QString("%1:%2:%3-:%4").arg(this->m_protocolComboBox->currentText())
+                                          .arg(this->m_hostAddressLineEdit->text().trimmed())
+                                          .arg(this->m_hostPortSpinBox->value())
+                                          .arg(this->m_guestPortSpinBox->value());
+
+    HostPortRegistry::HostPort hostPort;
+    if (!HostPortRegistry::parseRule(rule, &hostPort)) {
+        SystemUtils::showMessage(tr("Qtemu - Port forwarding"),
+                                 tr("<p>%1 is not a valid rule</p>").arg(rule),
+                                 QMessageBox::Warning);
+        return;
+    }
+
+    if (this->portForwards().contains(rule)) {
+        return;
+    }
+
+    this->addPortForwardToTree(rule);
+}
+
+/**
+ * @brief Remove the selected port forwarding rule
+ *
+ * Remove the selected port forwarding rule
+ */
+void MachineConfigNetwork::removePortForward()
+{
+    delete this->m_portForwardTree->currentItem();
+}
+
+/**
+ * @brief Add a rule to the tree
+ * @param rule, port forwarding rule
+ *
+ * Add a rule to the tree, the rule is kept in the item
+ */
+void MachineConfigNetwork::addPortForwardToTree(const QString &rule)
+{
+    HostPortRegistry::HostPort hostPort;
+    HostPortRegistry::parseRule(rule, &hostPort);
+
+    QTreeWidgetItem *ruleItem = new QTreeWidgetItem(this->m_portForwardTree, QTreeWidgetItem::Type);
+    ruleItem->setText(0, hostPort.protocol);
+    ruleItem->setText(1, hostPort.address.isEmpty() ? tr("All") : hostPort.address);
+    ruleItem->setText(2, QString::number(hostPort.port));
+    ruleItem->setText(3, rule.section(":", -1));
+    ruleItem->setData(0, Qt::UserRole, rule);
+}
+
+/**
+ * @brief Get the rules of the tree
+ * @return port forwarding rules
+ *
+ * Get the rules of the tree
+ */
+QStringList MachineConfigNetwork::portForwards() const
+{
+    QStringList portForwards;
+
+    QTreeWidgetItemIterator it(this->m_portForwardTree);
+    while (*it) {
+        portForwards.append((*it)->data(0, Qt::UserRole).toString());
+        ++it;
+    }
+
+    return portForwards;
+}
+
 /**
  * @brief Enable or disable the network
  *
  * Enable or disable the network for the machine
+ * and replace the network cards of the machine.
+ * The port forwarding changes are applied to the
+ * running machine
  */
 void MachineConfigNetwork::saveNetworkData()
 {
+    QStringList oldPortForwards = this->m_machine->getPortForwards();
+    QStringList newPortForwards = this->portForwards();
+    QStringList failedPortForwards;
+
+    for (int i = 0; i < oldPortForwards.size(); ++i) {
+        if (!newPortForwards.contains(oldPortForwards.at(i))) {
+            this->m_machine->removePortForward(oldPortForwards.at(i));
+        }
+    }
+
+    for (int i = 0; i < newPortForwards.size(); ++i) {
+        QString error;
+        if (!oldPortForwards.contains(newPortForwards.at(i)) &&
+            !this->m_machine->addPortForward(newPortForwards.at(i), &error)) {
+            failedPortForwards.append(newPortForwards.at(i) + ": " + error);
+        }
+    }
+    this->m_machine->setPortForwards(newPortForwards);
+
+    if (!failedPortForwards.isEmpty()) {
+        SystemUtils::showMessage(tr("Qtemu - Port forwarding"),
+                                 tr("<p>Cannot add the port forwarding to the running machine</p>"
+                                    "<p>%1</p>"
+                                    "<p>The rules are used in the next launch</p>").arg(failedPortForwards.join("<br>")),
+                                 QMessageBox::Warning);
+    }
+
     bool useNetwork = false;
 
     if (this->m_withNetworkRadio->isChecked()) {
         useNetwork = true;
     }
     this->m_machine->setUseNetwork(useNetwork);
+
+    if (!this->m_enableFields) {
+        return;
+    }
+
+    QList<NetworkCard *> oldNetworkCards = this->m_machine->getNetworkCards();
+
+    this->m_machine->removeAllNetworkCards();
+    for (int i = 0; i < this->m_networkCards.size(); ++i) {
+        this->m_machine->addNetworkCard(this->m_networkCards.at(i)->clone(this->m_machine));
+    }
+
+    qDeleteAll(oldNetworkCards);
 }
@@ -26,9 +26,19 @@
 #include <QVBoxLayout>
 #include <QGroupBox>
 #include <QRadioButton>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QListWidget>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QTreeWidget>
 
 // Local
 #include "../machine.h"
+#include "../utils/systemutils.h"
 
 class MachineConfigNetwork : public QWidget {
     Q_OBJECT
@@ -47,19 +57,72 @@ class MachineConfigNetwork : public QWidget {
     public slots:
 
     private slots:
+        void addNetworkCard();
+        void removeNetworkCard();
+        void fillCardDetails();
+        void updateNetworkCard();
+        void generateMACAddress();
+        void addPortForward();
+        void removePortForward();
 
     protected:
 
     private:
         QVBoxLayout *m_networkLayout;
         QVBoxLayout *m_networkMainLayout;
+        QHBoxLayout *m_cardsLayout;
+        QVBoxLayout *m_cardsListLayout;
+        QHBoxLayout *m_cardsButtonsLayout;
+        QFormLayout *m_cardDetailsLayout;
+        QHBoxLayout *m_MACLayout;
+        QVBoxLayout *m_portForwardLayout;
+        QHBoxLayout *m_portForwardInputLayout;
 
         QGroupBox *m_machineNetworkGroup;
+        QGroupBox *m_networkCardsGroup;
+        QGroupBox *m_portForwardGroup;
+
+        QTreeWidget *m_portForwardTree;
+        QComboBox *m_protocolComboBox;
+        QLineEdit *m_hostAddressLineEdit;
+        QSpinBox *m_hostPortSpinBox;
+        QSpinBox *m_guestPortSpinBox;
+        QPushButton *m_addPortForwardButton;
+        QPushButton *m_removePortForwardButton;
 
         QRadioButton *m_withNetworkRadio;
         QRadioButton *m_withoutNetworkRadio;
 
+        QListWidget *m_cardsList;
+
+        QPushButton *m_addCardButton;
+        QPushButton *m_removeCardButton;
+        QPushButton *m_generateMACButton;
+
+        QComboBox *m_backendComboBox;
+        QComboBox *m_modelComboBox;
+        QComboBox *m_socketModeComboBox;
+        QComboBox *m_localNetworkComboBox;
+
+        QSpinBox *m_queuesSpinBox;
+
+        QLineEdit *m_MACLineEdit;
+        QLineEdit *m_ifnameLineEdit;
+        QLineEdit *m_bridgeLineEdit;
+        QLineEdit *m_socketAddressLineEdit;
+
+        QCheckBox *m_vhostCheckBox;
+
+        QList<NetworkCard *> m_networkCards;
+        NetworkCard *m_selectedCard;
+        bool m_enableFields;
+
         Machine *m_machine;
 
+        // Methods
+        QString cardLabel(int index) const;
+        void addPortForwardToTree(const QString &rule);
+        QStringList portForwards() const;
+
 };
 #endif // MACHINECONFIGNETWORK_H
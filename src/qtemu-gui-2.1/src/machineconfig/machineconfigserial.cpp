@@ -0,0 +1,146 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "machineconfigserial.h"
+
+/**
+ * @brief Serial console configuration window
+ * @param machine, machine to be configured
+ * @param parent, parent widget
+ *
+ * In this window the user can enable the capture of the serial console
+ * and choose how QtEmu detects that the guest finished the boot
+ */
+MachineConfigSerial::MachineConfigSerial(Machine *machine,
+                                         QWidget *parent) : QWidget(parent)
+{
+    bool enableFields = true;
+
+    if (machine->getState() != Machine::Stopped) {
+        enableFields = false;
+    }
+
+    this->m_machine = machine;
+
+    m_serialCaptureCheckBox = new QCheckBox(tr("Save the output of the first serial port"), this);
+    m_serialCaptureCheckBox->setEnabled(enableFields);
+    m_serialCaptureCheckBox->setChecked(machine->getSerialCapture());
+
+    m_serialLogSizeSpinBox = new QSpinBox(this);
+    m_serialLogSizeSpinBox->setRange(16, 1048576);
+    m_serialLogSizeSpinBox->setSuffix(" KiB");
+    m_serialLogSizeSpinBox->setValue(machine->getSerialLogSize());
+    m_serialLogSizeSpinBox->setEnabled(enableFields && machine->getSerialCapture());
+
+    connect(m_serialCaptureCheckBox, &QAbstractButton::toggled,
+            m_serialLogSizeSpinBox, &QWidget::setEnabled);
+
+    m_serialLogLabel = new QLabel(QDir::toNativeSeparators(QDir(machine->getPath()).filePath("serial.log")), this);
+    m_serialLogLabel->setWordWrap(true);
+    m_serialLogLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+    m_serialLayout = new QFormLayout();
+    m_serialLayout->setAlignment(Qt::AlignTop);
+    m_serialLayout->setContentsMargins(5, 20, 5, 0);
+    m_serialLayout->addRow(m_serialCaptureCheckBox);
+    m_serialLayout->addRow(tr("Log size") + ":", m_serialLogSizeSpinBox);
+    m_serialLayout->addRow(tr("Log file") + ":", m_serialLogLabel);
+
+    m_serialGroup = new QGroupBox(tr("Serial console"));
+    m_serialGroup->setLayout(m_serialLayout);
+
+    m_readinessModeComboBox = new QComboBox(this);
+    m_readinessModeComboBox->addItem(tr("Don't measure the boot"), "none");
+    m_readinessModeComboBox->addItem(tr("Pattern in the serial console"), "serial");
+    m_readinessModeComboBox->addItem(tr("QEMU guest agent answers"), "agent");
+    m_readinessModeComboBox->addItem(tr("TCP port of the host accepts connections"), "tcp");
+    m_readinessModeComboBox->setEnabled(enableFields);
+
+    m_readinessPatternLineEdit = new QLineEdit(this);
+    m_readinessPatternLineEdit->setPlaceholderText("login:");
+    m_readinessPatternLineEdit->setText(machine->getBootReadinessPattern());
+
+    m_readinessPortSpinBox = new QSpinBox(this);
+    m_readinessPortSpinBox->setRange(1, 65535);
+    m_readinessPortSpinBox->setValue(machine->getBootReadinessPort() > 0 ? machine->getBootReadinessPort() : 2222);
+
+    connect(m_readinessModeComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MachineConfigSerial::readinessModeChanged);
+
+    int readinessIndex = m_readinessModeComboBox->findData(machine->getBootReadinessMode());
+    m_readinessModeComboBox->setCurrentIndex(readinessIndex != -1 ? readinessIndex : 0);
+    this->readinessModeChanged(m_readinessModeComboBox->currentIndex());
+
+    m_readinessLayout = new QFormLayout();
+    m_readinessLayout->setAlignment(Qt::AlignTop);
+    m_readinessLayout->setContentsMargins(5, 20, 5, 0);
+    m_readinessLayout->addRow(tr("Guest ready when") + ":", m_readinessModeComboBox);
+    m_readinessLayout->addRow(tr("Pattern") + ":", m_readinessPatternLineEdit);
+    m_readinessLayout->addRow(tr("Port") + ":", m_readinessPortSpinBox);
+
+    m_readinessGroup = new QGroupBox(tr("Boot time"));
+    m_readinessGroup->setLayout(m_readinessLayout);
+
+    m_serialMainLayout = new QVBoxLayout();
+    m_serialMainLayout->setAlignment(Qt::AlignTop);
+    m_serialMainLayout->addWidget(m_serialGroup);
+    m_serialMainLayout->addWidget(m_readinessGroup);
+
+    m_serialPageWidget = new QWidget();
+    m_serialPageWidget->setLayout(m_serialMainLayout);
+
+    qDebug() << "MachineConfigSerial created";
+}
+
+MachineConfigSerial::~MachineConfigSerial()
+{
+    qDebug() << "MachineConfigSerial destroyed";
+}
+
+/**
+ * @brief Enable the fields of the readiness mode
+ * @param index, index of the selected mode
+ *
+ * Enable the fields of the readiness mode
+ */
+void MachineConfigSerial::readinessModeChanged(int index)
+{
+    QString mode = this->m_readinessModeComboBox->itemData(index).toString();
+    bool enableFields = this->m_readinessModeComboBox->isEnabled();
+
+    this->m_readinessPatternLineEdit->setEnabled(enableFields && mode == "serial");
+    this->m_readinessPortSpinBox->setEnabled(enableFields && mode == "tcp");
+}
+
+/**
+ * @brief Save the serial console options
+ *
+ * Save the serial console and boot time options of the machine
+ */
+void MachineConfigSerial::saveSerialData()
+{
+    this->m_machine->setSerialCapture(this->m_serialCaptureCheckBox->isChecked());
+    this->m_machine->setSerialLogSize(this->m_serialLogSizeSpinBox->value());
+    this->m_machine->setBootReadinessMode(this->m_readinessModeComboBox->currentData().toString());
+    this->m_machine->setBootReadinessPattern(this->m_readinessPatternLineEdit->text());
+    this->m_machine->setBootReadinessPort(this->m_readinessPortSpinBox->value());
+}
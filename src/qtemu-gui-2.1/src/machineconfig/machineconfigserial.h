@@ -0,0 +1,78 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MACHINECONFIGSERIAL_H
+#define MACHINECONFIGSERIAL_H
+
+// Qt
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QLabel>
+#include <QComboBox>
+#include <QLineEdit>
+
+// Local
+#include "../machine.h"
+
+class MachineConfigSerial : public QWidget {
+    Q_OBJECT
+
+    public:
+        explicit MachineConfigSerial(Machine *machine,
+                                     QWidget *parent = nullptr);
+        ~MachineConfigSerial();
+        QWidget *m_serialPageWidget;
+
+        // Methods
+        void saveSerialData();
+
+    signals:
+
+    public slots:
+
+    private slots:
+        void readinessModeChanged(int index);
+
+    protected:
+
+    private:
+        QVBoxLayout *m_serialMainLayout;
+        QFormLayout *m_serialLayout;
+
+        QGroupBox *m_serialGroup;
+
+        QCheckBox *m_serialCaptureCheckBox;
+        QSpinBox *m_serialLogSizeSpinBox;
+        QLabel *m_serialLogLabel;
+
+        QFormLayout *m_readinessLayout;
+        QGroupBox *m_readinessGroup;
+        QComboBox *m_readinessModeComboBox;
+        QLineEdit *m_readinessPatternLineEdit;
+        QSpinBox *m_readinessPortSpinBox;
+
+        Machine *m_machine;
+
+};
+#endif // MACHINECONFIGSERIAL_H
@@ -52,12 +52,13 @@ MachineConfigWindow::MachineConfigWindow(Machine *machine,
     this->setMinimumSize(700, 500);
 
     m_configGeneral  = new MachineConfigGeneral(machine, this);
-    m_configHardware = new MachineConfigHardware(machine, this);
+    m_configHardware = new MachineConfigHardware(machine, QEMUGlobalObject, this);
     m_configBoot     = new MachineConfigBoot(machine, this);
     m_configMedia    = new MachineConfigMedia(machine, QEMUGlobalObject, this);
     m_configNetwork  = new MachineConfigNetwork(machine, this);
-    m_configAudio    = new MachineConfigAudio(machine, this);
-    m_configAccel    = new MachineConfigAccel(machine, this);
+    m_configAudio    = new MachineConfigAudio(machine, QEMUGlobalObject, this);
+    m_configAccel    = new MachineConfigAccel(machine, QEMUGlobalObject, this);
+    m_configSerial   = new MachineConfigSerial(machine, this);
 
     m_optionsListWidget = new QListWidget(this);
     m_optionsListWidget->setViewMode(QListView::ListMode);
@@ -97,8 +98,12 @@ MachineConfigWindow::MachineConfigWindow(Machine *machine,
     m_optionsListWidget->item(6)->setIcon(QIcon::fromTheme("mathematica",
                                                            QIcon(QPixmap(":/images/icons/breeze/32x32/mathematica.svg"))));
 
+    m_optionsListWidget->addItem(tr("Serial console"));
+    m_optionsListWidget->item(7)->setIcon(QIcon::fromTheme("utilities-terminal",
+                                                           QIcon(QPixmap(":/images/icons/breeze/32x32/document-properties.svg"))));
+
     /*m_optionsListWidget->addItem(tr("Display"));
-    m_optionsListWidget->item(7)->setIcon(QIcon::fromTheme("applications-multimedia",
+    m_optionsListWidget->item(8)->setIcon(QIcon::fromTheme("applications-multimedia",
                                                            QIcon(QPixmap(":/images/icons/breeze/32x32/.svg"))));*/
 
     // Prepare window
@@ -112,6 +117,7 @@ MachineConfigWindow::MachineConfigWindow(Machine *machine,
     m_optionsStackedWidget->addWidget(this->m_configNetwork->m_networkPageWidget);
     m_optionsStackedWidget->addWidget(this->m_configAudio->m_audioPageWidget);
     m_optionsStackedWidget->addWidget(this->m_configAccel->m_acceleratorPageWidget);
+    m_optionsStackedWidget->addWidget(this->m_configSerial->m_serialPageWidget);
 
     connect(m_optionsListWidget, &QListWidget::currentRowChanged,
             m_optionsStackedWidget, &QStackedWidget::setCurrentIndex);
@@ -177,8 +183,16 @@ void MachineConfigWindow::saveMachineSettings()
     this->m_configNetwork->saveNetworkData();
     this->m_configAudio->saveAudioData();
     this->m_configAccel->saveAccelData();
+    this->m_configSerial->saveSerialData();
     this->m_machine->saveMachine();
 
+    if (!this->m_machine->applyResourceLimits()) {
+        SystemUtils::showMessage(tr("Qtemu - Resource limits"),
+                                 tr("<p>Cannot change the limits of the running machine</p>"
+                                    "<p>The new limits are used in the next launch</p>"),
+                                 QMessageBox::Warning);
+    }
+
     this->m_osWidget->setText(this->m_machine->getName());
     emit(saveMachineSettingsSignal(this->m_machine->getUuid())); // For reload labels in mainwindow ;)
 
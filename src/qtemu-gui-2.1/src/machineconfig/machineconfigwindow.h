@@ -57,6 +57,7 @@
 #include "machineconfignetwork.h"
 #include "machineconfigaudio.h"
 #include "machineconfigaccel.h"
+#include "machineconfigserial.h"
 
 class MachineConfigWindow : public QWidget {
     Q_OBJECT
@@ -101,6 +102,7 @@ class MachineConfigWindow : public QWidget {
         MachineConfigNetwork *m_configNetwork;
         MachineConfigAudio *m_configAudio;
         MachineConfigAccel *m_configAccel;
+        MachineConfigSerial *m_configSerial;
 
         Machine *m_machine;
         QListWidgetItem *m_osWidget;
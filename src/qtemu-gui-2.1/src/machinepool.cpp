@@ -0,0 +1,282 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "machinepool.h"
+
+/**
+ * @brief Pool of prewarmed machines
+ * @param machines, machines of QtEmu
+ * @param QEMUGlobalObject, QEMU global object
+ * @param parent, parent object
+ *
+ * Keeps the pooled machines launched with the CPUs paused, so
+ * starting them only continues the CPUs. The pooled templates
+ * keep their number of pooled machines, a started machine leaves
+ * the pool and a new one is created from the template. The pool
+ * is refilled in background, one machine at a time and only when
+ * the host has room, the user launches always come first.
+ * The Pool settings group has:
+ * enabled: keep the pooled machines prewarmed
+ * interval: ms between two refills
+ * maxFailures: failed prewarms after which a machine is not prewarmed again
+ */
+MachinePool::MachinePool(const QList<Machine *> *machines,
+                         QEMU *QEMUGlobalObject,
+                         QObject *parent) : QObject(parent)
+{
+    this->m_machines = machines;
+    this->m_QEMUGlobalObject = QEMUGlobalObject;
+
+    this->m_batchProvisioner = new BatchProvisioner(QEMUGlobalObject, this);
+    connect(m_batchProvisioner, &BatchProvisioner::finishedSignal,
+            this, &MachinePool::provisionFinished);
+
+    this->m_refillTimer = new QTimer(this);
+    connect(m_refillTimer, &QTimer::timeout,
+            this, &MachinePool::refillPool);
+
+    connect(QEMUGlobalObject->admissionController(), &AdmissionController::admissionSignal,
+            this, &MachinePool::machineAdmission);
+
+    this->loadSettings();
+
+    qDebug() << "MachinePool object created";
+}
+
+MachinePool::~MachinePool()
+{
+    qDebug() << "MachinePool object destroyed";
+}
+
+/**
+ * @brief Load the settings of the pool
+ *
+ * Load the settings of the pool and start
+ * or stop the refills
+ */
+void MachinePool::loadSettings()
+{
+    QSettings settings;
+    settings.beginGroup("Pool");
+    bool enabled = settings.value("enabled", true).toBool();
+    this->m_interval = qMax(1000, settings.value("interval", 10000).toInt());
+    this->m_maxFailures = qMax(1, settings.value("maxFailures", 3).toInt());
+    settings.endGroup();
+
+    if (enabled) {
+        this->m_refillTimer->start(this->m_interval);
+    } else {
+        this->m_refillTimer->stop();
+    }
+}
+
+/**
+ * @brief Get the prewarmed machines
+ * @return number of machines launched and paused
+ *
+ * Get the prewarmed machines
+ */
+int MachinePool::prewarmedCount() const
+{
+    int prewarmed = 0;
+    foreach (Machine *machine, *this->m_machines) {
+        if (machine->isPrewarmed()) {
+            ++prewarmed;
+        }
+    }
+
+    return prewarmed;
+}
+
+/**
+ * @brief Refill the pool
+ *
+ * Release the started machines of the templates, create
+ * the missing machines of the templates and prewarm
+ * the next pooled machine
+ */
+void MachinePool::refillPool()
+{
+    this->releaseTakenMachines();
+    this->refillTemplates();
+    this->prewarmNextMachine();
+}
+
+/**
+ * @brief Release the started machines of the templates
+ *
+ * A started machine of a pooled template becomes a
+ * normal machine and its template creates another one
+ */
+void MachinePool::releaseTakenMachines()
+{
+    foreach (Machine *machine, *this->m_machines) {
+        if (!machine->getPooled() || machine->getState() == Machine::Stopped) {
+            continue;
+        }
+
+        this->m_prewarmFailures.remove(machine->getUuid());
+
+        if (machine->getPoolTemplate().isEmpty()) {
+            continue;
+        }
+
+        Logger::logMachineAction(machine->getPath(), machine->getName(), machine->getUuid(),
+                                 "Machine taken from the pool of the template " + machine->getPoolTemplate());
+
+        machine->setPooled(false);
+        machine->setPoolTemplate(QString());
+        machine->saveMachine();
+    }
+}
+
+/**
+ * @brief Create the missing machines of the templates
+ *
+ * Create the machines of one pooled template
+ * with less machines than its pool size
+ */
+void MachinePool::refillTemplates()
+{
+    if (this->m_batchProvisioner->isRunning()) {
+        return;
+    }
+
+    foreach (const QString &templateName, TemplateLibrary::templateNames()) {
+        int poolSize = TemplateLibrary::poolSize(templateName);
+        if (poolSize < 1 || this->m_provisionFailures.value(templateName) >= this->m_maxFailures) {
+            continue;
+        }
+
+        int pooledMachines = 0;
+        foreach (Machine *machine, *this->m_machines) {
+            if (machine->getPooled() && machine->getPoolTemplate() == templateName) {
+                ++pooledMachines;
+            }
+        }
+
+        if (pooledMachines >= poolSize) {
+            continue;
+        }
+
+        QJsonObject pool;
+        pool["enabled"]  = true;
+        pool["template"] = templateName;
+
+        QJsonObject overrides;
+        overrides["pool"] = pool;
+
+        this->m_provisioningTemplate = templateName;
+        this->m_batchProvisioner->setMachineOverrides(overrides);
+        this->m_batchProvisioner->provision(templateName, poolSize - pooledMachines,
+                                            templateName + "-pool", BatchProvisioner::Overlay);
+        return;
+    }
+}
+
+/**
+ * @brief Prewarm the next pooled machine
+ *
+ * Launch paused one stopped pooled machine that fits in the host
+ */
+void MachinePool::prewarmNextMachine()
+{
+    AdmissionController *admissionController = this->m_QEMUGlobalObject->admissionController();
+
+    foreach (Machine *machine, *this->m_machines) {
+        if (!machine->getPooled() ||
+            machine->getState() != Machine::Stopped ||
+            machine->isPrewarmed() ||
+            this->m_prewarmFailures.value(machine->getUuid()) >= this->m_maxFailures ||
+            !admissionController->fits(machine)) {
+            continue;
+        }
+
+        connect(machine, &Machine::prewarmFinishedSignal,
+                this, &MachinePool::prewarmFinished, Qt::UniqueConnection);
+
+        if (!machine->prewarmMachine(this->m_QEMUGlobalObject)) {
+            this->m_prewarmFailures[machine->getUuid()] += 1;
+        }
+        return;
+    }
+}
+
+/**
+ * @brief A prewarmed machine finished
+ * @param discarded, true if the machine was discarded
+ *
+ * A prewarmed machine that finishes by itself failed
+ */
+void MachinePool::prewarmFinished(bool discarded)
+{
+    Machine *machine = qobject_cast<Machine *>(this->sender());
+    if (machine == nullptr || discarded) {
+        return;
+    }
+
+    this->m_prewarmFailures[machine->getUuid()] += 1;
+    qDebug() << "Prewarm of" << machine->getName() << "failed"
+             << this->m_prewarmFailures.value(machine->getUuid()) << "times";
+}
+
+/**
+ * @brief A launch didn't fit in the host
+ * @param machine, machine launched
+ * @param decision, decision of the admission controller
+ * @param reason, missing resources
+ *
+ * Discard one prewarmed machine to make room for the launch
+ */
+void MachinePool::machineAdmission(Machine *machine,
+                                   AdmissionController::Decision decision,
+                                   const QString &reason)
+{
+    Q_UNUSED(decision);
+    Q_UNUSED(reason);
+
+    foreach (Machine *prewarmedMachine, *this->m_machines) {
+        if (prewarmedMachine != machine && prewarmedMachine->isPrewarmed()) {
+            prewarmedMachine->discardPrewarm();
+            return;
+        }
+    }
+}
+
+/**
+ * @brief The machines of a template are created
+ * @param provisioned, true if the machines are created
+ * @param names, names of the new machines
+ * @param error, reason of the failure
+ *
+ * The new machines are added to the pool when QtEmu reloads the catalog
+ */
+void MachinePool::provisionFinished(bool provisioned, const QStringList &names, const QString &error)
+{
+    if (!provisioned) {
+        this->m_provisionFailures[this->m_provisioningTemplate] += 1;
+        qDebug() << "Cannot refill the pool of the template" << this->m_provisioningTemplate << error;
+        return;
+    }
+
+    qDebug() << "Pool of the template" << this->m_provisioningTemplate << "refilled with" << names;
+    emit(machinesProvisionedSignal());
+}
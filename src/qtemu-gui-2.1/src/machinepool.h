@@ -0,0 +1,84 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MACHINEPOOL_H
+#define MACHINEPOOL_H
+
+// Qt
+#include <QObject>
+#include <QTimer>
+#include <QSettings>
+#include <QHash>
+#include <QJsonObject>
+
+#include <QDebug>
+
+// Local
+#include "machine.h"
+#include "templates/batchprovisioner.h"
+
+class MachinePool : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit MachinePool(const QList<Machine *> *machines,
+                             QEMU *QEMUGlobalObject,
+                             QObject *parent = nullptr);
+        ~MachinePool();
+
+        void loadSettings();
+        int prewarmedCount() const;
+
+    signals:
+        void machinesProvisionedSignal();
+
+    public slots:
+        void refillPool();
+
+    private slots:
+        void prewarmFinished(bool discarded);
+        void machineAdmission(Machine *machine,
+                              AdmissionController::Decision decision,
+                              const QString &reason);
+        void provisionFinished(bool provisioned, const QStringList &names, const QString &error);
+
+    protected:
+
+    private:
+        const QList<Machine *> *m_machines;
+        QEMU *m_QEMUGlobalObject;
+        QTimer *m_refillTimer;
+        BatchProvisioner *m_batchProvisioner;
+
+        QHash<QString, int> m_prewarmFailures;
+        QHash<QString, int> m_provisionFailures;
+        QString m_provisioningTemplate;
+
+        // Settings
+        int m_interval;
+        int m_maxFailures;
+
+        // Methods
+        void releaseTakenMachines();
+        void refillTemplates();
+        void prewarmNextMachine();
+};
+
+#endif // MACHINEPOOL_H
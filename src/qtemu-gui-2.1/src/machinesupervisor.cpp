@@ -0,0 +1,342 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "machinesupervisor.h"
+
+// Crash records kept in the crashes.json file of a machine
+static const int MAX_CRASH_RECORDS = 100;
+
+/**
+ * @brief Supervisor of a machine
+ * @param machinePath, path of the machine
+ * @param parent, parent object
+ *
+ * Decides if a finished machine is launched again, following its
+ * restart policy. The restarts wait an exponential backoff and stop
+ * when the machine crashes too often, a crash loop. Every crash is
+ * saved in the crashes.json file of the machine with the last lines
+ * of the standard error of QEMU. The Supervisor settings group has:
+ * backoffInitial: ms before the first restart
+ * backoffMax: maximum ms before a restart
+ * crashLoopCount: crashes inside the window that stop the restarts
+ * crashLoopWindow: seconds of the window
+ * errorLines: lines of the standard error saved with a crash
+ */
+MachineSupervisor::MachineSupervisor(const QString &machinePath,
+                                     QObject *parent) : QObject(parent)
+{
+    this->m_crashesFilePath = QDir(machinePath).filePath("crashes.json");
+    this->m_restartPolicy = MachineSupervisor::Never;
+    this->m_stopRequested = false;
+    this->m_consecutiveCrashes = 0;
+
+    this->m_restartTimer = new QTimer(this);
+    this->m_restartTimer->setSingleShot(true);
+    connect(m_restartTimer, &QTimer::timeout,
+            this, &MachineSupervisor::restartSignal);
+
+    this->loadSettings();
+
+    qDebug() << "MachineSupervisor object created";
+}
+
+MachineSupervisor::~MachineSupervisor()
+{
+    qDebug() << "MachineSupervisor object destroyed";
+}
+
+/**
+ * @brief Get the policy from the saved string
+ * @param policy, name of the policy
+ * @return the policy, Never if unknown
+ *
+ * Get the policy from the saved string
+ */
+MachineSupervisor::RestartPolicy MachineSupervisor::policyFromString(const QString &policy)
+{
+    if (policy == "on-failure") {
+        return MachineSupervisor::OnFailure;
+    } else if (policy == "always") {
+        return MachineSupervisor::Always;
+    }
+
+    return MachineSupervisor::Never;
+}
+
+/**
+ * @brief Get the string saved for the policy
+ * @param policy, restart policy
+ * @return name of the policy
+ *
+ * Get the string saved for the policy
+ */
+QString MachineSupervisor::policyToString(MachineSupervisor::RestartPolicy policy)
+{
+    switch (policy) {
+        case MachineSupervisor::OnFailure:
+            return "on-failure";
+        case MachineSupervisor::Always:
+            return "always";
+        default:
+            return "never";
+    }
+}
+
+/**
+ * @brief Get the restart policy
+ * @return restart policy
+ *
+ * Get the restart policy
+ */
+MachineSupervisor::RestartPolicy MachineSupervisor::restartPolicy() const
+{
+    return this->m_restartPolicy;
+}
+
+/**
+ * @brief Set the restart policy
+ * @param policy, restart policy
+ *
+ * Set the restart policy, a pending restart is cancelled
+ * if the machine is not restarted anymore
+ */
+void MachineSupervisor::setRestartPolicy(MachineSupervisor::RestartPolicy policy)
+{
+    this->m_restartPolicy = policy;
+
+    if (policy == MachineSupervisor::Never) {
+        this->m_restartTimer->stop();
+    }
+}
+
+/**
+ * @brief Get the number of crashes
+ * @return crashes saved in the crashes.json file
+ *
+ * Get the number of crashes
+ */
+int MachineSupervisor::crashCount() const
+{
+    QFile crashesFile(this->m_crashesFilePath);
+    if (!crashesFile.open(QFile::ReadOnly)) {
+        return 0;
+    }
+
+    return QJsonDocument::fromJson(crashesFile.readAll()).object()["crashCount"].toInt();
+}
+
+/**
+ * @brief Get the crash records
+ * @return last crashes of the machine, the oldest first
+ *
+ * Get the crash records
+ */
+QJsonArray MachineSupervisor::crashRecords() const
+{
+    QFile crashesFile(this->m_crashesFilePath);
+    if (!crashesFile.open(QFile::ReadOnly)) {
+        return QJsonArray();
+    }
+
+    return QJsonDocument::fromJson(crashesFile.readAll()).object()["crashes"].toArray();
+}
+
+/**
+ * @brief Know if a restart is pending
+ * @return true if the machine is waiting the backoff
+ *
+ * Know if a restart is pending
+ */
+bool MachineSupervisor::isRestartPending() const
+{
+    return this->m_restartTimer->isActive();
+}
+
+/**
+ * @brief Append the standard error of QEMU
+ * @param errorOutput, data read from the standard error
+ *
+ * Only the last errorLines lines are kept
+ */
+void MachineSupervisor::appendErrorOutput(const QByteArray &errorOutput)
+{
+    QByteArray errorData = this->m_partialErrorLine + errorOutput;
+    QList<QByteArray> lines = errorData.split('\n');
+
+    // The last line is incomplete until its newline arrives
+    this->m_partialErrorLine = lines.takeLast();
+
+    for (const QByteArray &line : lines) {
+        this->m_errorLines.append(QString::fromLocal8Bit(line).trimmed());
+    }
+
+    while (this->m_errorLines.size() > this->m_errorLinesCount) {
+        this->m_errorLines.removeFirst();
+    }
+}
+
+/**
+ * @brief The machine is launched
+ *
+ * Reset the standard error of the previous run
+ */
+void MachineSupervisor::machineLaunched()
+{
+    this->loadSettings();
+
+    this->m_restartTimer->stop();
+    this->m_stopRequested = false;
+    this->m_errorLines.clear();
+    this->m_partialErrorLine.clear();
+}
+
+/**
+ * @brief The user asked to stop the machine
+ *
+ * A stopped machine is not restarted, whatever the policy
+ */
+void MachineSupervisor::stopRequested()
+{
+    this->m_stopRequested = true;
+    this->m_restartTimer->stop();
+}
+
+/**
+ * @brief The machine is finished
+ * @param exitCode, exit code of QEMU
+ * @param exitStatus, exit status of QEMU
+ * @param uptime, ms the machine was running
+ *
+ * Save the crash and schedule the restart
+ */
+void MachineSupervisor::machineFinished(int exitCode, QProcess::ExitStatus exitStatus, qint64 uptime)
+{
+    bool crashed = exitStatus == QProcess::CrashExit || exitCode != 0;
+
+    if (crashed) {
+        if (!this->m_partialErrorLine.isEmpty()) {
+            this->appendErrorOutput("\n");
+        }
+        this->saveCrash(exitCode, exitStatus, uptime);
+    }
+
+    bool restart = !this->m_stopRequested &&
+                   (this->m_restartPolicy == MachineSupervisor::Always ||
+                    (this->m_restartPolicy == MachineSupervisor::OnFailure && crashed));
+    if (!restart) {
+        return;
+    }
+
+    // A machine that ran longer than the window is healthy again
+    if (uptime > static_cast<qint64>(this->m_crashLoopWindow) * 1000) {
+        this->m_consecutiveCrashes = 0;
+    }
+
+    if (crashed) {
+        QDateTime now = QDateTime::currentDateTime();
+        this->m_recentCrashes.append(now);
+        while (!this->m_recentCrashes.isEmpty() &&
+               this->m_recentCrashes.first().secsTo(now) > this->m_crashLoopWindow) {
+            this->m_recentCrashes.removeFirst();
+        }
+
+        if (this->m_recentCrashes.size() >= this->m_crashLoopCount) {
+            qDebug() << "Crash loop detected," << this->m_recentCrashes.size() << "crashes";
+            emit crashLoopSignal(this->m_recentCrashes.size());
+            this->m_recentCrashes.clear();
+            this->m_consecutiveCrashes = 0;
+            return;
+        }
+    }
+
+    int delay = this->m_backoffInitial;
+    for (int i = 0; i < this->m_consecutiveCrashes && delay < this->m_backoffMax; ++i) {
+        delay *= 2;
+    }
+    delay = qMin(delay, this->m_backoffMax);
+
+    if (crashed) {
+        ++this->m_consecutiveCrashes;
+    }
+
+    this->m_restartTimer->start(delay);
+    emit restartScheduledSignal(delay);
+}
+
+/**
+ * @brief Load the supervisor settings
+ *
+ * Load the supervisor settings
+ */
+void MachineSupervisor::loadSettings()
+{
+    QSettings settings;
+    settings.beginGroup("Supervisor");
+    this->m_backoffInitial = qMax(100, settings.value("backoffInitial", 1000).toInt());
+    this->m_backoffMax = qMax(this->m_backoffInitial, settings.value("backoffMax", 60000).toInt());
+    this->m_crashLoopCount = qMax(1, settings.value("crashLoopCount", 5).toInt());
+    this->m_crashLoopWindow = qMax(1, settings.value("crashLoopWindow", 300).toInt());
+    this->m_errorLinesCount = qMax(0, settings.value("errorLines", 50).toInt());
+    settings.endGroup();
+}
+
+/**
+ * @brief Save a crash
+ * @param exitCode, exit code of QEMU
+ * @param exitStatus, exit status of QEMU
+ * @param uptime, ms the machine was running
+ *
+ * Save a crash in the crashes.json file
+ */
+void MachineSupervisor::saveCrash(int exitCode, QProcess::ExitStatus exitStatus, qint64 uptime)
+{
+    QJsonObject crashesObject;
+
+    QFile crashesFile(this->m_crashesFilePath);
+    if (crashesFile.open(QFile::ReadOnly)) {
+        crashesObject = QJsonDocument::fromJson(crashesFile.readAll()).object();
+        crashesFile.close();
+    }
+
+    QJsonObject crash;
+    crash["time"]       = QDateTime::currentDateTime().toString(Qt::ISODate);
+    crash["exitCode"]   = exitCode;
+    crash["exitStatus"] = exitStatus == QProcess::CrashExit ? "crash" : "normal";
+    crash["uptime"]     = uptime;
+    crash["stderr"]     = QJsonArray::fromStringList(this->m_errorLines);
+
+    QJsonArray crashes = crashesObject["crashes"].toArray();
+    crashes.append(crash);
+    while (crashes.size() > MAX_CRASH_RECORDS) {
+        crashes.removeFirst();
+    }
+
+    crashesObject["crashCount"] = crashesObject["crashCount"].toInt() + 1;
+    crashesObject["crashes"] = crashes;
+
+    QSaveFile saveFile(this->m_crashesFilePath);
+    if (!saveFile.open(QFile::WriteOnly)) {
+        qDebug() << "Cannot save the crash" << this->m_crashesFilePath;
+        return;
+    }
+    saveFile.write(QJsonDocument(crashesObject).toJson());
+    saveFile.commit();
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MACHINESUPERVISOR_H
+#define MACHINESUPERVISOR_H
+
+// Qt
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+#include <QSettings>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+#include <QVector>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <QDebug>
+
+class MachineSupervisor : public QObject {
+    Q_OBJECT
+
+    public:
+        enum RestartPolicy {
+            Never, OnFailure, Always
+        };
+
+        explicit MachineSupervisor(const QString &machinePath,
+                                   QObject *parent = nullptr);
+        ~MachineSupervisor();
+
+        static RestartPolicy policyFromString(const QString &policy);
+        static QString policyToString(RestartPolicy policy);
+
+        RestartPolicy restartPolicy() const;
+        void setRestartPolicy(RestartPolicy policy);
+
+        int crashCount() const;
+        QJsonArray crashRecords() const;
+        bool isRestartPending() const;
+
+        void appendErrorOutput(const QByteArray &errorOutput);
+        void machineLaunched();
+        void stopRequested();
+        void machineFinished(int exitCode, QProcess::ExitStatus exitStatus, qint64 uptime);
+
+    signals:
+        void restartSignal();
+        void restartScheduledSignal(int delay);
+        void crashLoopSignal(int crashes);
+
+    public slots:
+
+    private slots:
+
+    protected:
+
+    private:
+        QString m_crashesFilePath;
+        RestartPolicy m_restartPolicy;
+        bool m_stopRequested;
+
+        QStringList m_errorLines;
+        QByteArray m_partialErrorLine;
+
+        QVector<QDateTime> m_recentCrashes;
+        int m_consecutiveCrashes;
+        QTimer *m_restartTimer;
+
+        // Settings
+        int m_backoffInitial;
+        int m_backoffMax;
+        int m_crashLoopCount;
+        int m_crashLoopWindow;
+        int m_errorLinesCount;
+
+        // Methods
+        void loadSettings();
+        void saveCrash(int exitCode, QProcess::ExitStatus exitStatus, qint64 uptime);
+};
+
+#endif // MACHINESUPERVISOR_H
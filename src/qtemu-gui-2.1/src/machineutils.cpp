@@ -47,14 +47,11 @@ QJsonObject MachineUtils::readMachineFile(QString machinePath)
     // TODO: Move all to generic function to check if file can be opened or readed
     QFile machineFile(machinePath);
     if (!machineFile.open(QFile::ReadOnly)) {
-        QMessageBox *machinePathMessageBox = new QMessageBox();
-        machinePathMessageBox->setWindowTitle(tr("Qtemu - Critical error"));
-        machinePathMessageBox->setIcon(QMessageBox::Critical);
-        machinePathMessageBox->setWindowIcon(QIcon::fromTheme("qtemu", QIcon(":/images/qtemu.png")));
-        machinePathMessageBox->setText(tr(qPrintable(QString("<p>Cannot load the machine</p>"
-                                                               "<p>Cannot open the <strong>%1</strong> file. "
-                                                               "Please ensure that the file exists and it's readable</p>").arg(machinePath))));
-        machinePathMessageBox->exec();
+        SystemUtils::showMessage(tr("Qtemu - Critical error"),
+                                 tr(qPrintable(QString("<p>Cannot load the machine</p>"
+                                                       "<p>Cannot open the <strong>%1</strong> file. "
+                                                       "Please ensure that the file exists and it's readable</p>").arg(machinePath))),
+                                 QMessageBox::Critical);
         return machineJSON;
     }
 
@@ -86,6 +83,11 @@ void MachineUtils::fillMachineObject(Machine *machine,
     QJsonObject bootObject = machineJSON["boot"].toObject();
     QJsonObject kernelObject = bootObject["kernelBoot"].toObject();
     QJsonArray mediaArray = machineJSON["media"].toArray();
+    QJsonObject serialObject = machineJSON["serial"].toObject();
+    QJsonObject readinessObject = machineJSON["readiness"].toObject();
+    QJsonObject balloonObject = machineJSON["balloon"].toObject();
+    QJsonObject poolObject = machineJSON["pool"].toObject();
+    QJsonObject cgroupObject = machineJSON["cgroup"].toObject();
 
     Boot *machineBoot = new Boot(machine);
     machineBoot->setBootMenu(bootObject["bootMenu"].toBool());
@@ -93,6 +95,7 @@ void MachineUtils::fillMachineObject(Machine *machine,
     machineBoot->setKernelPath(kernelObject["kernelPath"].toString());
     machineBoot->setInitrdPath(kernelObject["initrdPath"].toString());
     machineBoot->setKernelArgs(kernelObject["kernelArgs"].toString());
+    machineBoot->setFastBoot(kernelObject["fastBoot"].toBool());
     machineBoot->setBootOrder(MachineUtils::getMediaDevices(bootObject["bootOrder"].toArray()));
 
     for(int i = 0; i < mediaArray.size(); ++i) {
@@ -104,6 +107,13 @@ void MachineUtils::fillMachineObject(Machine *machine,
         media->setType(mediaObject["type"].toString());
         media->setDriveInterface(mediaObject["interface"].toString());
         media->setUuid(mediaObject["uuid"].toVariant().toUuid());
+
+        QJsonObject throttleObject = mediaObject["throttle"].toObject();
+        QStringList throttleKeys = Media::throttleKeys();
+        for (int j = 0; j < throttleKeys.size(); ++j) {
+            media->setThrottle(throttleKeys.at(j), throttleObject[throttleKeys.at(j)].toVariant().toLongLong());
+        }
+        media->setThrottleGroup(throttleObject["group"].toString());
         machine->addMedia(media);
     }
 
@@ -114,7 +124,43 @@ void MachineUtils::fillMachineObject(Machine *machine,
     machine->setType(machineJSON["type"].toString());
     machine->setDescription(machineJSON["description"].toString());
     machine->setRAM(machineJSON["RAM"].toInt());
+    machine->setHugePages(machineJSON["hugePages"].toBool());
+    machine->setMemMerge(machineJSON["memMerge"].toBool(true));
     machine->setUseNetwork(machineJSON["network"].toBool());
+
+    // Machines without network cards used one user mode card,
+    // with the default MAC address of QEMU
+    QJsonArray networkCardsArray = machineJSON["networkCards"].toArray();
+    if (!machineJSON.contains("networkCards") && machineJSON["network"].toBool()) {
+        QJsonObject cardObject;
+        cardObject["backend"] = "user";
+        cardObject["uuid"] = QUuid::createUuid().toString();
+        networkCardsArray.append(cardObject);
+    }
+
+    for (int i = 0; i < networkCardsArray.size(); ++i) {
+        QJsonObject cardObject = networkCardsArray[i].toObject();
+
+        NetworkCard *networkCard = new NetworkCard(machine);
+        networkCard->setBackend(cardObject["backend"].toString("user"));
+        networkCard->setModel(cardObject["model"].toString("virtio-net-pci"));
+        networkCard->setQueues(cardObject["queues"].toInt(1));
+        networkCard->setMACAddress(cardObject["MAC"].toString());
+        networkCard->setVhost(cardObject["vhost"].toBool(true));
+        networkCard->setIfname(cardObject["ifname"].toString());
+        networkCard->setBridge(cardObject["bridge"].toString("br0"));
+        networkCard->setSocketMode(cardObject["socketMode"].toString("listen"));
+        networkCard->setSocketAddress(cardObject["socketAddress"].toString());
+        networkCard->setLocalNetwork(cardObject["localNetwork"].toString());
+        networkCard->setUuid(cardObject["uuid"].toVariant().toUuid());
+        machine->addNetworkCard(networkCard);
+    }
+
+    QStringList portForwards;
+    foreach (const QJsonValue &rule, machineJSON["portForwards"].toArray()) {
+        portForwards.append(rule.toString());
+    }
+    machine->setPortForwards(portForwards);
     machine->setConfigPath(machineConfigPath);
     machine->setPath(machineJSON["path"].toString());
     machine->setUuid(machineJSON["uuid"].toString());
@@ -130,6 +176,28 @@ void MachineUtils::fillMachineObject(Machine *machine,
     machine->setAudio(MachineUtils::getSoundCards(machineJSON["audio"].toArray()));
     machine->setAccelerator(MachineUtils::getAccelerators(machineJSON["accelerator"].toArray()));
     machine->setBoot(machineBoot);
+    machine->setSerialCapture(serialObject["capture"].toBool(false));
+    machine->setSerialLogSize(serialObject["logSize"].toInt(1024));
+    machine->setBootReadinessMode(readinessObject["mode"].toString("none"));
+    machine->setBootReadinessPattern(readinessObject["pattern"].toString());
+    machine->setBootReadinessPort(readinessObject["port"].toInt());
+    machine->setRestartPolicy(machineJSON["restart"].toString("never"));
+    machine->setBalloon(balloonObject["enabled"].toBool(false));
+    machine->setBalloonMinimum(balloonObject["minimum"].toInt(256));
+    machine->setBalloonMaximum(balloonObject["maximum"].toInt(0));
+    machine->setPooled(poolObject["enabled"].toBool(false));
+    machine->setPoolTemplate(poolObject["template"].toString());
+    machine->setCGroup(cgroupObject["enabled"].toBool(false));
+    machine->setCPUMax(cgroupObject["cpuMax"].toInt(0));
+    machine->setCPUWeight(cgroupObject["cpuWeight"].toInt(100));
+    machine->setMemoryMax(cgroupObject["memoryMax"].toInt(0));
+    machine->setMemoryHigh(cgroupObject["memoryHigh"].toInt(0));
+
+    QStringList IOMax;
+    foreach (const QJsonValue &limit, cgroupObject["ioMax"].toArray()) {
+        IOMax.append(limit.toString());
+    }
+    machine->setIOMax(IOMax);
 }
 
 /**
@@ -200,6 +268,23 @@ bool MachineUtils::deleteMachine(const QUuid machineUuid)
     return removedDirectory;
 }
 
+/**
+ * @brief Clean the output of the QEMU monitor
+ * @param rawOutput, data read from the monitor
+ * @return the last line written by the monitor, without the terminal escapes
+ *
+ * Clean the output of the QEMU monitor
+ */
+QString MachineUtils::cleanMonitorOutput(const QByteArray &rawOutput)
+{
+    QString standardOut = rawOutput;
+    QStringList splitStandardOut = standardOut.split("[K");
+    QString cleanStandardOut = splitStandardOut.last().remove(QRegExp("\\[[KD]."));
+
+    // Remove space characters, included \r \t \n
+    return cleanStandardOut.simplified();
+}
+
 /**
  * @brief Get the sound cards
  * @param soundCardsArray, json array with the sound cards of the machine
@@ -51,6 +51,7 @@ class MachineUtils : public QObject {
         static void fillMachineObject(Machine *machine,
                                       QJsonObject machineJSON, QString machineConfigPath);
         static bool deleteMachine(const QUuid machineUuid);
+        static QString cleanMonitorOutput(const QByteArray &rawOutput);
 
         static QStringList getSoundCards(QJsonArray soundCardsArray);
         static QStringList getAccelerators(QJsonArray acceleratorsArray);
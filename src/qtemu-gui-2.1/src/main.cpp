@@ -25,6 +25,8 @@
 #include <QLibraryInfo>
 #include <QDir>
 #include <QCoreApplication>
+#include <QTimer>
+#include <QLoggingCategory>
 
 // C++ standard library
 #include <iostream>
@@ -34,9 +36,44 @@
 #include "qemu.h"
 #include "utils/logger.h"
 #include "utils/firstrunwizard.h"
+#include "utils/tracer.h"
+#include "commandline.h"
 
 int main(int argc, char *argv[])
 {
+    // Command line mode, --list, --start, --stop and --daemon, without GUI
+    if (CommandLine::isCommand(argc, argv)) {
+        QCoreApplication qtemuApp(argc, argv);
+        qtemuApp.setApplicationName("QtEmu");
+        qtemuApp.setApplicationVersion("2.1");
+        qtemuApp.setOrganizationName("QtEmu");
+        qtemuApp.setOrganizationDomain("https://www.qtemu.org");
+
+        QLoggingCategory::setFilterRules("*.debug=false");
+
+        CommandLine commandLine;
+        return commandLine.exec(qtemuApp.arguments());
+    }
+
+    // Startup trace, --trace-startup[=file]
+    bool traceStartup = false;
+    QString traceFilePath;
+    for (int i = 1; i < argc; ++i) {
+        QString argument = QString::fromLocal8Bit(argv[i]);
+        if (argument == "--trace-startup") {
+            traceStartup = true;
+        } else if (argument.startsWith("--trace-startup=")) {
+            traceStartup = true;
+            traceFilePath = argument.section('=', 1);
+        }
+    }
+
+    if (traceStartup) {
+        Tracer::start();
+    }
+
+    Tracer::addInstantEvent("Process started", "startup");
+
     QApplication qtemuApp(argc, argv);
     qtemuApp.setApplicationName("QtEmu");
     qtemuApp.setApplicationVersion("2.1");
@@ -63,22 +100,25 @@ int main(int argc, char *argv[])
     QSettings settings;
 
     // Data folder
-    settings.beginGroup("DataFolder");
-    QDir dataDirectory;
-    QString dataDirectoryPath = QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/");
-    QString dataDirectoryLogs = QDir::toNativeSeparators(dataDirectoryPath + "logs");
-
-    if (!dataDirectory.exists(dataDirectoryPath)) {
-        dataDirectory.mkdir(dataDirectoryPath);
-
-        if (!dataDirectory.exists(dataDirectoryLogs)) {
-            dataDirectory.mkdir(dataDirectoryLogs);
+    {
+        QTEMU_TRACE_SCOPE("Data folder");
+        settings.beginGroup("DataFolder");
+        QDir dataDirectory;
+        QString dataDirectoryPath = QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/");
+        QString dataDirectoryLogs = QDir::toNativeSeparators(dataDirectoryPath + "logs");
+
+        if (!dataDirectory.exists(dataDirectoryPath)) {
+            dataDirectory.mkdir(dataDirectoryPath);
+
+            if (!dataDirectory.exists(dataDirectoryLogs)) {
+                dataDirectory.mkdir(dataDirectoryLogs);
+            }
         }
-    }
 
-    settings.setValue("QtEmuData", dataDirectoryPath);
-    settings.setValue("QtEmuLogs", dataDirectoryLogs);
-    settings.endGroup();
+        settings.setValue("QtEmuData", dataDirectoryPath);
+        settings.setValue("QtEmuLogs", dataDirectoryLogs);
+        settings.endGroup();
+    }
 
     // Translations
     QTranslator translatorQt;
@@ -97,38 +137,44 @@ int main(int argc, char *argv[])
         language = QLocale::system().name();
     }
 
-    languageFile = QString("qt_%1").arg(language);
+    {
+        QTEMU_TRACE_SCOPE("Qt translation");
+        languageFile = QString("qt_%1").arg(language);
 
-    std::cout << "\n"
-              << "Using Qt translation "
-              << QLibraryInfo::location(QLibraryInfo::TranslationsPath).toStdString()
-              << "/"
-              << languageFile.toStdString()
-              << "\n";
+        std::cout << "\n"
+                  << "Using Qt translation "
+                  << QLibraryInfo::location(QLibraryInfo::TranslationsPath).toStdString()
+                  << "/"
+                  << languageFile.toStdString()
+                  << "\n";
 
-    languageLoaded = translatorQt.load(languageFile, QLibraryInfo::location(QLibraryInfo::TranslationsPath));
+        languageLoaded = translatorQt.load(languageFile, QLibraryInfo::location(QLibraryInfo::TranslationsPath));
 
-    if (languageLoaded) {
-        std::cout << "Language loaded";
-        qtemuApp.installTranslator(&translatorQt);
-    } else {
-        std::cout << "Language unavailable";
+        if (languageLoaded) {
+            std::cout << "Language loaded";
+            qtemuApp.installTranslator(&translatorQt);
+        } else {
+            std::cout << "Language unavailable";
+        }
     }
 
-    languageFile = QString(":/translations/qtemu_%1").arg(language);
+    {
+        QTEMU_TRACE_SCOPE("QtEmu translation");
+        languageFile = QString(":/translations/qtemu_%1").arg(language);
 
-    std::cout << "\n"
-              << "Using QtEmu translation "
-              << languageFile.toStdString()
-              << "\n";
+        std::cout << "\n"
+                  << "Using QtEmu translation "
+                  << languageFile.toStdString()
+                  << "\n";
 
-    languageLoaded = translatorQtEmu.load(languageFile);
+        languageLoaded = translatorQtEmu.load(languageFile);
 
-    if (languageLoaded) {
-        std::cout << "Language loaded";
-        qtemuApp.installTranslator(&translatorQtEmu);
-    } else {
-        std::cout << "Language unavailable";
+        if (languageLoaded) {
+            std::cout << "Language loaded";
+            qtemuApp.installTranslator(&translatorQtEmu);
+        } else {
+            std::cout << "Language unavailable";
+        }
     }
 
     // Launch first run winzard
@@ -138,6 +184,7 @@ int main(int argc, char *argv[])
     settings.sync(); // sync settings
 
     if (runFirstRunWizard) {
+        QTEMU_TRACE_SCOPE("First run wizard");
         FirstRunWizard *firstRunWizard = new FirstRunWizard(nullptr);
         firstRunWizard->show();
         firstRunWizard->exec();
@@ -149,15 +196,42 @@ int main(int argc, char *argv[])
     QString logMessage = "QtEmu started with PID\t";
     logMessage.append(QString::number(QCoreApplication::applicationPid()));
 
-    Logger::logQtemuAction(logMessage);
+    {
+        QTEMU_TRACE_SCOPE("Logger");
+        Logger::logQtemuAction(logMessage);
+    }
 
     std::cout << "\n";
     std::cout << QString("- Running with Qt v%1\n\n").arg(qVersion())
                                                      .toStdString();
     std::cout.flush();
 
+    qint64 mainWindowStart = Tracer::now();
     MainWindow qtemuWindow;
     qtemuWindow.show();
+    Tracer::addCompleteEvent("Main window", "startup", mainWindowStart, Tracer::now() - mainWindowStart);
+
+    // The startup finishes when the event loop runs for the first time
+    if (Tracer::isEnabled()) {
+        if (traceFilePath.isEmpty()) {
+            settings.beginGroup("DataFolder");
+            traceFilePath = QDir::toNativeSeparators(settings.value("QtEmuLogs").toString() + "/startup-trace.json");
+            settings.endGroup();
+        }
+
+        QTimer::singleShot(0, [=]() {
+            Tracer::addCompleteEvent("Startup", "startup", 0, Tracer::now());
+            if (Tracer::save(traceFilePath)) {
+                std::cout << "Startup trace saved in " << traceFilePath.toStdString() << "\n";
+                std::cout.flush();
+            }
+        });
+    }
+
+    int exitCode = qtemuApp.exec();
+
+    // Write the pending log records
+    Logger::stop();
 
-    return qtemuApp.exec();
+    return exitCode;
 }
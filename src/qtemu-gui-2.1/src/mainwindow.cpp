@@ -34,17 +34,47 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     this->setWindowIcon(QIcon::fromTheme("qtemu", QIcon(":/images/qtemu.png")));
     this->setMinimumSize(700, 500);
 
+    this->m_controlServer = nullptr;
+
     // Close the application when all windows are closed
     qApp->setQuitOnLastWindowClosed(true);
 
     QSettings settings;
 
+    QTEMU_TRACE_SCOPE("MainWindow");
+
     // Generate QEMU object
-    qemuGlobalObject = new QEMU(this);
+    {
+        QTEMU_TRACE_SCOPE("QEMU");
+        qemuGlobalObject = new QEMU(this);
+    }
 
-    m_configWindow = new ConfigWindow(qemuGlobalObject, this);
-    m_helpwidget  = new HelpWidget(this);
-    m_aboutwidget = new AboutWidget(this);
+    {
+        QTEMU_TRACE_SCOPE("ConfigWindow");
+        m_configWindow = new ConfigWindow(qemuGlobalObject, this);
+    }
+    {
+        QTEMU_TRACE_SCOPE("HelpWidget");
+        m_helpwidget  = new HelpWidget(this);
+    }
+    {
+        QTEMU_TRACE_SCOPE("AboutWidget");
+        m_aboutwidget = new AboutWidget(this);
+    }
+    {
+        QTEMU_TRACE_SCOPE("MemorySharingWidget");
+        m_ksmMonitor = new KSMMonitor(&this->m_machinesList, this->qemuGlobalObject, this);
+        m_memorySharingWidget = new MemorySharingWidget(m_ksmMonitor, this);
+    }
+    {
+        QTEMU_TRACE_SCOPE("LocalNetworksWidget");
+        m_localNetworksWidget = new LocalNetworksWidget(&this->m_machinesList, this);
+    }
+    {
+        QTEMU_TRACE_SCOPE("ProvisionWidget");
+        m_templateLibrary = new TemplateLibrary(this->qemuGlobalObject, this);
+        m_provisionWidget = new ProvisionWidget(this->qemuGlobalObject, this);
+    }
 
     // Prepare main layout
     m_osListWidget = new QListWidget(this);
@@ -66,6 +96,9 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     m_machineNetworkLabel  = new QLabel(this);
     m_machineMediaLabel    = new QLabel(this);
     m_machineMediaLabel->setWordWrap(true);
+    m_machineBootTimeLabel = new QLabel(this);
+    m_machineBootChangesLabel = new QLabel(this);
+    m_machineBootChangesLabel->setWordWrap(true);
 
     m_machineDetailsLayout = new QFormLayout();
     m_machineDetailsLayout->setSpacing(7);
@@ -81,15 +114,26 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     m_machineDetailsLayout->addRow(tr("Accelerator") + ":", m_machineAccelLabel);
     m_machineDetailsLayout->addRow(tr("Network") + ":", m_machineNetworkLabel);
     m_machineDetailsLayout->addRow(tr("Media") + ":", m_machineMediaLabel);
+    m_machineDetailsLayout->addRow(tr("Boot time") + ":", m_machineBootTimeLabel);
+    m_machineDetailsLayout->addRow(tr("Boot changes") + ":", m_machineBootChangesLabel);
 
     m_machineDetailsGroup = new QGroupBox(tr("Machine details"), this);
     m_machineDetailsGroup->setAlignment(Qt::AlignHCenter);
     m_machineDetailsGroup->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     m_machineDetailsGroup->setLayout(m_machineDetailsLayout);
 
+    // Display of the running machine
+    m_machineDisplay = new VNCViewer(this);
+
+    m_machineDisplayArea = new QScrollArea(this);
+    m_machineDisplayArea->setAlignment(Qt::AlignCenter);
+    m_machineDisplayArea->setBackgroundRole(QPalette::Dark);
+    m_machineDisplayArea->setWidget(m_machineDisplay);
+
     m_osDetailsStackedWidget = new QStackedWidget(this);
     m_osDetailsStackedWidget->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::MinimumExpanding);
     m_osDetailsStackedWidget->addWidget(m_machineDetailsGroup);
+    m_osDetailsStackedWidget->addWidget(m_machineDisplayArea);
 
     m_containerLayout = new QHBoxLayout();
     m_containerLayout->addWidget(m_osListWidget);
@@ -111,11 +155,50 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     this->createMenus();
     this->createToolBars();
 
+    // Watch the machines files to reload the changes made outside QtEmu
+    settings.beginGroup("DataFolder");
+    QString dataDirectoryPath = settings.value("QtEmuData",
+                                               QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/")).toString();
+    settings.endGroup();
+
+    m_machineWatcher = new MachineWatcher(dataDirectoryPath.append("qtemu.json"), this);
+    connect(m_machineWatcher, &MachineWatcher::machinesFileChangedSignal,
+            this, &MainWindow::reloadMachinesFile);
+    connect(m_machineWatcher, &MachineWatcher::machineConfigChangedSignal,
+            this, &MainWindow::reloadMachineConfig);
+
     // Load all the machines
     this->m_osListWidget->setCurrentRow(0);
-    this->loadMachines();
+    {
+        QTEMU_TRACE_SCOPE("Load machines");
+        this->loadMachines();
+    }
     this->loadUI(m_osListWidget->count());
 
+    // Serve the metrics of the machines
+    m_metricsExporter = new MetricsExporter(&this->m_machinesList, this);
+
+    // Control the machines from scripts
+    m_controlServer = new ControlServer(&this->m_machinesList, this->qemuGlobalObject, this);
+
+    connect(m_templateLibrary, &TemplateLibrary::templateSavedSignal,
+            this, &MainWindow::machineTemplateSaved);
+
+    connect(m_provisionWidget, &ProvisionWidget::machinesProvisionedSignal,
+            this, &MainWindow::reloadMachinesFile);
+
+    // Move the memory between the machines with a balloon
+    m_balloonManager = new BalloonManager(&this->m_machinesList, this->qemuGlobalObject, this);
+
+    // Keep the pooled machines launched and paused
+    m_machinePool = new MachinePool(&this->m_machinesList, this->qemuGlobalObject, this);
+    connect(m_machinePool, &MachinePool::machinesProvisionedSignal,
+            this, &MainWindow::reloadMachinesFile);
+
+    // The message boxes don't block the launch of the machine
+    connect(qemuGlobalObject->admissionController(), &AdmissionController::admissionSignal,
+            this, &MainWindow::machineAdmission, Qt::QueuedConnection);
+
     // Connect
     connect(m_osListWidget, &QListWidget::itemClicked,
             this, &MainWindow::changeMachine);
@@ -152,6 +235,12 @@ void MainWindow::createMenus()
     m_machineMenu->addAction(m_settingsMachineAction);
     m_machineMenu->addAction(m_exportMachineAction);
     m_machineMenu->addAction(m_removeMachineAction);
+    m_machineMenu->addSeparator();
+    m_machineMenu->addAction(m_saveTemplateAction);
+    m_machineMenu->addAction(m_provisionAction);
+    m_machineMenu->addSeparator();
+    m_machineMenu->addAction(m_memorySharingAction);
+    m_machineMenu->addAction(m_localNetworksAction);
 
     // Help
     m_helpMenu = new QMenu(tr("&Help"), this);
@@ -234,6 +323,34 @@ void MainWindow::createMenusActions()
     connect(m_removeMachineAction, &QAction::triggered,
             this, &MainWindow::deleteMachine);
 
+    m_saveTemplateAction = new QAction(QIcon::fromTheme("document-save",
+                                                        QIcon(QPixmap(":/images/icons/breeze/32x32/document-save.svg"))),
+                                       tr("Save as template"),
+                                       this);
+    connect(m_saveTemplateAction, &QAction::triggered,
+            this, &MainWindow::saveMachineTemplate);
+
+    m_provisionAction = new QAction(QIcon::fromTheme("project-development-new-template",
+                                                     QIcon(QPixmap(":/images/icons/breeze/32x32/project-development-new-template.svg"))),
+                                    tr("Create from template"),
+                                    this);
+    connect(m_provisionAction, &QAction::triggered,
+            m_provisionWidget, &QWidget::show);
+
+    m_memorySharingAction = new QAction(QIcon::fromTheme("edit-duplicate",
+                                                         QIcon(QPixmap(":/images/icons/breeze/32x32/edit-duplicate.svg"))),
+                                        tr("Memory sharing"),
+                                        this);
+    connect(m_memorySharingAction, &QAction::triggered,
+            m_memorySharingWidget, &QWidget::show);
+
+    m_localNetworksAction = new QAction(QIcon::fromTheme("network-manager",
+                                                         QIcon(QPixmap(":/images/icons/breeze/32x32/network-manager.svg"))),
+                                        tr("Local networks"),
+                                        this);
+    connect(m_localNetworksAction, &QAction::triggered,
+            m_localNetworksWidget, &QWidget::show);
+
     // Actions for Help menu
     m_helpQuickHelpAction = new QAction(QIcon::fromTheme("help-contents",
                                                          QIcon(QPixmap(":/images/icons/breeze/32x32/help-contents.svg"))),
@@ -485,12 +602,15 @@ void MainWindow::generateMachineObject(const QJsonObject machineConfigJsonObject
     Machine *machine = new Machine(this);
     connect(machine, &Machine::machineStateChangedSignal,
             this, &MainWindow::machineStateChanged);
+    connect(machine, &Machine::machineBootedSignal,
+            this, &MainWindow::machineBooted);
 
     MachineUtils::fillMachineObject(machine,
                                     machineJSON,
                                     machineConfigPath);
 
     this->m_machinesList.append(machine);
+    this->m_machineWatcher->watchMachine(machineConfigPath);
 }
 
 /**
@@ -511,6 +631,8 @@ void MainWindow::createNewMachine()
 
     connect(m_machine, &Machine::machineStateChangedSignal,
             this, &MainWindow::machineStateChanged);
+    connect(m_machine, &Machine::machineBootedSignal,
+            this, &MainWindow::machineBooted);
 
     MachineWizard newMachineWizard(m_machine, this->m_osListWidget, this->qemuGlobalObject, this);
 
@@ -519,6 +641,7 @@ void MainWindow::createNewMachine()
 
     if (!m_machine->getUuid().isEmpty()) {
         m_machinesList.append(m_machine);
+        this->m_machineWatcher->watchMachine(m_machine->getConfigPath());
         this->loadUI(this->m_osListWidget->count());
     }
 }
@@ -538,6 +661,7 @@ void MainWindow::deleteMachine()
         QMutableListIterator<Machine*> machines(this->m_machinesList);
         while (machines.hasNext() && !machineRemovedList) {
             if (machines.next()->getUuid() == machineUuid.toString()) {
+                this->m_machineWatcher->unwatchMachine(machines.value()->getConfigPath());
                 machines.remove();
                 machineRemovedList = true;
             }
@@ -547,6 +671,75 @@ void MainWindow::deleteMachine()
     }
 }
 
+/**
+ * @brief Save the selected machine as a template
+ *
+ * Ask the name of the template and copy the
+ * disks of the machine in background
+ */
+void MainWindow::saveMachineTemplate()
+{
+    if (this->m_osListWidget->currentItem() == nullptr) {
+        return;
+    }
+
+    QUuid machineUuid = this->m_osListWidget->currentItem()->data(QMetaType::QUuid).toUuid();
+    Machine *templateMachine = nullptr;
+    foreach (Machine *machine, this->m_machinesList) {
+        if (machine->getUuid() == machineUuid.toString()) {
+            templateMachine = machine;
+            break;
+        }
+    }
+
+    if (templateMachine == nullptr) {
+        return;
+    }
+
+    bool accepted = false;
+    QString templateName = QInputDialog::getText(this, tr("Save as template") + " - QtEmu",
+                                                 tr("Name of the template") + ":",
+                                                 QLineEdit::Normal,
+                                                 templateMachine->getName(),
+                                                 &accepted);
+    if (!accepted) {
+        return;
+    }
+
+    QString error;
+    if (!this->m_templateLibrary->saveTemplate(templateMachine, templateName.trimmed(), &error)) {
+        SystemUtils::showMessage(tr("Qtemu - Critical error"),
+                                 tr("<p>Cannot save the template</p><p>%1</p>").arg(error),
+                                 QMessageBox::Critical);
+        return;
+    }
+
+    this->m_saveTemplateAction->setEnabled(false);
+}
+
+/**
+ * @brief A template is saved
+ * @param saved, true if the template is saved
+ * @param name, name of the template
+ * @param error, reason of the failure
+ *
+ * Tell the user the result of the saving
+ */
+void MainWindow::machineTemplateSaved(bool saved, const QString &name, const QString &error)
+{
+    this->m_saveTemplateAction->setEnabled(true);
+
+    if (saved) {
+        SystemUtils::showMessage(tr("Save as template") + " - QtEmu",
+                                 tr("The template <strong>%1</strong> is saved").arg(name),
+                                 QMessageBox::Information);
+    } else {
+        SystemUtils::showMessage(tr("Qtemu - Critical error"),
+                                 tr("<p>Cannot save the template %1</p><p>%2</p>").arg(name, error),
+                                 QMessageBox::Critical);
+    }
+}
+
 /**
  * @brief Open the machine options window
  *
@@ -613,6 +806,8 @@ void MainWindow::importMachine()
     Machine *machine = new Machine(this);
     connect(machine, &Machine::machineStateChangedSignal,
             this, &MainWindow::machineStateChanged);
+    connect(machine, &Machine::machineBootedSignal,
+            this, &MainWindow::machineBooted);
 
     ImportWizard importWizard(machine, this->m_osListWidget, this);
 
@@ -624,6 +819,7 @@ void MainWindow::importMachine()
         return;
     } else {
         this->m_machinesList.append(machine);
+        this->m_machineWatcher->watchMachine(machine->getConfigPath());
         this->loadUI(this->m_osListWidget->count());
     }
 }
@@ -691,6 +887,10 @@ void MainWindow::pauseMachine()
  */
 void MainWindow::loadUI(const int machineCount)
 {
+    if (this->m_controlServer != nullptr) {
+        this->m_controlServer->watchMachines();
+    }
+
     if (machineCount == 0) {
         // Disable all options
         this->m_startMachineAction->setEnabled(false);
@@ -702,6 +902,8 @@ void MainWindow::loadUI(const int machineCount)
         this->m_removeMachineAction->setEnabled(false);
 
         this->emptyMachineDetailsSection();
+        this->m_machineDisplay->disconnectFromServer();
+        this->m_osDetailsStackedWidget->setCurrentWidget(this->m_machineDetailsGroup);
     } else {
         QUuid machineUuid = this->m_osListWidget->currentItem()->data(QMetaType::QUuid).toUuid();
         foreach (Machine *machine, this->m_machinesList) {
@@ -711,6 +913,7 @@ void MainWindow::loadUI(const int machineCount)
                 this->m_removeMachineAction->setEnabled(true);
                 this->controlMachineActions(machine->getState());
                 this->fillMachineDetailsSection(machine);
+                this->showMachineDisplay(machine);
                 break;
             }
         }
@@ -731,6 +934,7 @@ void MainWindow::changeMachine(QListWidgetItem *machineItem)
         if (machine->getUuid() == machineUuid.toString()) {
             controlMachineActions(machine->getState());
             fillMachineDetailsSection(machine);
+            showMachineDisplay(machine);
         }
     }
 }
@@ -751,7 +955,15 @@ void MainWindow::fillMachineDetailsSection(Machine *machine)
     this->m_machineGraphicsLabel->setText(machine->getGPUType());
     this->m_machineAudioLabel->setText(machine->getAudioLabel());
     this->m_machineAccelLabel->setText(machine->getAcceleratorLabel());
-    this->m_machineNetworkLabel->setText(machine->getUseNetwork() == true ? tr("Yes") : tr("no"));
+    QStringList networkBackends;
+    for (int i = 0; i < machine->getNetworkCards().size(); ++i) {
+        networkBackends.append(machine->getNetworkCards().at(i)->backend());
+    }
+    if (machine->getUseNetwork() == true && !networkBackends.isEmpty()) {
+        this->m_machineNetworkLabel->setText(networkBackends.join(", "));
+    } else {
+        this->m_machineNetworkLabel->setText(tr("no"));
+    }
     QString mediaLabel;
     for (int i = 0; i < machine->getMedia().size(); ++i) {
          mediaLabel.append("(")
@@ -761,6 +973,17 @@ void MainWindow::fillMachineDetailsSection(Machine *machine)
                    .append("\n");
     }
     this->m_machineMediaLabel->setText(mediaLabel);
+
+    QJsonObject bootConfig = machine->getBootConfig();
+    int boots = 0;
+    qint64 bootTime = machine->getBootHistory()->medianBootTime(BootHistory::configHash(bootConfig), &boots);
+    if (boots > 0) {
+        this->m_machineBootTimeLabel->setText(tr("%1 s (median of %n boots)", "", boots)
+                                              .arg(bootTime / 1000.0, 0, 'f', 1));
+    } else {
+        this->m_machineBootTimeLabel->setText(tr("Not measured"));
+    }
+    this->m_machineBootChangesLabel->setText(machine->getBootHistory()->compare(bootConfig).join("\n"));
 }
 
 /**
@@ -780,6 +1003,28 @@ void MainWindow::emptyMachineDetailsSection()
     this->m_machineAccelLabel->setText("");
     this->m_machineNetworkLabel->setText("");
     this->m_machineMediaLabel->setText("");
+    this->m_machineBootTimeLabel->setText("");
+    this->m_machineBootChangesLabel->setText("");
+}
+
+/**
+ * @brief Show the display of the machine
+ * @param machine, selected machine
+ *
+ * Show the display of the machine while it's running,
+ * the details of the machine otherwise
+ */
+void MainWindow::showMachineDisplay(Machine *machine)
+{
+    bool running = machine->getState() == Machine::Started || machine->getState() == Machine::Paused;
+
+    if (running && machine->hasEmbeddedDisplay()) {
+        this->m_machineDisplay->connectToServer(machine->getDisplayServerName());
+        this->m_osDetailsStackedWidget->setCurrentWidget(this->m_machineDisplayArea);
+    } else {
+        this->m_machineDisplay->disconnectFromServer();
+        this->m_osDetailsStackedWidget->setCurrentWidget(this->m_machineDetailsGroup);
+    }
 }
 
 /**
@@ -803,6 +1048,88 @@ void MainWindow::machinesMenu(const QPoint &pos)
 void MainWindow::machineStateChanged(Machine::States newState)
 {
     controlMachineActions(newState);
+
+    Machine *machine = qobject_cast<Machine *>(this->sender());
+    if (machine == nullptr) {
+        return;
+    }
+
+    // The config changed on disk while the machine was running
+    if (newState == Machine::Stopped && this->m_pendingReloads.contains(machine->getConfigPath())) {
+        this->reloadMachineConfig(machine->getConfigPath());
+    }
+
+    if (this->m_osListWidget->currentItem() == nullptr) {
+        return;
+    }
+
+    QUuid machineUuid = this->m_osListWidget->currentItem()->data(QMetaType::QUuid).toUuid();
+    if (machine->getUuid() == machineUuid.toString()) {
+        this->showMachineDisplay(machine);
+    }
+}
+
+/**
+ * @brief The guest of a VM is ready
+ * @param bootTime, boot time of the VM
+ *
+ * Update the boot times if the VM is the selected one
+ */
+void MainWindow::machineBooted(qint64 bootTime)
+{
+    Q_UNUSED(bootTime);
+
+    Machine *machine = qobject_cast<Machine *>(this->sender());
+    if (machine == nullptr || this->m_osListWidget->currentItem() == nullptr) {
+        return;
+    }
+
+    QUuid machineUuid = this->m_osListWidget->currentItem()->data(QMetaType::QUuid).toUuid();
+    if (machine->getUuid() == machineUuid.toString()) {
+        this->fillMachineDetailsSection(machine);
+    }
+}
+
+/**
+ * @brief The admission controller decided about a VM
+ * @param machine, VM to be launched
+ * @param decision, decision of the controller
+ * @param reason, resources missing in the host
+ *
+ * Tell the user that the host can't hold the VM
+ */
+void MainWindow::machineAdmission(Machine *machine,
+                                  AdmissionController::Decision decision,
+                                  const QString &reason)
+{
+    // The machine can be deleted before the decision arrives
+    if (!this->m_machinesList.contains(machine)) {
+        return;
+    }
+
+    QString details = QString("<br>").append(QString(reason).replace("; ", "<br>"));
+
+    switch (decision) {
+        case AdmissionController::Warned:
+            SystemUtils::showMessage(tr("QtEmu - Host resources"),
+                                     tr("The host is short of resources for the machine <b>%1</b>, "
+                                        "it's launched anyway:").arg(machine->getName()) + details,
+                                     QMessageBox::Warning);
+            break;
+        case AdmissionController::Queued:
+            SystemUtils::showMessage(tr("QtEmu - Host resources"),
+                                     tr("The machine <b>%1</b> is queued, it will be launched "
+                                        "when the host has enough resources:").arg(machine->getName()) + details,
+                                     QMessageBox::Information);
+            break;
+        case AdmissionController::Refused:
+            SystemUtils::showMessage(tr("QtEmu - Host resources"),
+                                     tr("The machine <b>%1</b> is not launched:").arg(machine->getName()) + details,
+                                     QMessageBox::Critical);
+            break;
+        default:
+            break;
+    }
 }
 
 /**
@@ -848,3 +1175,156 @@ void MainWindow::updateMachineDetailsConfig(const QUuid machineUuid)
         }
     }
 }
+
+/**
+ * @brief Reload the list of machines
+ *
+ * Reload the list of machines after the qtemu.json file
+ * is changed outside QtEmu. Only the added machines are read,
+ * the machines already loaded are not parsed again
+ */
+void MainWindow::reloadMachinesFile()
+{
+    QFile machinesFile(this->m_machineWatcher->machinesFilePath());
+    if (!machinesFile.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QByteArray machinesData = machinesFile.readAll();
+    machinesFile.close();
+
+    QJsonDocument machinesDocument(QJsonDocument::fromJson(machinesData));
+    if (!machinesDocument.isObject()) {
+        // Half written file, wait for the next change
+        return;
+    }
+
+    QJsonArray machines = machinesDocument["machines"].toArray();
+    QSet<QString> machinesUuids;
+
+    for (int i = 0; i < machines.size(); ++i) {
+        QJsonObject machineConfigJsonObject = machines[i].toObject();
+        QString machineUuid = machineConfigJsonObject["uuid"].toString();
+        machinesUuids.insert(machineUuid);
+
+        if (this->findMachineItem(machineUuid) == nullptr) {
+            this->generateMachineObject(machineConfigJsonObject, this->m_osListWidget->count());
+        }
+    }
+
+    QMutableListIterator<Machine*> machinesIterator(this->m_machinesList);
+    while (machinesIterator.hasNext()) {
+        Machine *machine = machinesIterator.next();
+        if (machinesUuids.contains(machine->getUuid()) ||
+            machine->getState() != Machine::Stopped) {
+            continue;
+        }
+
+        delete this->findMachineItem(machine->getUuid());
+        this->m_machineWatcher->unwatchMachine(machine->getConfigPath());
+        machinesIterator.remove();
+        machine->deleteLater();
+    }
+
+    if (this->m_osListWidget->count() > 0 && this->m_osListWidget->currentItem() == nullptr) {
+        this->m_osListWidget->setCurrentRow(0);
+    }
+
+    this->loadUI(this->m_osListWidget->count());
+}
+
+/**
+ * @brief Reload one machine
+ * @param configPath, path of the changed machine config file
+ *
+ * Read again the config file of the machine and update
+ * the list and the details section. The files saved by QtEmu
+ * are skipped, and a machine that isn't stopped is reloaded
+ * when it stops, its objects are in use
+ */
+void MainWindow::reloadMachineConfig(const QString &configPath)
+{
+    this->m_pendingReloads.remove(configPath);
+
+    Machine *changedMachine = nullptr;
+    foreach (Machine *machine, this->m_machinesList) {
+        if (machine->getConfigPath() == configPath) {
+            changedMachine = machine;
+            break;
+        }
+    }
+
+    if (changedMachine == nullptr) {
+        return;
+    }
+
+    QFile configFile(configPath);
+    if (!configFile.open(QFile::ReadOnly)) {
+        return;
+    }
+    QByteArray configData = configFile.readAll();
+    configFile.close();
+
+    QByteArray configHash = QCryptographicHash::hash(configData, QCryptographicHash::Sha1);
+    if (configHash == changedMachine->getConfigHash()) {
+        return;
+    }
+
+    if (changedMachine->getState() != Machine::Stopped) {
+        this->m_pendingReloads.insert(configPath);
+        return;
+    }
+
+    QJsonObject machineJSON = QJsonDocument::fromJson(configData).object();
+    if (machineJSON.isEmpty()) {
+        return;
+    }
+
+    QListWidgetItem *machineItem = this->findMachineItem(changedMachine->getUuid());
+
+    // The prewarmed QEMU was launched with the old configuration
+    changedMachine->discardPrewarm();
+
+    Machine::States machineState = changedMachine->getState();
+    Boot *oldBoot = changedMachine->getBoot();
+    QList<Media *> oldMedia = changedMachine->getMedia();
+    QList<NetworkCard *> oldNetworkCards = changedMachine->getNetworkCards();
+
+    changedMachine->removeAllMedia();
+    changedMachine->removeAllNetworkCards();
+    MachineUtils::fillMachineObject(changedMachine, machineJSON, configPath);
+    changedMachine->setState(machineState);
+    changedMachine->setConfigHash(configHash);
+
+    qDeleteAll(oldMedia);
+    qDeleteAll(oldNetworkCards);
+    delete oldBoot;
+
+    if (machineItem != nullptr) {
+        machineItem->setText(changedMachine->getName());
+        machineItem->setData(QMetaType::QUuid, changedMachine->getUuid());
+
+        if (machineItem == this->m_osListWidget->currentItem()) {
+            this->fillMachineDetailsSection(changedMachine);
+        }
+    }
+}
+
+/**
+ * @brief Find the item of a machine in the list
+ * @param machineUuid, uuid of the machine
+ * @return item of the machine, nullptr if the machine isn't in the list
+ *
+ * Find the item of a machine in the list
+ */
+QListWidgetItem *MainWindow::findMachineItem(const QString &machineUuid)
+{
+    for (int i = 0; i < this->m_osListWidget->count(); ++i) {
+        QListWidgetItem *machineItem = this->m_osListWidget->item(i);
+        if (machineItem->data(QMetaType::QUuid).toString() == machineUuid) {
+            return machineItem;
+        }
+    }
+
+    return nullptr;
+}
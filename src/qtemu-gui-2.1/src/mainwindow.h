@@ -43,6 +43,10 @@
 #include <QFile>
 #include <QProcess>
 #include <QMessageBox>
+#include <QInputDialog>
+#include <QScrollArea>
+#include <QSet>
+#include <QCryptographicHash>
 
 // Local
 #include "machine.h"
@@ -55,6 +59,18 @@
 #include "qemu.h"
 #include "export-import/export.h"
 #include "export-import/import.h"
+#include "utils/machinewatcher.h"
+#include "utils/tracer.h"
+#include "metricsexporter.h"
+#include "controlserver.h"
+#include "balloonmanager.h"
+#include "ksmmonitor.h"
+#include "machinepool.h"
+#include "memorysharingwidget.h"
+#include "localnetworkswidget.h"
+#include "vncviewer.h"
+#include "templates/templatelibrary.h"
+#include "templates/provisionwidget.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -83,11 +99,19 @@ class MainWindow : public QMainWindow {
         void resetMachine();
         void pauseMachine();
         void deleteMachine();
+        void saveMachineTemplate();
+        void machineTemplateSaved(bool saved, const QString &name, const QString &error);
         void loadUI(const int machineCount);
         void changeMachine(QListWidgetItem *machineItem);
         void machineStateChanged(Machine::States newState);
+        void machineBooted(qint64 bootTime);
+        void machineAdmission(Machine *machine,
+                              AdmissionController::Decision decision,
+                              const QString &reason);
         void machinesMenu(const QPoint &pos);
         void updateMachineDetailsConfig(const QUuid machineUuid);
+        void reloadMachinesFile();
+        void reloadMachineConfig(const QString &configPath);
 
     protected:
 
@@ -107,6 +131,10 @@ class MainWindow : public QMainWindow {
         QAction *m_exportMachineAction;
         QAction *m_importMachineAction;
         QAction *m_removeMachineAction;
+        QAction *m_saveTemplateAction;
+        QAction *m_provisionAction;
+        QAction *m_memorySharingAction;
+        QAction *m_localNetworksAction;
         QAction *m_groupMachineAction;
 
         QAction *m_helpQuickHelpAction;
@@ -130,6 +158,9 @@ class MainWindow : public QMainWindow {
         ConfigWindow *m_configWindow;
         HelpWidget *m_helpwidget;
         AboutWidget *m_aboutwidget;
+        MemorySharingWidget *m_memorySharingWidget;
+        LocalNetworksWidget *m_localNetworksWidget;
+        ProvisionWidget *m_provisionWidget;
 
         // Layouts
         QVBoxLayout *m_mainLayout;
@@ -145,7 +176,16 @@ class MainWindow : public QMainWindow {
         // List of OS
         QListWidget *m_osListWidget;
         QStackedWidget *m_osDetailsStackedWidget;
+        QScrollArea *m_machineDisplayArea;
+        VNCViewer *m_machineDisplay;
         QList<Machine *> m_machinesList;
+        QSet<QString> m_pendingReloads;
+        MetricsExporter *m_metricsExporter;
+        ControlServer *m_controlServer;
+        BalloonManager *m_balloonManager;
+        KSMMonitor *m_ksmMonitor;
+        TemplateLibrary *m_templateLibrary;
+        MachinePool *m_machinePool;
 
         // Machine
         Machine *m_machine;
@@ -160,16 +200,23 @@ class MainWindow : public QMainWindow {
         QLabel *m_machineAccelLabel;
         QLabel *m_machineNetworkLabel;
         QLabel *m_machineMediaLabel;
+        QLabel *m_machineBootTimeLabel;
+        QLabel *m_machineBootChangesLabel;
 
         // QEMU
         QEMU *qemuGlobalObject;
 
+        // Machines files watcher
+        MachineWatcher *m_machineWatcher;
+
         // Methods
         void generateMachineObject(const QJsonObject machinesConfigJsonObject, int pos);
         void loadMachines();
         void controlMachineActions(Machine::States state);
         void fillMachineDetailsSection(Machine *machine);
         void emptyMachineDetailsSection();
+        void showMachineDisplay(Machine *machine);
+        QListWidgetItem *findMachineItem(const QString &machineUuid);
 
 };
 #endif // MAINWINDOW_H
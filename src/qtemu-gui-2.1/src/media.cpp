@@ -238,3 +238,89 @@ void Media::setUuid(const QUuid &uuid)
 {
     m_uuid = uuid;
 }
+
+/**
+ * @brief Get a throttle limit of the media
+ * @param key, limit name, one of the throttleKeys
+ * @return limit value, 0 if the limit is not set
+ *
+ * Get a throttle limit of the media.
+ * The iops limits are operations per second, the bps limits
+ * bytes per second
+ */
+qlonglong Media::throttle(const QString &key) const
+{
+    return m_throttle.value(key, 0);
+}
+
+/**
+ * @brief Set a throttle limit of the media
+ * @param key, limit name, one of the throttleKeys
+ * @param value, limit value, 0 removes the limit
+ *
+ * Set a throttle limit of the media
+ */
+void Media::setThrottle(const QString &key, const qlonglong &value)
+{
+    if (value <= 0) {
+        m_throttle.remove(key);
+    } else {
+        m_throttle.insert(key, value);
+    }
+}
+
+/**
+ * @brief Get the throttle group of the media
+ * @return throttle group name
+ *
+ * Get the throttle group of the media.
+ * The drives of the same group in a machine share the
+ * limits. A QEMU throttle group only exists inside one
+ * QEMU process, the machines with the same group name
+ * are throttled independently
+ */
+QString Media::throttleGroup() const
+{
+    return m_throttleGroup;
+}
+
+/**
+ * @brief Set the throttle group of the media
+ * @param throttleGroup, throttle group name
+ *
+ * Set the throttle group of the media
+ */
+void Media::setThrottleGroup(const QString &throttleGroup)
+{
+    m_throttleGroup = throttleGroup;
+}
+
+/**
+ * @brief Get if the media is throttled
+ * @return true if any limit or group is set
+ *
+ * Get if the media is throttled
+ */
+bool Media::isThrottled() const
+{
+    return !m_throttle.isEmpty() || !m_throttleGroup.isEmpty();
+}
+
+/**
+ * @brief Get the throttle limit names
+ * @return limit names
+ *
+ * Get the throttle limit names, the same names of the
+ * throttling options of the QEMU drives.
+ * The max limits are the bursts
+ */
+QStringList Media::throttleKeys()
+{
+    QStringList keys;
+    keys << "iops-total" << "iops-read" << "iops-write"
+         << "bps-total" << "bps-read" << "bps-write"
+         << "iops-total-max" << "iops-read-max" << "iops-write-max"
+         << "bps-total-max" << "bps-read-max" << "bps-write-max";
+
+    return keys;
+}
@@ -24,6 +24,8 @@
 // Qt
 #include <QObject>
 #include <QUuid>
+#include <QHash>
+#include <QStringList>
 #include <QDebug>
 
 class Media: public QObject {
@@ -60,6 +62,16 @@ class Media: public QObject {
         QUuid uuid() const;
         void setUuid(const QUuid &uuid);
 
+        qlonglong throttle(const QString &key) const;
+        void setThrottle(const QString &key, const qlonglong &value);
+
+        QString throttleGroup() const;
+        void setThrottleGroup(const QString &throttleGroup);
+
+        bool isThrottled() const;
+
+        static QStringList throttleKeys();
+
     protected:
 
     private:
@@ -72,6 +84,8 @@ class Media: public QObject {
         QString m_cache;
         QString m_IO;
         QUuid m_uuid;
+        QHash<QString, qlonglong> m_throttle;
+        QString m_throttleGroup;
 };
 
 #endif // MEDIA_H
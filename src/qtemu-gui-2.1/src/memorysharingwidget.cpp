@@ -0,0 +1,220 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "memorysharingwidget.h"
+
+// Interval in ms between two refreshes of the counters
+static const int REFRESH_INTERVAL = 2000;
+
+/**
+ * @brief Memory sharing window
+ * @param ksmMonitor, monitor of the kernel same-page merging
+ * @param parent, widget parent
+ *
+ * Window with the counters of the kernel same-page merging, the
+ * memory saved by every group of machines and the dense mode
+ */
+MemorySharingWidget::MemorySharingWidget(KSMMonitor *ksmMonitor,
+                                         QWidget *parent) : QWidget(parent)
+{
+    this->setWindowTitle(tr("Memory sharing") + " - QtEmu");
+    this->setWindowIcon(QIcon::fromTheme("qtemu",
+                                         QIcon(":/images/qtemu.png")));
+    this->setWindowFlag(Qt::Window);
+    this->setMinimumSize(500, 450);
+
+    this->m_ksmMonitor = ksmMonitor;
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(REFRESH_INTERVAL);
+    connect(m_refreshTimer, &QTimer::timeout,
+            this, &MemorySharingWidget::refresh);
+
+    m_stateLabel = new QLabel(this);
+    m_pagesSharedLabel = new QLabel(this);
+    m_pagesSharingLabel = new QLabel(this);
+    m_pagesUnsharedLabel = new QLabel(this);
+    m_pagesVolatileLabel = new QLabel(this);
+    m_fullScansLabel = new QLabel(this);
+    m_scanRateLabel = new QLabel(this);
+    m_savedLabel = new QLabel(this);
+
+    m_countersLayout = new QFormLayout();
+    m_countersLayout->addRow(tr("State") + ":", m_stateLabel);
+    m_countersLayout->addRow(tr("Shared pages") + ":", m_pagesSharedLabel);
+    m_countersLayout->addRow(tr("Sharing pages") + ":", m_pagesSharingLabel);
+    m_countersLayout->addRow(tr("Unshared pages") + ":", m_pagesUnsharedLabel);
+    m_countersLayout->addRow(tr("Volatile pages") + ":", m_pagesVolatileLabel);
+    m_countersLayout->addRow(tr("Full scans") + ":", m_fullScansLabel);
+    m_countersLayout->addRow(tr("Scan rate") + ":", m_scanRateLabel);
+    m_countersLayout->addRow(tr("Memory saved") + ":", m_savedLabel);
+
+    QStringList header;
+    header << tr("Machines") << tr("Running") << tr("RAM") << tr("Saved");
+
+    m_groupsTree = new QTreeWidget(this);
+    m_groupsTree->setColumnCount(4);
+    m_groupsTree->setRootIsDecorated(false);
+    m_groupsTree->setHeaderLabels(header);
+
+    m_estimateLabel = new QLabel(this);
+    m_estimateLabel->setWordWrap(true);
+
+    m_denseModeCheckBox = new QCheckBox(tr("Dense mode: merge and scan faster when the host is short of memory"), this);
+    m_denseModeCheckBox->setChecked(ksmMonitor->denseMode());
+    connect(m_denseModeCheckBox, &QCheckBox::toggled,
+            this, &MemorySharingWidget::denseModeChanged);
+
+    m_denseStateLabel = new QLabel(this);
+    m_denseStateLabel->setWordWrap(true);
+
+    connect(m_ksmMonitor, &KSMMonitor::denseActiveChangedSignal,
+            this, &MemorySharingWidget::refresh);
+
+    m_closeButton = new QPushButton(QIcon::fromTheme("window-close",
+                                                     QIcon(QPixmap(":/images/icons/breeze/32x32/window-close.svg"))),
+                                    tr("&Close"),
+                                    this);
+    connect(m_closeButton, &QAbstractButton::clicked,
+            this, &QWidget::hide);
+
+    QList<QKeySequence> closeShortcuts;
+    closeShortcuts << QKeySequence(Qt::Key_Escape);
+    m_closeAction = new QAction(this);
+    m_closeAction->setShortcuts(closeShortcuts);
+    connect(m_closeAction, &QAction::triggered,
+            this, &QWidget::hide);
+    this->addAction(m_closeAction);
+
+    m_mainLayout = new QVBoxLayout(this);
+    m_mainLayout->addItem(m_countersLayout);
+    m_mainLayout->addWidget(m_groupsTree, 1);
+    m_mainLayout->addWidget(m_estimateLabel);
+    m_mainLayout->addWidget(m_denseModeCheckBox);
+    m_mainLayout->addWidget(m_denseStateLabel);
+    m_mainLayout->addWidget(m_closeButton, 0, Qt::AlignRight);
+
+    qDebug() << "MemorySharingWidget created";
+}
+
+MemorySharingWidget::~MemorySharingWidget()
+{
+    qDebug() << "MemorySharingWidget destroyed";
+}
+
+/**
+ * @brief Refresh the counters
+ *
+ * Read the counters of KSM and the memory
+ * saved by every group of machines
+ */
+void MemorySharingWidget::refresh()
+{
+    KSMMonitor::Counters counters = this->m_ksmMonitor->counters();
+
+    if (!counters.available) {
+        m_stateLabel->setText(tr("Not available in this host"));
+    } else {
+        m_stateLabel->setText(counters.running ? tr("Running") : tr("Stopped"));
+    }
+
+    m_pagesSharedLabel->setText(QString::number(counters.pagesShared));
+    m_pagesSharingLabel->setText(QString::number(counters.pagesSharing));
+    m_pagesUnsharedLabel->setText(QString::number(counters.pagesUnshared));
+    m_pagesVolatileLabel->setText(QString::number(counters.pagesVolatile));
+    m_fullScansLabel->setText(QString::number(counters.fullScans));
+    m_scanRateLabel->setText(tr("%1 pages every %2 ms")
+                             .arg(counters.pagesToScan)
+                             .arg(counters.sleepMillisecs));
+    m_savedLabel->setText(MemorySharingWidget::formatBytes(this->m_ksmMonitor->savedBytes(counters)));
+
+    bool perProcess = false;
+    QList<KSMMonitor::GroupSaving> savings = this->m_ksmMonitor->groupSavings(counters, &perProcess);
+
+    m_groupsTree->clear();
+    foreach (const KSMMonitor::GroupSaving &saving, savings) {
+        QTreeWidgetItem *groupItem = new QTreeWidgetItem(m_groupsTree, QTreeWidgetItem::Type);
+        groupItem->setText(0, saving.group);
+        groupItem->setText(1, QString::number(saving.machines));
+        groupItem->setText(2, QString::number(saving.memory) + " MiB");
+        groupItem->setText(3, MemorySharingWidget::formatBytes(saving.savedBytes));
+    }
+
+    if (perProcess) {
+        m_estimateLabel->setText(tr("The memory saved is split between the groups "
+                                    "by the merged pages of every machine."));
+    } else {
+        m_estimateLabel->setText(tr("The memory saved is split between the groups "
+                                    "by the RAM of the machines, the kernel doesn't "
+                                    "give the merged pages of every machine."));
+    }
+
+    if (!this->m_ksmMonitor->denseMode()) {
+        m_denseStateLabel->clear();
+    } else if (this->m_ksmMonitor->isDenseActive()) {
+        m_denseStateLabel->setText(tr("The host is short of memory, KSM is tuned."));
+    } else {
+        m_denseStateLabel->setText(tr("KSM is tuned when the host is short of memory."));
+    }
+}
+
+/**
+ * @brief The dense mode is enabled or disabled
+ * @param enabled, true if the dense mode is enabled
+ *
+ * Save the dense mode and refresh the window
+ */
+void MemorySharingWidget::denseModeChanged(bool enabled)
+{
+    this->m_ksmMonitor->setDenseMode(enabled);
+    this->refresh();
+}
+
+void MemorySharingWidget::closeEvent(QCloseEvent *event)
+{
+    this->hide();
+    event->ignore();
+}
+
+void MemorySharingWidget::showEvent(QShowEvent *event)
+{
+    this->refresh();
+    this->m_refreshTimer->start();
+    event->accept();
+}
+
+void MemorySharingWidget::hideEvent(QHideEvent *event)
+{
+    this->m_refreshTimer->stop();
+    event->accept();
+}
+
+/**
+ * @brief Format an amount of memory
+ * @param bytes, bytes of memory
+ * @return memory in MiB
+ *
+ * Format an amount of memory
+ */
+QString MemorySharingWidget::formatBytes(qint64 bytes)
+{
+    return QString::number(static_cast<double>(bytes) / 1024 / 1024, 'f', 1) + " MiB";
+}
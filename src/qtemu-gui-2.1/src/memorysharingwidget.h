@@ -0,0 +1,93 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MEMORYSHARINGWIDGET_H
+#define MEMORYSHARINGWIDGET_H
+
+// Qt
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QAction>
+#include <QCloseEvent>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QTimer>
+
+#include <QDebug>
+
+// Local
+#include "ksmmonitor.h"
+
+class MemorySharingWidget : public QWidget {
+    Q_OBJECT
+
+    public:
+        explicit MemorySharingWidget(KSMMonitor *ksmMonitor,
+                                     QWidget *parent = nullptr);
+        ~MemorySharingWidget();
+
+    signals:
+
+    public slots:
+        void refresh();
+
+    private slots:
+        void denseModeChanged(bool enabled);
+
+    protected:
+        virtual void closeEvent(QCloseEvent *event);
+        virtual void showEvent(QShowEvent *event);
+        virtual void hideEvent(QHideEvent *event);
+
+    private:
+        KSMMonitor *m_ksmMonitor;
+        QTimer *m_refreshTimer;
+
+        QVBoxLayout *m_mainLayout;
+        QFormLayout *m_countersLayout;
+
+        QLabel *m_stateLabel;
+        QLabel *m_pagesSharedLabel;
+        QLabel *m_pagesSharingLabel;
+        QLabel *m_pagesUnsharedLabel;
+        QLabel *m_pagesVolatileLabel;
+        QLabel *m_fullScansLabel;
+        QLabel *m_scanRateLabel;
+        QLabel *m_savedLabel;
+
+        QTreeWidget *m_groupsTree;
+        QLabel *m_estimateLabel;
+
+        QCheckBox *m_denseModeCheckBox;
+        QLabel *m_denseStateLabel;
+
+        QPushButton *m_closeButton;
+        QAction *m_closeAction;
+
+        // Methods
+        static QString formatBytes(qint64 bytes);
+};
+
+#endif // MEMORYSHARINGWIDGET_H
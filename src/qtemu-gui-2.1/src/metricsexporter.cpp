@@ -0,0 +1,544 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "metricsexporter.h"
+
+// C++ standard library
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Metrics exporter
+ * @param machines, machines of QtEmu
+ * @param parent, parent object
+ *
+ * Export the metrics of the machines in the Prometheus text format.
+ * The metrics are served over HTTP in a localhost TCP port or in
+ * a UNIX socket, and can be dumped periodically to a file
+ */
+MetricsExporter::MetricsExporter(const QList<Machine *> *machines,
+                                 QObject *parent) : QObject(parent)
+{
+    this->m_machines = machines;
+    this->m_tcpServer = nullptr;
+    this->m_localServer = nullptr;
+    this->m_sampleInterval = 1000;
+
+    this->m_buffer.reserve(64 * 1024);
+
+    this->m_dumpTimer = new QTimer(this);
+    connect(m_dumpTimer, &QTimer::timeout,
+            this, &MetricsExporter::dumpMetrics);
+
+    this->loadSettings();
+
+    qDebug() << "MetricsExporter object created";
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    this->stopServers();
+
+    qDebug() << "MetricsExporter object destroyed";
+}
+
+/**
+ * @brief Load the exporter settings
+ *
+ * Load the Metrics settings group and start or stop the
+ * server and the dump timer
+ * enabled: serve the metrics
+ * listen: tcp or unix
+ * port: localhost port for tcp
+ * socketPath: socket for unix
+ * dumpFile: file where the metrics are dumped, empty to disable
+ * dumpInterval: seconds between dumps
+ */
+void MetricsExporter::loadSettings()
+{
+    QSettings settings;
+    settings.beginGroup("DataFolder");
+    QString dataDirectoryPath = settings.value("QtEmuData",
+                                               QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/")).toString();
+    settings.endGroup();
+
+    settings.beginGroup("Metrics");
+    bool enabled = settings.value("enabled", false).toBool();
+    QString listen = settings.value("listen", "tcp").toString();
+    quint16 port = static_cast<quint16>(settings.value("port", 9477).toInt());
+    QString socketPath = settings.value("socketPath", dataDirectoryPath + "metrics.sock").toString();
+    this->m_dumpFilePath = settings.value("dumpFile", "").toString();
+    int dumpInterval = settings.value("dumpInterval", 15).toInt();
+    this->m_sampleInterval = settings.value("sampleInterval", 1000).toInt();
+    settings.endGroup();
+
+    this->stopServers();
+
+    if (enabled && listen == "unix") {
+        QLocalServer::removeServer(socketPath);
+        this->m_localServer = new QLocalServer(this);
+        this->m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
+        connect(m_localServer, &QLocalServer::newConnection,
+                this, &MetricsExporter::newLocalConnection);
+
+        if (!this->m_localServer->listen(socketPath)) {
+            qDebug() << "Cannot serve the metrics in" << socketPath << this->m_localServer->errorString();
+        }
+    } else if (enabled) {
+        this->m_tcpServer = new QTcpServer(this);
+        connect(m_tcpServer, &QTcpServer::newConnection,
+                this, &MetricsExporter::newTcpConnection);
+
+        if (!this->m_tcpServer->listen(QHostAddress::LocalHost, port)) {
+            qDebug() << "Cannot serve the metrics in port" << port << this->m_tcpServer->errorString();
+        }
+    }
+
+    if (!this->m_dumpFilePath.isEmpty() && dumpInterval > 0) {
+        this->m_dumpTimer->start(dumpInterval * 1000);
+    } else {
+        this->m_dumpTimer->stop();
+    }
+}
+
+/**
+ * @brief Render the metrics
+ * @return metrics in the Prometheus text format
+ *
+ * Render the metrics of all the machines. The buffer is
+ * reused between calls and the process counters are sampled
+ * at most once every sampleInterval milliseconds
+ */
+const QByteArray &MetricsExporter::render()
+{
+    if (!this->m_sampleTimer.isValid() || this->m_sampleTimer.elapsed() >= this->m_sampleInterval) {
+        this->sampleProcesses();
+        this->m_sampleTimer.start();
+    }
+
+    static const char *stateNames[] = {"started", "stopped", "saved", "paused"};
+
+    this->m_buffer.resize(0);
+
+    this->appendMetricHeader("qtemu_machines", "gauge", "Number of machines.");
+    this->m_buffer.append("qtemu_machines ");
+    this->appendNumber(this->m_machines->size());
+    this->m_buffer.append('\n');
+
+    this->appendMetricHeader("qtemu_machine_state", "gauge", "State of the machine.");
+    foreach (const Machine *machine, *this->m_machines) {
+        for (int state = Machine::Started; state <= Machine::Paused; ++state) {
+            this->m_buffer.append("qtemu_machine_state");
+            this->appendLabels(machine);
+            this->m_buffer.chop(1);
+            this->m_buffer.append(",state=\"").append(stateNames[state]).append("\"} ");
+            this->m_buffer.append(machine->getState() == state ? '1' : '0');
+            this->m_buffer.append('\n');
+        }
+    }
+
+    this->appendMetricHeader("qtemu_machine_uptime_seconds", "gauge", "Time since the QEMU process started.");
+    foreach (const Machine *machine, *this->m_machines) {
+        this->m_buffer.append("qtemu_machine_uptime_seconds");
+        this->appendLabels(machine);
+        this->m_buffer.append(' ');
+        this->appendSeconds(machine->getUptime());
+        this->m_buffer.append('\n');
+    }
+
+    this->appendMetricHeader("qtemu_machine_launch_latency_seconds", "gauge",
+                             "Time between the launch and the start of the QEMU process.");
+    foreach (const Machine *machine, *this->m_machines) {
+        if (machine->getLaunchLatency() < 0) {
+            continue;
+        }
+        this->m_buffer.append("qtemu_machine_launch_latency_seconds");
+        this->appendLabels(machine);
+        this->m_buffer.append(' ');
+        this->appendSeconds(machine->getLaunchLatency());
+        this->m_buffer.append('\n');
+    }
+
+#ifdef Q_OS_LINUX
+    static const qint64 clockTicks = sysconf(_SC_CLK_TCK);
+    static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+
+    this->appendMetricHeader("qtemu_machine_cpu_seconds_total", "counter", "CPU time used by the QEMU process.");
+    foreach (Machine *machine, *this->m_machines) {
+        if (!this->m_samples.contains(machine)) {
+            continue;
+        }
+        this->m_buffer.append("qtemu_machine_cpu_seconds_total");
+        this->appendLabels(machine);
+        this->m_buffer.append(' ');
+        this->appendSeconds(this->m_samples[machine].CPUTicks * 1000 / clockTicks);
+        this->m_buffer.append('\n');
+    }
+
+    this->appendMetricHeader("qtemu_machine_resident_memory_bytes", "gauge", "Resident memory of the QEMU process.");
+    foreach (Machine *machine, *this->m_machines) {
+        if (!this->m_samples.contains(machine)) {
+            continue;
+        }
+        this->m_buffer.append("qtemu_machine_resident_memory_bytes");
+        this->appendLabels(machine);
+        this->m_buffer.append(' ');
+        this->appendNumber(this->m_samples[machine].residentPages * pageSize);
+        this->m_buffer.append('\n');
+    }
+
+    this->appendMetricHeader("qtemu_machine_block_read_bytes_total", "counter", "Bytes read from storage by the QEMU process.");
+    foreach (Machine *machine, *this->m_machines) {
+        if (!this->m_samples.contains(machine) || this->m_samples[machine].readBytes < 0) {
+            continue;
+        }
+        this->m_buffer.append("qtemu_machine_block_read_bytes_total");
+        this->appendLabels(machine);
+        this->m_buffer.append(' ');
+        this->appendNumber(this->m_samples[machine].readBytes);
+        this->m_buffer.append('\n');
+    }
+
+    this->appendMetricHeader("qtemu_machine_block_write_bytes_total", "counter", "Bytes written to storage by the QEMU process.");
+    foreach (Machine *machine, *this->m_machines) {
+        if (!this->m_samples.contains(machine) || this->m_samples[machine].writeBytes < 0) {
+            continue;
+        }
+        this->m_buffer.append("qtemu_machine_block_write_bytes_total");
+        this->appendLabels(machine);
+        this->m_buffer.append(' ');
+        this->appendNumber(this->m_samples[machine].writeBytes);
+        this->m_buffer.append('\n');
+    }
+#endif
+
+    return m_buffer;
+}
+
+/**
+ * @brief Dump the metrics
+ *
+ * Dump the metrics to the dump file. The file is replaced
+ * atomically, so the collectors never read half a dump
+ */
+void MetricsExporter::dumpMetrics()
+{
+    if (this->m_dumpFilePath.isEmpty()) {
+        return;
+    }
+
+    QSaveFile dumpFile(this->m_dumpFilePath);
+    if (!dumpFile.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot dump the metrics in" << this->m_dumpFilePath << dumpFile.errorString();
+        return;
+    }
+
+    dumpFile.write(this->render());
+
+    if (!dumpFile.commit()) {
+        qDebug() << "Cannot dump the metrics in" << this->m_dumpFilePath << dumpFile.errorString();
+    }
+}
+
+/**
+ * @brief New TCP connection
+ *
+ * Serve the metrics to a new TCP client
+ */
+void MetricsExporter::newTcpConnection()
+{
+    while (this->m_tcpServer->hasPendingConnections()) {
+        QTcpSocket *socket = this->m_tcpServer->nextPendingConnection();
+        connect(socket, &QTcpSocket::disconnected,
+                socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead,
+                this, [=]() { this->serveRequest(socket); });
+    }
+}
+
+/**
+ * @brief New local connection
+ *
+ * Serve the metrics to a new UNIX socket client
+ */
+void MetricsExporter::newLocalConnection()
+{
+    while (this->m_localServer->hasPendingConnections()) {
+        QLocalSocket *socket = this->m_localServer->nextPendingConnection();
+        connect(socket, &QLocalSocket::disconnected,
+                socket, &QObject::deleteLater);
+        connect(socket, &QLocalSocket::readyRead,
+                this, [=]() { this->serveRequest(socket); });
+    }
+}
+
+/**
+ * @brief Stop the servers
+ *
+ * Stop the TCP and the UNIX socket servers
+ */
+void MetricsExporter::stopServers()
+{
+    if (this->m_tcpServer != nullptr) {
+        this->m_tcpServer->close();
+        this->m_tcpServer->deleteLater();
+        this->m_tcpServer = nullptr;
+    }
+
+    if (this->m_localServer != nullptr) {
+        this->m_localServer->close();
+        this->m_localServer->deleteLater();
+        this->m_localServer = nullptr;
+    }
+}
+
+/**
+ * @brief Serve a request
+ * @param socket, client socket
+ *
+ * Answer an HTTP request with the metrics once the request
+ * headers are received, and close the connection
+ */
+void MetricsExporter::serveRequest(QIODevice *socket)
+{
+    QByteArray request = socket->peek(8192);
+    if (!request.contains("\r\n\r\n") && !request.contains("\n\n") && request.size() < 8192) {
+        return;
+    }
+
+    socket->readAll();
+    disconnect(socket, &QIODevice::readyRead, this, nullptr);
+
+    const QByteArray &metrics = this->render();
+
+    char header[160];
+    int headerSize = std::snprintf(header, sizeof(header),
+                                   "HTTP/1.0 200 OK\r\n"
+                                   "Content-Type: text/plain; version=0.0.4\r\n"
+                                   "Content-Length: %d\r\n"
+                                   "Connection: close\r\n\r\n",
+                                   metrics.size());
+
+    socket->write(header, headerSize);
+    socket->write(metrics);
+
+    QTcpSocket *tcpSocket = qobject_cast<QTcpSocket *>(socket);
+    if (tcpSocket != nullptr) {
+        tcpSocket->disconnectFromHost();
+    }
+
+    QLocalSocket *localSocket = qobject_cast<QLocalSocket *>(socket);
+    if (localSocket != nullptr) {
+        localSocket->disconnectFromServer();
+    }
+}
+
+/**
+ * @brief Sample the processes
+ *
+ * Sample the CPU, memory and storage counters of the
+ * QEMU processes of the running machines
+ */
+void MetricsExporter::sampleProcesses()
+{
+    QHash<Machine *, ProcessSample> samples;
+    samples.reserve(this->m_machines->size());
+
+    foreach (Machine *machine, *this->m_machines) {
+        qint64 processId = machine->getProcessId();
+        if (processId <= 0) {
+            continue;
+        }
+
+        ProcessSample sample;
+        if (this->sampleProcess(processId, sample)) {
+            samples.insert(machine, sample);
+        }
+    }
+
+    this->m_samples.swap(samples);
+}
+
+/**
+ * @brief Sample a process
+ * @param processId, pid of the QEMU process
+ * @param sample, sample to be filled
+ * @return true if the process is sampled
+ *
+ * Read /proc/<pid>/stat, /proc/<pid>/statm and /proc/<pid>/io
+ * without allocations. Only available on GNU/Linux
+ */
+bool MetricsExporter::sampleProcess(qint64 processId, ProcessSample &sample) const
+{
+#ifdef Q_OS_LINUX
+    char path[64];
+    char buffer[4096];
+
+    sample.processId = processId;
+    sample.CPUTicks = 0;
+    sample.residentPages = 0;
+    sample.readBytes = -1;
+    sample.writeBytes = -1;
+
+    auto readProcFile = [&](const char *file) -> ssize_t {
+        std::snprintf(path, sizeof(path), "/proc/%lld/%s", static_cast<long long>(processId), file);
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return -1;
+        }
+        ssize_t size = ::read(fd, buffer, sizeof(buffer) - 1);
+        ::close(fd);
+        if (size >= 0) {
+            buffer[size] = '\0';
+        }
+        return size;
+    };
+
+    // utime and stime are the fields 14 and 15, after the command name
+    if (readProcFile("stat") <= 0) {
+        return false;
+    }
+
+    const char *fields = std::strrchr(buffer, ')');
+    if (fields == nullptr) {
+        return false;
+    }
+
+    // Skip the state, a character, and the fields 4 to 13
+    char *end = const_cast<char *>(fields + 2);
+    if (*end != '\0') {
+        ++end;
+    }
+    for (int field = 4; field < 14; ++field) {
+        std::strtoll(end, &end, 10);
+    }
+    qint64 userTicks = std::strtoll(end, &end, 10);
+    qint64 systemTicks = std::strtoll(end, &end, 10);
+    sample.CPUTicks = userTicks + systemTicks;
+
+    // Resident pages are the second field
+    if (readProcFile("statm") > 0) {
+        std::strtoll(buffer, &end, 10);
+        sample.residentPages = std::strtoll(end, &end, 10);
+    }
+
+    // /proc/<pid>/io is only readable by the owner
+    if (readProcFile("io") > 0) {
+        const char *readBytes = std::strstr(buffer, "\nread_bytes:");
+        const char *writeBytes = std::strstr(buffer, "\nwrite_bytes:");
+        if (readBytes != nullptr) {
+            sample.readBytes = std::strtoll(readBytes + 12, nullptr, 10);
+        }
+        if (writeBytes != nullptr) {
+            sample.writeBytes = std::strtoll(writeBytes + 13, nullptr, 10);
+        }
+    }
+
+    return true;
+#else
+    Q_UNUSED(processId)
+    Q_UNUSED(sample)
+    return false;
+#endif
+}
+
+/**
+ * @brief Append the labels of a machine
+ * @param machine, machine
+ *
+ * Append the uuid and the name labels of a machine, escaped
+ * Ex: {uuid="8f6...",name="Debian"}
+ */
+void MetricsExporter::appendLabels(const Machine *machine)
+{
+    this->m_buffer.append("{uuid=\"");
+    QString uuid = machine->getUuid();
+    for (int i = 0; i < uuid.size(); ++i) {
+        char character = uuid.at(i).toLatin1();
+        if (character != '{' && character != '}') {
+            this->m_buffer.append(character);
+        }
+    }
+
+    this->m_buffer.append("\",name=\"");
+    QByteArray name = machine->getName().toUtf8();
+    for (int i = 0; i < name.size(); ++i) {
+        char character = name.at(i);
+        if (character == '\\' || character == '"') {
+            this->m_buffer.append('\\').append(character);
+        } else if (character == '\n') {
+            this->m_buffer.append("\\n");
+        } else {
+            this->m_buffer.append(character);
+        }
+    }
+
+    this->m_buffer.append("\"}");
+}
+
+/**
+ * @brief Append a number
+ * @param value, number to be appended
+ *
+ * Append a number to the buffer without temporary strings
+ */
+void MetricsExporter::appendNumber(qint64 value)
+{
+    char number[32];
+    int size = std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(value));
+    this->m_buffer.append(number, size);
+}
+
+/**
+ * @brief Append seconds
+ * @param milliseconds, time in milliseconds
+ *
+ * Append a time in seconds with millisecond precision
+ */
+void MetricsExporter::appendSeconds(qint64 milliseconds)
+{
+    char number[32];
+    int size = std::snprintf(number, sizeof(number), "%lld.%03lld",
+                             static_cast<long long>(milliseconds / 1000),
+                             static_cast<long long>(milliseconds % 1000));
+    this->m_buffer.append(number, size);
+}
+
+/**
+ * @brief Append the header of a metric
+ * @param name, name of the metric
+ * @param type, type of the metric
+ * @param help, description of the metric
+ *
+ * Append the HELP and TYPE lines of a metric
+ */
+void MetricsExporter::appendMetricHeader(const char *name, const char *type, const char *help)
+{
+    this->m_buffer.append("# HELP ").append(name).append(' ').append(help).append('\n');
+    this->m_buffer.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+}
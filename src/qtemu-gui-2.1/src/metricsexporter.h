@@ -0,0 +1,98 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+// Qt
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QSaveFile>
+#include <QSettings>
+#include <QHash>
+#include <QDir>
+
+#include <QDebug>
+
+// Local
+#include "machine.h"
+
+class MetricsExporter : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit MetricsExporter(const QList<Machine *> *machines,
+                                 QObject *parent = nullptr);
+        ~MetricsExporter();
+
+        void loadSettings();
+        const QByteArray &render();
+
+    signals:
+
+    public slots:
+        void dumpMetrics();
+
+    private slots:
+        void newTcpConnection();
+        void newLocalConnection();
+
+    protected:
+
+    private:
+        struct ProcessSample {
+            qint64 processId;
+            qint64 CPUTicks;
+            qint64 residentPages;
+            qint64 readBytes;
+            qint64 writeBytes;
+        };
+
+        const QList<Machine *> *m_machines;
+
+        QTcpServer *m_tcpServer;
+        QLocalServer *m_localServer;
+        QTimer *m_dumpTimer;
+        QString m_dumpFilePath;
+
+        QByteArray m_buffer;
+        QHash<Machine *, ProcessSample> m_samples;
+        QElapsedTimer m_sampleTimer;
+        int m_sampleInterval;
+
+        // Methods
+        void stopServers();
+        void serveRequest(QIODevice *socket);
+        void sampleProcesses();
+        bool sampleProcess(qint64 processId, ProcessSample &sample) const;
+
+        void appendLabels(const Machine *machine);
+        void appendNumber(qint64 value);
+        void appendSeconds(qint64 milliseconds);
+        void appendMetricHeader(const char *name, const char *type, const char *help);
+};
+
+#endif // METRICSEXPORTER_H
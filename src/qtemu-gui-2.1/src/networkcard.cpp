@@ -0,0 +1,418 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "networkcard.h"
+
+/**
+ * @brief Network card object
+ *
+ * Network card of the machine, the netdev backend
+ * and the guest device.
+ * The backends are user, tap, bridge, socket and local,
+ * a local network shared with other machines of the host
+ */
+NetworkCard::NetworkCard(QObject *parent) : QObject(parent)
+{
+    this->m_backend = "user";
+    this->m_model = "virtio-net-pci";
+    this->m_queues = 1;
+    this->m_vhost = true;
+    this->m_bridge = "br0";
+    this->m_socketMode = "listen";
+
+    qDebug() << "NetworkCard object created";
+}
+
+NetworkCard::~NetworkCard()
+{
+    qDebug() << "NetworkCard object destroyed";
+}
+
+/**
+ * @brief Get the backend of the card
+ * @return backend
+ *
+ * Get the backend of the card
+ * Ex: user, tap, bridge, socket, local
+ */
+QString NetworkCard::backend() const
+{
+    return m_backend;
+}
+
+/**
+ * @brief Set the backend of the card
+ * @param backend, new backend
+ *
+ * Set the backend of the card
+ */
+void NetworkCard::setBackend(const QString &backend)
+{
+    m_backend = backend;
+}
+
+/**
+ * @brief Get the model of the card
+ * @return model
+ *
+ * Get the model of the card
+ * Ex: virtio-net-pci, e1000, rtl8139
+ */
+QString NetworkCard::model() const
+{
+    return m_model;
+}
+
+/**
+ * @brief Set the model of the card
+ * @param model, new model
+ *
+ * Set the model of the card
+ */
+void NetworkCard::setModel(const QString &model)
+{
+    m_model = model;
+}
+
+/**
+ * @brief Get the queues of the card
+ * @return number of queues
+ *
+ * Get the queues of the card, more than one
+ * queue needs a virtio-net card with tap
+ */
+int NetworkCard::queues() const
+{
+    return m_queues;
+}
+
+/**
+ * @brief Set the queues of the card
+ * @param queues, number of queues
+ *
+ * Set the queues of the card
+ */
+void NetworkCard::setQueues(int queues)
+{
+    m_queues = queues;
+}
+
+/**
+ * @brief Get the MAC address of the card
+ * @return MAC address
+ *
+ * Get the MAC address of the card
+ * Ex: 52:54:00:12:34:56
+ */
+QString NetworkCard::MACAddress() const
+{
+    return m_MACAddress;
+}
+
+/**
+ * @brief Set the MAC address of the card
+ * @param MACAddress, new MAC address
+ *
+ * Set the MAC address of the card
+ */
+void NetworkCard::setMACAddress(const QString &MACAddress)
+{
+    m_MACAddress = MACAddress;
+}
+
+/**
+ * @brief Get if the tap backend uses vhost
+ * @return true if vhost is used
+ *
+ * Get if the tap backend uses vhost, the packets are
+ * moved by the host kernel
+ */
+bool NetworkCard::vhost() const
+{
+    return m_vhost;
+}
+
+/**
+ * @brief Set if the tap backend uses vhost
+ * @param vhost, true to use vhost
+ *
+ * Set if the tap backend uses vhost
+ */
+void NetworkCard::setVhost(bool vhost)
+{
+    m_vhost = vhost;
+}
+
+/**
+ * @brief Get the tap interface
+ * @return tap interface name
+ *
+ * Get the tap interface, the interface must exist
+ * and be owned by the user
+ * Ex: tap0
+ */
+QString NetworkCard::ifname() const
+{
+    return m_ifname;
+}
+
+/**
+ * @brief Set the tap interface
+ * @param ifname, tap interface name
+ *
+ * Set the tap interface
+ */
+void NetworkCard::setIfname(const QString &ifname)
+{
+    m_ifname = ifname;
+}
+
+/**
+ * @brief Get the bridge of the bridge helper
+ * @return bridge name
+ *
+ * Get the bridge of the bridge helper
+ * Ex: br0, virbr0
+ */
+QString NetworkCard::bridge() const
+{
+    return m_bridge;
+}
+
+/**
+ * @brief Set the bridge of the bridge helper
+ * @param bridge, bridge name
+ *
+ * Set the bridge of the bridge helper
+ */
+void NetworkCard::setBridge(const QString &bridge)
+{
+    m_bridge = bridge;
+}
+
+/**
+ * @brief Get the socket mode
+ * @return socket mode
+ *
+ * Get the socket mode
+ * Ex: listen, connect, mcast
+ */
+QString NetworkCard::socketMode() const
+{
+    return m_socketMode;
+}
+
+/**
+ * @brief Set the socket mode
+ * @param socketMode, new socket mode
+ *
+ * Set the socket mode
+ */
+void NetworkCard::setSocketMode(const QString &socketMode)
+{
+    m_socketMode = socketMode;
+}
+
+/**
+ * @brief Get the socket address
+ * @return socket address
+ *
+ * Get the socket address
+ * Ex: 127.0.0.1:10000
+ */
+QString NetworkCard::socketAddress() const
+{
+    return m_socketAddress;
+}
+
+/**
+ * @brief Set the socket address
+ * @param socketAddress, new socket address
+ *
+ * Set the socket address
+ */
+void NetworkCard::setSocketAddress(const QString &socketAddress)
+{
+    m_socketAddress = socketAddress;
+}
+
+/**
+ * @brief Get the local network of the card
+ * @return local network name
+ *
+ * Get the local network of the card, used
+ * by the local backend
+ */
+QString NetworkCard::localNetwork() const
+{
+    return m_localNetwork;
+}
+
+/**
+ * @brief Set the local network of the card
+ * @param localNetwork, local network name
+ *
+ * Set the local network of the card
+ */
+void NetworkCard::setLocalNetwork(const QString &localNetwork)
+{
+    m_localNetwork = localNetwork;
+}
+
+/**
+ * @brief Get the uuid of the card
+ * @return the uuid
+ *
+ * Get the uuid of the card
+ */
+QUuid NetworkCard::uuid() const
+{
+    return m_uuid;
+}
+
+/**
+ * @brief Set the uuid of the card
+ * @param uuid, set the new uuid
+ *
+ * Set the uuid of the card
+ */
+void NetworkCard::setUuid(const QUuid &uuid)
+{
+    m_uuid = uuid;
+}
+
+/**
+ * @brief Get the netdev of the card
+ * @param id, netdev id
+ * @return argument for -netdev
+ *
+ * Get the netdev of the card
+ * Ex: tap,id=net0,ifname=tap0,script=no,downscript=no,vhost=on,queues=4
+ */
+QString NetworkCard::netdev(const QString &id) const
+{
+    QString netdev;
+
+    if (this->m_backend == "tap") {
+        netdev = QString("tap,id=%1").arg(id);
+        if (!this->m_ifname.isEmpty()) {
+            netdev.append(",ifname=").append(this->m_ifname);
+        }
+        netdev.append(",script=no,downscript=no");
+        if (this->m_vhost) {
+            netdev.append(",vhost=on");
+        }
+        if (this->m_queues > 1) {
+            netdev.append(QString(",queues=%1").arg(this->m_queues));
+        }
+    } else if (this->m_backend == "bridge") {
+        netdev = QString("bridge,id=%1,br=%2").arg(id).arg(this->m_bridge);
+    } else if (this->m_backend == "socket") {
+        netdev = QString("socket,id=%1,%2=%3").arg(id).arg(this->m_socketMode).arg(this->m_socketAddress);
+    } else if (this->m_backend == "local") {
+        LocalNetworks::Network network = LocalNetworks::network(this->m_localNetwork);
+        netdev = QString("socket,id=%1,mcast=%2:%3,localaddr=127.0.0.1").arg(id)
+                                                                          .arg(network.address)
+                                                                          .arg(network.port);
+    } else {
+        netdev = QString("user,id=%1").arg(id);
+    }
+
+    return netdev;
+}
+
+/**
+ * @brief Get the device of the card
+ * @param id, netdev id
+ * @param model, model used instead of the card model
+ * @return argument for -device
+ *
+ * Get the device of the card. The multiqueue is enabled
+ * for virtio-net with tap, with two vectors per queue pair
+ * Ex: virtio-net-pci,netdev=net0,mac=52:54:00:12:34:56,mq=on,vectors=10
+ */
+QString NetworkCard::device(const QString &id, const QString &model) const
+{
+    QString cardModel = model.isEmpty() ? this->m_model : model;
+
+    QString device = QString("%1,netdev=%2").arg(cardModel).arg(id);
+    if (!this->m_MACAddress.isEmpty()) {
+        device.append(",mac=").append(this->m_MACAddress);
+    }
+
+    if (cardModel.startsWith("virtio-net") && this->m_backend == "tap" && this->m_queues > 1) {
+        device.append(",mq=on");
+        if (cardModel == "virtio-net-pci") {
+            device.append(QString(",vectors=%1").arg(2 * this->m_queues + 2));
+        }
+    }
+
+    // The local networks set the MTU and the RX queue of virtio-net,
+    // QEMU ignores the TX queue size out of vhost-user
+    if (cardModel.startsWith("virtio-net") && this->m_backend == "local") {
+        LocalNetworks::Network network = LocalNetworks::network(this->m_localNetwork);
+        device.append(QString(",host_mtu=%1,rx_queue_size=%2").arg(network.MTU)
+                                                              .arg(network.rxQueueSize));
+    }
+
+    return device;
+}
+
+/**
+ * @brief Clone the card
+ * @param parent, parent of the new card
+ * @return copy of the card
+ *
+ * Clone the card with all the settings
+ */
+NetworkCard *NetworkCard::clone(QObject *parent) const
+{
+    NetworkCard *card = new NetworkCard(parent);
+    card->setBackend(this->m_backend);
+    card->setModel(this->m_model);
+    card->setQueues(this->m_queues);
+    card->setMACAddress(this->m_MACAddress);
+    card->setVhost(this->m_vhost);
+    card->setIfname(this->m_ifname);
+    card->setBridge(this->m_bridge);
+    card->setSocketMode(this->m_socketMode);
+    card->setSocketAddress(this->m_socketAddress);
+    card->setLocalNetwork(this->m_localNetwork);
+    card->setUuid(this->m_uuid);
+
+    return card;
+}
+
+/**
+ * @brief Generate a MAC address
+ * @return random MAC address
+ *
+ * Generate a random MAC address with the QEMU prefix, 52:54:00
+ */
+QString NetworkCard::generateMACAddress()
+{
+    QString MACAddress("52:54:00");
+    for (int i = 0; i < 3; ++i) {
+        MACAddress.append(QString(":%1").arg(QRandomGenerator::global()->bounded(256), 2, 16, QChar('0')));
+    }
+
+    return MACAddress;
+}
@@ -0,0 +1,95 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef NETWORKCARD_H
+#define NETWORKCARD_H
+
+// Qt
+#include <QObject>
+#include <QUuid>
+#include <QRandomGenerator>
+#include <QDebug>
+
+// Local
+#include "localnetworks.h"
+
+class NetworkCard: public QObject {
+    Q_OBJECT
+
+    public:
+        explicit NetworkCard(QObject *parent = nullptr);
+        ~NetworkCard();
+
+        QString backend() const;
+        void setBackend(const QString &backend);
+
+        QString model() const;
+        void setModel(const QString &model);
+
+        int queues() const;
+        void setQueues(int queues);
+
+        QString MACAddress() const;
+        void setMACAddress(const QString &MACAddress);
+
+        bool vhost() const;
+        void setVhost(bool vhost);
+
+        QString ifname() const;
+        void setIfname(const QString &ifname);
+
+        QString bridge() const;
+        void setBridge(const QString &bridge);
+
+        QString socketMode() const;
+        void setSocketMode(const QString &socketMode);
+
+        QString socketAddress() const;
+        void setSocketAddress(const QString &socketAddress);
+
+        QString localNetwork() const;
+        void setLocalNetwork(const QString &localNetwork);
+
+        QUuid uuid() const;
+        void setUuid(const QUuid &uuid);
+
+        // Methods
+        QString netdev(const QString &id) const;
+        QString device(const QString &id, const QString &model = QString()) const;
+        NetworkCard *clone(QObject *parent) const;
+        static QString generateMACAddress();
+
+    protected:
+
+    private:
+        QString m_backend;
+        QString m_model;
+        int m_queues;
+        QString m_MACAddress;
+        bool m_vhost;
+        QString m_ifname;
+        QString m_bridge;
+        QString m_socketMode;
+        QString m_socketAddress;
+        QString m_localNetwork;
+        QUuid m_uuid;
+};
+
+#endif // NETWORKCARD_H
@@ -250,6 +250,7 @@ void MachineConclusionPage::generateBoot()
     boot->setKernelPath("");
     boot->setInitrdPath("");
     boot->setKernelArgs("");
+    boot->setFastBoot(false);
     boot->addBootOrder("c"); // Boot from HDD
 
     this->m_newMachine->setBoot(boot);
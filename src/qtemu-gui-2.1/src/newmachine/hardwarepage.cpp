@@ -25,20 +25,22 @@
 /**
  * @brief Machine hardware page
  * @param machine, new machine object
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param parent, widget parent
  *
  * Hardware page section. In this page you can select the cpu, graphics, audio and
  * network for the new machine
  */
 MachineHardwarePage::MachineHardwarePage(Machine *machine,
+                                         QEMU *QEMUGlobalObject,
                                          QWidget *parent) : QWizardPage(parent)
 {
     this->setTitle(tr("Machine hardware"));
     this->m_newMachine = machine;
 
     m_hardwareTabWidget = new QTabWidget(this);
-    m_hardwareTabWidget->addTab(new ProcessorTab(machine, this), tr("Processor"));
-    m_hardwareTabWidget->addTab(new GraphicsTab(machine, this), tr("Graphics"));
+    m_hardwareTabWidget->addTab(new ProcessorTab(machine, QEMUGlobalObject, this), tr("Processor"));
+    m_hardwareTabWidget->addTab(new GraphicsTab(machine, QEMUGlobalObject, this), tr("Graphics"));
     m_hardwareTabWidget->addTab(new AudioTab(machine, this), tr("Audio"));
     m_hardwareTabWidget->addTab(new NetworkTab(machine, this), tr("Network"));
 
@@ -59,11 +61,13 @@ MachineHardwarePage::~MachineHardwarePage()
 /**
  * @brief Processor tab
  * @param machine, new machine object
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param parent, widget parent
  *
  * Processor tab. In this tab you can select the CPU type, etc...
  */
 ProcessorTab::ProcessorTab(Machine *machine,
+                           QEMU *QEMUGlobalObject,
                            QWidget *parent) : QWidget(parent)
 {
     this->m_newMachine = machine;
@@ -72,7 +76,7 @@ ProcessorTab::ProcessorTab(Machine *machine,
     m_CPUTypeLabel->setWordWrap(true);
 
     m_CPUType = new QComboBox(this);
-    SystemUtils::setCPUTypesx86(m_CPUType);
+    SystemUtils::setCPUTypesx86(m_CPUType, QEMUGlobalObject);
     this->selectProcessor(0);
 
     connect(m_CPUType, QOverload<int>::of(&QComboBox::currentIndexChanged),
@@ -246,12 +250,14 @@ void ProcessorTab::selectMaxHotCPU(int maxCPU)
 /**
  * @brief GraphicsTab tab
  * @param machine, new machine object
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param parent, widget parent
  *
  * GraphicsTab tab. In this tab you can select the GPU type and
  * keyboard
  */
 GraphicsTab::GraphicsTab(Machine *machine,
+                         QEMU *QEMUGlobalObject,
                          QWidget *parent) : QWidget(parent)
 {
     this->m_newMachine = machine;
@@ -259,9 +265,10 @@ GraphicsTab::GraphicsTab(Machine *machine,
     m_GPUTypeLabel = new QLabel(tr("GPU Type") + ":", this);
     m_GPUTypeLabel->setWordWrap(true);
     m_GPUType = new QComboBox(this);
-    SystemUtils::setGPUTypes(m_GPUType);
-    m_GPUType->setCurrentIndex(1);
-    this->selectGraphics(1);
+    SystemUtils::setGPUTypes(m_GPUType, QEMUGlobalObject);
+    int stdGPUIndex = qMax(m_GPUType->findData("std"), 0);
+    m_GPUType->setCurrentIndex(stdGPUIndex);
+    this->selectGraphics(stdGPUIndex);
 
     connect(m_GPUType, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &GraphicsTab::selectGraphics);
@@ -510,14 +517,20 @@ void AudioTab::selectPCSpeakerCard(bool selectPCSpeaker)
  * @param parent, widget parent
  *
  * NetworkTab tab. In this tab you can enable or disable
- * the network
+ * the network and choose the backend of the card
  */
 NetworkTab::NetworkTab(Machine *machine,
                        QWidget *parent) : QWidget(parent)
 {
     this->m_newMachine = machine;
 
-    m_withNetworkRadio = new QRadioButton(tr("User Mode Network Connection (Uses the user mode network stack)"), this);
+    // One virtio-net card, more cards can be added in the configuration
+    this->m_networkCard = new NetworkCard(machine);
+    this->m_networkCard->setMACAddress(NetworkCard::generateMACAddress());
+    this->m_networkCard->setUuid(QUuid::createUuid());
+    this->m_newMachine->addNetworkCard(this->m_networkCard);
+
+    m_withNetworkRadio = new QRadioButton(tr("Network Connection (Uses a virtio-net network card)"), this);
     m_withNetworkRadio->setChecked(true);
     this->networkState(true);
 
@@ -526,8 +539,30 @@ NetworkTab::NetworkTab(Machine *machine,
 
     m_withoutNetworkRadio = new QRadioButton(tr("No network (No network cards installed on this machine"), this);
 
+    m_backendComboBox = new QComboBox(this);
+    m_backendComboBox->addItem(tr("User mode"), "user");
+    m_backendComboBox->addItem(tr("Tap with vhost"), "tap");
+    m_backendComboBox->addItem(tr("Bridge helper"), "bridge");
+    m_backendComboBox->addItem(tr("Socket"), "socket");
+
+    connect(m_backendComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &NetworkTab::selectBackend);
+
+    m_queuesSpinBox = new QSpinBox(this);
+    m_queuesSpinBox->setMinimum(1);
+    m_queuesSpinBox->setMaximum(16);
+    m_queuesSpinBox->setEnabled(false);
+
+    connect(m_queuesSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &NetworkTab::selectQueues);
+
+    m_networkCardLayout = new QFormLayout();
+    m_networkCardLayout->addRow(tr("Backend") + ":", m_backendComboBox);
+    m_networkCardLayout->addRow(tr("Queues") + ":", m_queuesSpinBox);
+
     m_networkLayout = new QVBoxLayout();
     m_networkLayout->addWidget(m_withNetworkRadio);
+    m_networkLayout->addLayout(m_networkCardLayout);
     m_networkLayout->addWidget(m_withoutNetworkRadio);
 
     this->setLayout(m_networkLayout);
@@ -550,3 +585,29 @@ void NetworkTab::networkState(bool network)
 {
     this->m_newMachine->setUseNetwork(network);
 }
+
+/**
+ * @brief Select the backend of the card
+ * @param index, backend index
+ *
+ * Select the backend of the card.
+ * The queues are only used with tap
+ */
+void NetworkTab::selectBackend(int index)
+{
+    QString backend = this->m_backendComboBox->itemData(index).toString();
+
+    this->m_networkCard->setBackend(backend);
+    this->m_queuesSpinBox->setEnabled(backend == "tap");
+}
+
+/**
+ * @brief Select the queues of the card
+ * @param queues, number of queues
+ *
+ * Select the queues of the card
+ */
+void NetworkTab::selectQueues(int queues)
+{
+    this->m_networkCard->setQueues(queues);
+}
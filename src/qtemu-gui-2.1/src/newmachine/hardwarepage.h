@@ -25,6 +25,7 @@
 // Qt
 #include <QWizard>
 #include <QVBoxLayout>
+#include <QFormLayout>
 #include <QTabWidget>
 #include <QComboBox>
 #include <QLabel>
@@ -42,6 +43,7 @@ class MachineHardwarePage: public QWizardPage {
 
     public:
         explicit MachineHardwarePage(Machine *machine,
+                                     QEMU *QEMUGlobalObject,
                                      QWidget *parent = nullptr);
         ~MachineHardwarePage();
 
@@ -64,6 +66,7 @@ class ProcessorTab: public QWidget {
 
     public:
         explicit ProcessorTab(Machine *machine,
+                              QEMU *QEMUGlobalObject,
                               QWidget *parent = nullptr);
         ~ProcessorTab();
 
@@ -112,6 +115,7 @@ class GraphicsTab: public QWidget {
 
     public:
         explicit GraphicsTab(Machine *machine,
+                             QEMU *QEMUGlobalObject,
                              QWidget *parent = nullptr);
         ~GraphicsTab();
     signals:
@@ -181,15 +185,23 @@ class NetworkTab: public QWidget {
 
     public slots:
         void networkState(bool network);
+        void selectBackend(int index);
+        void selectQueues(int queues);
 
     protected:
 
     private:
         QVBoxLayout *m_networkLayout;
+        QFormLayout *m_networkCardLayout;
 
         QRadioButton *m_withNetworkRadio;
         QRadioButton *m_withoutNetworkRadio;
 
+        QComboBox *m_backendComboBox;
+        QSpinBox *m_queuesSpinBox;
+
+        NetworkCard *m_networkCard;
+
         Machine *m_newMachine;
 };
 
@@ -24,16 +24,19 @@
 /**
  * @brief Machine page
  * @param machine, new machine object
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
  * @param parent, widget parent
  *
  * Machine page section. In this page you can select the machine type.
  * ex: for x86_64, pc-i440fx-1.4
  */
 MachinePage::MachinePage(Machine *machine,
+                         QEMU *QEMUGlobalObject,
                          QWidget *parent) : QWizardPage(parent)
 {
     this->setTitle(tr("Machine page"));
     this->m_newMachine = machine;
+    this->m_qemuGlobalObject = QEMUGlobalObject;
 
     customFilter = new CustomFilter(this);
     this->setMachines();
@@ -91,7 +94,9 @@ void MachinePage::textFilterChanged()
 /**
  * @brief Add the machines to the model
  *
- * Add all the machines to the model
+ * Add all the machines to the model.
+ * If the QEMU binary is probed, the machines supported
+ * by the binary are used
  */
 void MachinePage::setMachines()
 {
@@ -100,6 +105,20 @@ void MachinePage::setMachines()
     model->setHeaderData(0, Qt::Horizontal, QObject::tr("Machine"));
     model->setHeaderData(1, Qt::Horizontal, QObject::tr("Description"));
 
+    if (this->m_qemuGlobalObject->capabilities()->isProbed()) {
+        QMap<QString, QString> machineTypes = this->m_qemuGlobalObject->capabilities()->machineTypes();
+        QMapIterator<QString, QString> machinesIterator(machineTypes);
+        while (machinesIterator.hasNext()) {
+            machinesIterator.next();
+            this->addMachine(model, machinesIterator.key(), machinesIterator.value());
+        }
+
+        if (model->rowCount() > 0) {
+            customFilter->setSourceModel(model);
+            return;
+        }
+    }
+
     this->addMachine(model, "none", "empty machine");
     this->addMachine(model, "isapc", "ISA-only PC");
     this->addMachine(model, "pc", "Standard PC (i440FX + PIIX, 1996) (alias of pc-i440fx-3.0)");
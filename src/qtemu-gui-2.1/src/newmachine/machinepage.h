@@ -37,6 +37,7 @@ class MachinePage: public QWizardPage {
 
     public:
         explicit MachinePage(Machine *machine,
+                             QEMU *QEMUGlobalObject,
                              QWidget *parent = nullptr);
         ~MachinePage();
 
@@ -61,6 +62,7 @@ class MachinePage: public QWizardPage {
         QLineEdit *filterLineEdit;
 
         Machine *m_newMachine;
+        QEMU *m_qemuGlobalObject;
 
         // Methods
         bool validatePage();
@@ -21,6 +21,8 @@
 
 // Local
 #include "qemu.h"
+#include "admissioncontroller.h"
+#include "hostportregistry.h"
 
 /**
  * @brief QEMU object
@@ -54,6 +56,14 @@ QEMU::QEMU(QObject *parent) : QObject(parent)
     settings.endGroup();
     settings.sync();
 
+    this->m_capabilities = new QEMUCapabilities(this);
+    this->m_admissionController = new AdmissionController(this);
+    this->m_hostPortRegistry = new HostPortRegistry(this);
+
+    this->m_binaryRegistry = new QEMUBinaryRegistry(this);
+    connect(m_binaryRegistry, &QEMUBinaryRegistry::binariesChangedSignal,
+            this, &QEMU::binariesChanged);
+
     this->setQEMUImgPath(qemuImgPath);
     this->setQEMUBinaries(qemuBinariesPath);
 
@@ -114,17 +124,81 @@ QString QEMU::getQEMUBinary(const QString binary) const
  * @brief Set the QEMU binaries
  * @param path, path where the QEMU binaries are located
  *
- * Set the QEMU binaries
+ * Set the QEMU binaries.
+ * The binaries known by the registry are used immediately
+ * and the path is rescanned in background, so only the
+ * directories modified since the last scan are listed
  */
 void QEMU::setQEMUBinaries(const QString path)
 {
-    this->m_QEMUBinaries.clear();
-
-    QDirIterator it(path, QStringList() << "qemu-system-*", QDir::NoFilter, QDirIterator::Subdirectories);
-    while (it.hasNext()) {
-        it.next();
-        if (!it.fileName().contains("w")) {
-            this->m_QEMUBinaries.insert(it.fileName(), it.filePath());
-        }
-    }
+    this->m_binaryRegistry->setPath(path);
+    this->m_binaryRegistry->rescan();
+
+    this->binariesChanged();
+}
+
+/**
+ * @brief Get the registry of QEMU binaries
+ * @return registry with the version and architecture of the binaries
+ *
+ * Get the registry of QEMU binaries
+ */
+QEMUBinaryRegistry *QEMU::binaryRegistry() const
+{
+    return m_binaryRegistry;
+}
+
+/**
+ * @brief Binaries changed
+ *
+ * Update the QEMU binaries with the binaries of the registry
+ * and probe the capabilities of the binary used to run the machines
+ */
+void QEMU::binariesChanged()
+{
+    this->m_QEMUBinaries = this->m_binaryRegistry->binaries();
+
+    #ifdef Q_OS_WIN
+    this->m_capabilities->setBinaryPath(this->getQEMUBinary("qemu-system-x86_64.exe"));
+    #else
+    this->m_capabilities->setBinaryPath(this->getQEMUBinary("qemu-system-x86_64"));
+    #endif
+
+    emit QEMUBinariesChangedSignal();
+}
+
+/**
+ * @brief Get the capabilities of the QEMU binary
+ * @return capabilities of the qemu-system-x86_64 binary
+ *
+ * Get the CPU models, machine types, devices and accelerators
+ * supported by the QEMU binary used to run the machines
+ */
+QEMUCapabilities *QEMU::capabilities() const
+{
+    return m_capabilities;
+}
+
+/**
+ * @brief Get the admission controller
+ * @return admission controller of the machines
+ *
+ * Get the controller that checks the resources of
+ * the host before a machine is launched
+ */
+AdmissionController *QEMU::admissionController() const
+{
+    return m_admissionController;
+}
+
+/**
+ * @brief Get the host port registry
+ * @return registry of the forwarded host ports
+ *
+ * Get the registry of the host ports forwarded
+ * to the running machines
+ */
+HostPortRegistry *QEMU::hostPortRegistry() const
+{
+    return m_hostPortRegistry;
 }
@@ -24,7 +24,7 @@
 
 // Qt
 #include <QObject>
-#include <QDirIterator>
+#include <QDir>
 #include <QFile>
 #include <QMap>
 #include <QSettings>
@@ -32,6 +32,13 @@
 
 #include <QDebug>
 
+// Local
+#include "qemucapabilities.h"
+#include "qemubinaryregistry.h"
+
+class AdmissionController;
+class HostPortRegistry;
+
 class QEMU : public QObject {
     Q_OBJECT
 
@@ -46,11 +53,26 @@ class QEMU : public QObject {
         QString getQEMUBinary(const QString binary) const;
         void setQEMUBinaries(const QString path);
 
+        QEMUBinaryRegistry *binaryRegistry() const;
+        QEMUCapabilities *capabilities() const;
+        AdmissionController *admissionController() const;
+        HostPortRegistry *hostPortRegistry() const;
+
+    signals:
+        void QEMUBinariesChangedSignal();
+
+    private slots:
+        void binariesChanged();
+
     protected:
 
     private:
         QString m_QEMUImgPath;
         QMap<QString, QString> m_QEMUBinaries;
+        QEMUBinaryRegistry *m_binaryRegistry;
+        QEMUCapabilities *m_capabilities;
+        AdmissionController *m_admissionController;
+        HostPortRegistry *m_hostPortRegistry;
 
 };
 
@@ -0,0 +1,264 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "qemubinaryregistry.h"
+
+/**
+ * @brief Registry of QEMU binaries
+ * @param parent, parent object
+ *
+ * Registry with the QEMU binaries found in the binaries path,
+ * their version and their target architecture.
+ * The registry is stored in the binaries.json file of the data
+ * folder, so the binaries are available at startup without
+ * walking the binaries path
+ */
+QEMUBinaryRegistry::QEMUBinaryRegistry(QObject *parent) : QObject(parent)
+{
+    this->m_scanner = nullptr;
+    this->m_rescanPending = false;
+
+    QSettings settings;
+    settings.beginGroup("DataFolder");
+    QString dataDirectoryPath = settings.value("QtEmuData",
+                                               QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/")).toString();
+    settings.endGroup();
+
+    this->m_registryFilePath = dataDirectoryPath.append("binaries.json");
+    this->loadRegistry();
+
+    qDebug() << "QEMUBinaryRegistry object created";
+}
+
+QEMUBinaryRegistry::~QEMUBinaryRegistry()
+{
+    if (this->m_scanner != nullptr) {
+        this->m_scanner->requestInterruption();
+        this->m_scanner->wait();
+    }
+
+    qDebug() << "QEMUBinaryRegistry object destroyed";
+}
+
+/**
+ * @brief Get the binaries path
+ * @return path where the QEMU binaries are located
+ *
+ * Get the binaries path
+ */
+QString QEMUBinaryRegistry::path() const
+{
+    return m_path;
+}
+
+/**
+ * @brief Set the binaries path
+ * @param path, path where the QEMU binaries are located
+ *
+ * Set the binaries path. If the registry has the binaries
+ * of the path they are available immediately, in other case
+ * there are no binaries until the first scan finishes
+ */
+void QEMUBinaryRegistry::setPath(const QString &path)
+{
+    this->m_path = path;
+    this->fillBinaries();
+}
+
+/**
+ * @brief Rescan the binaries path
+ *
+ * Rescan the binaries path in background. Only the directories
+ * modified since the last scan are listed again.
+ * binariesChangedSignal is emitted if the binaries change
+ */
+void QEMUBinaryRegistry::rescan()
+{
+    if (this->m_path.isEmpty()) {
+        return;
+    }
+
+    if (this->m_scanner != nullptr) {
+        this->m_rescanPending = true;
+        return;
+    }
+
+    this->m_rescanPending = false;
+
+    this->m_scanner = new QEMUBinaryScanner(this->m_path, this->m_registry, this);
+    connect(m_scanner, &QEMUBinaryScanner::scanFinishedSignal,
+            this, &QEMUBinaryRegistry::scanFinished);
+    connect(m_scanner, &QThread::finished,
+            m_scanner, &QObject::deleteLater);
+    connect(m_scanner, &QThread::finished,
+            this, [=]() {
+        this->m_scanner = nullptr;
+        if (this->m_rescanPending) {
+            this->rescan();
+        }
+    });
+
+    this->m_scanner->start(QThread::LowPriority);
+}
+
+/**
+ * @brief Know if a scan is running
+ * @return true if the binaries path is being scanned
+ *
+ * Know if a scan is running
+ */
+bool QEMUBinaryRegistry::isScanning() const
+{
+    return this->m_scanner != nullptr;
+}
+
+/**
+ * @brief Get all the binaries
+ * @return QMap with the name and the location of the binaries
+ *
+ * Get all the binaries
+ */
+QMap<QString, QString> QEMUBinaryRegistry::binaries() const
+{
+    return m_binaries;
+}
+
+/**
+ * @brief Get the version of a binary
+ * @param binary, name of the binary
+ * @return version of the binary
+ *
+ * Get the version of a binary
+ * Ex: 3.1.0, 4.2.1...
+ */
+QString QEMUBinaryRegistry::binaryVersion(const QString &binary) const
+{
+    return this->binaryObject(binary)["version"].toString();
+}
+
+/**
+ * @brief Get the target architecture of a binary
+ * @param binary, name of the binary
+ * @return architecture emulated by the binary
+ *
+ * Get the target architecture of a binary
+ * Ex: x86_64, aarch64...
+ */
+QString QEMUBinaryRegistry::binaryArchitecture(const QString &binary) const
+{
+    return this->binaryObject(binary)["arch"].toString();
+}
+
+/**
+ * @brief Scan finished
+ * @param scan, result of the scan
+ *
+ * Store the result of the scan and notify if the binaries changed
+ */
+void QEMUBinaryRegistry::scanFinished(const QJsonObject &scan)
+{
+    bool binariesChanged = scan["binaries"] != this->m_registry["binaries"] ||
+                           scan["path"] != this->m_registry["path"];
+    bool directoriesChanged = scan["directories"] != this->m_registry["directories"];
+
+    this->m_registry = scan;
+
+    if (binariesChanged || directoriesChanged) {
+        this->saveRegistry();
+    }
+
+    if (scan["path"].toString() != this->m_path) {
+        this->m_rescanPending = true;
+        return;
+    }
+
+    if (binariesChanged) {
+        this->fillBinaries();
+        emit binariesChangedSignal();
+    }
+}
+
+/**
+ * @brief Load the registry
+ *
+ * Load the registry from the data folder
+ */
+void QEMUBinaryRegistry::loadRegistry()
+{
+    QFile registryFile(this->m_registryFilePath);
+    if (!registryFile.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    QJsonDocument registryDocument(QJsonDocument::fromJson(registryFile.readAll()));
+    this->m_registry = registryDocument.object();
+
+    registryFile.close();
+}
+
+/**
+ * @brief Save the registry
+ *
+ * Save the registry in the data folder
+ */
+void QEMUBinaryRegistry::saveRegistry()
+{
+    QFile registryFile(this->m_registryFilePath);
+    if (!registryFile.open(QFile::WriteOnly)) {
+        qDebug() << "Cannot write the binaries registry" << this->m_registryFilePath;
+        return;
+    }
+
+    registryFile.write(QJsonDocument(this->m_registry).toJson(QJsonDocument::Compact));
+    registryFile.close();
+}
+
+/**
+ * @brief Fill the binaries
+ *
+ * Fill the binaries with the registry data of the current path
+ */
+void QEMUBinaryRegistry::fillBinaries()
+{
+    this->m_binaries.clear();
+
+    if (this->m_registry["path"].toString() != this->m_path) {
+        return;
+    }
+
+    QJsonObject binariesObject = this->m_registry["binaries"].toObject();
+    for (QJsonObject::const_iterator it = binariesObject.constBegin(); it != binariesObject.constEnd(); ++it) {
+        this->m_binaries.insert(it.value().toObject()["name"].toString(), it.key());
+    }
+}
+
+/**
+ * @brief Get the registry data of a binary
+ * @param binary, name of the binary
+ * @return object with the data of the binary
+ *
+ * Get the registry data of a binary
+ */
+QJsonObject QEMUBinaryRegistry::binaryObject(const QString &binary) const
+{
+    return this->m_registry["binaries"].toObject().value(this->m_binaries.value(binary)).toObject();
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef QEMUBINARYREGISTRY_H
+#define QEMUBINARYREGISTRY_H
+
+// Qt
+#include <QObject>
+#include <QSettings>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <QDebug>
+
+// Local
+#include "qemubinaryscanner.h"
+
+class QEMUBinaryRegistry : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit QEMUBinaryRegistry(QObject *parent = nullptr);
+        ~QEMUBinaryRegistry();
+
+        QString path() const;
+        void setPath(const QString &path);
+        void rescan();
+        bool isScanning() const;
+
+        QMap<QString, QString> binaries() const;
+        QString binaryVersion(const QString &binary) const;
+        QString binaryArchitecture(const QString &binary) const;
+
+    signals:
+        void binariesChangedSignal();
+
+    public slots:
+
+    private slots:
+        void scanFinished(const QJsonObject &scan);
+
+    protected:
+
+    private:
+        QString m_path;
+        QString m_registryFilePath;
+
+        QJsonObject m_registry;
+        QMap<QString, QString> m_binaries;
+
+        QEMUBinaryScanner *m_scanner;
+        bool m_rescanPending;
+
+        // Methods
+        void loadRegistry();
+        void saveRegistry();
+        void fillBinaries();
+        QJsonObject binaryObject(const QString &binary) const;
+};
+
+#endif // QEMUBINARYREGISTRY_H
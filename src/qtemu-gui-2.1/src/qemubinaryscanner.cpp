@@ -0,0 +1,229 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "qemubinaryscanner.h"
+#include "qemucapabilities.h"
+#include "utils/tracer.h"
+
+/**
+ * @brief Scanner of QEMU binaries
+ * @param path, path where the QEMU binaries are located
+ * @param previousScan, result of the previous scan of the path
+ * @param parent, parent object
+ *
+ * Thread that looks for the qemu-system-* binaries inside the path.
+ * Directories with the same modification time than in the
+ * previous scan aren't listed again, and binaries with the same
+ * size and modification time keep the version of the previous scan
+ */
+QEMUBinaryScanner::QEMUBinaryScanner(const QString &path,
+                                     const QJsonObject &previousScan,
+                                     QObject *parent) : QThread(parent)
+{
+    this->m_path = path;
+
+    if (previousScan["path"].toString() == path) {
+        this->m_previousScan = previousScan;
+    }
+
+    qDebug() << "QEMUBinaryScanner object created";
+}
+
+QEMUBinaryScanner::~QEMUBinaryScanner()
+{
+    qDebug() << "QEMUBinaryScanner object destroyed";
+}
+
+/**
+ * @brief Get the path scanned
+ * @return path scanned
+ *
+ * Get the path scanned
+ */
+QString QEMUBinaryScanner::path() const
+{
+    return m_path;
+}
+
+/**
+ * @brief Get the target architecture of a binary
+ * @param binaryName, name of the binary
+ * @return architecture emulated by the binary
+ *
+ * Get the target architecture of a binary from its name
+ * Ex: qemu-system-x86_64.exe -> x86_64
+ */
+QString QEMUBinaryScanner::binaryArchitecture(const QString &binaryName)
+{
+    QString architecture = binaryName;
+    architecture.remove(QRegularExpression("^qemu-system-"));
+    architecture.remove(QRegularExpression("\\.exe$"));
+
+    return architecture;
+}
+
+/**
+ * @brief Scan the path
+ *
+ * Scan the path and all its subdirectories. When the scan
+ * finishes, scanFinishedSignal is emitted with the result
+ */
+void QEMUBinaryScanner::run()
+{
+    QTEMU_TRACE_SCOPE("QEMU binaries scan");
+
+    QJsonObject previousDirectories = this->m_previousScan["directories"].toObject();
+    QJsonObject previousBinaries = this->m_previousScan["binaries"].toObject();
+
+    QJsonObject directories;
+    QJsonObject binaries;
+
+    int listedDirectories = 0;
+
+    QStringList pendingDirectories;
+    pendingDirectories.append(QDir::cleanPath(this->m_path));
+
+    while (!pendingDirectories.isEmpty() && !this->isInterruptionRequested()) {
+        QString directoryPath = pendingDirectories.takeFirst();
+        if (directories.contains(directoryPath)) {
+            continue;
+        }
+
+        QFileInfo directoryInfo(directoryPath);
+        if (!directoryInfo.isDir()) {
+            continue;
+        }
+
+        qint64 modified = directoryInfo.lastModified().toMSecsSinceEpoch();
+        QJsonObject directoryObject = previousDirectories.value(directoryPath).toObject();
+
+        if (directoryObject.isEmpty() || directoryObject["modified"].toVariant().toLongLong() != modified) {
+            QDir directory(directoryPath);
+
+            QJsonArray subdirectories;
+            foreach (const QString &subdirectory,
+                     directory.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks)) {
+                subdirectories.append(directory.filePath(subdirectory));
+            }
+
+            QJsonArray binaryNames;
+            foreach (const QString &binaryName,
+                     directory.entryList(QStringList() << "qemu-system-*", QDir::Files | QDir::System)) {
+                if (!binaryName.contains("w")) {
+                    binaryNames.append(binaryName);
+                }
+            }
+
+            directoryObject = QJsonObject();
+            directoryObject["modified"] = modified;
+            directoryObject["subdirectories"] = subdirectories;
+            directoryObject["binaries"] = binaryNames;
+
+            ++listedDirectories;
+        }
+
+        directories[directoryPath] = directoryObject;
+
+        QJsonArray subdirectories = directoryObject["subdirectories"].toArray();
+        for (int i = 0; i < subdirectories.size(); ++i) {
+            pendingDirectories.append(subdirectories[i].toString());
+        }
+
+        QJsonArray binaryNames = directoryObject["binaries"].toArray();
+        for (int i = 0; i < binaryNames.size(); ++i) {
+            QFileInfo binaryInfo(QDir(directoryPath).filePath(binaryNames[i].toString()));
+            if (!binaryInfo.exists()) {
+                continue;
+            }
+
+            binaries[binaryInfo.filePath()] = this->scanBinary(binaryInfo,
+                                                               previousBinaries.value(binaryInfo.filePath()).toObject());
+        }
+    }
+
+    if (this->isInterruptionRequested()) {
+        return;
+    }
+
+    qDebug() << "QEMU binaries scanned:" << directories.size() << "directories,"
+             << listedDirectories << "listed," << binaries.size() << "binaries";
+
+    QJsonObject scan;
+    scan["path"] = this->m_path;
+    scan["directories"] = directories;
+    scan["binaries"] = binaries;
+
+    emit scanFinishedSignal(scan);
+}
+
+/**
+ * @brief Scan one binary
+ * @param binaryInfo, file info of the binary
+ * @param previousBinary, result of the previous scan of the binary
+ * @return object with the data of the binary
+ *
+ * Scan one binary. The version is only asked to QEMU
+ * if the binary has changed since the previous scan
+ */
+QJsonObject QEMUBinaryScanner::scanBinary(const QFileInfo &binaryInfo,
+                                          const QJsonObject &previousBinary) const
+{
+    qint64 size = binaryInfo.size();
+    qint64 modified = binaryInfo.lastModified().toMSecsSinceEpoch();
+
+    if (!previousBinary.isEmpty() &&
+        previousBinary["size"].toVariant().toLongLong() == size &&
+        previousBinary["modified"].toVariant().toLongLong() == modified) {
+        return previousBinary;
+    }
+
+    QJsonObject binaryObject;
+    binaryObject["name"] = binaryInfo.fileName();
+    binaryObject["size"] = size;
+    binaryObject["modified"] = modified;
+    binaryObject["version"] = this->binaryVersion(binaryInfo.filePath());
+    binaryObject["arch"] = QEMUBinaryScanner::binaryArchitecture(binaryInfo.fileName());
+
+    return binaryObject;
+}
+
+/**
+ * @brief Get the version of a binary
+ * @param binaryPath, path of the binary
+ * @return version of the binary, empty if QEMU doesn't answer
+ *
+ * Get the version of a binary running it with --version
+ */
+QString QEMUBinaryScanner::binaryVersion(const QString &binaryPath) const
+{
+    QProcess versionProcess;
+    versionProcess.setProcessChannelMode(QProcess::MergedChannels);
+    versionProcess.start(binaryPath, QStringList() << "--version");
+
+    if (!versionProcess.waitForFinished(5000)) {
+        versionProcess.kill();
+        versionProcess.waitForFinished();
+        return QString();
+    }
+
+    return QEMUCapabilities::parseVersion(versionProcess.readAll());
+}
@@ -0,0 +1,68 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef QEMUBINARYSCANNER_H
+#define QEMUBINARYSCANNER_H
+
+// Qt
+#include <QThread>
+#include <QProcess>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QRegularExpression>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <QDebug>
+
+class QEMUBinaryScanner : public QThread {
+    Q_OBJECT
+
+    public:
+        explicit QEMUBinaryScanner(const QString &path,
+                                   const QJsonObject &previousScan,
+                                   QObject *parent = nullptr);
+        ~QEMUBinaryScanner();
+
+        QString path() const;
+
+        static QString binaryArchitecture(const QString &binaryName);
+
+    signals:
+        void scanFinishedSignal(const QJsonObject &scan);
+
+    public slots:
+
+    protected:
+        void run() override;
+
+    private:
+        QString m_path;
+        QJsonObject m_previousScan;
+
+        // Methods
+        QJsonObject scanBinary(const QFileInfo &binaryInfo,
+                               const QJsonObject &previousBinary) const;
+        QString binaryVersion(const QString &binaryPath) const;
+};
+
+#endif // QEMUBINARYSCANNER_H
@@ -0,0 +1,508 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "qemucapabilities.h"
+
+/**
+ * @brief Capabilities of a QEMU binary
+ * @param parent, parent object
+ *
+ * CPU models, machine types, devices and accelerators supported
+ * by one QEMU binary. QEMU is asked only once per binary, the
+ * results are stored in the capabilities.json file of the data folder
+ * and reused while the size and the modification time of the
+ * binary doesn't change
+ */
+QEMUCapabilities::QEMUCapabilities(QObject *parent) : QObject(parent)
+{
+    this->m_probeProcess = nullptr;
+
+    QSettings settings;
+    settings.beginGroup("DataFolder");
+    QString dataDirectoryPath = settings.value("QtEmuData",
+                                               QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/")).toString();
+    settings.endGroup();
+
+    this->m_cacheFilePath = dataDirectoryPath.append("capabilities.json");
+    this->loadCache();
+
+    qDebug() << "QEMUCapabilities object created";
+}
+
+QEMUCapabilities::~QEMUCapabilities()
+{
+    qDebug() << "QEMUCapabilities object destroyed";
+}
+
+/**
+ * @brief Get the path of the binary
+ * @return path of the binary
+ *
+ * Get the path of the binary
+ */
+QString QEMUCapabilities::binaryPath() const
+{
+    return m_binaryPath;
+}
+
+/**
+ * @brief Set the path of the binary
+ * @param binaryPath, path of the binary
+ *
+ * Set the path of the binary. The capabilities are taken
+ * from the cache if they are still valid, if not, QEMU is
+ * probed in background and capabilitiesProbedSignal is
+ * emitted when the probe finishes
+ */
+void QEMUCapabilities::setBinaryPath(const QString &binaryPath)
+{
+    if (binaryPath == this->m_binaryPath && this->isProbed()) {
+        return;
+    }
+
+    if (this->m_probeProcess != nullptr) {
+        this->m_probeProcess->disconnect(this);
+        this->m_probeProcess->kill();
+        this->m_probeProcess->deleteLater();
+        this->m_probeProcess = nullptr;
+    }
+
+    this->m_binaryPath = binaryPath;
+    this->m_capabilities = QJsonObject();
+
+    if (binaryPath.isEmpty()) {
+        return;
+    }
+
+    QJsonObject cacheEntry = this->m_cache.value(binaryPath).toObject();
+    if (this->isCacheEntryValid(cacheEntry)) {
+        this->m_capabilities = cacheEntry;
+        return;
+    }
+
+    QFileInfo binaryInfo(binaryPath);
+    if (!binaryInfo.isExecutable()) {
+        return;
+    }
+
+    this->m_probeCapabilities = QJsonObject();
+    this->m_probeCapabilities["size"] = binaryInfo.size();
+    this->m_probeCapabilities["modified"] = binaryInfo.lastModified().toMSecsSinceEpoch();
+
+    this->m_probeSteps.clear();
+    this->m_probeSteps << "version" << "machine" << "cpu" << "device" << "accel";
+
+    this->m_probeProcess = new QProcess(this);
+    this->m_probeProcess->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_probeProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &QEMUCapabilities::probeStepFinished);
+
+    this->startProbeStep();
+}
+
+/**
+ * @brief Know if the capabilities of the binary are available
+ * @return true if the binary has been probed
+ *
+ * Know if the capabilities of the binary are available
+ */
+bool QEMUCapabilities::isProbed() const
+{
+    return !this->m_capabilities.isEmpty();
+}
+
+/**
+ * @brief Get the version of the binary
+ * @return version of the binary
+ *
+ * Get the version of the binary
+ * Ex: 3.1.0, 4.2.1...
+ */
+QString QEMUCapabilities::version() const
+{
+    return this->m_capabilities["version"].toString();
+}
+
+/**
+ * @brief Get the CPU models
+ * @return map with the CPU model and its description
+ *
+ * Get the CPU models supported by the binary
+ */
+QMap<QString, QString> QEMUCapabilities::CPUModels() const
+{
+    QMap<QString, QString> CPUModels;
+    QJsonObject CPUObject = this->m_capabilities["cpus"].toObject();
+    for (QJsonObject::const_iterator it = CPUObject.constBegin(); it != CPUObject.constEnd(); ++it) {
+        CPUModels.insert(it.key(), it.value().toString());
+    }
+
+    return CPUModels;
+}
+
+/**
+ * @brief Get the machine types
+ * @return map with the machine type and its description
+ *
+ * Get the machine types supported by the binary
+ */
+QMap<QString, QString> QEMUCapabilities::machineTypes() const
+{
+    QMap<QString, QString> machineTypes;
+    QJsonObject machinesObject = this->m_capabilities["machines"].toObject();
+    for (QJsonObject::const_iterator it = machinesObject.constBegin(); it != machinesObject.constEnd(); ++it) {
+        machineTypes.insert(it.key(), it.value().toString());
+    }
+
+    return machineTypes;
+}
+
+/**
+ * @brief Get the devices
+ * @return list with the names and aliases of the devices
+ *
+ * Get the devices supported by the binary
+ */
+QStringList QEMUCapabilities::devices() const
+{
+    QStringList devices;
+    QJsonArray devicesArray = this->m_capabilities["devices"].toArray();
+    for (int i = 0; i < devicesArray.size(); ++i) {
+        devices.append(devicesArray[i].toString());
+    }
+
+    return devices;
+}
+
+/**
+ * @brief Get the accelerators
+ * @return list with the accelerators
+ *
+ * Get the accelerators supported by the binary.
+ * Old binaries don't support -accel help, in that
+ * case the list is empty
+ */
+QStringList QEMUCapabilities::accelerators() const
+{
+    QStringList accelerators;
+    QJsonArray acceleratorsArray = this->m_capabilities["accelerators"].toArray();
+    for (int i = 0; i < acceleratorsArray.size(); ++i) {
+        accelerators.append(acceleratorsArray[i].toString());
+    }
+
+    return accelerators;
+}
+
+/**
+ * @brief Know if the binary supports a CPU model
+ * @param CPUModel, CPU model
+ * @return true if the CPU model is supported or the binary isn't probed
+ *
+ * Know if the binary supports a CPU model
+ */
+bool QEMUCapabilities::hasCPUModel(const QString &CPUModel) const
+{
+    QJsonObject CPUObject = this->m_capabilities["cpus"].toObject();
+
+    return CPUObject.isEmpty() || CPUObject.contains(CPUModel);
+}
+
+/**
+ * @brief Know if the binary supports a device
+ * @param device, name or alias of the device
+ * @return true if the device is supported or the binary isn't probed
+ *
+ * Know if the binary supports a device
+ */
+bool QEMUCapabilities::hasDevice(const QString &device) const
+{
+    QJsonArray devicesArray = this->m_capabilities["devices"].toArray();
+
+    return devicesArray.isEmpty() || devicesArray.contains(device);
+}
+
+/**
+ * @brief Know if the binary supports an accelerator
+ * @param accelerator, accelerator
+ * @return true if the accelerator is supported or it's unknown
+ *
+ * Know if the binary supports an accelerator
+ */
+bool QEMUCapabilities::hasAccelerator(const QString &accelerator) const
+{
+    QJsonArray acceleratorsArray = this->m_capabilities["accelerators"].toArray();
+
+    return acceleratorsArray.isEmpty() || acceleratorsArray.contains(accelerator);
+}
+
+/**
+ * @brief Parse the output of --version
+ * @param output, output of QEMU
+ * @return version of QEMU
+ *
+ * Parse the output of --version
+ * Ex: QEMU emulator version 3.1.0 (Debian 1:3.1+dfsg-8)
+ */
+QString QEMUCapabilities::parseVersion(const QByteArray &output)
+{
+    QRegularExpression versionRegex("version\\s+(\\d+\\.\\d+(\\.\\d+)?)");
+    QRegularExpressionMatch versionMatch = versionRegex.match(QString::fromUtf8(output));
+
+    return versionMatch.hasMatch() ? versionMatch.captured(1) : QString();
+}
+
+/**
+ * @brief Parse the output of -cpu help
+ * @param output, output of QEMU
+ * @return object with the CPU models and their descriptions
+ *
+ * Parse the output of -cpu help. Old versions prefix every
+ * model with the architecture, newer versions use a header.
+ * The CPUID flags at the end are ignored
+ * Ex: x86            Haswell  Intel Core Processor (Haswell)
+ */
+QJsonObject QEMUCapabilities::parseCPUHelp(const QByteArray &output)
+{
+    QJsonObject CPUObject;
+    QRegularExpression CPURegex("^\\s*(?:x86\\s+)?(\\S+)\\s*(.*)$");
+
+    QStringList lines = QString::fromUtf8(output).split("\n");
+    foreach (const QString &line, lines) {
+        if (line.startsWith("Recognized") || line.startsWith("Available CPU definition")) {
+            break;
+        }
+
+        if (line.trimmed().isEmpty() || line.endsWith(":")) {
+            continue;
+        }
+
+        QRegularExpressionMatch CPUMatch = CPURegex.match(line);
+        if (CPUMatch.hasMatch()) {
+            QString description = CPUMatch.captured(2).trimmed();
+            description.remove(QRegularExpression("^'|'$"));
+            CPUObject[CPUMatch.captured(1)] = description;
+        }
+    }
+
+    return CPUObject;
+}
+
+/**
+ * @brief Parse the output of -machine help
+ * @param output, output of QEMU
+ * @return object with the machine types and their descriptions
+ *
+ * Parse the output of -machine help
+ * Ex: pc-q35-3.0           Standard PC (Q35 + ICH9, 2009)
+ */
+QJsonObject QEMUCapabilities::parseMachineHelp(const QByteArray &output)
+{
+    QJsonObject machinesObject;
+    QRegularExpression machineRegex("^(\\S+)\\s+(.*)$");
+
+    QStringList lines = QString::fromUtf8(output).split("\n");
+    foreach (const QString &line, lines) {
+        if (line.startsWith("Supported machines")) {
+            continue;
+        }
+
+        QRegularExpressionMatch machineMatch = machineRegex.match(line.trimmed());
+        if (machineMatch.hasMatch()) {
+            machinesObject[machineMatch.captured(1)] = machineMatch.captured(2).trimmed();
+        }
+    }
+
+    return machinesObject;
+}
+
+/**
+ * @brief Parse the output of -device help
+ * @param output, output of QEMU
+ * @return array with the names and aliases of the devices
+ *
+ * Parse the output of -device help
+ * Ex: name "AC97", bus PCI, alias "ac97", desc "Intel 82801AA AC97 Audio"
+ */
+QJsonArray QEMUCapabilities::parseDeviceHelp(const QByteArray &output)
+{
+    QJsonArray devicesArray;
+    QRegularExpression deviceRegex("(?:name|alias) \"([^\"]+)\"");
+
+    QRegularExpressionMatchIterator deviceIterator = deviceRegex.globalMatch(QString::fromUtf8(output));
+    while (deviceIterator.hasNext()) {
+        devicesArray.append(deviceIterator.next().captured(1));
+    }
+
+    return devicesArray;
+}
+
+/**
+ * @brief Parse the output of -accel help
+ * @param output, output of QEMU
+ * @return array with the accelerators
+ *
+ * Parse the output of -accel help
+ */
+QJsonArray QEMUCapabilities::parseAccelHelp(const QByteArray &output)
+{
+    QJsonArray acceleratorsArray;
+
+    QStringList lines = QString::fromUtf8(output).split("\n");
+    foreach (const QString &line, lines) {
+        QString accelerator = line.trimmed();
+        if (accelerator.isEmpty() || accelerator.contains(" ") || accelerator.endsWith(":")) {
+            continue;
+        }
+        acceleratorsArray.append(accelerator);
+    }
+
+    return acceleratorsArray;
+}
+
+/**
+ * @brief One step of the probe has finished
+ * @param exitCode, exit code of QEMU
+ * @param exitStatus, exit status of QEMU
+ *
+ * Parse the output of the step and start the next one.
+ * When all the steps are done, the capabilities are stored in the cache
+ */
+void QEMUCapabilities::probeStepFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QString step = this->m_probeSteps.takeFirst();
+    QByteArray output = this->m_probeProcess->readAll();
+    bool stepFailed = (exitStatus != QProcess::NormalExit || exitCode != 0);
+
+    if (step == "version") {
+        if (stepFailed) {
+            qDebug() << "Cannot probe the QEMU binary" << this->m_binaryPath;
+            this->m_probeProcess->deleteLater();
+            this->m_probeProcess = nullptr;
+            return;
+        }
+        this->m_probeCapabilities["version"] = QEMUCapabilities::parseVersion(output);
+    } else if (!stepFailed) {
+        if (step == "machine") {
+            this->m_probeCapabilities["machines"] = QEMUCapabilities::parseMachineHelp(output);
+        } else if (step == "cpu") {
+            this->m_probeCapabilities["cpus"] = QEMUCapabilities::parseCPUHelp(output);
+        } else if (step == "device") {
+            this->m_probeCapabilities["devices"] = QEMUCapabilities::parseDeviceHelp(output);
+        } else if (step == "accel") {
+            this->m_probeCapabilities["accelerators"] = QEMUCapabilities::parseAccelHelp(output);
+        }
+    }
+
+    if (!this->m_probeSteps.isEmpty()) {
+        this->startProbeStep();
+        return;
+    }
+
+    this->m_probeProcess->deleteLater();
+    this->m_probeProcess = nullptr;
+
+    this->m_capabilities = this->m_probeCapabilities;
+    this->m_cache[this->m_binaryPath] = this->m_capabilities;
+    this->saveCache();
+
+    qDebug() << "QEMU binary probed" << this->m_binaryPath << this->version();
+
+    emit(capabilitiesProbedSignal());
+}
+
+/**
+ * @brief Start the next step of the probe
+ *
+ * Start the next step of the probe
+ */
+void QEMUCapabilities::startProbeStep()
+{
+    QString step = this->m_probeSteps.first();
+
+    QStringList args;
+    if (step == "version") {
+        args << "--version";
+    } else {
+        args << QString("-%1").arg(step) << "help";
+    }
+
+    this->m_probeProcess->start(this->m_binaryPath, args, QIODevice::ReadOnly);
+}
+
+/**
+ * @brief Load the capabilities cache
+ *
+ * Load the capabilities cache from the data folder
+ */
+void QEMUCapabilities::loadCache()
+{
+    QFile cacheFile(this->m_cacheFilePath);
+    if (!cacheFile.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    QJsonDocument cacheDocument(QJsonDocument::fromJson(cacheFile.readAll()));
+    this->m_cache = cacheDocument["binaries"].toObject();
+
+    cacheFile.close();
+}
+
+/**
+ * @brief Save the capabilities cache
+ *
+ * Save the capabilities cache in the data folder
+ */
+void QEMUCapabilities::saveCache()
+{
+    QFile cacheFile(this->m_cacheFilePath);
+    if (!cacheFile.open(QFile::WriteOnly)) {
+        qDebug() << "Cannot write the capabilities cache" << this->m_cacheFilePath;
+        return;
+    }
+
+    QJsonObject cacheObject;
+    cacheObject["binaries"] = this->m_cache;
+
+    cacheFile.write(QJsonDocument(cacheObject).toJson(QJsonDocument::Compact));
+    cacheFile.close();
+}
+
+/**
+ * @brief Check if a cache entry is still valid
+ * @param entry, cache entry of the binary
+ * @return true if the binary hasn't changed since the probe
+ *
+ * Check if a cache entry is still valid comparing the size
+ * and the modification time of the binary
+ */
+bool QEMUCapabilities::isCacheEntryValid(const QJsonObject &entry) const
+{
+    if (entry.isEmpty()) {
+        return false;
+    }
+
+    QFileInfo binaryInfo(this->m_binaryPath);
+
+    return binaryInfo.exists() &&
+           entry["size"].toVariant().toLongLong() == binaryInfo.size() &&
+           entry["modified"].toVariant().toLongLong() == binaryInfo.lastModified().toMSecsSinceEpoch();
+}
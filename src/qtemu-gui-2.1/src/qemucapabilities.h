@@ -0,0 +1,99 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef QEMUCAPABILITIES_H
+#define QEMUCAPABILITIES_H
+
+// Qt
+#include <QObject>
+#include <QProcess>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSettings>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QRegularExpression>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <QDebug>
+
+class QEMUCapabilities : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit QEMUCapabilities(QObject *parent = nullptr);
+        ~QEMUCapabilities();
+
+        QString binaryPath() const;
+        void setBinaryPath(const QString &binaryPath);
+
+        bool isProbed() const;
+        QString version() const;
+
+        QMap<QString, QString> CPUModels() const;
+        QMap<QString, QString> machineTypes() const;
+        QStringList devices() const;
+        QStringList accelerators() const;
+
+        bool hasCPUModel(const QString &CPUModel) const;
+        bool hasDevice(const QString &device) const;
+        bool hasAccelerator(const QString &accelerator) const;
+
+        // Parsers of the QEMU help output
+        static QString parseVersion(const QByteArray &output);
+        static QJsonObject parseCPUHelp(const QByteArray &output);
+        static QJsonObject parseMachineHelp(const QByteArray &output);
+        static QJsonArray parseDeviceHelp(const QByteArray &output);
+        static QJsonArray parseAccelHelp(const QByteArray &output);
+
+    signals:
+        void capabilitiesProbedSignal();
+
+    public slots:
+
+    private slots:
+        void probeStepFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    protected:
+
+    private:
+        QString m_binaryPath;
+        QString m_cacheFilePath;
+
+        QJsonObject m_cache;
+        QJsonObject m_capabilities;
+
+        // Probe
+        QProcess *m_probeProcess;
+        QStringList m_probeSteps;
+        QJsonObject m_probeCapabilities;
+
+        // Methods
+        void loadCache();
+        void saveCache();
+        bool isCacheEntryValid(const QJsonObject &entry) const;
+        void startProbeStep();
+};
+
+#endif // QEMUCAPABILITIES_H
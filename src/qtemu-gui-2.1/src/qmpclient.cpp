@@ -0,0 +1,308 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "qmpclient.h"
+
+// Attempts to connect while QEMU creates the socket
+static const int MAX_CONNECT_ATTEMPTS = 50;
+
+/**
+ * @brief QMP client
+ * @param machinePath, path of the machine
+ * @param machineUuid, uuid of the machine
+ * @param parent, parent object
+ *
+ * Client for the QEMU Machine Protocol of a machine.
+ * QEMU listens in qmp.sock inside the machine folder
+ * (a named pipe on Windows), the client negotiates the
+ * capabilities and then executes commands and receives events
+ */
+QMPClient::QMPClient(const QString &machinePath,
+                     const QString &machineUuid,
+                     QObject *parent) : QObject(parent)
+{
+    QString uuid(machineUuid);
+    uuid.remove("{").remove("}");
+
+#ifdef Q_OS_WIN
+    // Named pipe \\.\pipe\qtemu-qmp-<uuid>
+    this->m_serverName = "qtemu-qmp-" + uuid;
+#else
+    this->m_serverName = QDir(machinePath).filePath("qmp.sock");
+#endif
+
+    this->m_connectAttempts = 0;
+    this->m_ready = false;
+    this->m_nextCommandId = 1;
+
+    this->m_qmpSocket = new QLocalSocket(this);
+    connect(m_qmpSocket, &QLocalSocket::readyRead,
+            this, &QMPClient::readMessages);
+    connect(m_qmpSocket, &QLocalSocket::disconnected,
+            this, &QMPClient::socketDisconnected);
+
+    this->m_connectTimer = new QTimer(this);
+    this->m_connectTimer->setInterval(100);
+    this->m_connectTimer->setSingleShot(true);
+    connect(m_connectTimer, &QTimer::timeout,
+            this, &QMPClient::tryConnect);
+
+    qDebug() << "QMPClient object created";
+}
+
+QMPClient::~QMPClient()
+{
+    this->disconnectFromMachine();
+
+    qDebug() << "QMPClient object destroyed";
+}
+
+/**
+ * @brief Get the QEMU arguments
+ * @return arguments for the QMP monitor
+ *
+ * Get the QEMU arguments to expose the QMP monitor
+ */
+QStringList QMPClient::QEMUArguments() const
+{
+    QStringList arguments;
+
+#ifdef Q_OS_WIN
+    arguments << "-chardev" << QString("pipe,id=qmp,path=%1").arg(this->m_serverName);
+#else
+    arguments << "-chardev" << QString("socket,id=qmp,path=%1,server,nowait").arg(this->m_serverName);
+#endif
+    arguments << "-mon" << "chardev=qmp,mode=control";
+
+    return arguments;
+}
+
+/**
+ * @brief Know if the client is ready
+ * @return true if the capabilities are negotiated
+ *
+ * Know if the client can execute commands
+ */
+bool QMPClient::isReady() const
+{
+    return m_ready;
+}
+
+/**
+ * @brief Connect to the machine
+ *
+ * Connect to the QMP monitor of the machine.
+ * readySignal is emitted when the capabilities are negotiated
+ */
+void QMPClient::connectToMachine()
+{
+    this->m_connectAttempts = 0;
+    this->tryConnect();
+}
+
+/**
+ * @brief Disconnect from the machine
+ *
+ * Disconnect from the QMP monitor. The pending commands
+ * are answered with an error
+ */
+void QMPClient::disconnectFromMachine()
+{
+    this->m_connectTimer->stop();
+    this->m_qmpSocket->abort();
+    this->socketDisconnected();
+}
+
+/**
+ * @brief Execute a command
+ * @param command, QMP command
+ * @param arguments, arguments of the command
+ * @param callback, function called with the reply, optional
+ *
+ * Execute a QMP command. The reply has a return or an error member
+ * Ex: execute("balloon", {"value": 1073741824})
+ */
+void QMPClient::execute(const QString &command,
+                        const QJsonObject &arguments,
+                        ReplyCallback callback)
+{
+    if (!this->m_ready) {
+        if (callback) {
+            QJsonObject error;
+            error["class"] = "GenericError";
+            error["desc"] = "QMP is not connected";
+
+            QJsonObject reply;
+            reply["error"] = error;
+            callback(reply);
+        }
+        return;
+    }
+
+    qint64 commandId = this->m_nextCommandId++;
+
+    QJsonObject message;
+    message["execute"] = command;
+    message["id"] = commandId;
+    if (!arguments.isEmpty()) {
+        message["arguments"] = arguments;
+    }
+
+    this->m_pendingCommands.insert(commandId, callback);
+    this->sendMessage(message);
+}
+
+/**
+ * @brief Try to connect
+ *
+ * Try to connect to the QMP socket, retried until QEMU creates it
+ */
+void QMPClient::tryConnect()
+{
+    if (this->m_qmpSocket->state() != QLocalSocket::UnconnectedState) {
+        return;
+    }
+
+    this->m_qmpSocket->connectToServer(this->m_serverName);
+
+    if (this->m_qmpSocket->waitForConnected(0) ||
+        this->m_qmpSocket->state() == QLocalSocket::ConnectedState) {
+        return;
+    }
+
+    this->m_qmpSocket->abort();
+
+    if (++this->m_connectAttempts >= MAX_CONNECT_ATTEMPTS) {
+        qDebug() << "Cannot connect to QMP" << this->m_serverName;
+        return;
+    }
+
+    this->m_connectTimer->start();
+}
+
+/**
+ * @brief Read the messages
+ *
+ * Read the messages of QEMU, one JSON object per line
+ */
+void QMPClient::readMessages()
+{
+    while (this->m_qmpSocket->canReadLine()) {
+        QByteArray line = this->m_qmpSocket->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QJsonParseError parseError;
+        QJsonDocument messageDocument = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !messageDocument.isObject()) {
+            qDebug() << "Invalid QMP message" << line;
+            continue;
+        }
+
+        this->processMessage(messageDocument.object());
+    }
+}
+
+/**
+ * @brief Socket disconnected
+ *
+ * Fail the pending commands and notify the disconnection
+ */
+void QMPClient::socketDisconnected()
+{
+    bool wasReady = this->m_ready;
+    this->m_ready = false;
+
+    QHash<qint64, ReplyCallback> pendingCommands;
+    pendingCommands.swap(this->m_pendingCommands);
+
+    QJsonObject error;
+    error["class"] = "GenericError";
+    error["desc"] = "QMP disconnected";
+
+    QJsonObject reply;
+    reply["error"] = error;
+
+    foreach (const ReplyCallback &callback, pendingCommands) {
+        if (callback) {
+            callback(reply);
+        }
+    }
+
+    if (wasReady) {
+        emit disconnectedSignal();
+    }
+}
+
+/**
+ * @brief Send a message
+ * @param message, message to be sent
+ *
+ * Send a message to QEMU
+ */
+void QMPClient::sendMessage(const QJsonObject &message)
+{
+    this->m_qmpSocket->write(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    this->m_qmpSocket->write("\n");
+}
+
+/**
+ * @brief Process a message
+ * @param message, message of QEMU
+ *
+ * Process the greeting, the command replies and the events
+ */
+void QMPClient::processMessage(const QJsonObject &message)
+{
+    // Greeting, negotiate the capabilities
+    if (message.contains("QMP")) {
+        QJsonObject capabilities;
+        capabilities["execute"] = "qmp_capabilities";
+        capabilities["id"] = 0;
+        this->sendMessage(capabilities);
+        return;
+    }
+
+    if (message.contains("event")) {
+        emit eventSignal(message["event"].toString(),
+                         message["data"].toObject(),
+                         message["timestamp"].toObject());
+        return;
+    }
+
+    qint64 commandId = message["id"].toVariant().toLongLong();
+
+    if (commandId == 0) {
+        if (message.contains("return") && !this->m_ready) {
+            this->m_ready = true;
+            qDebug() << "QMP connected" << this->m_serverName;
+            emit readySignal();
+        }
+        return;
+    }
+
+    ReplyCallback callback = this->m_pendingCommands.take(commandId);
+    if (callback) {
+        callback(message);
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef QMPCLIENT_H
+#define QMPCLIENT_H
+
+// Qt
+#include <QObject>
+#include <QLocalSocket>
+#include <QTimer>
+#include <QHash>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <QDebug>
+
+// C++ standard library
+#include <functional>
+
+class QMPClient : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit QMPClient(const QString &machinePath,
+                           const QString &machineUuid,
+                           QObject *parent = nullptr);
+        ~QMPClient();
+
+        typedef std::function<void(const QJsonObject &reply)> ReplyCallback;
+
+        QStringList QEMUArguments() const;
+        bool isReady() const;
+
+        void connectToMachine();
+        void disconnectFromMachine();
+
+        void execute(const QString &command,
+                     const QJsonObject &arguments = QJsonObject(),
+                     ReplyCallback callback = nullptr);
+
+    signals:
+        void readySignal();
+        void eventSignal(const QString &event,
+                         const QJsonObject &data,
+                         const QJsonObject &timestamp);
+        void disconnectedSignal();
+
+    public slots:
+
+    private slots:
+        void tryConnect();
+        void readMessages();
+        void socketDisconnected();
+
+    protected:
+
+    private:
+        QString m_serverName;
+
+        QLocalSocket *m_qmpSocket;
+        QTimer *m_connectTimer;
+        int m_connectAttempts;
+        bool m_ready;
+
+        qint64 m_nextCommandId;
+        QHash<qint64, ReplyCallback> m_pendingCommands;
+
+        // Methods
+        void sendMessage(const QJsonObject &message);
+        void processMessage(const QJsonObject &message);
+};
+
+#endif // QMPCLIENT_H
@@ -0,0 +1,201 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "serialconsole.h"
+
+// Attempts to connect while QEMU creates the chardev
+static const int MAX_CONNECT_ATTEMPTS = 50;
+
+/**
+ * @brief Serial console of a machine
+ * @param machinePath, path of the machine
+ * @param machineUuid, uuid of the machine
+ * @param logSize, bytes of serial output retained
+ * @param parent, parent object
+ *
+ * QEMU listens in a chardev for the first serial port of the
+ * machine and QtEmu drains it into the serial.log file of the
+ * machine, a circular log that never grows over logSize
+ */
+SerialConsole::SerialConsole(const QString &machinePath,
+                             const QString &machineUuid,
+                             qint64 logSize,
+                             QObject *parent) : QObject(parent)
+{
+    QString uuid(machineUuid);
+    uuid.remove("{").remove("}");
+
+#ifdef Q_OS_WIN
+    // Named pipe \\.\pipe\qtemu-serial-<uuid>
+    this->m_serverName = "qtemu-serial-" + uuid;
+#else
+    this->m_serverName = QDir(machinePath).filePath("serial.sock");
+#endif
+
+    this->m_serialLog = new SerialLog(QDir(machinePath).filePath("serial.log"), logSize);
+    this->m_connectAttempts = 0;
+
+    this->m_serialSocket = new QLocalSocket(this);
+    connect(m_serialSocket, &QLocalSocket::readyRead,
+            this, &SerialConsole::readSerialData);
+
+    this->m_connectTimer = new QTimer(this);
+    this->m_connectTimer->setInterval(100);
+    connect(m_connectTimer, &QTimer::timeout,
+            this, &SerialConsole::connectToMachine);
+
+    qDebug() << "SerialConsole object created";
+}
+
+SerialConsole::~SerialConsole()
+{
+    this->stop();
+    delete this->m_serialLog;
+
+    qDebug() << "SerialConsole object destroyed";
+}
+
+/**
+ * @brief Get the chardev server
+ * @return path of the socket or name of the pipe
+ *
+ * Get the chardev server where QEMU listens
+ */
+QString SerialConsole::chardevServer() const
+{
+    return m_serverName;
+}
+
+/**
+ * @brief Get the QEMU arguments
+ * @return arguments for the serial chardev
+ *
+ * Get the QEMU arguments to expose the first serial port
+ */
+QStringList SerialConsole::QEMUArguments() const
+{
+    QStringList arguments;
+
+#ifdef Q_OS_WIN
+    arguments << "-chardev" << QString("pipe,id=serial0,path=%1").arg(this->m_serverName);
+#else
+    arguments << "-chardev" << QString("socket,id=serial0,path=%1,server,nowait").arg(this->m_serverName);
+#endif
+    arguments << "-serial" << "chardev:serial0";
+
+    return arguments;
+}
+
+/**
+ * @brief Get the serial log
+ * @return circular log with the serial output
+ *
+ * Get the serial log. The viewers can read it without copies
+ * with SerialLog::segments
+ */
+const SerialLog *SerialConsole::log() const
+{
+    return m_serialLog;
+}
+
+/**
+ * @brief Start capturing the serial console
+ *
+ * Open the log and connect to the chardev of the machine
+ */
+void SerialConsole::start()
+{
+    if (!this->m_serialLog->open()) {
+        return;
+    }
+
+    this->m_connectAttempts = 0;
+    this->connectToMachine();
+}
+
+/**
+ * @brief Stop capturing the serial console
+ *
+ * Drain the pending data and close the log
+ */
+void SerialConsole::stop()
+{
+    this->m_connectTimer->stop();
+
+    if (this->m_serialSocket->state() == QLocalSocket::ConnectedState) {
+        this->readSerialData();
+    }
+
+    this->m_serialSocket->abort();
+    this->m_serialLog->close();
+}
+
+/**
+ * @brief Connect to the machine
+ *
+ * Connect to the chardev of the machine.
+ * Retried until QEMU creates the chardev
+ */
+void SerialConsole::connectToMachine()
+{
+    if (this->m_serialSocket->state() != QLocalSocket::UnconnectedState) {
+        return;
+    }
+
+    this->m_serialSocket->connectToServer(this->m_serverName, QIODevice::ReadOnly);
+
+    if (this->m_serialSocket->waitForConnected(0) ||
+        this->m_serialSocket->state() == QLocalSocket::ConnectedState) {
+        this->m_connectTimer->stop();
+        qDebug() << "Serial console connected" << this->m_serverName;
+        return;
+    }
+
+    this->m_serialSocket->abort();
+
+    if (++this->m_connectAttempts >= MAX_CONNECT_ATTEMPTS) {
+        this->m_connectTimer->stop();
+        qDebug() << "Cannot connect to the serial console" << this->m_serverName;
+        return;
+    }
+
+    this->m_connectTimer->start();
+}
+
+/**
+ * @brief Read the serial data
+ *
+ * Append the serial data to the log and emit it
+ */
+void SerialConsole::readSerialData()
+{
+    char buffer[16384];
+    QByteArray serialData;
+
+    qint64 bytesRead;
+    while ((bytesRead = this->m_serialSocket->read(buffer, sizeof(buffer))) > 0) {
+        this->m_serialLog->append(buffer, bytesRead);
+        serialData.append(buffer, static_cast<int>(bytesRead));
+    }
+
+    emit serialDataSignal(serialData);
+}
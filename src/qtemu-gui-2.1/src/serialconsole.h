@@ -0,0 +1,74 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef SERIALCONSOLE_H
+#define SERIALCONSOLE_H
+
+// Qt
+#include <QObject>
+#include <QLocalSocket>
+#include <QTimer>
+#include <QDir>
+
+#include <QDebug>
+
+// Local
+#include "utils/seriallog.h"
+
+class SerialConsole : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit SerialConsole(const QString &machinePath,
+                               const QString &machineUuid,
+                               qint64 logSize,
+                               QObject *parent = nullptr);
+        ~SerialConsole();
+
+        QString chardevServer() const;
+        QStringList QEMUArguments() const;
+
+        const SerialLog *log() const;
+
+        void start();
+        void stop();
+
+    signals:
+        void serialDataSignal(const QByteArray &data);
+
+    public slots:
+
+    private slots:
+        void connectToMachine();
+        void readSerialData();
+
+    protected:
+
+    private:
+        QString m_serverName;
+        SerialLog *m_serialLog;
+
+        QLocalSocket *m_serialSocket;
+        QTimer *m_connectTimer;
+        int m_connectAttempts;
+};
+
+#endif // SERIALCONSOLE_H
@@ -0,0 +1,383 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "batchprovisioner.h"
+
+/**
+ * @brief Batch provisioner
+ * @param QEMUGlobalObject, QEMU global object, used to find qemu-img
+ * @param parent, parent object
+ *
+ * Creates N machines from a template. The disks are overlays of the
+ * golden images of the template or full copies, created by several
+ * qemu-img processes in parallel. When all the disks are ready the
+ * config files are written and the machines are added to the catalog
+ * with one atomic write. If something fails nothing is added and the
+ * folders of the new machines are removed. The Templates settings
+ * group has:
+ * parallelJobs: qemu-img processes at the same time, the CPU count by default
+ */
+BatchProvisioner::BatchProvisioner(QEMU *QEMUGlobalObject,
+                                   QObject *parent) : QObject(parent)
+{
+    this->m_QEMUGlobalObject = QEMUGlobalObject;
+    this->m_running = false;
+    this->m_totalJobs = 0;
+    this->m_doneJobs = 0;
+    this->m_maxParallelJobs = 1;
+
+    qDebug() << "BatchProvisioner object created";
+}
+
+BatchProvisioner::~BatchProvisioner()
+{
+    if (this->m_running) {
+        this->rollback(tr("The provisioning was cancelled"));
+    }
+
+    qDebug() << "BatchProvisioner object destroyed";
+}
+
+/**
+ * @brief Provision machines from a template
+ * @param templateName, name of the template
+ * @param count, number of machines
+ * @param namePrefix, prefix of the names, followed by a number
+ * @param diskMode, overlays of the golden images or full copies
+ * @return true if the provisioning is started
+ *
+ * Generate the names, the uuids and the folders of the machines
+ * and start the creation of their disks
+ */
+bool BatchProvisioner::provision(const QString &templateName, int count,
+                                 const QString &namePrefix, DiskMode diskMode)
+{
+    if (this->m_running || count < 1) {
+        return false;
+    }
+
+    QJsonObject templateJSON = TemplateLibrary::readTemplate(templateName);
+    if (templateJSON.isEmpty()) {
+        emit(finishedSignal(false, QStringList(), tr("The template %1 doesn't exist").arg(templateName)));
+        return false;
+    }
+
+    QSettings settings;
+    settings.beginGroup("Configuration");
+    QString machinesPath = settings.value("machinePath", QDir::homePath()).toString();
+    settings.endGroup();
+
+    settings.beginGroup("Templates");
+    this->m_maxParallelJobs = qMax(1, settings.value("parallelJobs", QThread::idealThreadCount()).toInt());
+    settings.endGroup();
+
+    this->m_running = true;
+    this->m_templateName = templateName;
+    this->m_newMachines.clear();
+    this->m_createdFolders.clear();
+    this->m_pendingJobs.clear();
+    this->m_doneJobs = 0;
+
+    QDir templateDirectory(TemplateLibrary::templatePath(templateName));
+    QString prefix = namePrefix.trimmed().isEmpty() ? templateName : namePrefix.trimmed();
+    int numberWidth = qMax(2, QString::number(count).length());
+
+    int number = 0;
+    while (this->m_newMachines.size() < count) {
+        ++number;
+        QString name = QString("%1-%2").arg(prefix).arg(number, numberWidth, 10, QChar('0'));
+        QString machinePath = QDir(machinesPath).filePath(name);
+
+        // The folder can belong to another machine
+        if (QDir(machinePath).exists()) {
+            continue;
+        }
+
+        if (!QDir().mkpath(machinePath) || !QDir().mkpath(QDir(machinePath).filePath("logs"))) {
+            this->rollback(tr("Cannot create the folder %1").arg(machinePath));
+            return false;
+        }
+        this->m_createdFolders.append(machinePath);
+
+        QString fileName = name.toLower().replace(" ", "_");
+
+        QJsonObject machineJSON = templateJSON["machine"].toObject();
+        machineJSON["name"] = name;
+        machineJSON["uuid"] = QUuid::createUuid().toString();
+        machineJSON["path"] = machinePath;
+        machineJSON["description"] = tr("Created from the template %1").arg(templateName);
+        foreach (const QString &key, this->m_machineOverrides.keys()) {
+            machineJSON[key] = this->m_machineOverrides.value(key);
+        }
+
+        QJsonArray media = machineJSON["media"].toArray();
+        for (int i = 0; i < media.size(); ++i) {
+            QJsonObject disk = media.at(i).toObject();
+            QString imagePath = disk["path"].toString();
+            if (disk["type"].toString() != "hdd" || !QDir::isRelativePath(imagePath)) {
+                continue;
+            }
+
+            QString diskName = QString("%1-disk%2.qcow2").arg(fileName).arg(i);
+            QString diskPath = QDir(machinePath).filePath(diskName);
+
+            QStringList jobArguments;
+            if (diskMode == BatchProvisioner::Overlay) {
+                jobArguments << "create" << "-f" << "qcow2"
+                             << "-b" << templateDirectory.filePath(imagePath)
+                             << "-F" << "qcow2"
+                             << diskPath;
+            } else {
+                jobArguments << "convert" << "-O" << "qcow2"
+                             << templateDirectory.filePath(imagePath)
+                             << diskPath;
+            }
+            this->m_pendingJobs.append(jobArguments);
+
+            disk["name"] = diskName;
+            disk["path"] = diskPath;
+            disk["uuid"] = QUuid::createUuid().toString();
+            media.replace(i, disk);
+        }
+        machineJSON["media"] = media;
+
+        // Every machine needs its own MAC addresses
+        QJsonArray networkCards = machineJSON["networkCards"].toArray();
+        for (int i = 0; i < networkCards.size(); ++i) {
+            QJsonObject card = networkCards.at(i).toObject();
+            card["MAC"] = NetworkCard::generateMACAddress();
+            card["uuid"] = QUuid::createUuid().toString();
+            networkCards.replace(i, card);
+        }
+        if (machineJSON.contains("networkCards")) {
+            machineJSON["networkCards"] = networkCards;
+        }
+
+        NewMachine newMachine;
+        newMachine.name = name;
+        newMachine.configPath = QDir(machinePath).filePath(fileName + ".json");
+        newMachine.machineJSON = machineJSON;
+        this->m_newMachines.append(newMachine);
+    }
+
+    this->m_totalJobs = this->m_pendingJobs.size();
+    emit(progressSignal(0, this->m_totalJobs));
+
+    if (this->m_pendingJobs.isEmpty()) {
+        this->commit();
+    } else {
+        this->startJobs();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Cancel the provisioning
+ *
+ * Stop the qemu-img processes and remove the new machines
+ */
+void BatchProvisioner::cancel()
+{
+    if (this->m_running) {
+        this->rollback(tr("The provisioning was cancelled"));
+    }
+}
+
+/**
+ * @brief Get if the provisioning is running
+ * @return true if machines are being provisioned
+ *
+ * Get if the provisioning is running
+ */
+bool BatchProvisioner::isRunning() const
+{
+    return this->m_running;
+}
+
+/**
+ * @brief Set the overrides of the machines
+ * @param overrides, keys of the machine config replaced in every new machine
+ *
+ * Set the keys of the machine config that replace
+ * the ones of the template in the new machines
+ */
+void BatchProvisioner::setMachineOverrides(const QJsonObject &overrides)
+{
+    this->m_machineOverrides = overrides;
+}
+
+/**
+ * @brief A disk is created
+ * @param exitCode, exit code of qemu-img
+ * @param exitStatus, exit status of qemu-img
+ *
+ * Start the next disks, the machines are committed
+ * when all the disks are created
+ */
+void BatchProvisioner::jobFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QProcess *job = qobject_cast<QProcess *>(this->sender());
+    if (job == nullptr || !this->m_runningJobs.removeOne(job)) {
+        return;
+    }
+    job->deleteLater();
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        this->rollback(QString::fromLocal8Bit(job->readAllStandardError()).trimmed());
+        return;
+    }
+
+    ++this->m_doneJobs;
+    emit(progressSignal(this->m_doneJobs, this->m_totalJobs));
+
+    if (this->m_doneJobs == this->m_totalJobs) {
+        this->commit();
+    } else {
+        this->startJobs();
+    }
+}
+
+/**
+ * @brief Start the pending disks
+ *
+ * Start qemu-img processes up to the parallel jobs limit
+ */
+void BatchProvisioner::startJobs()
+{
+    while (!this->m_pendingJobs.isEmpty() && this->m_runningJobs.size() < this->m_maxParallelJobs) {
+        QProcess *job = new QProcess(this);
+        connect(job, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, &BatchProvisioner::jobFinished);
+
+        this->m_runningJobs.append(job);
+        job->start(this->m_QEMUGlobalObject->QEMUImgPath(), this->m_pendingJobs.takeFirst());
+
+        if (!job->waitForStarted(2000)) {
+            this->rollback(tr("Cannot start qemu-img"));
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Commit the new machines
+ *
+ * Write the config files of the machines and add all of
+ * them to the catalog in one atomic write
+ */
+void BatchProvisioner::commit()
+{
+    foreach (const NewMachine &newMachine, this->m_newMachines) {
+        QSaveFile machineFile(newMachine.configPath);
+        if (!machineFile.open(QFile::WriteOnly)) {
+            this->rollback(machineFile.errorString());
+            return;
+        }
+
+        machineFile.write(QJsonDocument(newMachine.machineJSON).toJson());
+        if (!machineFile.commit()) {
+            this->rollback(machineFile.errorString());
+            return;
+        }
+    }
+
+    QSettings settings;
+    settings.beginGroup("DataFolder");
+    QString dataDirectoryPath = settings.value("QtEmuData",
+                                               QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/")).toString();
+    settings.endGroup();
+
+    QString catalogPath = QDir(dataDirectoryPath).filePath("qtemu.json");
+
+    QJsonObject catalogObject;
+    QFile catalogFile(catalogPath);
+    if (catalogFile.open(QFile::ReadOnly)) {
+        catalogObject = QJsonDocument::fromJson(catalogFile.readAll()).object();
+        catalogFile.close();
+    }
+
+    QJsonArray machines = catalogObject["machines"].toArray();
+    QStringList names;
+    foreach (const NewMachine &newMachine, this->m_newMachines) {
+        QJsonObject machine;
+        machine["uuid"]       = newMachine.machineJSON["uuid"];
+        machine["path"]       = newMachine.machineJSON["path"];
+        machine["configpath"] = newMachine.configPath;
+        machine["icon"]       = newMachine.machineJSON["OSVersion"].toString().toLower().replace(" ", "_");
+        machines.append(machine);
+
+        names.append(newMachine.name);
+    }
+    catalogObject["machines"] = machines;
+
+    QSaveFile catalogSaveFile(catalogPath);
+    if (!catalogSaveFile.open(QFile::WriteOnly)) {
+        this->rollback(catalogSaveFile.errorString());
+        return;
+    }
+
+    catalogSaveFile.write(QJsonDocument(catalogObject).toJson());
+    if (!catalogSaveFile.commit()) {
+        this->rollback(catalogSaveFile.errorString());
+        return;
+    }
+
+    foreach (const NewMachine &newMachine, this->m_newMachines) {
+        Logger::logMachineCreation(newMachine.machineJSON["path"].toString(), newMachine.name,
+                                   "Machine created from the template " + this->m_templateName);
+    }
+
+    this->m_running = false;
+    this->m_newMachines.clear();
+    this->m_createdFolders.clear();
+
+    emit(finishedSignal(true, names, QString()));
+}
+
+/**
+ * @brief Roll back the provisioning
+ * @param error, reason of the failure
+ *
+ * Stop the qemu-img processes and remove the
+ * folders of the new machines
+ */
+void BatchProvisioner::rollback(const QString &error)
+{
+    foreach (QProcess *job, this->m_runningJobs) {
+        job->disconnect(this);
+        job->kill();
+        job->waitForFinished(1000);
+        job->deleteLater();
+    }
+    this->m_runningJobs.clear();
+    this->m_pendingJobs.clear();
+
+    foreach (const QString &folder, this->m_createdFolders) {
+        QDir(folder).removeRecursively();
+    }
+    this->m_createdFolders.clear();
+    this->m_newMachines.clear();
+    this->m_running = false;
+
+    qDebug() << "Provisioning rolled back:" << error;
+    emit(finishedSignal(false, QStringList(), error));
+}
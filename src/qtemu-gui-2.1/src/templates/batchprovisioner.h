@@ -0,0 +1,99 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef BATCHPROVISIONER_H
+#define BATCHPROVISIONER_H
+
+// Qt
+#include <QObject>
+#include <QProcess>
+#include <QSettings>
+#include <QSaveFile>
+#include <QThread>
+#include <QUuid>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <QDebug>
+
+// Local
+#include "templatelibrary.h"
+#include "../networkcard.h"
+
+class BatchProvisioner : public QObject {
+    Q_OBJECT
+
+    public:
+        enum DiskMode {
+            Overlay, Copy
+        };
+
+        explicit BatchProvisioner(QEMU *QEMUGlobalObject,
+                                  QObject *parent = nullptr);
+        ~BatchProvisioner();
+
+        bool provision(const QString &templateName, int count,
+                       const QString &namePrefix, DiskMode diskMode);
+        void cancel();
+        bool isRunning() const;
+        void setMachineOverrides(const QJsonObject &overrides);
+
+    signals:
+        void progressSignal(int done, int total);
+        void finishedSignal(bool provisioned, const QStringList &names, const QString &error);
+
+    public slots:
+
+    private slots:
+        void jobFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    protected:
+
+    private:
+        struct NewMachine {
+            QString name;
+            QString configPath;
+            QJsonObject machineJSON;
+        };
+
+        QEMU *m_QEMUGlobalObject;
+        bool m_running;
+        int m_maxParallelJobs;
+
+        QList<QStringList> m_pendingJobs;
+        QList<QProcess *> m_runningJobs;
+        int m_totalJobs;
+        int m_doneJobs;
+
+        QString m_templateName;
+        QJsonObject m_machineOverrides;
+        QList<NewMachine> m_newMachines;
+        QStringList m_createdFolders;
+
+        // Methods
+        void startJobs();
+        void commit();
+        void rollback(const QString &error);
+};
+
+#endif // BATCHPROVISIONER_H
@@ -0,0 +1,314 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "provisionwidget.h"
+
+/**
+ * @brief Create machines from a template window
+ * @param QEMUGlobalObject, QEMU global object with data about QEMU
+ * @param parent, widget parent
+ *
+ * Window to create N machines from a template at once
+ */
+ProvisionWidget::ProvisionWidget(QEMU *QEMUGlobalObject,
+                                 QWidget *parent) : QWidget(parent)
+{
+    this->setWindowTitle(tr("Create machines from a template") + " - QtEmu");
+    this->setWindowIcon(QIcon::fromTheme("qtemu",
+                                         QIcon(":/images/qtemu.png")));
+    this->setWindowFlag(Qt::Window);
+    this->setMinimumSize(450, 300);
+
+    m_batchProvisioner = new BatchProvisioner(QEMUGlobalObject, this);
+    connect(m_batchProvisioner, &BatchProvisioner::progressSignal,
+            this, &ProvisionWidget::provisionProgress);
+    connect(m_batchProvisioner, &BatchProvisioner::finishedSignal,
+            this, &ProvisionWidget::provisionFinished);
+
+    m_templateComboBox = new QComboBox(this);
+    connect(m_templateComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ProvisionWidget::templateChanged);
+
+    m_removeTemplateButton = new QPushButton(QIcon::fromTheme("edit-delete",
+                                                              QIcon(QPixmap(":/images/icons/breeze/32x32/remove.svg"))),
+                                             "",
+                                             this);
+    m_removeTemplateButton->setToolTip(tr("Remove template"));
+    connect(m_removeTemplateButton, &QAbstractButton::clicked,
+            this, &ProvisionWidget::removeTemplate);
+
+    m_templateLayout = new QHBoxLayout();
+    m_templateLayout->addWidget(m_templateComboBox, 1);
+    m_templateLayout->addWidget(m_removeTemplateButton);
+
+    m_templateDescriptionLabel = new QLabel(this);
+    m_templateDescriptionLabel->setWordWrap(true);
+
+    m_countSpinBox = new QSpinBox(this);
+    m_countSpinBox->setMinimum(1);
+    m_countSpinBox->setMaximum(500);
+    m_countSpinBox->setValue(10);
+
+    m_namePrefixLineEdit = new QLineEdit(this);
+
+    m_diskModeComboBox = new QComboBox(this);
+    m_diskModeComboBox->addItem(tr("Linked to the template image"), BatchProvisioner::Overlay);
+    m_diskModeComboBox->addItem(tr("Full copy of the template image"), BatchProvisioner::Copy);
+
+    m_poolSizeSpinBox = new QSpinBox(this);
+    m_poolSizeSpinBox->setMinimum(0);
+    m_poolSizeSpinBox->setMaximum(50);
+    m_poolSizeSpinBox->setSpecialValueText(tr("Not pooled"));
+    m_poolSizeSpinBox->setToolTip(tr("Machines of the template kept launched and paused for an instant start"));
+
+    m_poolSizeButton = new QPushButton(tr("&Apply"), this);
+    connect(m_poolSizeButton, &QAbstractButton::clicked,
+            this, &ProvisionWidget::savePoolSize);
+
+    m_poolLayout = new QHBoxLayout();
+    m_poolLayout->addWidget(m_poolSizeSpinBox, 1);
+    m_poolLayout->addWidget(m_poolSizeButton);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setValue(0);
+
+    m_formLayout = new QFormLayout();
+    m_formLayout->addRow(tr("Template") + ":", m_templateLayout);
+    m_formLayout->addRow("", m_templateDescriptionLabel);
+    m_formLayout->addRow(tr("Machines") + ":", m_countSpinBox);
+    m_formLayout->addRow(tr("Name prefix") + ":", m_namePrefixLineEdit);
+    m_formLayout->addRow(tr("Disks") + ":", m_diskModeComboBox);
+    m_formLayout->addRow(tr("Pool") + ":", m_poolLayout);
+
+    m_provisionButton = new QPushButton(QIcon::fromTheme("project-development-new-template",
+                                                         QIcon(QPixmap(":/images/icons/breeze/32x32/project-development-new-template.svg"))),
+                                        tr("C&reate"),
+                                        this);
+    connect(m_provisionButton, &QAbstractButton::clicked,
+            this, &ProvisionWidget::provisionMachines);
+
+    m_closeButton = new QPushButton(QIcon::fromTheme("window-close",
+                                                     QIcon(QPixmap(":/images/icons/breeze/32x32/window-close.svg"))),
+                                    tr("&Close"),
+                                    this);
+    connect(m_closeButton, &QAbstractButton::clicked,
+            this, &QWidget::hide);
+
+    QList<QKeySequence> closeShortcuts;
+    closeShortcuts << QKeySequence(Qt::Key_Escape);
+    m_closeAction = new QAction(this);
+    m_closeAction->setShortcuts(closeShortcuts);
+    connect(m_closeAction, &QAction::triggered,
+            this, &QWidget::hide);
+    this->addAction(m_closeAction);
+
+    m_buttonsLayout = new QHBoxLayout();
+    m_buttonsLayout->addStretch(1);
+    m_buttonsLayout->addWidget(m_provisionButton);
+    m_buttonsLayout->addWidget(m_closeButton);
+
+    m_mainLayout = new QVBoxLayout(this);
+    m_mainLayout->addItem(m_formLayout);
+    m_mainLayout->addStretch(1);
+    m_mainLayout->addWidget(m_progressBar);
+    m_mainLayout->addItem(m_buttonsLayout);
+
+    qDebug() << "ProvisionWidget created";
+}
+
+ProvisionWidget::~ProvisionWidget()
+{
+    qDebug() << "ProvisionWidget destroyed";
+}
+
+/**
+ * @brief Load the templates
+ *
+ * Fill the templates combo with the saved templates
+ */
+void ProvisionWidget::loadTemplates()
+{
+    QString currentTemplate = this->m_templateComboBox->currentText();
+
+    this->m_templateComboBox->clear();
+    this->m_templateComboBox->addItems(TemplateLibrary::templateNames());
+
+    int currentIndex = this->m_templateComboBox->findText(currentTemplate);
+    if (currentIndex >= 0) {
+        this->m_templateComboBox->setCurrentIndex(currentIndex);
+    }
+
+    bool hasTemplates = this->m_templateComboBox->count() > 0;
+    this->m_removeTemplateButton->setEnabled(hasTemplates && !this->m_batchProvisioner->isRunning());
+    this->m_poolSizeButton->setEnabled(hasTemplates);
+    this->m_provisionButton->setEnabled(hasTemplates && !this->m_batchProvisioner->isRunning());
+    if (!hasTemplates) {
+        this->m_templateDescriptionLabel->setText(tr("There are no templates, save a stopped "
+                                                     "machine as template from the Machine menu."));
+    }
+}
+
+/**
+ * @brief The selected template changed
+ * @param index, index of the template
+ *
+ * Show the description of the template
+ */
+void ProvisionWidget::templateChanged(int index)
+{
+    if (index < 0) {
+        return;
+    }
+
+    QJsonObject templateJSON = TemplateLibrary::readTemplate(this->m_templateComboBox->itemText(index));
+    QJsonObject machineJSON = templateJSON["machine"].toObject();
+
+    this->m_templateDescriptionLabel->setText(tr("%1 %2, %3 MiB of RAM, from the machine %4")
+                                              .arg(machineJSON["OSType"].toString())
+                                              .arg(machineJSON["OSVersion"].toString())
+                                              .arg(machineJSON["RAM"].toInt())
+                                              .arg(templateJSON["source"].toString()));
+    this->m_namePrefixLineEdit->setText(templateJSON["name"].toString());
+    this->m_poolSizeSpinBox->setValue(templateJSON["pool"].toInt());
+}
+
+/**
+ * @brief Save the pool size of the selected template
+ *
+ * The machines of the pool are created in background
+ */
+void ProvisionWidget::savePoolSize()
+{
+    QString templateName = this->m_templateComboBox->currentText();
+    if (templateName.isEmpty()) {
+        return;
+    }
+
+    if (!TemplateLibrary::setPoolSize(templateName, this->m_poolSizeSpinBox->value())) {
+        SystemUtils::showMessage(tr("Qtemu - Critical error"),
+                                 tr("Cannot save the template %1").arg(templateName),
+                                 QMessageBox::Critical);
+    }
+}
+
+/**
+ * @brief Remove the selected template
+ *
+ * Remove the selected template after a confirmation
+ */
+void ProvisionWidget::removeTemplate()
+{
+    QString templateName = this->m_templateComboBox->currentText();
+    if (templateName.isEmpty()) {
+        return;
+    }
+
+    int answer = QMessageBox::question(this, tr("Remove template") + " - QtEmu",
+                                       tr("<p>Remove the template <strong>%1</strong>?</p>"
+                                          "<p>The machines linked to its images can't boot anymore.</p>")
+                                       .arg(templateName),
+                                       QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+    if (answer != QMessageBox::Yes) {
+        return;
+    }
+
+    if (!TemplateLibrary::removeTemplate(templateName)) {
+        SystemUtils::showMessage(tr("Qtemu - Critical error"),
+                                 tr("Cannot remove the template %1").arg(templateName),
+                                 QMessageBox::Critical);
+    }
+
+    this->loadTemplates();
+}
+
+/**
+ * @brief Create the machines
+ *
+ * Start the provisioning of the machines
+ */
+void ProvisionWidget::provisionMachines()
+{
+    BatchProvisioner::DiskMode diskMode =
+            static_cast<BatchProvisioner::DiskMode>(this->m_diskModeComboBox->currentData().toInt());
+
+    this->m_progressBar->setValue(0);
+    this->m_provisionButton->setEnabled(false);
+    this->m_removeTemplateButton->setEnabled(false);
+
+    this->m_batchProvisioner->provision(this->m_templateComboBox->currentText(),
+                                        this->m_countSpinBox->value(),
+                                        this->m_namePrefixLineEdit->text(),
+                                        diskMode);
+}
+
+/**
+ * @brief Progress of the provisioning
+ * @param done, disks created
+ * @param total, disks to be created
+ *
+ * Update the progress bar
+ */
+void ProvisionWidget::provisionProgress(int done, int total)
+{
+    this->m_progressBar->setMaximum(qMax(1, total));
+    this->m_progressBar->setValue(total == 0 ? 1 : done);
+}
+
+/**
+ * @brief The provisioning finished
+ * @param provisioned, true if the machines are created
+ * @param names, names of the new machines
+ * @param error, reason of the failure
+ *
+ * Tell the user the result of the provisioning
+ */
+void ProvisionWidget::provisionFinished(bool provisioned, const QStringList &names, const QString &error)
+{
+    this->loadTemplates();
+
+    if (!provisioned) {
+        this->m_progressBar->setValue(0);
+        SystemUtils::showMessage(tr("Qtemu - Critical error"),
+                                 tr("<p>Cannot create the machines</p><p>%1</p>").arg(error),
+                                 QMessageBox::Critical);
+        return;
+    }
+
+    emit(machinesProvisionedSignal());
+
+    SystemUtils::showMessage(tr("Create machines from a template") + " - QtEmu",
+                             tr("%n machine(s) created, from %1 to %2", "", names.size())
+                             .arg(names.first())
+                             .arg(names.last()),
+                             QMessageBox::Information);
+}
+
+void ProvisionWidget::closeEvent(QCloseEvent *event)
+{
+    this->hide();
+    event->ignore();
+}
+
+void ProvisionWidget::showEvent(QShowEvent *event)
+{
+    this->loadTemplates();
+    event->accept();
+}
@@ -0,0 +1,95 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef PROVISIONWIDGET_H
+#define PROVISIONWIDGET_H
+
+// Qt
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QPushButton>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QLineEdit>
+#include <QLabel>
+#include <QProgressBar>
+#include <QAction>
+#include <QCloseEvent>
+#include <QShowEvent>
+#include <QMessageBox>
+
+#include <QDebug>
+
+// Local
+#include "batchprovisioner.h"
+
+class ProvisionWidget : public QWidget {
+    Q_OBJECT
+
+    public:
+        explicit ProvisionWidget(QEMU *QEMUGlobalObject,
+                                 QWidget *parent = nullptr);
+        ~ProvisionWidget();
+
+    signals:
+        void machinesProvisionedSignal();
+
+    public slots:
+        void loadTemplates();
+
+    private slots:
+        void templateChanged(int index);
+        void removeTemplate();
+        void savePoolSize();
+        void provisionMachines();
+        void provisionProgress(int done, int total);
+        void provisionFinished(bool provisioned, const QStringList &names, const QString &error);
+
+    protected:
+        virtual void closeEvent(QCloseEvent *event);
+        virtual void showEvent(QShowEvent *event);
+
+    private:
+        BatchProvisioner *m_batchProvisioner;
+
+        QVBoxLayout *m_mainLayout;
+        QFormLayout *m_formLayout;
+        QHBoxLayout *m_templateLayout;
+        QHBoxLayout *m_poolLayout;
+        QHBoxLayout *m_buttonsLayout;
+
+        QComboBox *m_templateComboBox;
+        QPushButton *m_removeTemplateButton;
+        QLabel *m_templateDescriptionLabel;
+        QSpinBox *m_countSpinBox;
+        QLineEdit *m_namePrefixLineEdit;
+        QComboBox *m_diskModeComboBox;
+        QSpinBox *m_poolSizeSpinBox;
+        QPushButton *m_poolSizeButton;
+        QProgressBar *m_progressBar;
+
+        QPushButton *m_provisionButton;
+        QPushButton *m_closeButton;
+        QAction *m_closeAction;
+};
+
+#endif // PROVISIONWIDGET_H
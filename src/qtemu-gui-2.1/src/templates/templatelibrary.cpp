@@ -0,0 +1,336 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "templatelibrary.h"
+
+/**
+ * @brief Library of machine templates
+ * @param QEMUGlobalObject, QEMU global object, used to find qemu-img
+ * @param parent, parent object
+ *
+ * A template is a folder in the templates folder of QtEmu with
+ * the template.json file, the hardware of a machine, and a golden
+ * image of every hard disk of the machine. New machines are
+ * provisioned from the templates by the BatchProvisioner
+ */
+TemplateLibrary::TemplateLibrary(QEMU *QEMUGlobalObject,
+                                 QObject *parent) : QObject(parent)
+{
+    this->m_QEMUGlobalObject = QEMUGlobalObject;
+
+    this->m_copyProcess = new QProcess(this);
+    connect(m_copyProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &TemplateLibrary::copyFinished);
+
+    qDebug() << "TemplateLibrary object created";
+}
+
+TemplateLibrary::~TemplateLibrary()
+{
+    qDebug() << "TemplateLibrary object destroyed";
+}
+
+/**
+ * @brief Get the templates folder
+ * @return path of the folder with all the templates
+ *
+ * Get the templates folder, inside the data folder of QtEmu
+ */
+QString TemplateLibrary::templatesPath()
+{
+    QSettings settings;
+    settings.beginGroup("DataFolder");
+    QString dataDirectoryPath = settings.value("QtEmuData",
+                                               QDir::toNativeSeparators(QDir::homePath() + "/.qtemu/")).toString();
+    settings.endGroup();
+
+    return QDir(dataDirectoryPath).filePath("templates");
+}
+
+/**
+ * @brief Get the folder of a template
+ * @param name, name of the template
+ * @return path of the folder of the template
+ *
+ * Get the folder of a template
+ */
+QString TemplateLibrary::templatePath(const QString &name)
+{
+    return QDir(TemplateLibrary::templatesPath()).filePath(QString(name).toLower().replace(" ", "_"));
+}
+
+/**
+ * @brief Get the names of the templates
+ * @return names of the saved templates
+ *
+ * Get the names of the templates with a template.json file
+ */
+QStringList TemplateLibrary::templateNames()
+{
+    QStringList names;
+
+    QDir templatesDirectory(TemplateLibrary::templatesPath());
+    foreach (const QString &directory, templatesDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+        QFile templateFile(QDir(templatesDirectory.filePath(directory)).filePath("template.json"));
+        if (!templateFile.open(QFile::ReadOnly)) {
+            continue;
+        }
+
+        QString name = QJsonDocument::fromJson(templateFile.readAll()).object()["name"].toString();
+        if (!name.isEmpty()) {
+            names.append(name);
+        }
+    }
+
+    return names;
+}
+
+/**
+ * @brief Read a template
+ * @param name, name of the template
+ * @return template, empty if it doesn't exist
+ *
+ * Read the template.json file of a template
+ */
+QJsonObject TemplateLibrary::readTemplate(const QString &name)
+{
+    QFile templateFile(QDir(TemplateLibrary::templatePath(name)).filePath("template.json"));
+    if (!templateFile.open(QFile::ReadOnly)) {
+        return QJsonObject();
+    }
+
+    return QJsonDocument::fromJson(templateFile.readAll()).object();
+}
+
+/**
+ * @brief Remove a template
+ * @param name, name of the template
+ * @return true if the template is removed
+ *
+ * Remove the folder of the template with its golden images.
+ * The machines linked to the images can't boot anymore
+ */
+bool TemplateLibrary::removeTemplate(const QString &name)
+{
+    QDir templateDirectory(TemplateLibrary::templatePath(name));
+    if (!templateDirectory.exists("template.json")) {
+        return false;
+    }
+
+    return templateDirectory.removeRecursively();
+}
+
+/**
+ * @brief Get the pool size of a template
+ * @param name, name of the template
+ * @return machines of the template kept launched and paused
+ *
+ * Get the pool size of a template, 0 if the template isn't pooled
+ */
+int TemplateLibrary::poolSize(const QString &name)
+{
+    return qMax(0, TemplateLibrary::readTemplate(name)["pool"].toInt());
+}
+
+/**
+ * @brief Set the pool size of a template
+ * @param name, name of the template
+ * @param size, machines of the template kept launched and paused
+ * @return true if the template is saved
+ *
+ * Set the pool size in the template.json file of the template
+ */
+bool TemplateLibrary::setPoolSize(const QString &name, int size)
+{
+    QJsonObject templateJSON = TemplateLibrary::readTemplate(name);
+    if (templateJSON.isEmpty()) {
+        return false;
+    }
+
+    templateJSON["pool"] = qMax(0, size);
+
+    QSaveFile templateFile(QDir(TemplateLibrary::templatePath(name)).filePath("template.json"));
+    if (!templateFile.open(QFile::WriteOnly)) {
+        return false;
+    }
+
+    templateFile.write(QJsonDocument(templateJSON).toJson());
+
+    return templateFile.commit();
+}
+
+/**
+ * @brief Save a machine as a template
+ * @param machine, stopped machine
+ * @param name, name of the template
+ * @param error, variable to store the error
+ * @return true if the saving is started
+ *
+ * The hard disks of the machine are converted to qcow2 golden images
+ * in background, one after another. The template.json file is written
+ * at the end, a template without it is never listed
+ */
+bool TemplateLibrary::saveTemplate(Machine *machine, const QString &name, QString *error)
+{
+    QString saveError;
+    QString templatePath = TemplateLibrary::templatePath(name);
+
+    if (this->isSaving()) {
+        saveError = tr("Another template is being saved");
+    } else if (name.trimmed().isEmpty()) {
+        saveError = tr("The name of the template is empty");
+    } else if (QDir(templatePath).exists()) {
+        saveError = tr("The template %1 already exists").arg(name);
+    } else if (machine->getState() != Machine::Stopped) {
+        saveError = tr("The machine must be stopped");
+    } else if (!QDir().mkpath(templatePath)) {
+        saveError = tr("Cannot create the folder %1").arg(templatePath);
+    }
+
+    if (!saveError.isEmpty()) {
+        if (error != nullptr) {
+            *error = saveError;
+        }
+        return false;
+    }
+
+    QJsonObject machineJSON = MachineUtils::readMachineFile(machine->getConfigPath());
+    machineJSON.remove("name");
+    machineJSON.remove("uuid");
+    machineJSON.remove("path");
+    machineJSON.remove("pool");
+
+    // The hard disks point to the golden images, relative to the template folder
+    QJsonArray media = machineJSON["media"].toArray();
+    for (int i = 0; i < media.size(); ++i) {
+        QJsonObject disk = media.at(i).toObject();
+        if (disk["type"].toString() != "hdd") {
+            continue;
+        }
+
+        QString imageName = QString("disk%1.qcow2").arg(i);
+
+        QStringList copyArguments;
+        copyArguments << "convert" << "-O" << "qcow2"
+                      << disk["path"].toString()
+                      << QDir(templatePath).filePath(imageName);
+        this->m_pendingCopies.append(copyArguments);
+
+        disk["name"] = imageName;
+        disk["path"] = imageName;
+        media.replace(i, disk);
+    }
+    machineJSON["media"] = media;
+
+    this->m_savingName = name;
+    this->m_savingTemplate = QJsonObject();
+    this->m_savingTemplate["name"]        = name;
+    this->m_savingTemplate["description"] = machine->getDescription();
+    this->m_savingTemplate["source"]      = machine->getName();
+    this->m_savingTemplate["created"]     = QDateTime::currentDateTime().toString(Qt::ISODate);
+    this->m_savingTemplate["machine"]     = machineJSON;
+
+    this->nextCopy();
+
+    return true;
+}
+
+/**
+ * @brief Get if a template is being saved
+ * @return true if the golden images are being copied
+ *
+ * Get if a template is being saved
+ */
+bool TemplateLibrary::isSaving() const
+{
+    return !this->m_savingName.isEmpty();
+}
+
+/**
+ * @brief A golden image is copied
+ * @param exitCode, exit code of qemu-img
+ * @param exitStatus, exit status of qemu-img
+ *
+ * Copy the next golden image or finish the template
+ */
+void TemplateLibrary::copyFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        this->finishSaving(false, QString::fromLocal8Bit(this->m_copyProcess->readAllStandardError()).trimmed());
+        return;
+    }
+
+    this->nextCopy();
+}
+
+/**
+ * @brief Copy the next golden image
+ *
+ * Copy the next golden image, when all the images
+ * are copied the template.json file is written
+ */
+void TemplateLibrary::nextCopy()
+{
+    if (!this->m_pendingCopies.isEmpty()) {
+        this->m_copyProcess->start(this->m_QEMUGlobalObject->QEMUImgPath(), this->m_pendingCopies.takeFirst());
+        if (!this->m_copyProcess->waitForStarted(2000)) {
+            this->finishSaving(false, tr("Cannot start qemu-img"));
+        }
+        return;
+    }
+
+    QSaveFile templateFile(QDir(TemplateLibrary::templatePath(this->m_savingName)).filePath("template.json"));
+    if (!templateFile.open(QFile::WriteOnly)) {
+        this->finishSaving(false, templateFile.errorString());
+        return;
+    }
+
+    templateFile.write(QJsonDocument(this->m_savingTemplate).toJson());
+    if (!templateFile.commit()) {
+        this->finishSaving(false, templateFile.errorString());
+        return;
+    }
+
+    this->finishSaving(true, QString());
+}
+
+/**
+ * @brief Finish the saving of the template
+ * @param saved, true if the template is saved
+ * @param error, error when the template isn't saved
+ *
+ * A template not saved is removed
+ */
+void TemplateLibrary::finishSaving(bool saved, const QString &error)
+{
+    QString name = this->m_savingName;
+
+    if (!saved) {
+        QDir(TemplateLibrary::templatePath(name)).removeRecursively();
+    }
+
+    this->m_pendingCopies.clear();
+    this->m_savingName.clear();
+    this->m_savingTemplate = QJsonObject();
+
+    qDebug() << "Template" << name << (saved ? "saved" : "not saved") << error;
+    emit(templateSavedSignal(saved, name, error));
+}
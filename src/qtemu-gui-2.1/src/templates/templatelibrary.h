@@ -0,0 +1,83 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEMPLATELIBRARY_H
+#define TEMPLATELIBRARY_H
+
+// Qt
+#include <QObject>
+#include <QProcess>
+#include <QSettings>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <QDebug>
+
+// Local
+#include "../machine.h"
+
+class TemplateLibrary : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit TemplateLibrary(QEMU *QEMUGlobalObject,
+                                 QObject *parent = nullptr);
+        ~TemplateLibrary();
+
+        static QString templatesPath();
+        static QString templatePath(const QString &name);
+        static QStringList templateNames();
+        static QJsonObject readTemplate(const QString &name);
+        static bool removeTemplate(const QString &name);
+        static int poolSize(const QString &name);
+        static bool setPoolSize(const QString &name, int size);
+
+        bool saveTemplate(Machine *machine, const QString &name, QString *error = nullptr);
+        bool isSaving() const;
+
+    signals:
+        void templateSavedSignal(bool saved, const QString &name, const QString &error);
+
+    public slots:
+
+    private slots:
+        void copyFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    protected:
+
+    private:
+        QEMU *m_QEMUGlobalObject;
+        QProcess *m_copyProcess;
+
+        QList<QStringList> m_pendingCopies;
+        QString m_savingName;
+        QJsonObject m_savingTemplate;
+
+        // Methods
+        void nextCopy();
+        void finishSaving(bool saved, const QString &error);
+};
+
+#endif // TEMPLATELIBRARY_H
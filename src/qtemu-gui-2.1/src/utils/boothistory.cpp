@@ -0,0 +1,306 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// C++ standard library
+#include <algorithm>
+
+// Local
+#include "boothistory.h"
+
+// Boots kept in the history of a machine
+static const int MAX_BOOT_RECORDS = 200;
+
+/**
+ * @brief Boot history of a machine
+ * @param filePath, path of the boots.json file of the machine
+ *
+ * The file is read the first time the history is used
+ */
+BootHistory::BootHistory(const QString &filePath)
+{
+    this->m_filePath = filePath;
+    this->m_loaded = false;
+
+    qDebug() << "BootHistory object created";
+}
+
+BootHistory::~BootHistory()
+{
+    qDebug() << "BootHistory object destroyed";
+}
+
+/**
+ * @brief Get the hash of a configuration
+ * @param config, options of the machine that change the boot
+ * @return hash of the configuration
+ *
+ * The keys of a QJsonObject are sorted, so the compact JSON
+ * of two equal configurations is always the same
+ */
+QString BootHistory::configHash(const QJsonObject &config)
+{
+    QByteArray configData = QJsonDocument(config).toJson(QJsonDocument::Compact);
+
+    return QString(QCryptographicHash::hash(configData, QCryptographicHash::Sha1).toHex().left(16));
+}
+
+/**
+ * @brief Get the path of the history file
+ * @return path of the history file
+ *
+ * Get the path of the history file
+ */
+QString BootHistory::filePath() const
+{
+    return this->m_filePath;
+}
+
+/**
+ * @brief Get the boots
+ * @return boots of the machine, the oldest first
+ *
+ * Get the boots
+ */
+QVector<BootHistory::BootRecord> BootHistory::records() const
+{
+    this->load();
+
+    return this->m_records;
+}
+
+/**
+ * @brief Add a boot
+ * @param bootTime, ms since QEMU was launched until the guest was ready
+ * @param config, options of the machine that change the boot
+ *
+ * Add a boot and save the history
+ */
+void BootHistory::append(qint64 bootTime, const QJsonObject &config)
+{
+    this->load();
+
+    BootRecord record;
+    record.time = QDateTime::currentDateTime();
+    record.bootTime = bootTime;
+    record.configHash = BootHistory::configHash(config);
+    record.config = config;
+
+    this->m_records.append(record);
+    if (this->m_records.size() > MAX_BOOT_RECORDS) {
+        this->m_records.remove(0, this->m_records.size() - MAX_BOOT_RECORDS);
+    }
+
+    this->save();
+}
+
+/**
+ * @brief Get the median boot time of a configuration
+ * @param configHash, hash of the configuration
+ * @param boots, variable to store the number of boots
+ * @return median boot time in ms, -1 if there are no boots
+ *
+ * Get the median boot time of a configuration
+ */
+qint64 BootHistory::medianBootTime(const QString &configHash, int *boots) const
+{
+    this->load();
+
+    QVector<qint64> bootTimes;
+    for (const BootRecord &record : this->m_records) {
+        if (record.configHash == configHash) {
+            bootTimes.append(record.bootTime);
+        }
+    }
+
+    if (boots != nullptr) {
+        *boots = bootTimes.size();
+    }
+
+    if (bootTimes.isEmpty()) {
+        return -1;
+    }
+
+    std::sort(bootTimes.begin(), bootTimes.end());
+
+    return bootTimes.at(bootTimes.size() / 2);
+}
+
+/**
+ * @brief Compare the configuration with the previous ones
+ * @param config, current configuration of the machine
+ * @param maxConfigs, number of previous configurations compared
+ * @return one line for each previous configuration
+ *
+ * Every line shows the options changed since that configuration
+ * and how the median boot time changed
+ */
+QStringList BootHistory::compare(const QJsonObject &config, int maxConfigs) const
+{
+    this->load();
+
+    QStringList comparison;
+    QString currentHash = BootHistory::configHash(config);
+
+    int currentBoots = 0;
+    qint64 currentBootTime = this->medianBootTime(currentHash, &currentBoots);
+    if (currentBoots == 0) {
+        return comparison;
+    }
+
+    // Previous configurations, the most recently booted first
+    QStringList previousHashes;
+    for (int i = this->m_records.size() - 1; i >= 0 && previousHashes.size() < maxConfigs; --i) {
+        const BootRecord &record = this->m_records.at(i);
+        if (record.configHash != currentHash && !previousHashes.contains(record.configHash)) {
+            previousHashes.append(record.configHash);
+        }
+    }
+
+    for (const QString &previousHash : previousHashes) {
+        QJsonObject previousConfig;
+        for (const BootRecord &record : this->m_records) {
+            if (record.configHash == previousHash) {
+                previousConfig = record.config;
+            }
+        }
+
+        qint64 previousBootTime = this->medianBootTime(previousHash);
+        double change = previousBootTime > 0
+                ? 100.0 * (currentBootTime - previousBootTime) / previousBootTime
+                : 0.0;
+
+        comparison.append(tr("%1: %2 s → %3 s (%4%5%)")
+                          .arg(this->describeChanges(previousConfig, config))
+                          .arg(previousBootTime / 1000.0, 0, 'f', 1)
+                          .arg(currentBootTime / 1000.0, 0, 'f', 1)
+                          .arg(change >= 0 ? "+" : "")
+                          .arg(change, 0, 'f', 0));
+    }
+
+    return comparison;
+}
+
+/**
+ * @brief Read the history file
+ *
+ * Read the history file
+ */
+void BootHistory::load() const
+{
+    if (this->m_loaded) {
+        return;
+    }
+    this->m_loaded = true;
+
+    QFile historyFile(this->m_filePath);
+    if (!historyFile.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    QJsonArray boots = QJsonDocument::fromJson(historyFile.readAll()).object()["boots"].toArray();
+    for (int i = 0; i < boots.size(); ++i) {
+        QJsonObject bootObject = boots.at(i).toObject();
+
+        BootRecord record;
+        record.time = QDateTime::fromString(bootObject["time"].toString(), Qt::ISODate);
+        record.bootTime = static_cast<qint64>(bootObject["bootTime"].toDouble());
+        record.config = bootObject["config"].toObject();
+        record.configHash = BootHistory::configHash(record.config);
+        this->m_records.append(record);
+    }
+}
+
+/**
+ * @brief Save the history file
+ *
+ * Save the history file
+ */
+void BootHistory::save() const
+{
+    QJsonArray boots;
+    for (const BootRecord &record : this->m_records) {
+        QJsonObject bootObject;
+        bootObject["time"]     = record.time.toString(Qt::ISODate);
+        bootObject["bootTime"] = record.bootTime;
+        bootObject["hash"]     = record.configHash;
+        bootObject["config"]   = record.config;
+        boots.append(bootObject);
+    }
+
+    QJsonObject historyObject;
+    historyObject["boots"] = boots;
+
+    QSaveFile historyFile(this->m_filePath);
+    if (!historyFile.open(QFile::WriteOnly)) {
+        qDebug() << "Cannot save the boot history" << this->m_filePath;
+        return;
+    }
+    historyFile.write(QJsonDocument(historyObject).toJson());
+    historyFile.commit();
+}
+
+/**
+ * @brief Describe the changes between two configurations
+ * @param from, previous configuration
+ * @param to, current configuration
+ * @return the changed options
+ *
+ * Describe the changes between two configurations
+ */
+QString BootHistory::describeChanges(const QJsonObject &from, const QJsonObject &to) const
+{
+    QStringList changes;
+
+    QStringList keys = from.keys();
+    for (const QString &key : to.keys()) {
+        if (!keys.contains(key)) {
+            keys.append(key);
+        }
+    }
+
+    for (const QString &key : keys) {
+        QString fromValue = from[key].toVariant().toString();
+        QString toValue = to[key].toVariant().toString();
+        if (fromValue == toValue) {
+            continue;
+        }
+
+        QString name = key;
+        if (key == "CPUType") {
+            name = tr("CPU type");
+        } else if (key == "CPUCount") {
+            name = tr("CPUs");
+        } else if (key == "RAM") {
+            name = tr("RAM");
+        } else if (key == "accelerator") {
+            name = tr("Accelerator");
+        } else if (key == "machineType") {
+            name = tr("Machine type");
+        } else if (key == "GPUType") {
+            name = tr("Graphics");
+        } else if (key == "diskInterface") {
+            name = tr("Disk interface");
+        }
+
+        changes.append(QString("%1 %2 → %3").arg(name, fromValue, toValue));
+    }
+
+    return changes.isEmpty() ? tr("Same options") : changes.join(", ");
+}
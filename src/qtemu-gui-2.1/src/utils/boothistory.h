@@ -0,0 +1,76 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef BOOTHISTORY_H
+#define BOOTHISTORY_H
+
+// Qt
+#include <QCoreApplication>
+#include <QFile>
+#include <QSaveFile>
+#include <QVector>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <QDebug>
+
+/**
+ * Boot times of a machine, each one saved with the hash of the
+ * options of the machine that change the boot, so the boots done
+ * with different configurations can be compared
+ */
+class BootHistory {
+    Q_DECLARE_TR_FUNCTIONS(BootHistory)
+
+    public:
+        struct BootRecord {
+            QDateTime time;
+            qint64 bootTime;
+            QString configHash;
+            QJsonObject config;
+        };
+
+        explicit BootHistory(const QString &filePath);
+        ~BootHistory();
+
+        static QString configHash(const QJsonObject &config);
+
+        QString filePath() const;
+        QVector<BootRecord> records() const;
+
+        void append(qint64 bootTime, const QJsonObject &config);
+        qint64 medianBootTime(const QString &configHash, int *boots = nullptr) const;
+        QStringList compare(const QJsonObject &config, int maxConfigs = 3) const;
+
+    private:
+        QString m_filePath;
+        mutable QVector<BootRecord> m_records;
+        mutable bool m_loaded;
+
+        // Methods
+        void load() const;
+        void save() const;
+        QString describeChanges(const QJsonObject &from, const QJsonObject &to) const;
+};
+
+#endif // BOOTHISTORY_H
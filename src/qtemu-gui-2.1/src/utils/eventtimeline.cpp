@@ -0,0 +1,371 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "eventtimeline.h"
+
+// C++ standard library
+#include <algorithm>
+#include <cstring>
+
+static const char EVENT_TIMELINE_MAGIC[8] = {'Q', 'T', 'E', 'M', 'U', 'E', 'V', 'T'};
+static const quint32 EVENT_TIMELINE_VERSION = 1;
+static const qint64 FILE_HEADER_SIZE = 12;
+
+// Record: monotonic time ms (8), wall time ms (8), type (2), data size (2), data
+static const qint64 RECORD_HEADER_SIZE = 20;
+
+/**
+ * @brief Event timeline
+ * @param filePath, path of the log file
+ *
+ * Timeline with the QMP events of a machine
+ */
+EventTimeline::EventTimeline(const QString &filePath)
+{
+    this->m_filePath = filePath;
+
+    qDebug() << "EventTimeline object created";
+}
+
+EventTimeline::~EventTimeline()
+{
+    this->close();
+
+    qDebug() << "EventTimeline object destroyed";
+}
+
+/**
+ * @brief Open the timeline
+ * @return true if the timeline is open
+ *
+ * Open the log file and build the index of the records.
+ * A record cut by a crash at the end of the file is discarded
+ */
+bool EventTimeline::open()
+{
+    if (this->m_file.isOpen()) {
+        return true;
+    }
+
+    this->m_file.setFileName(this->m_filePath);
+    if (!this->m_file.open(QIODevice::ReadWrite)) {
+        qDebug() << "Cannot open the event timeline" << this->m_filePath << this->m_file.errorString();
+        return false;
+    }
+
+    if (!this->loadIndex()) {
+        this->m_file.resize(0);
+        this->m_index.clear();
+
+        uchar header[FILE_HEADER_SIZE];
+        std::memcpy(header, EVENT_TIMELINE_MAGIC, sizeof(EVENT_TIMELINE_MAGIC));
+        qToLittleEndian<quint32>(EVENT_TIMELINE_VERSION, header + 8);
+
+        this->m_file.seek(0);
+        this->m_file.write(reinterpret_cast<char *>(header), FILE_HEADER_SIZE);
+        this->m_file.flush();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Close the timeline
+ *
+ * Close the log file
+ */
+void EventTimeline::close()
+{
+    if (this->m_file.isOpen()) {
+        this->m_file.close();
+    }
+
+    this->m_index.clear();
+}
+
+/**
+ * @brief Know if the timeline is open
+ * @return true if the timeline is open
+ *
+ * Know if the timeline is open
+ */
+bool EventTimeline::isOpen() const
+{
+    return this->m_file.isOpen();
+}
+
+/**
+ * @brief Get the path of the log file
+ * @return path of the log file
+ *
+ * Get the path of the log file
+ */
+QString EventTimeline::filePath() const
+{
+    return m_filePath;
+}
+
+/**
+ * @brief Get the number of events
+ * @return number of events in the timeline
+ *
+ * Get the number of events
+ */
+int EventTimeline::count() const
+{
+    return this->m_index.size();
+}
+
+/**
+ * @brief Append an event
+ * @param event, name of the QMP event
+ * @param data, data of the event
+ * @param timestamp, QEMU timestamp of the event
+ *
+ * Append an event with the current monotonic time. The wall
+ * time is the QEMU timestamp, or the current time without it
+ */
+void EventTimeline::append(const QString &event,
+                           const QJsonObject &data,
+                           const QJsonObject &timestamp)
+{
+    if (!this->isOpen()) {
+        return;
+    }
+
+    EventType type = EventTimeline::eventType(event);
+
+    QJsonObject storedData(data);
+    if (type == Other) {
+        storedData["event"] = event;
+    }
+
+    QByteArray payload = QJsonDocument(storedData).toJson(QJsonDocument::Compact);
+    if (payload.size() > 0xFFFF) {
+        payload = QByteArray("{}");
+    }
+
+    IndexEntry entry;
+    entry.monotonicTime = QElapsedTimer::msecsSinceReference();
+    if (timestamp.contains("seconds")) {
+        entry.wallTime = timestamp["seconds"].toVariant().toLongLong() * 1000 +
+                         timestamp["microseconds"].toVariant().toLongLong() / 1000;
+    } else {
+        entry.wallTime = QDateTime::currentMSecsSinceEpoch();
+    }
+    entry.offset = this->m_file.size();
+    entry.type = static_cast<quint16>(type);
+    entry.dataSize = static_cast<quint16>(payload.size());
+
+    uchar header[RECORD_HEADER_SIZE];
+    qToLittleEndian<qint64>(entry.monotonicTime, header);
+    qToLittleEndian<qint64>(entry.wallTime, header + 8);
+    qToLittleEndian<quint16>(entry.type, header + 16);
+    qToLittleEndian<quint16>(entry.dataSize, header + 18);
+
+    this->m_file.seek(entry.offset);
+    if (this->m_file.write(reinterpret_cast<char *>(header), RECORD_HEADER_SIZE) != RECORD_HEADER_SIZE ||
+        this->m_file.write(payload) != payload.size()) {
+        qDebug() << "Cannot write the event timeline" << this->m_filePath << this->m_file.errorString();
+        this->m_file.resize(entry.offset);
+        return;
+    }
+    this->m_file.flush();
+
+    // Events arrive in order, except if the clock of the host changes
+    if (this->m_index.isEmpty() || this->m_index.last().wallTime <= entry.wallTime) {
+        this->m_index.append(entry);
+    } else {
+        QVector<IndexEntry>::iterator position =
+                std::upper_bound(this->m_index.begin(), this->m_index.end(), entry,
+                                 [](const IndexEntry &a, const IndexEntry &b) {
+            return a.wallTime < b.wallTime;
+        });
+        this->m_index.insert(position, entry);
+    }
+}
+
+/**
+ * @brief Query the timeline
+ * @param fromWallTime, start of the range, ms since epoch
+ * @param toWallTime, end of the range, ms since epoch, included
+ * @param typeMask, mask with the types wanted, bit 1 << EventType
+ * @return events of the range sorted by time
+ *
+ * Query the timeline by time range and type. Only the
+ * data of the matching events is read from the file
+ */
+QVector<EventTimeline::Event> EventTimeline::query(qint64 fromWallTime,
+                                                   qint64 toWallTime,
+                                                   quint32 typeMask) const
+{
+    QVector<Event> events;
+
+    if (!this->isOpen()) {
+        return events;
+    }
+
+    IndexEntry fromEntry;
+    fromEntry.wallTime = fromWallTime;
+
+    QVector<IndexEntry>::const_iterator it =
+            std::lower_bound(this->m_index.constBegin(), this->m_index.constEnd(), fromEntry,
+                             [](const IndexEntry &a, const IndexEntry &b) {
+        return a.wallTime < b.wallTime;
+    });
+
+    for (; it != this->m_index.constEnd() && it->wallTime <= toWallTime; ++it) {
+        if ((typeMask & (1u << it->type)) == 0) {
+            continue;
+        }
+
+        this->m_file.seek(it->offset + RECORD_HEADER_SIZE);
+        QByteArray payload = this->m_file.read(it->dataSize);
+
+        Event event;
+        event.monotonicTime = it->monotonicTime;
+        event.wallTime = it->wallTime;
+        event.type = static_cast<EventType>(it->type);
+        event.data = QJsonDocument::fromJson(payload).object();
+
+        events.append(event);
+    }
+
+    return events;
+}
+
+/**
+ * @brief Get the type of an event
+ * @param event, name of the QMP event
+ * @return type of the event
+ *
+ * Get the type of an event
+ * Ex: BLOCK_IO_ERROR -> BlockIOError
+ */
+EventTimeline::EventType EventTimeline::eventType(const QString &event)
+{
+    if (event == "STOP") {
+        return Stop;
+    } else if (event == "RESUME") {
+        return Resume;
+    } else if (event == "SHUTDOWN") {
+        return Shutdown;
+    } else if (event == "RESET") {
+        return Reset;
+    } else if (event == "BLOCK_IO_ERROR") {
+        return BlockIOError;
+    } else if (event == "BALLOON_CHANGE") {
+        return BalloonChange;
+    } else if (event == "JOB_STATUS_CHANGE") {
+        return JobStatusChange;
+    }
+
+    return Other;
+}
+
+/**
+ * @brief Get the name of an event type
+ * @param type, type of the event
+ * @return name of the QMP event
+ *
+ * Get the name of an event type
+ */
+QString EventTimeline::eventName(EventType type)
+{
+    switch (type) {
+        case Stop:
+            return "STOP";
+        case Resume:
+            return "RESUME";
+        case Shutdown:
+            return "SHUTDOWN";
+        case Reset:
+            return "RESET";
+        case BlockIOError:
+            return "BLOCK_IO_ERROR";
+        case BalloonChange:
+            return "BALLOON_CHANGE";
+        case JobStatusChange:
+            return "JOB_STATUS_CHANGE";
+        default:
+            return "OTHER";
+    }
+}
+
+/**
+ * @brief Load the index
+ * @return false if the file isn't a timeline
+ *
+ * Build the index reading only the record headers
+ */
+bool EventTimeline::loadIndex()
+{
+    this->m_index.clear();
+
+    qint64 fileSize = this->m_file.size();
+    if (fileSize < FILE_HEADER_SIZE) {
+        return false;
+    }
+
+    uchar header[RECORD_HEADER_SIZE];
+
+    this->m_file.seek(0);
+    if (this->m_file.read(reinterpret_cast<char *>(header), FILE_HEADER_SIZE) != FILE_HEADER_SIZE ||
+        std::memcmp(header, EVENT_TIMELINE_MAGIC, sizeof(EVENT_TIMELINE_MAGIC)) != 0 ||
+        qFromLittleEndian<quint32>(header + 8) != EVENT_TIMELINE_VERSION) {
+        return false;
+    }
+
+    qint64 offset = FILE_HEADER_SIZE;
+    while (offset + RECORD_HEADER_SIZE <= fileSize) {
+        this->m_file.seek(offset);
+        if (this->m_file.read(reinterpret_cast<char *>(header), RECORD_HEADER_SIZE) != RECORD_HEADER_SIZE) {
+            break;
+        }
+
+        IndexEntry entry;
+        entry.monotonicTime = qFromLittleEndian<qint64>(header);
+        entry.wallTime = qFromLittleEndian<qint64>(header + 8);
+        entry.type = qFromLittleEndian<quint16>(header + 16);
+        entry.dataSize = qFromLittleEndian<quint16>(header + 18);
+        entry.offset = offset;
+
+        if (offset + RECORD_HEADER_SIZE + entry.dataSize > fileSize) {
+            break;
+        }
+
+        this->m_index.append(entry);
+        offset += RECORD_HEADER_SIZE + entry.dataSize;
+    }
+
+    // Discard a record cut at the end of the file
+    if (offset < fileSize) {
+        this->m_file.resize(offset);
+    }
+
+    std::stable_sort(this->m_index.begin(), this->m_index.end(),
+                     [](const IndexEntry &a, const IndexEntry &b) {
+        return a.wallTime < b.wallTime;
+    });
+
+    return true;
+}
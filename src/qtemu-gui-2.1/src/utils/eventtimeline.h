@@ -0,0 +1,101 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef EVENTTIMELINE_H
+#define EVENTTIMELINE_H
+
+// Qt
+#include <QFile>
+#include <QVector>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+
+#include <QDebug>
+
+/**
+ * Append only binary log with the QMP events of a machine.
+ * Every record has the monotonic and the wall clock time, in ms,
+ * of the event, its type and the event data as compact JSON.
+ * The index of the records is kept in memory
+ */
+class EventTimeline {
+
+    public:
+        enum EventType {
+            Other = 0,
+            Stop,
+            Resume,
+            Shutdown,
+            Reset,
+            BlockIOError,
+            BalloonChange,
+            JobStatusChange
+        };
+
+        struct Event {
+            qint64 monotonicTime;
+            qint64 wallTime;
+            EventType type;
+            QJsonObject data;
+        };
+
+        explicit EventTimeline(const QString &filePath);
+        ~EventTimeline();
+
+        bool open();
+        void close();
+        bool isOpen() const;
+
+        QString filePath() const;
+        int count() const;
+
+        void append(const QString &event,
+                    const QJsonObject &data,
+                    const QJsonObject &timestamp);
+
+        QVector<Event> query(qint64 fromWallTime,
+                             qint64 toWallTime,
+                             quint32 typeMask = 0xFFFFFFFF) const;
+
+        static EventType eventType(const QString &event);
+        static QString eventName(EventType type);
+
+    private:
+        struct IndexEntry {
+            qint64 wallTime;
+            qint64 monotonicTime;
+            qint64 offset;
+            quint16 type;
+            quint16 dataSize;
+        };
+
+        QString m_filePath;
+        mutable QFile m_file;
+        QVector<IndexEntry> m_index;
+
+        // Methods
+        bool loadIndex();
+};
+
+#endif // EVENTTIMELINE_H
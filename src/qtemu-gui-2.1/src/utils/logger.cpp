@@ -18,9 +18,14 @@
  * Boston, MA 02110-1301, USA.
  */
 
+
 // Local
 #include "logger.h"
 
+QMutex Logger::m_writerMutex;
+LogWriter *Logger::m_writer = nullptr;
+QString Logger::m_logDirectoryPath;
+
 Logger::Logger(QObject *parent) : QObject(parent)
 {
     qDebug() << "Logger created";
@@ -33,7 +38,7 @@ Logger::~Logger()
 
 /**
  * @brief Log the machine creation actions
- * @param fileLocation, log file location
+ * @param fileLocation, machine location
  * @param machineName, name of the machine
  * @param message, message to be logged
  *
@@ -43,29 +48,24 @@ void Logger::logMachineCreation(const QString &fileLocation,
                                 const QString &machineName,
                                 const QString &message)
 {
-    QString path = fileLocation + "/logs/" + machineName.toLower().replace(" ", "_") + ".log";
-
-    QFile machineLogsFile(path);
-    if (!machineLogsFile.open(QIODevice::Append)) {
-        QMessageBox *m_logMachineMessageBox = new QMessageBox();
-        m_logMachineMessageBox->setWindowTitle(tr("Qtemu - Critical error"));
-        m_logMachineMessageBox->setIcon(QMessageBox::Critical);
-        m_logMachineMessageBox->setWindowIcon(QIcon::fromTheme("qtemu", QIcon(":/images/qtemu.png")));
-        m_logMachineMessageBox->setText(tr("<p>Problem writing in the log</p>"));
-        m_logMachineMessageBox->exec();
-        return;
-    }
-
-    QTextStream fileStream(&machineLogsFile);
-    fileStream.setCodec("UTF-8");
-
-    if (machineLogsFile.isWritable()) {
-        fileStream << message;
-    }
+    log(machineLogPath(fileLocation, machineName), "info", QString(), machineName, message);
+}
 
-    if (machineLogsFile.isOpen()) {
-        machineLogsFile.close();
-    }
+/**
+ * @brief Log the machine actions
+ * @param fileLocation, machine location
+ * @param machineName, name of the machine
+ * @param machineUuid, uuid of the machine
+ * @param message, message to be logged
+ *
+ * Log the machine actions, like start, stop or pause
+ */
+void Logger::logMachineAction(const QString &fileLocation,
+                              const QString &machineName,
+                              const QString &machineUuid,
+                              const QString &message)
+{
+    log(machineLogPath(fileLocation, machineName), "info", machineUuid, machineName, message);
 }
 
 /**
@@ -76,34 +76,7 @@ void Logger::logMachineCreation(const QString &fileLocation,
  */
 void Logger::logQtemuAction(const QString &message)
 {
-    QSettings settings;
-    settings.beginGroup("DataFolder");
-    QString logDirectoryPath = settings.value("QtEmuLogs").toString();
-    settings.endGroup();
-
-    QString logMessage = QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss ").append(message).append("\n");
-
-    QFile logsFile(logDirectoryPath.append("/qtemu.log"));
-    if (!logsFile.open(QIODevice::Append)) {
-        QMessageBox *m_logQtEmuMessageBox = new QMessageBox();
-        m_logQtEmuMessageBox->setWindowTitle(tr("Qtemu - Critical error"));
-        m_logQtEmuMessageBox->setIcon(QMessageBox::Critical);
-        m_logQtEmuMessageBox->setWindowIcon(QIcon::fromTheme("qtemu", QIcon(":/images/qtemu.png")));
-        m_logQtEmuMessageBox->setText(tr("<p>Problem writing in the log</p>"));
-        m_logQtEmuMessageBox->exec();
-        return;
-    }
-
-    QTextStream fileStream(&logsFile);
-    fileStream.setCodec("UTF-8");
-
-    if (logsFile.isWritable()) {
-        fileStream << logMessage;
-    }
-
-    if (logsFile.isOpen()) {
-        logsFile.close();
-    }
+    log("qtemu.log", "info", QString(), QString(), message);
 }
 
 /**
@@ -114,33 +87,104 @@ void Logger::logQtemuAction(const QString &message)
  */
 void Logger::logQtemuError(const QString &message)
 {
+    log("qtemu.err", "error", QString(), QString(), message);
+}
+
+/**
+ * @brief Stop the logger
+ *
+ * Write the pending records and stop the writer thread.
+ * Called before the application exits
+ */
+void Logger::stop()
+{
+    QMutexLocker locker(&m_writerMutex);
+
+    if (m_writer != nullptr) {
+        m_writer->stop();
+        delete m_writer;
+        m_writer = nullptr;
+    }
+}
+
+/**
+ * @brief Get the log writer
+ * @return log writer
+ *
+ * Get the log writer, started the first time that
+ * something is logged with the options of the Logger group.
+ * m_writerMutex must be locked
+ */
+LogWriter *Logger::writer()
+{
+    if (m_writer != nullptr) {
+        return m_writer;
+    }
+
     QSettings settings;
     settings.beginGroup("DataFolder");
+    m_logDirectoryPath = settings.value("QtEmuLogs").toString();
+    settings.endGroup();
 
-    QString logDirectoryPath = settings.value("QtEmuLogs").toString();
+    settings.beginGroup("Logger");
+    LogWriterOptions options;
+    options.jsonLines = settings.value("jsonLines", false).toBool();
+    options.syncInterval = settings.value("syncInterval", 1000).toInt();
+    options.maxFileSize = settings.value("maxFileSize", 5 * 1024 * 1024).toLongLong();
+    options.rotationInterval = settings.value("rotationInterval", 7 * 24 * 60 * 60).toInt();
+    options.rotatedFiles = settings.value("rotatedFiles", 5).toInt();
     settings.endGroup();
 
-    QString logMessage = QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss ").append(message).append("\n");;
-
-    QFile logsFile(logDirectoryPath.append("/qtemu.err"));
-    if (!logsFile.open(QIODevice::Append)) {
-        QMessageBox *m_logQtEmuErrorMessageBox = new QMessageBox();
-        m_logQtEmuErrorMessageBox->setWindowTitle(tr("Qtemu - Critical error"));
-        m_logQtEmuErrorMessageBox->setIcon(QMessageBox::Critical);
-        m_logQtEmuErrorMessageBox->setWindowIcon(QIcon::fromTheme("qtemu", QIcon(":/images/qtemu.png")));
-        m_logQtEmuErrorMessageBox->setText(tr("<p>Problem writing in the log</p>"));
-        m_logQtEmuErrorMessageBox->exec();
-        return;
-    }
+    m_writer = new LogWriter(options);
+    m_writer->start(QThread::LowPriority);
 
-    QTextStream fileStream(&logsFile);
-    fileStream.setCodec("UTF-8");
+    return m_writer;
+}
 
-    if (logsFile.isWritable()) {
-        fileStream << logMessage;
-    }
+/**
+ * @brief Get the log of a machine
+ * @param fileLocation, machine location
+ * @param machineName, name of the machine
+ * @return path of the machine log
+ *
+ * Get the log of a machine
+ */
+QString Logger::machineLogPath(const QString &fileLocation,
+                               const QString &machineName)
+{
+    return fileLocation + "/logs/" + QString(machineName).toLower().replace(" ", "_") + ".log";
+}
 
-    if (logsFile.isOpen()) {
-        logsFile.close();
+/**
+ * @brief Log a record
+ * @param filePath, log file, relative to the logs folder if it isn't absolute
+ * @param level, info or error
+ * @param machineUuid, uuid of the machine, if any
+ * @param machineName, name of the machine, if any
+ * @param message, message to be logged
+ *
+ * Queue the record for the writer thread, it never waits for the disk
+ */
+void Logger::log(const QString &filePath,
+                 const QString &level,
+                 const QString &machineUuid,
+                 const QString &machineName,
+                 const QString &message)
+{
+    LogRecord record;
+    record.time = QDateTime::currentDateTime();
+    record.filePath = filePath;
+    record.level = level;
+    record.machineUuid = machineUuid;
+    record.machineName = machineName;
+    record.message = message;
+
+    QMutexLocker locker(&m_writerMutex);
+    LogWriter *logWriter = writer();
+
+    if (QDir::isRelativePath(filePath)) {
+        record.filePath = m_logDirectoryPath + "/" + filePath;
     }
+
+    logWriter->enqueue(record);
 }
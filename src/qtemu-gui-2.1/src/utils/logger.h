@@ -18,6 +18,7 @@
  * Boston, MA 02110-1301, USA.
  */
 
+
 #ifndef LOGGER_H
 #define LOGGER_H
 
@@ -25,12 +26,14 @@
 #include <QObject>
 #include <QDateTime>
 #include <QSettings>
-#include <QFile>
-#include <QTextStream>
-#include <QMessageBox>
-#include <QIcon>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDir>
 #include <QDebug>
 
+// Local
+#include "logwriter.h"
+
 class Logger : public QObject {
     Q_OBJECT
 
@@ -41,14 +44,33 @@ class Logger : public QObject {
         static void logMachineCreation(const QString &fileLocation,
                                        const QString &machineName,
                                        const QString &message);
+        static void logMachineAction(const QString &fileLocation,
+                                     const QString &machineName,
+                                     const QString &machineUuid,
+                                     const QString &message);
         static void logQtemuAction(const QString &message);
         static void logQtemuError(const QString &message);
 
+        static void stop();
+
     public slots:
 
     protected:
 
     private:
+        static QMutex m_writerMutex;
+        static LogWriter *m_writer;
+        static QString m_logDirectoryPath;
+
+        // Methods
+        static LogWriter *writer();
+        static QString machineLogPath(const QString &fileLocation,
+                                      const QString &machineName);
+        static void log(const QString &filePath,
+                        const QString &level,
+                        const QString &machineUuid,
+                        const QString &machineName,
+                        const QString &message);
 
 };
 
@@ -0,0 +1,335 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "logwriter.h"
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Records waiting to be written before the oldest ones are dropped
+static const int MAX_QUEUED_RECORDS = 100000;
+
+/**
+ * @brief Log writer
+ * @param options, format, sync and rotation options
+ * @param parent, parent object
+ *
+ * Thread that writes the log records. The producers only
+ * append the records to a queue, the writer takes all the
+ * queued records at once and writes them in batch
+ */
+LogWriter::LogWriter(const LogWriterOptions &options,
+                     QObject *parent) : QThread(parent)
+{
+    this->m_options = options;
+    this->m_droppedRecords = 0;
+    this->m_stopRequested = false;
+    this->m_queue.reserve(1024);
+
+    qDebug() << "LogWriter object created";
+}
+
+LogWriter::~LogWriter()
+{
+    this->stop();
+
+    qDebug() << "LogWriter object destroyed";
+}
+
+/**
+ * @brief Enqueue a record
+ * @param record, record to be written
+ *
+ * Enqueue a record. It never waits for the disk, if the
+ * queue is full the record is dropped
+ */
+void LogWriter::enqueue(const LogRecord &record)
+{
+    QMutexLocker locker(&m_queueMutex);
+
+    if (this->m_queue.size() >= MAX_QUEUED_RECORDS) {
+        ++this->m_droppedRecords;
+        return;
+    }
+
+    this->m_queue.append(record);
+    this->m_queueCondition.wakeOne();
+}
+
+/**
+ * @brief Stop the writer
+ *
+ * Write the queued records, sync the files and stop the thread
+ */
+void LogWriter::stop()
+{
+    {
+        QMutexLocker locker(&m_queueMutex);
+        this->m_stopRequested = true;
+        this->m_queueCondition.wakeOne();
+    }
+
+    this->wait();
+}
+
+/**
+ * @brief Writer loop
+ *
+ * Wait for records and write them. The files are flushed after
+ * every batch and synced to disk every syncInterval milliseconds,
+ * or after every batch if syncInterval is 0
+ */
+void LogWriter::run()
+{
+    QElapsedTimer syncTimer;
+    syncTimer.start();
+
+    QVector<LogRecord> records;
+    bool stopRequested = false;
+
+    while (!stopRequested) {
+        int droppedRecords = 0;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            if (this->m_queue.isEmpty() && !this->m_stopRequested) {
+                if (this->m_options.syncInterval <= 0) {
+                    // Nothing to sync until the next batch
+                    this->m_queueCondition.wait(&m_queueMutex);
+                } else {
+                    qint64 remaining = qMax<qint64>(this->m_options.syncInterval - syncTimer.elapsed(), 1);
+                    this->m_queueCondition.wait(&m_queueMutex, static_cast<unsigned long>(remaining));
+                }
+            }
+
+            records.swap(this->m_queue);
+            droppedRecords = this->m_droppedRecords;
+            this->m_droppedRecords = 0;
+            stopRequested = this->m_stopRequested;
+        }
+
+        if (droppedRecords > 0 && !records.isEmpty()) {
+            LogRecord droppedRecord = records.first();
+            droppedRecord.level = "error";
+            droppedRecord.machineUuid.clear();
+            droppedRecord.machineName.clear();
+            droppedRecord.message = QString("%1 log records dropped").arg(droppedRecords);
+            records.prepend(droppedRecord);
+        }
+
+        bool written = !records.isEmpty();
+        this->writeRecords(records);
+        records.clear();
+
+        bool syncDue = this->m_options.syncInterval <= 0 ? written
+                                                        : syncTimer.elapsed() >= this->m_options.syncInterval;
+        if (stopRequested || syncDue) {
+            this->syncLogFiles();
+            syncTimer.restart();
+        }
+    }
+
+    this->closeLogFiles();
+}
+
+/**
+ * @brief Write the records
+ * @param records, records to be written
+ *
+ * Write the records in their files and flush the files
+ */
+void LogWriter::writeRecords(const QVector<LogRecord> &records)
+{
+    if (records.isEmpty()) {
+        return;
+    }
+
+    QHash<QString, QByteArray> batches;
+    foreach (const LogRecord &record, records) {
+        batches[record.filePath].append(this->formatRecord(record));
+    }
+
+    QHash<QString, QByteArray>::const_iterator it;
+    for (it = batches.constBegin(); it != batches.constEnd(); ++it) {
+        LogFile *logFile = this->openLogFile(it.key());
+        if (logFile == nullptr) {
+            continue;
+        }
+
+        if (logFile->file->write(it.value()) < 0) {
+            qDebug() << "Cannot write the log" << it.key() << logFile->file->errorString();
+            continue;
+        }
+
+        logFile->file->flush();
+        logFile->pendingSync = true;
+    }
+}
+
+/**
+ * @brief Open a log file
+ * @param filePath, path of the log file
+ * @return log file, nullptr if it cannot be opened
+ *
+ * Open a log file in append mode, rotating it before
+ * if it's too big or too old
+ */
+LogWriter::LogFile *LogWriter::openLogFile(const QString &filePath)
+{
+    if (this->m_files.contains(filePath)) {
+        LogFile &logFile = this->m_files[filePath];
+
+        bool tooBig = this->m_options.maxFileSize > 0 &&
+                      logFile.file->size() >= this->m_options.maxFileSize;
+        bool tooOld = this->m_options.rotationInterval > 0 &&
+                      logFile.opened.secsTo(QDateTime::currentDateTime()) >= this->m_options.rotationInterval;
+
+        if (!tooBig && !tooOld) {
+            return &logFile;
+        }
+
+        logFile.file->close();
+        delete logFile.file;
+        this->m_files.remove(filePath);
+
+        this->rotateLogFile(filePath);
+    } else {
+        QFileInfo logFileInfo(filePath);
+        if (this->m_options.maxFileSize > 0 && logFileInfo.size() >= this->m_options.maxFileSize) {
+            this->rotateLogFile(filePath);
+        }
+    }
+
+    QFile *file = new QFile(filePath);
+    if (!file->open(QIODevice::Append)) {
+        qDebug() << "Cannot open the log" << filePath << file->errorString();
+        delete file;
+        return nullptr;
+    }
+
+    LogFile logFile;
+    logFile.file = file;
+    logFile.opened = QDateTime::currentDateTime();
+    logFile.pendingSync = false;
+
+    QHash<QString, LogFile>::iterator inserted = this->m_files.insert(filePath, logFile);
+
+    return &inserted.value();
+}
+
+/**
+ * @brief Rotate a log file
+ * @param filePath, path of the log file
+ *
+ * Rotate a log file. file.log is renamed to file.log.1,
+ * file.log.1 to file.log.2... and the oldest one is removed
+ */
+void LogWriter::rotateLogFile(const QString &filePath)
+{
+    if (!QFile::exists(filePath)) {
+        return;
+    }
+
+    if (this->m_options.rotatedFiles <= 0) {
+        QFile::remove(filePath);
+        return;
+    }
+
+    QFile::remove(QString("%1.%2").arg(filePath).arg(this->m_options.rotatedFiles));
+    for (int i = this->m_options.rotatedFiles - 1; i > 0; --i) {
+        QFile::rename(QString("%1.%2").arg(filePath).arg(i),
+                      QString("%1.%2").arg(filePath).arg(i + 1));
+    }
+
+    QFile::rename(filePath, filePath + ".1");
+}
+
+/**
+ * @brief Sync the log files
+ *
+ * Sync to disk the log files written since the last sync
+ */
+void LogWriter::syncLogFiles()
+{
+    QHash<QString, LogFile>::iterator it;
+    for (it = this->m_files.begin(); it != this->m_files.end(); ++it) {
+        if (!it.value().pendingSync) {
+            continue;
+        }
+
+#ifdef Q_OS_WIN
+        _commit(it.value().file->handle());
+#else
+        fsync(it.value().file->handle());
+#endif
+        it.value().pendingSync = false;
+    }
+}
+
+/**
+ * @brief Close the log files
+ *
+ * Close all the log files
+ */
+void LogWriter::closeLogFiles()
+{
+    this->syncLogFiles();
+
+    QHash<QString, LogFile>::iterator it;
+    for (it = this->m_files.begin(); it != this->m_files.end(); ++it) {
+        it.value().file->close();
+        delete it.value().file;
+    }
+
+    this->m_files.clear();
+}
+
+/**
+ * @brief Format a record
+ * @param record, record to be formatted
+ * @return line to be written
+ *
+ * Format a record as text or as JSON line
+ * Ex: 12.05.2019 18:20:31 QtEmu started with PID 1234
+ * Ex: {"time":"2019-05-12T18:20:31.120","level":"info","message":"..."}
+ */
+QByteArray LogWriter::formatRecord(const LogRecord &record) const
+{
+    if (!this->m_options.jsonLines) {
+        return record.time.toString("dd.MM.yyyy hh:mm:ss ").append(record.message).append("\n").toUtf8();
+    }
+
+    QJsonObject recordObject;
+    recordObject["time"] = record.time.toString("yyyy-MM-ddThh:mm:ss.zzz");
+    recordObject["level"] = record.level;
+    if (!record.machineUuid.isEmpty()) {
+        recordObject["uuid"] = record.machineUuid;
+    }
+    if (!record.machineName.isEmpty()) {
+        recordObject["machine"] = record.machineName;
+    }
+    recordObject["message"] = record.message;
+
+    return QJsonDocument(recordObject).toJson(QJsonDocument::Compact).append("\n");
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+// Qt
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QVector>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <QDebug>
+
+struct LogRecord {
+    QDateTime time;
+    QString filePath;
+    QString level;
+    QString machineUuid;
+    QString machineName;
+    QString message;
+};
+
+struct LogWriterOptions {
+    bool jsonLines;
+    int syncInterval;
+    qint64 maxFileSize;
+    int rotationInterval;
+    int rotatedFiles;
+};
+
+class LogWriter : public QThread {
+    Q_OBJECT
+
+    public:
+        explicit LogWriter(const LogWriterOptions &options,
+                           QObject *parent = nullptr);
+        ~LogWriter();
+
+        void enqueue(const LogRecord &record);
+        void stop();
+
+    signals:
+
+    public slots:
+
+    protected:
+        void run() override;
+
+    private:
+        struct LogFile {
+            QFile *file;
+            QDateTime opened;
+            bool pendingSync;
+        };
+
+        LogWriterOptions m_options;
+
+        // Queue shared by all the producers
+        QMutex m_queueMutex;
+        QWaitCondition m_queueCondition;
+        QVector<LogRecord> m_queue;
+        int m_droppedRecords;
+        bool m_stopRequested;
+
+        // Only used by the writer thread
+        QHash<QString, LogFile> m_files;
+
+        // Methods
+        void writeRecords(const QVector<LogRecord> &records);
+        LogFile *openLogFile(const QString &filePath);
+        void rotateLogFile(const QString &filePath);
+        void syncLogFiles();
+        void closeLogFiles();
+        QByteArray formatRecord(const LogRecord &record) const;
+};
+
+#endif // LOGWRITER_H
@@ -0,0 +1,186 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "machinewatcher.h"
+
+/**
+ * @brief Watcher of the machines configuration files
+ * @param machinesFilePath, path of the qtemu.json file
+ * @param parent, parent object
+ *
+ * Watch the qtemu.json file and the config file of every machine.
+ * The folder of qtemu.json is watched too, so the file is watched
+ * when it's created after QtEmu starts. Changes are coalesced during a short debounce window, so a burst
+ * of writes to the same file produces only one notification
+ */
+MachineWatcher::MachineWatcher(const QString &machinesFilePath,
+                               QObject *parent) : QObject(parent)
+{
+    this->m_machinesFilePath = machinesFilePath;
+
+    this->m_fileSystemWatcher = new QFileSystemWatcher(this);
+    connect(m_fileSystemWatcher, &QFileSystemWatcher::fileChanged,
+            this, &MachineWatcher::fileChanged);
+    connect(m_fileSystemWatcher, &QFileSystemWatcher::directoryChanged,
+            this, &MachineWatcher::directoryChanged);
+
+    this->m_debounceTimer = new QTimer(this);
+    this->m_debounceTimer->setSingleShot(true);
+    this->m_debounceTimer->setInterval(300);
+    connect(m_debounceTimer, &QTimer::timeout,
+            this, &MachineWatcher::processPendingChanges);
+
+    QString machinesDirectoryPath = QFileInfo(m_machinesFilePath).absolutePath();
+    if (QFileInfo::exists(machinesDirectoryPath)) {
+        this->m_fileSystemWatcher->addPath(machinesDirectoryPath);
+    }
+
+    if (QFileInfo::exists(m_machinesFilePath)) {
+        this->m_fileSystemWatcher->addPath(m_machinesFilePath);
+    }
+
+    qDebug() << "MachineWatcher object created";
+}
+
+MachineWatcher::~MachineWatcher()
+{
+    qDebug() << "MachineWatcher object destroyed";
+}
+
+/**
+ * @brief Get the path of the qtemu.json file
+ * @return path of the qtemu.json file
+ *
+ * Get the path of the qtemu.json file
+ */
+QString MachineWatcher::machinesFilePath() const
+{
+    return m_machinesFilePath;
+}
+
+/**
+ * @brief Start watching a machine config file
+ * @param configPath, path of the machine config file
+ *
+ * Start watching a machine config file
+ */
+void MachineWatcher::watchMachine(const QString &configPath)
+{
+    if (configPath.isEmpty() || this->m_watchedConfigs.contains(configPath)) {
+        return;
+    }
+
+    this->m_watchedConfigs.insert(configPath);
+    this->m_fileSystemWatcher->addPath(configPath);
+}
+
+/**
+ * @brief Stop watching a machine config file
+ * @param configPath, path of the machine config file
+ *
+ * Stop watching a machine config file
+ */
+void MachineWatcher::unwatchMachine(const QString &configPath)
+{
+    this->m_watchedConfigs.remove(configPath);
+    this->m_pendingPaths.remove(configPath);
+    this->m_missingRetries.remove(configPath);
+    this->m_fileSystemWatcher->removePath(configPath);
+}
+
+/**
+ * @brief A watched file has changed
+ * @param path, path of the changed file
+ *
+ * Queue the file and restart the debounce timer
+ */
+void MachineWatcher::fileChanged(const QString &path)
+{
+    this->m_pendingPaths.insert(path);
+    this->m_debounceTimer->start();
+}
+
+/**
+ * @brief The folder of qtemu.json has changed
+ * @param path, path of the folder
+ *
+ * Watch qtemu.json when it appears in the folder, created
+ * for the first machine or restored by other program
+ */
+void MachineWatcher::directoryChanged(const QString &path)
+{
+    Q_UNUSED(path);
+
+    if (QFileInfo::exists(this->m_machinesFilePath) &&
+        !this->m_fileSystemWatcher->files().contains(this->m_machinesFilePath)) {
+        this->fileChanged(this->m_machinesFilePath);
+    }
+}
+
+/**
+ * @brief Notify the pending changes
+ *
+ * Notify every changed file once. Files replaced by a rename
+ * (most editors and provisioning tools do that) are dropped by
+ * QFileSystemWatcher, so they are watched again here
+ */
+void MachineWatcher::processPendingChanges()
+{
+    QSet<QString> pendingPaths = this->m_pendingPaths;
+    this->m_pendingPaths.clear();
+
+    foreach (const QString &path, pendingPaths) {
+        bool isMachinesFile = (path == this->m_machinesFilePath);
+
+        if (!isMachinesFile && !this->m_watchedConfigs.contains(path)) {
+            continue;
+        }
+
+        if (!QFileInfo::exists(path)) {
+            // Probably still being replaced, try it again in the next rounds
+            int retries = this->m_missingRetries.value(path, 0);
+            if (retries < 10) {
+                this->m_missingRetries.insert(path, retries + 1);
+                this->m_pendingPaths.insert(path);
+            } else {
+                this->m_missingRetries.remove(path);
+            }
+            continue;
+        }
+
+        this->m_missingRetries.remove(path);
+
+        if (!this->m_fileSystemWatcher->files().contains(path)) {
+            this->m_fileSystemWatcher->addPath(path);
+        }
+
+        if (isMachinesFile) {
+            emit(machinesFileChangedSignal());
+        } else {
+            emit(machineConfigChangedSignal(path));
+        }
+    }
+
+    if (!this->m_pendingPaths.isEmpty()) {
+        this->m_debounceTimer->start();
+    }
+}
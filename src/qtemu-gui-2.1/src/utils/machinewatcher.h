@@ -0,0 +1,71 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef MACHINEWATCHER_H
+#define MACHINEWATCHER_H
+
+// Qt
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QFileInfo>
+#include <QTimer>
+#include <QSet>
+#include <QHash>
+#include <QDebug>
+
+class MachineWatcher : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit MachineWatcher(const QString &machinesFilePath,
+                                QObject *parent = nullptr);
+        ~MachineWatcher();
+
+        QString machinesFilePath() const;
+
+        void watchMachine(const QString &configPath);
+        void unwatchMachine(const QString &configPath);
+
+    signals:
+        void machinesFileChangedSignal();
+        void machineConfigChangedSignal(const QString &configPath);
+
+    public slots:
+
+    private slots:
+        void fileChanged(const QString &path);
+        void directoryChanged(const QString &path);
+        void processPendingChanges();
+
+    protected:
+
+    private:
+        QFileSystemWatcher *m_fileSystemWatcher;
+        QTimer *m_debounceTimer;
+
+        QString m_machinesFilePath;
+        QSet<QString> m_watchedConfigs;
+        QSet<QString> m_pendingPaths;
+        QHash<QString, int> m_missingRetries;
+
+};
+
+#endif // MACHINEWATCHER_H
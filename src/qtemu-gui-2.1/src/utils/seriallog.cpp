@@ -0,0 +1,284 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "seriallog.h"
+
+// C++ standard library
+#include <cstring>
+
+static const char SERIAL_LOG_MAGIC[8] = {'Q', 'T', 'E', 'M', 'U', 'S', 'R', 'L'};
+static const quint32 SERIAL_LOG_VERSION = 1;
+
+/**
+ * @brief Circular serial log
+ * @param filePath, path of the log file
+ * @param capacity, bytes of serial output retained
+ *
+ * Circular log for the serial console of a machine.
+ * The file never grows over the header plus the capacity
+ */
+SerialLog::SerialLog(const QString &filePath, qint64 capacity)
+{
+    this->m_filePath = filePath;
+    this->m_capacity = qMax<qint64>(capacity, 4096);
+    this->m_map = nullptr;
+    this->m_header = nullptr;
+    this->m_data = nullptr;
+
+    qDebug() << "SerialLog object created";
+}
+
+SerialLog::~SerialLog()
+{
+    this->close();
+
+    qDebug() << "SerialLog object destroyed";
+}
+
+/**
+ * @brief Open the log
+ * @return true if the log is mapped
+ *
+ * Open and map the log file. An existing log with the same
+ * capacity is continued, in other case it's started again
+ */
+bool SerialLog::open()
+{
+    if (this->isOpen()) {
+        return true;
+    }
+
+    qint64 fileSize = static_cast<qint64>(sizeof(Header)) + this->m_capacity;
+
+    this->m_file.setFileName(this->m_filePath);
+    if (!this->m_file.open(QIODevice::ReadWrite)) {
+        qDebug() << "Cannot open the serial log" << this->m_filePath << this->m_file.errorString();
+        return false;
+    }
+
+    bool reuse = this->m_file.size() == fileSize;
+
+    if (!reuse && !this->m_file.resize(fileSize)) {
+        qDebug() << "Cannot resize the serial log" << this->m_filePath << this->m_file.errorString();
+        this->m_file.close();
+        return false;
+    }
+
+    this->m_map = this->m_file.map(0, fileSize);
+    if (this->m_map == nullptr) {
+        qDebug() << "Cannot map the serial log" << this->m_filePath << this->m_file.errorString();
+        this->m_file.close();
+        return false;
+    }
+
+    this->m_header = reinterpret_cast<Header *>(this->m_map);
+    this->m_data = reinterpret_cast<char *>(this->m_map + sizeof(Header));
+
+    if (!reuse || !this->isHeaderValid()) {
+        std::memset(this->m_header, 0, sizeof(Header));
+        std::memcpy(this->m_header->magic, SERIAL_LOG_MAGIC, sizeof(SERIAL_LOG_MAGIC));
+        this->m_header->version = SERIAL_LOG_VERSION;
+        this->m_header->headerSize = sizeof(Header);
+        this->m_header->capacity = static_cast<quint64>(this->m_capacity);
+        this->m_header->written = 0;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Close the log
+ *
+ * Unmap and close the log file
+ */
+void SerialLog::close()
+{
+    if (this->m_map != nullptr) {
+        this->m_file.unmap(this->m_map);
+    }
+
+    this->m_map = nullptr;
+    this->m_header = nullptr;
+    this->m_data = nullptr;
+
+    if (this->m_file.isOpen()) {
+        this->m_file.close();
+    }
+}
+
+/**
+ * @brief Know if the log is open
+ * @return true if the log is mapped
+ *
+ * Know if the log is open
+ */
+bool SerialLog::isOpen() const
+{
+    return this->m_map != nullptr;
+}
+
+/**
+ * @brief Get the path of the log file
+ * @return path of the log file
+ *
+ * Get the path of the log file
+ */
+QString SerialLog::filePath() const
+{
+    return m_filePath;
+}
+
+/**
+ * @brief Get the capacity of the log
+ * @return bytes retained by the log
+ *
+ * Get the capacity of the log
+ */
+qint64 SerialLog::capacity() const
+{
+    return m_capacity;
+}
+
+/**
+ * @brief Get the size of the log
+ * @return bytes stored in the log
+ *
+ * Get the bytes stored in the log, never more than the capacity
+ */
+qint64 SerialLog::size() const
+{
+    if (!this->isOpen()) {
+        return 0;
+    }
+
+    return static_cast<qint64>(qMin<quint64>(this->m_header->written,
+                                             static_cast<quint64>(this->m_capacity)));
+}
+
+/**
+ * @brief Get the total bytes written
+ * @return bytes written since the log was created
+ *
+ * Get the total bytes written, including the overwritten ones
+ */
+quint64 SerialLog::totalWritten() const
+{
+    return this->isOpen() ? this->m_header->written : 0;
+}
+
+/**
+ * @brief Append data to the log
+ * @param data, data to be appended
+ * @param size, size of the data
+ *
+ * Append data to the log overwriting the oldest bytes
+ * when the log is full
+ */
+void SerialLog::append(const char *data, qint64 size)
+{
+    if (!this->isOpen() || size <= 0) {
+        return;
+    }
+
+    quint64 written = this->m_header->written + static_cast<quint64>(size);
+
+    // Only the last capacity bytes are retained
+    if (size > this->m_capacity) {
+        data += size - this->m_capacity;
+        size = this->m_capacity;
+    }
+
+    qint64 position = static_cast<qint64>((written - static_cast<quint64>(size)) %
+                                          static_cast<quint64>(this->m_capacity));
+    qint64 firstSize = qMin(size, this->m_capacity - position);
+
+    std::memcpy(this->m_data + position, data, static_cast<size_t>(firstSize));
+    if (firstSize < size) {
+        std::memcpy(this->m_data, data + firstSize, static_cast<size_t>(size - firstSize));
+    }
+
+    this->m_header->written = written;
+}
+
+/**
+ * @brief Get the log segments
+ * @return oldest and newest segments of the log
+ *
+ * Get the log contents without copying them. The first segment
+ * is followed by the second one, the pointers are valid while
+ * the log is open and nothing is appended
+ */
+SerialLog::Segments SerialLog::segments() const
+{
+    Segments segments = {nullptr, 0, nullptr, 0};
+
+    if (!this->isOpen() || this->m_header->written == 0) {
+        return segments;
+    }
+
+    quint64 capacity = static_cast<quint64>(this->m_capacity);
+    if (this->m_header->written <= capacity) {
+        segments.first = this->m_data;
+        segments.firstSize = static_cast<qint64>(this->m_header->written);
+        return segments;
+    }
+
+    qint64 position = static_cast<qint64>(this->m_header->written % capacity);
+    segments.first = this->m_data + position;
+    segments.firstSize = this->m_capacity - position;
+    segments.second = this->m_data;
+    segments.secondSize = position;
+
+    return segments;
+}
+
+/**
+ * @brief Read all the log
+ * @return contents of the log
+ *
+ * Read all the log, from the oldest to the newest byte
+ */
+QByteArray SerialLog::readAll() const
+{
+    Segments segments = this->segments();
+
+    QByteArray contents;
+    contents.reserve(static_cast<int>(segments.firstSize + segments.secondSize));
+    contents.append(segments.first, static_cast<int>(segments.firstSize));
+    contents.append(segments.second, static_cast<int>(segments.secondSize));
+
+    return contents;
+}
+
+/**
+ * @brief Check the header of the log
+ * @return true if the header matches the log
+ *
+ * Check the header of an existing log
+ */
+bool SerialLog::isHeaderValid() const
+{
+    return std::memcmp(this->m_header->magic, SERIAL_LOG_MAGIC, sizeof(SERIAL_LOG_MAGIC)) == 0 &&
+           this->m_header->version == SERIAL_LOG_VERSION &&
+           this->m_header->headerSize == sizeof(Header) &&
+           this->m_header->capacity == static_cast<quint64>(this->m_capacity);
+}
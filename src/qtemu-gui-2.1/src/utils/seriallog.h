@@ -0,0 +1,84 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef SERIALLOG_H
+#define SERIALLOG_H
+
+// Qt
+#include <QFile>
+#include <QString>
+
+#include <QDebug>
+
+/**
+ * Circular log stored in a memory mapped file.
+ * The file has a fixed size: a header and the data
+ * area, where the oldest bytes are overwritten
+ */
+class SerialLog {
+
+    public:
+        struct Segments {
+            const char *first;
+            qint64 firstSize;
+            const char *second;
+            qint64 secondSize;
+        };
+
+        explicit SerialLog(const QString &filePath, qint64 capacity);
+        ~SerialLog();
+
+        bool open();
+        void close();
+        bool isOpen() const;
+
+        QString filePath() const;
+        qint64 capacity() const;
+        qint64 size() const;
+        quint64 totalWritten() const;
+
+        void append(const char *data, qint64 size);
+        Segments segments() const;
+        QByteArray readAll() const;
+
+    private:
+        struct Header {
+            char magic[8];
+            quint32 version;
+            quint32 headerSize;
+            quint64 capacity;
+            quint64 written;
+            char reserved[32];
+        };
+
+        QString m_filePath;
+        qint64 m_capacity;
+
+        QFile m_file;
+        uchar *m_map;
+        Header *m_header;
+        char *m_data;
+
+        // Methods
+        bool isHeaderValid() const;
+};
+
+#endif // SERIALLOG_H
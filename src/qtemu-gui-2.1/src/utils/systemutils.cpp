@@ -40,6 +40,12 @@ SystemUtils::~SystemUtils()
 void SystemUtils::showMessage(QString title, QString text,
                               QMessageBox::Icon severityLevel)
 {
+    // Without GUI, like the command line mode, the message goes to stderr
+    if (qobject_cast<QApplication *>(QCoreApplication::instance()) == nullptr) {
+        qWarning().noquote() << title + ":" << QString(text).remove(QRegExp("<[^>]*>"));
+        return;
+    }
+
     QMessageBox *qemuImgNotFoundMessageBox = new QMessageBox();
     qemuImgNotFoundMessageBox->setWindowTitle(title);
     qemuImgNotFoundMessageBox->setIcon(severityLevel);
@@ -83,10 +89,13 @@ void SystemUtils::getTotalMemory(int &totalRAM)
 /**
  * @brief Get all the CPU types for x86
  * @param CPUType, combobox to insert all the CPU
+ * @param qemuGlobalObject, QEMU global object with data about QEMU
  *
- * Get all the CPU types for x86
+ * Get all the CPU types for x86.
+ * If the QEMU binary is probed, the CPU types not supported by
+ * the binary are removed and the new ones are added
  */
-void SystemUtils::setCPUTypesx86(QComboBox *CPUType)
+void SystemUtils::setCPUTypesx86(QComboBox *CPUType, QEMU *qemuGlobalObject)
 {
     // Intel among many others...IBM, Texas Instruments, AMD, Cyrix...
     CPUType->addItem("486", QString("486"));
@@ -142,15 +151,42 @@ void SystemUtils::setCPUTypesx86(QComboBox *CPUType)
     CPUType->addItem("Base", QString("base"));
     CPUType->addItem("Host", QString("host"));
     CPUType->addItem("Max",  QString("max"));
+
+    if (qemuGlobalObject == nullptr || !qemuGlobalObject->capabilities()->isProbed()) {
+        return;
+    }
+
+    QEMUCapabilities *capabilities = qemuGlobalObject->capabilities();
+    for (int i = CPUType->count() - 1; i >= 0; --i) {
+        if (!capabilities->hasCPUModel(CPUType->itemData(i).toString())) {
+            CPUType->removeItem(i);
+        }
+    }
+
+    QMap<QString, QString> CPUModels = capabilities->CPUModels();
+    QMapIterator<QString, QString> CPUIterator(CPUModels);
+    while (CPUIterator.hasNext()) {
+        CPUIterator.next();
+        if (CPUType->findData(CPUIterator.key()) == -1) {
+            QString CPULabel = CPUIterator.value();
+            if (CPULabel.isEmpty() || CPULabel.startsWith("(")) {
+                CPULabel = CPUIterator.key();
+            }
+            CPUType->addItem(CPULabel, CPUIterator.key());
+        }
+    }
 }
 
 /**
  * @brief Get all the GPU cards
  * @param GPUType, combobox to insert all the GPU
+ * @param qemuGlobalObject, QEMU global object with data about QEMU
  *
- * Get all the GPU cards
+ * Get all the GPU cards.
+ * If the QEMU binary is probed, only the GPU cards
+ * supported by the binary are inserted
  */
-void SystemUtils::setGPUTypes(QComboBox *GPUType)
+void SystemUtils::setGPUTypes(QComboBox *GPUType, QEMU *qemuGlobalObject)
 {
     GPUType->addItem("None",                         QString("none"));
     GPUType->addItem("Standard VGA(VESA 2.0)",       QString("std"));
@@ -161,6 +197,29 @@ void SystemUtils::setGPUTypes(QComboBox *GPUType)
     GPUType->addItem("Sun Cgthree Framebuffer",      QString("cg3"));
     GPUType->addItem("Virtio VGA Card",              QString("virtio"));
     GPUType->addItem("Xen Framebuffer",              QString("xenfb"));
+
+    if (qemuGlobalObject == nullptr || !qemuGlobalObject->capabilities()->isProbed()) {
+        return;
+    }
+
+    // Device that QEMU uses for every -vga option
+    QHash<QString, QString> GPUDevices;
+    GPUDevices.insert("std",    "VGA");
+    GPUDevices.insert("cirrus", "cirrus-vga");
+    GPUDevices.insert("vmware", "vmware-svga");
+    GPUDevices.insert("qxl",    "qxl-vga");
+    GPUDevices.insert("tcx",    "SUNW,tcx");
+    GPUDevices.insert("cg3",    "cgthree");
+    GPUDevices.insert("virtio", "virtio-vga");
+    GPUDevices.insert("xenfb",  "xenfb");
+
+    for (int i = GPUType->count() - 1; i >= 0; --i) {
+        QString GPU = GPUType->itemData(i).toString();
+        if (GPUDevices.contains(GPU) &&
+            !qemuGlobalObject->capabilities()->hasDevice(GPUDevices.value(GPU))) {
+            GPUType->removeItem(i);
+        }
+    }
 }
 
 /**
@@ -208,11 +267,14 @@ void SystemUtils::setKeyboardLayout(QComboBox *keyboardLayout)
 
 /**
  * @brief Get all the audio cards
+ * @param qemuGlobalObject, QEMU global object with data about QEMU
  * @return hash with all the audio cards
  *
- * Get all the audio cards
+ * Get all the audio cards.
+ * If the QEMU binary is probed, only the audio cards
+ * supported by the binary are returned
  */
-QHash<QString, QString> SystemUtils::getSoundCards()
+QHash<QString, QString> SystemUtils::getSoundCards(QEMU *qemuGlobalObject)
 {
     QHash<QString, QString> soundCardsHash;
     soundCardsHash.insert("sb16", "Creative Sound Blaster 16");
@@ -224,16 +286,42 @@ QHash<QString, QString> SystemUtils::getSoundCards()
     soundCardsHash.insert("cs4231a", "CS4231A");
     soundCardsHash.insert("pcspk", "PC Speaker");
 
+    if (qemuGlobalObject == nullptr || !qemuGlobalObject->capabilities()->isProbed()) {
+        return soundCardsHash;
+    }
+
+    // Device that QEMU uses for every -soundhw option
+    QHash<QString, QString> soundDevices;
+    soundDevices.insert("sb16",    "sb16");
+    soundDevices.insert("ac97",    "AC97");
+    soundDevices.insert("gus",     "gus");
+    soundDevices.insert("hda",     "intel-hda");
+    soundDevices.insert("es1370",  "ES1370");
+    soundDevices.insert("adlib",   "adlib");
+    soundDevices.insert("cs4231a", "cs4231a");
+
+    QMutableHashIterator<QString, QString> soundCardsIterator(soundCardsHash);
+    while (soundCardsIterator.hasNext()) {
+        soundCardsIterator.next();
+        QString soundDevice = soundDevices.value(soundCardsIterator.key());
+        if (!soundDevice.isEmpty() && !qemuGlobalObject->capabilities()->hasDevice(soundDevice)) {
+            soundCardsIterator.remove();
+        }
+    }
+
     return soundCardsHash;
 }
 
 /**
  * @brief Get all the accelerators
+ * @param qemuGlobalObject, QEMU global object with data about QEMU
  * @return hash with the accelerators
  *
- * Get all the accelerators
+ * Get all the accelerators.
+ * If the QEMU binary is probed, only the accelerators
+ * supported by the binary are returned
  */
-QHash<QString, QString> SystemUtils::getAccelerators()
+QHash<QString, QString> SystemUtils::getAccelerators(QEMU *qemuGlobalObject)
 {
     QHash<QString, QString> acceleratorsHash;
 #ifdef Q_OS_LINUX
@@ -245,6 +333,18 @@ QHash<QString, QString> SystemUtils::getAccelerators()
     acceleratorsHash.insert("hax", "Hardware Accelerated Execution Manager (HAXM)");
 #endif
 
+    if (qemuGlobalObject == nullptr || !qemuGlobalObject->capabilities()->isProbed()) {
+        return acceleratorsHash;
+    }
+
+    QMutableHashIterator<QString, QString> acceleratorsIterator(acceleratorsHash);
+    while (acceleratorsIterator.hasNext()) {
+        acceleratorsIterator.next();
+        if (!qemuGlobalObject->capabilities()->hasAccelerator(acceleratorsIterator.key())) {
+            acceleratorsIterator.remove();
+        }
+    }
+
     return acceleratorsHash;
 }
 
@@ -31,6 +31,7 @@
 #include <QJsonArray>
 #include <QProcess>
 #include <QMessageBox>
+#include <QApplication>
 #include <QSettings>
 
 #include <QDebug>
@@ -65,11 +66,11 @@ class SystemUtils {
 
         static void getTotalMemory(int &totalRAM);
 
-        static void setCPUTypesx86(QComboBox *CPUType);
-        static void setGPUTypes(QComboBox *GPUType);
+        static void setCPUTypesx86(QComboBox *CPUType, QEMU *qemuGlobalObject = nullptr);
+        static void setGPUTypes(QComboBox *GPUType, QEMU *qemuGlobalObject = nullptr);
         static void setKeyboardLayout(QComboBox *keyboardLayout);
-        static QHash<QString, QString> getSoundCards();
-        static QHash<QString, QString> getAccelerators();
+        static QHash<QString, QString> getSoundCards(QEMU *qemuGlobalObject = nullptr);
+        static QHash<QString, QString> getAccelerators(QEMU *qemuGlobalObject = nullptr);
         static QMap<QString, QString> getMediaDevices();
 
         static QString getOsIcon(const QString &osVersion);
@@ -0,0 +1,205 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+// Local
+#include "tracer.h"
+
+bool Tracer::m_enabled = false;
+QElapsedTimer Tracer::m_timer;
+QMutex Tracer::m_eventsMutex;
+QVector<Tracer::TraceEvent> Tracer::m_events;
+
+/**
+ * @brief Start the tracer
+ *
+ * Start the tracer. From this moment the ScopedTrace
+ * objects record their events
+ */
+void Tracer::start()
+{
+    QMutexLocker locker(&m_eventsMutex);
+
+    m_events.clear();
+    m_events.reserve(256);
+    m_timer.start();
+    m_enabled = true;
+}
+
+/**
+ * @brief Know if the tracer is started
+ * @return true if the tracer is started
+ *
+ * Know if the tracer is started
+ */
+bool Tracer::isEnabled()
+{
+    return m_enabled;
+}
+
+/**
+ * @brief Get the time since the tracer was started
+ * @return microseconds since the tracer was started
+ *
+ * Get the time since the tracer was started
+ */
+qint64 Tracer::now()
+{
+    return m_timer.nsecsElapsed() / 1000;
+}
+
+/**
+ * @brief Add a complete event
+ * @param name, name of the event
+ * @param category, category of the event
+ * @param start, start of the event in microseconds
+ * @param duration, duration of the event in microseconds
+ *
+ * Add an event with a duration to the trace
+ */
+void Tracer::addCompleteEvent(const char *name, const char *category,
+                              qint64 start, qint64 duration)
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    TraceEvent event = {name, category, 'X', start, duration,
+                        reinterpret_cast<quintptr>(QThread::currentThreadId())};
+
+    QMutexLocker locker(&m_eventsMutex);
+    m_events.append(event);
+}
+
+/**
+ * @brief Add an instant event
+ * @param name, name of the event
+ * @param category, category of the event
+ *
+ * Add an event without duration to the trace
+ */
+void Tracer::addInstantEvent(const char *name, const char *category)
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    TraceEvent event = {name, category, 'i', now(), 0,
+                        reinterpret_cast<quintptr>(QThread::currentThreadId())};
+
+    QMutexLocker locker(&m_eventsMutex);
+    m_events.append(event);
+}
+
+/**
+ * @brief Save the trace
+ * @param traceFilePath, path of the trace file
+ * @return true if the trace is saved
+ *
+ * Save the trace in the Chrome trace event format.
+ * The file can be opened with chrome://tracing or Perfetto
+ */
+bool Tracer::save(const QString &traceFilePath)
+{
+    QMutexLocker locker(&m_eventsMutex);
+
+    qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+
+    QJsonObject processNameArgs;
+    processNameArgs["name"] = "QtEmu";
+
+    QJsonObject processNameEvent;
+    processNameEvent["name"] = "process_name";
+    processNameEvent["ph"] = "M";
+    processNameEvent["pid"] = pid;
+    processNameEvent["args"] = processNameArgs;
+    traceEvents.append(processNameEvent);
+
+    // Chrome expects small thread ids
+    QVector<quintptr> threadIds;
+
+    foreach (const TraceEvent &event, m_events) {
+        int tid = threadIds.indexOf(event.threadId);
+        if (tid < 0) {
+            threadIds.append(event.threadId);
+            tid = threadIds.size() - 1;
+        }
+
+        QJsonObject eventObject;
+        eventObject["name"] = QString::fromUtf8(event.name);
+        eventObject["cat"] = QString::fromUtf8(event.category);
+        eventObject["ph"] = QString(QChar(event.phase));
+        eventObject["ts"] = event.start;
+        eventObject["pid"] = pid;
+        eventObject["tid"] = tid;
+
+        if (event.phase == 'X') {
+            eventObject["dur"] = event.duration;
+        } else {
+            eventObject["s"] = "p";
+        }
+
+        traceEvents.append(eventObject);
+    }
+
+    QJsonObject traceObject;
+    traceObject["traceEvents"] = traceEvents;
+    traceObject["displayTimeUnit"] = "ms";
+
+    QFile traceFile(traceFilePath);
+    if (!traceFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        qDebug() << "Cannot write the trace" << traceFilePath;
+        return false;
+    }
+
+    traceFile.write(QJsonDocument(traceObject).toJson(QJsonDocument::Compact));
+    traceFile.close();
+
+    qDebug() << "Trace saved in" << traceFilePath << "with" << m_events.size() << "events";
+
+    return true;
+}
+
+/**
+ * @brief Scoped trace
+ * @param name, name of the event
+ * @param category, category of the event
+ *
+ * Record the time between the creation and the destruction
+ * of the object as a complete event
+ */
+ScopedTrace::ScopedTrace(const char *name, const char *category)
+{
+    this->m_name = name;
+    this->m_category = category;
+    this->m_start = Tracer::isEnabled() ? Tracer::now() : -1;
+}
+
+ScopedTrace::~ScopedTrace()
+{
+    if (this->m_start < 0) {
+        return;
+    }
+
+    Tracer::addCompleteEvent(this->m_name, this->m_category,
+                             this->m_start, Tracer::now() - this->m_start);
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TRACER_H
+#define TRACER_H
+
+// Qt
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QFile>
+#include <QVector>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <QDebug>
+
+class Tracer {
+
+    public:
+        static void start();
+        static bool isEnabled();
+        static qint64 now();
+
+        static void addCompleteEvent(const char *name, const char *category,
+                                     qint64 start, qint64 duration);
+        static void addInstantEvent(const char *name, const char *category = "qtemu");
+
+        static bool save(const QString &traceFilePath);
+
+    protected:
+
+    private:
+        struct TraceEvent {
+            const char *name;
+            const char *category;
+            char phase;
+            qint64 start;
+            qint64 duration;
+            quintptr threadId;
+        };
+
+        static bool m_enabled;
+        static QElapsedTimer m_timer;
+        static QMutex m_eventsMutex;
+        static QVector<TraceEvent> m_events;
+};
+
+/**
+ * Trace the time spent in a scope.
+ * It does nothing if the tracer isn't started.
+ * The name and the category must be string literals
+ */
+class ScopedTrace {
+
+    public:
+        explicit ScopedTrace(const char *name, const char *category = "qtemu");
+        ~ScopedTrace();
+
+    private:
+        const char *m_name;
+        const char *m_category;
+        qint64 m_start;
+};
+
+#define QTEMU_TRACE_CONCAT_(a, b) a##b
+#define QTEMU_TRACE_CONCAT(a, b) QTEMU_TRACE_CONCAT_(a, b)
+#define QTEMU_TRACE_SCOPE(name) ScopedTrace QTEMU_TRACE_CONCAT(qtemuTraceScope, __LINE__)(name)
+
+#endif // TRACER_H
@@ -0,0 +1,1307 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "vncclient.h"
+
+// C++ standard library
+#include <algorithm>
+#include <cstring>
+
+// Attempts to connect while QEMU creates the socket
+static const int MAX_CONNECT_ATTEMPTS = 50;
+
+// Largest block of data accepted in a message
+static const quint32 MAX_DATA_SIZE = 64 * 1024 * 1024;
+
+// Output grown in every inflate call
+static const int INFLATE_CHUNK_SIZE = 64 * 1024;
+
+// Security types
+static const quint8 SECURITY_NONE = 1;
+
+// Client messages
+static const quint8 SET_PIXEL_FORMAT = 0;
+static const quint8 SET_ENCODINGS = 2;
+static const quint8 FRAMEBUFFER_UPDATE_REQUEST = 3;
+static const quint8 KEY_EVENT = 4;
+static const quint8 POINTER_EVENT = 5;
+
+// Server messages
+static const quint8 FRAMEBUFFER_UPDATE = 0;
+static const quint8 SET_COLOUR_MAP_ENTRIES = 1;
+static const quint8 BELL = 2;
+static const quint8 SERVER_CUT_TEXT = 3;
+
+// Encodings and pseudo-encodings
+static const qint32 RAW = 0;
+static const qint32 COPY_RECT = 1;
+static const qint32 TIGHT = 7;
+static const qint32 ZRLE = 16;
+static const qint32 DESKTOP_SIZE = -223;
+static const qint32 TIGHT_COMPRESS_LEVEL_1 = -255;
+
+/**
+ * @brief VNC client
+ * @param parent, parent object
+ *
+ * Client of the remote framebuffer protocol for the
+ * display of a machine. The server sends only the damaged
+ * rectangles, encoded with Tight or ZRLE, and the client
+ * asks for the next update while it's active
+ */
+VNCClient::VNCClient(QObject *parent) : QObject(parent)
+{
+    this->m_connectAttempts = 0;
+    this->m_state = Disconnected;
+    this->m_offset = 0;
+    this->m_active = false;
+    this->m_updateRequested = false;
+    this->m_framebufferValid = false;
+    this->m_pendingRectangles = 0;
+    this->m_rectangleRead = false;
+
+    this->initStreams();
+
+    this->m_vncSocket = new QLocalSocket(this);
+    connect(m_vncSocket, &QLocalSocket::connected,
+            this, &VNCClient::socketConnected);
+    connect(m_vncSocket, &QLocalSocket::readyRead,
+            this, &VNCClient::readMessages);
+    connect(m_vncSocket, &QLocalSocket::disconnected,
+            this, &VNCClient::socketDisconnected);
+
+    this->m_connectTimer = new QTimer(this);
+    this->m_connectTimer->setInterval(100);
+    this->m_connectTimer->setSingleShot(true);
+    connect(m_connectTimer, &QTimer::timeout,
+            this, &VNCClient::tryConnect);
+
+    qDebug() << "VNCClient object created";
+}
+
+VNCClient::~VNCClient()
+{
+    this->m_vncSocket->disconnect(this);
+    this->m_vncSocket->abort();
+    this->endStreams();
+
+    qDebug() << "VNCClient object destroyed";
+}
+
+/**
+ * @brief Know if the client is connected
+ * @return true if the handshake is finished
+ *
+ * Know if the client receives the framebuffer
+ */
+bool VNCClient::isConnected() const
+{
+    return this->m_state == Normal;
+}
+
+/**
+ * @brief Get the server name
+ * @return local socket of the server
+ *
+ * Get the local socket of the server
+ */
+QString VNCClient::serverName() const
+{
+    return this->m_serverName;
+}
+
+/**
+ * @brief Get the desktop name
+ * @return name sent by the server
+ *
+ * Get the name of the desktop sent by the server
+ */
+QString VNCClient::desktopName() const
+{
+    return this->m_desktopName;
+}
+
+/**
+ * @brief Get the framebuffer
+ * @return image with the display of the machine
+ *
+ * Get the framebuffer, updated with the damaged rectangles
+ */
+const QImage &VNCClient::framebuffer() const
+{
+    return this->m_framebuffer;
+}
+
+/**
+ * @brief Connect to a server
+ * @param serverName, local socket of the server
+ *
+ * Connect to the VNC server, retried until QEMU creates
+ * the socket. connectedSignal is emitted after the handshake
+ */
+void VNCClient::connectToServer(const QString &serverName)
+{
+    if (serverName == this->m_serverName &&
+        this->m_vncSocket->state() != QLocalSocket::UnconnectedState) {
+        return;
+    }
+
+    this->disconnectFromServer();
+
+    this->m_serverName = serverName;
+    this->m_connectAttempts = 0;
+    this->tryConnect();
+}
+
+/**
+ * @brief Disconnect from the server
+ *
+ * Disconnect from the VNC server
+ */
+void VNCClient::disconnectFromServer()
+{
+    this->m_connectTimer->stop();
+    this->m_vncSocket->abort();
+    this->socketDisconnected();
+}
+
+/**
+ * @brief Set if the client is active
+ * @param active, true to receive the updates
+ *
+ * An inactive client doesn't ask for the next update,
+ * so QEMU doesn't encode the display. The damage is
+ * kept by QEMU and sent when the client is active again
+ */
+void VNCClient::setActive(bool active)
+{
+    this->m_active = active;
+
+    if (active && this->m_state == Normal && !this->m_updateRequested) {
+        this->requestUpdate();
+    }
+}
+
+/**
+ * @brief Send a pointer event
+ * @param x, horizontal position in the framebuffer
+ * @param y, vertical position in the framebuffer
+ * @param buttonMask, pressed buttons, bit 0 is the left button
+ *
+ * Send the position and the buttons of the pointer
+ */
+void VNCClient::sendPointerEvent(int x, int y, quint8 buttonMask)
+{
+    if (this->m_state != Normal) {
+        return;
+    }
+
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream << POINTER_EVENT << buttonMask
+           << static_cast<quint16>(qBound(0, x, this->m_framebuffer.width() - 1))
+           << static_cast<quint16>(qBound(0, y, this->m_framebuffer.height() - 1));
+
+    this->m_vncSocket->write(message);
+}
+
+/**
+ * @brief Send a key event
+ * @param keysym, X11 keysym of the key
+ * @param down, true if the key is pressed
+ *
+ * Send a key press or release
+ */
+void VNCClient::sendKeyEvent(quint32 keysym, bool down)
+{
+    if (this->m_state != Normal) {
+        return;
+    }
+
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream << KEY_EVENT << static_cast<quint8>(down ? 1 : 0) << quint16(0) << keysym;
+
+    this->m_vncSocket->write(message);
+}
+
+/**
+ * @brief Try to connect
+ *
+ * Try to connect to the VNC socket, retried until QEMU creates it
+ */
+void VNCClient::tryConnect()
+{
+    if (this->m_vncSocket->state() != QLocalSocket::UnconnectedState) {
+        return;
+    }
+
+    this->m_vncSocket->connectToServer(this->m_serverName);
+
+    if (this->m_vncSocket->waitForConnected(0) ||
+        this->m_vncSocket->state() == QLocalSocket::ConnectedState) {
+        return;
+    }
+
+    this->m_vncSocket->abort();
+
+    if (++this->m_connectAttempts >= MAX_CONNECT_ATTEMPTS) {
+        qDebug() << "Cannot connect to VNC" << this->m_serverName;
+        return;
+    }
+
+    this->m_connectTimer->start();
+}
+
+/**
+ * @brief Socket connected
+ *
+ * Wait for the protocol version of the server
+ */
+void VNCClient::socketConnected()
+{
+    this->m_buffer.clear();
+    this->m_offset = 0;
+    this->m_pendingRectangles = 0;
+    this->m_rectangleRead = false;
+    this->m_updateRequested = false;
+    this->m_framebufferValid = false;
+
+    // Every connection begins new zlib streams
+    this->endStreams();
+    this->initStreams();
+
+    this->m_state = ProtocolVersion;
+}
+
+/**
+ * @brief Read the messages
+ *
+ * Process the messages of the server. The incomplete
+ * messages are kept until the rest of the data arrives
+ */
+void VNCClient::readMessages()
+{
+    this->m_buffer.append(this->m_vncSocket->readAll());
+
+    bool processed = true;
+    while (processed && this->m_state != Disconnected) {
+        if (this->m_state == Normal) {
+            processed = this->processMessage();
+        } else {
+            processed = this->processHandshake();
+        }
+    }
+
+    this->m_buffer.remove(0, this->m_offset);
+    this->m_offset = 0;
+}
+
+/**
+ * @brief Socket disconnected
+ *
+ * Notify the disconnection
+ */
+void VNCClient::socketDisconnected()
+{
+    bool wasConnected = this->m_state == Normal;
+
+    this->m_state = Disconnected;
+    this->m_buffer.clear();
+    this->m_offset = 0;
+    this->m_pendingRectangles = 0;
+    this->m_rectangleRead = false;
+    this->m_updateRequested = false;
+    this->m_damage = QRegion();
+
+    if (wasConnected) {
+        qDebug() << "VNC disconnected" << this->m_serverName;
+        emit disconnectedSignal();
+    }
+}
+
+/**
+ * @brief Know if the data is available
+ * @param size, bytes needed
+ * @return true if the buffer has the bytes
+ *
+ * Know if the buffer has the bytes after the current position
+ */
+bool VNCClient::available(qint64 size) const
+{
+    return this->m_buffer.size() - this->m_offset >= size;
+}
+
+/**
+ * @brief Peek an unsigned integer
+ * @param position, position in the buffer
+ * @return big endian value at the position
+ *
+ * Read a value without consuming it
+ */
+quint8 VNCClient::peekU8(int position) const
+{
+    return static_cast<quint8>(this->m_buffer.at(position));
+}
+
+quint16 VNCClient::peekU16(int position) const
+{
+    return static_cast<quint16>(this->peekU8(position) << 8 | this->peekU8(position + 1));
+}
+
+quint32 VNCClient::peekU32(int position) const
+{
+    return static_cast<quint32>(this->peekU16(position)) << 16 | this->peekU16(position + 2);
+}
+
+/**
+ * @brief Peek a compact length of Tight
+ * @param position, position of the length in the buffer
+ * @param length, variable to store the length
+ * @param size, variable to store the bytes of the length
+ * @return false if the length isn't complete
+ *
+ * The length uses 7 bits of every byte, up to 3 bytes
+ */
+bool VNCClient::peekCompactLength(int position, int *length, int *size) const
+{
+    *length = 0;
+
+    for (int i = 0; i < 3; ++i) {
+        if (position + i >= this->m_buffer.size()) {
+            return false;
+        }
+
+        quint8 byte = this->peekU8(position + i);
+        *length |= (i < 2 ? (byte & 0x7f) : byte) << (7 * i);
+        *size = i + 1;
+
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Process the handshake
+ * @return false if more data is needed
+ *
+ * Negotiate the protocol version and the security, then
+ * receive the size of the framebuffer
+ */
+bool VNCClient::processHandshake()
+{
+    switch (this->m_state) {
+        case ProtocolVersion: {
+            if (!this->available(12)) {
+                return false;
+            }
+
+            QByteArray version = this->m_buffer.mid(this->m_offset, 12);
+            this->m_offset += 12;
+
+            if (!version.startsWith("RFB ")) {
+                this->protocolError("Invalid protocol version");
+                return false;
+            }
+
+            // The 3.3 version has no list of security types
+            if (version.mid(8, 3).toInt() >= 8) {
+                this->m_vncSocket->write("RFB 003.008\n");
+                this->m_state = SecurityTypes;
+            } else {
+                this->m_vncSocket->write("RFB 003.003\n");
+                this->m_state = SecurityType;
+            }
+            return true;
+        }
+        case SecurityTypes: {
+            if (!this->available(1)) {
+                return false;
+            }
+
+            int count = this->peekU8(this->m_offset);
+            if (count == 0) {
+                if (!this->available(5)) {
+                    return false;
+                }
+                quint32 length = this->peekU32(this->m_offset + 1);
+                if (length > MAX_DATA_SIZE || !this->available(5 + static_cast<qint64>(length))) {
+                    return false;
+                }
+                this->protocolError(QString::fromUtf8(this->m_buffer.mid(this->m_offset + 5,
+                                                                         static_cast<int>(length))));
+                return false;
+            }
+
+            if (!this->available(1 + count)) {
+                return false;
+            }
+
+            bool securityNone = false;
+            for (int i = 1; i <= count; ++i) {
+                if (this->peekU8(this->m_offset + i) == SECURITY_NONE) {
+                    securityNone = true;
+                }
+            }
+            this->m_offset += 1 + count;
+
+            if (!securityNone) {
+                this->protocolError("The server needs authentication");
+                return false;
+            }
+
+            this->m_vncSocket->write(QByteArray(1, static_cast<char>(SECURITY_NONE)));
+            this->m_state = SecurityResult;
+            return true;
+        }
+        case SecurityType: {
+            if (!this->available(4)) {
+                return false;
+            }
+
+            quint32 securityType = this->peekU32(this->m_offset);
+            this->m_offset += 4;
+
+            if (securityType != SECURITY_NONE) {
+                this->protocolError("The server needs authentication");
+                return false;
+            }
+
+            // Shared connection, other clients are kept
+            this->m_vncSocket->write(QByteArray(1, 1));
+            this->m_state = ServerInit;
+            return true;
+        }
+        case SecurityResult: {
+            if (!this->available(4)) {
+                return false;
+            }
+
+            if (this->peekU32(this->m_offset) != 0) {
+                this->protocolError("The server refused the connection");
+                return false;
+            }
+            this->m_offset += 4;
+
+            // Shared connection, other clients are kept
+            this->m_vncSocket->write(QByteArray(1, 1));
+            this->m_state = ServerInit;
+            return true;
+        }
+        case ServerInit: {
+            if (!this->available(24)) {
+                return false;
+            }
+
+            quint32 nameLength = this->peekU32(this->m_offset + 20);
+            if (nameLength > MAX_DATA_SIZE) {
+                this->protocolError("Invalid desktop name");
+                return false;
+            }
+            if (!this->available(24 + static_cast<qint64>(nameLength))) {
+                return false;
+            }
+
+            int width = this->peekU16(this->m_offset);
+            int height = this->peekU16(this->m_offset + 2);
+            this->m_desktopName = QString::fromUtf8(this->m_buffer.mid(this->m_offset + 24,
+                                                                       static_cast<int>(nameLength)));
+            this->m_offset += 24 + static_cast<int>(nameLength);
+
+            this->sendSetup();
+            this->m_state = Normal;
+            this->resizeFramebuffer(width, height);
+
+            qDebug() << "VNC connected" << this->m_serverName;
+            emit connectedSignal();
+
+            if (this->m_active) {
+                this->requestUpdate();
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Process a message
+ * @return false if more data is needed
+ *
+ * Process the framebuffer updates. The rectangles of
+ * an update are decoded one by one as they arrive
+ */
+bool VNCClient::processMessage()
+{
+    if (this->m_pendingRectangles > 0) {
+        return this->processRectangle();
+    }
+
+    if (!this->available(1)) {
+        return false;
+    }
+
+    quint8 messageType = this->peekU8(this->m_offset);
+    switch (messageType) {
+        case FRAMEBUFFER_UPDATE:
+            if (!this->available(4)) {
+                return false;
+            }
+            this->m_pendingRectangles = this->peekU16(this->m_offset + 2);
+            this->m_rectangleRead = false;
+            this->m_offset += 4;
+
+            if (this->m_pendingRectangles == 0) {
+                this->finishUpdate();
+            }
+            return true;
+        case SET_COLOUR_MAP_ENTRIES: {
+            if (!this->available(6)) {
+                return false;
+            }
+            int size = 6 + this->peekU16(this->m_offset + 4) * 6;
+            if (!this->available(size)) {
+                return false;
+            }
+            this->m_offset += size;
+            return true;
+        }
+        case BELL:
+            this->m_offset += 1;
+            return true;
+        case SERVER_CUT_TEXT: {
+            if (!this->available(8)) {
+                return false;
+            }
+            quint32 length = this->peekU32(this->m_offset + 4);
+            if (length > MAX_DATA_SIZE) {
+                this->protocolError("Invalid cut text");
+                return false;
+            }
+            if (!this->available(8 + static_cast<qint64>(length))) {
+                return false;
+            }
+            this->m_offset += 8 + static_cast<int>(length);
+            return true;
+        }
+        default:
+            this->protocolError(QString("Unknown message %1").arg(messageType));
+            return false;
+    }
+}
+
+/**
+ * @brief Process a rectangle
+ * @return false if more data is needed
+ *
+ * Decode a rectangle into the framebuffer and add it to the damage
+ */
+bool VNCClient::processRectangle()
+{
+    if (!this->m_rectangleRead) {
+        if (!this->available(12)) {
+            return false;
+        }
+
+        this->m_rectangle.x = this->peekU16(this->m_offset);
+        this->m_rectangle.y = this->peekU16(this->m_offset + 2);
+        this->m_rectangle.width = this->peekU16(this->m_offset + 4);
+        this->m_rectangle.height = this->peekU16(this->m_offset + 6);
+        this->m_rectangle.encoding = static_cast<qint32>(this->peekU32(this->m_offset + 8));
+        this->m_offset += 12;
+        this->m_rectangleRead = true;
+
+        if (this->m_rectangle.encoding != DESKTOP_SIZE &&
+            (this->m_rectangle.x + this->m_rectangle.width > this->m_framebuffer.width() ||
+             this->m_rectangle.y + this->m_rectangle.height > this->m_framebuffer.height())) {
+            this->protocolError("Rectangle out of the framebuffer");
+            return false;
+        }
+    }
+
+    bool decoded = false;
+    switch (this->m_rectangle.encoding) {
+        case RAW:
+            if (!this->available(static_cast<qint64>(this->m_rectangle.width) * this->m_rectangle.height * 4)) {
+                return false;
+            }
+            decoded = this->decodeRaw();
+            break;
+        case COPY_RECT:
+            if (!this->available(4)) {
+                return false;
+            }
+            decoded = this->decodeCopyRect();
+            break;
+        case ZRLE: {
+            if (!this->available(4)) {
+                return false;
+            }
+            quint32 length = this->peekU32(this->m_offset);
+            if (length > MAX_DATA_SIZE) {
+                this->protocolError("Invalid ZRLE data");
+                return false;
+            }
+            if (!this->available(4 + static_cast<qint64>(length))) {
+                return false;
+            }
+            decoded = this->decodeZRLE(static_cast<int>(length));
+            break;
+        }
+        case TIGHT: {
+            int size = 0;
+            if (!this->tightSize(&size)) {
+                return false;
+            }
+            decoded = this->decodeTight(size);
+            break;
+        }
+        case DESKTOP_SIZE:
+            this->resizeFramebuffer(this->m_rectangle.width, this->m_rectangle.height);
+            decoded = true;
+            break;
+        default:
+            this->protocolError(QString("Unknown encoding %1").arg(this->m_rectangle.encoding));
+            return false;
+    }
+
+    if (!decoded) {
+        this->protocolError(QString("Invalid data of the encoding %1").arg(this->m_rectangle.encoding));
+        return false;
+    }
+
+    if (this->m_rectangle.encoding != DESKTOP_SIZE) {
+        this->m_damage += QRect(this->m_rectangle.x, this->m_rectangle.y,
+                                this->m_rectangle.width, this->m_rectangle.height);
+    }
+
+    this->m_rectangleRead = false;
+    if (--this->m_pendingRectangles == 0) {
+        this->finishUpdate();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Finish an update
+ *
+ * Notify the damaged region and ask for the next update
+ * if the client is active
+ */
+void VNCClient::finishUpdate()
+{
+    this->m_updateRequested = false;
+
+    if (!this->m_damage.isEmpty()) {
+        emit framebufferUpdatedSignal(this->m_damage);
+        this->m_damage = QRegion();
+    }
+
+    if (this->m_active && this->m_state == Normal) {
+        this->requestUpdate();
+    }
+}
+
+/**
+ * @brief Ask for an update
+ *
+ * Ask for the changes of the framebuffer. QEMU answers
+ * the incremental requests when the display changes
+ */
+void VNCClient::requestUpdate()
+{
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream << FRAMEBUFFER_UPDATE_REQUEST
+           << static_cast<quint8>(this->m_framebufferValid ? 1 : 0)
+           << quint16(0) << quint16(0)
+           << static_cast<quint16>(this->m_framebuffer.width())
+           << static_cast<quint16>(this->m_framebuffer.height());
+
+    this->m_vncSocket->write(message);
+
+    this->m_framebufferValid = true;
+    this->m_updateRequested = true;
+}
+
+/**
+ * @brief Send the setup of the client
+ *
+ * Ask for 32 bits true colour pixels and the
+ * encodings, Tight and ZRLE preferred
+ */
+void VNCClient::sendSetup()
+{
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+
+    // Little endian 0x00RRGGBB, the layout of QImage::Format_RGB32
+    stream << SET_PIXEL_FORMAT << quint8(0) << quint16(0)
+           << quint8(32) << quint8(24) << quint8(0) << quint8(1)
+           << quint16(255) << quint16(255) << quint16(255)
+           << quint8(16) << quint8(8) << quint8(0)
+           << quint8(0) << quint16(0);
+
+    // The socket is local, a fast compression saves CPU in the host
+    QList<qint32> encodings;
+    encodings << TIGHT << ZRLE << COPY_RECT << RAW << DESKTOP_SIZE << TIGHT_COMPRESS_LEVEL_1;
+
+    stream << SET_ENCODINGS << quint8(0) << static_cast<quint16>(encodings.size());
+    for (int i = 0; i < encodings.size(); ++i) {
+        stream << encodings.at(i);
+    }
+
+    this->m_vncSocket->write(message);
+}
+
+/**
+ * @brief Protocol error
+ * @param error, description of the error
+ *
+ * Disconnect from the server after an error
+ */
+void VNCClient::protocolError(const QString &error)
+{
+    qDebug() << "VNC error" << this->m_serverName << error;
+
+    this->disconnectFromServer();
+}
+
+/**
+ * @brief Get the size of a Tight rectangle
+ * @param size, variable to store the bytes of the rectangle, -1 if invalid
+ * @return false if more data is needed to know the size
+ *
+ * Get the size of a Tight rectangle before decoding it,
+ * the zlib streams can't decode a rectangle twice
+ */
+bool VNCClient::tightSize(int *size) const
+{
+    if (!this->available(1)) {
+        return false;
+    }
+
+    int position = this->m_offset;
+    quint8 control = this->peekU8(position++);
+    int compression = control >> 4;
+    int length = 0;
+    int lengthSize = 0;
+
+    // Fill, one pixel
+    if (compression == 0x08) {
+        *size = 4;
+        return this->available(*size);
+    }
+
+    // JPEG
+    if (compression == 0x09) {
+        if (!this->peekCompactLength(position, &length, &lengthSize)) {
+            return false;
+        }
+        *size = 1 + lengthSize + length;
+        return this->available(*size);
+    }
+
+    if (compression > 0x09) {
+        *size = -1;
+        return true;
+    }
+
+    // Basic compression, with an optional filter
+    int rowSize = this->m_rectangle.width * 3;
+    if (control & 0x40) {
+        if (!this->available(position - this->m_offset + 1)) {
+            return false;
+        }
+
+        quint8 filter = this->peekU8(position++);
+        if (filter == 1) {
+            if (!this->available(position - this->m_offset + 1)) {
+                return false;
+            }
+            int colors = this->peekU8(position++) + 1;
+            position += colors * 3;
+            rowSize = colors == 2 ? (this->m_rectangle.width + 7) / 8 : this->m_rectangle.width;
+        } else if (filter > 2) {
+            *size = -1;
+            return true;
+        }
+    }
+
+    // The small data isn't compressed
+    int dataSize = rowSize * this->m_rectangle.height;
+    if (dataSize < 12) {
+        *size = position - this->m_offset + dataSize;
+        return this->available(*size);
+    }
+
+    if (!this->peekCompactLength(position, &length, &lengthSize)) {
+        return false;
+    }
+    *size = position - this->m_offset + lengthSize + length;
+
+    return this->available(*size);
+}
+
+/**
+ * @brief Decode a raw rectangle
+ * @return true if the rectangle is decoded
+ *
+ * Copy the pixels into the framebuffer
+ */
+bool VNCClient::decodeRaw()
+{
+    const uchar *data = reinterpret_cast<const uchar *>(this->m_buffer.constData()) + this->m_offset;
+
+    for (int row = 0; row < this->m_rectangle.height; ++row) {
+        QRgb *line = reinterpret_cast<QRgb *>(this->m_framebuffer.scanLine(this->m_rectangle.y + row)) +
+                     this->m_rectangle.x;
+        for (int column = 0; column < this->m_rectangle.width; ++column) {
+            line[column] = qRgb(data[2], data[1], data[0]);
+            data += 4;
+        }
+    }
+
+    this->m_offset += this->m_rectangle.width * this->m_rectangle.height * 4;
+
+    return true;
+}
+
+/**
+ * @brief Decode a copy rectangle
+ * @return true if the rectangle is decoded
+ *
+ * Copy other region of the framebuffer, the windows moved in the guest
+ */
+bool VNCClient::decodeCopyRect()
+{
+    int sourceX = this->peekU16(this->m_offset);
+    int sourceY = this->peekU16(this->m_offset + 2);
+    this->m_offset += 4;
+
+    if (sourceX + this->m_rectangle.width > this->m_framebuffer.width() ||
+        sourceY + this->m_rectangle.height > this->m_framebuffer.height()) {
+        return false;
+    }
+
+    // The regions can overlap
+    QImage source = this->m_framebuffer.copy(sourceX, sourceY,
+                                             this->m_rectangle.width, this->m_rectangle.height);
+    for (int row = 0; row < this->m_rectangle.height; ++row) {
+        memcpy(this->m_framebuffer.scanLine(this->m_rectangle.y + row) + this->m_rectangle.x * 4,
+               source.constScanLine(row),
+               static_cast<size_t>(this->m_rectangle.width) * 4);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decode a ZRLE rectangle
+ * @param size, bytes of the compressed data
+ * @return true if the rectangle is decoded
+ *
+ * The rectangle is divided in tiles of 64x64 pixels, every
+ * tile is raw, solid, packed palette or run-length encoded.
+ * The pixels have 3 bytes, the blue is the first one
+ */
+bool VNCClient::decodeZRLE(int size)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(this->m_buffer.constData()) + this->m_offset + 4;
+    this->m_offset += 4 + size;
+
+    if (!this->inflateData(&this->m_zrleStream, data, size)) {
+        return false;
+    }
+
+    const uchar *input = reinterpret_cast<const uchar *>(this->m_inflated.constData());
+    const uchar *end = input + this->m_inflated.size();
+    QRgb palette[128];
+
+    int lastX = this->m_rectangle.x + this->m_rectangle.width;
+    int lastY = this->m_rectangle.y + this->m_rectangle.height;
+
+    for (int tileY = this->m_rectangle.y; tileY < lastY; tileY += 64) {
+        int tileHeight = qMin(64, lastY - tileY);
+
+        for (int tileX = this->m_rectangle.x; tileX < lastX; tileX += 64) {
+            int tileWidth = qMin(64, lastX - tileX);
+
+            if (input >= end) {
+                return false;
+            }
+            quint8 subencoding = *input++;
+
+            int paletteSize = 0;
+            if (subencoding >= 2 && subencoding <= 16) {
+                paletteSize = subencoding;
+            } else if (subencoding >= 130) {
+                paletteSize = subencoding - 128;
+            } else if (subencoding != 0 && subencoding != 1 && subencoding != 128) {
+                return false;
+            }
+
+            if (end - input < paletteSize * 3) {
+                return false;
+            }
+            for (int i = 0; i < paletteSize; ++i) {
+                palette[i] = qRgb(input[2], input[1], input[0]);
+                input += 3;
+            }
+
+            if (subencoding == 0) {
+                // Raw
+                if (end - input < tileWidth * tileHeight * 3) {
+                    return false;
+                }
+                for (int row = 0; row < tileHeight; ++row) {
+                    QRgb *line = reinterpret_cast<QRgb *>(this->m_framebuffer.scanLine(tileY + row)) + tileX;
+                    for (int column = 0; column < tileWidth; ++column) {
+                        line[column] = qRgb(input[2], input[1], input[0]);
+                        input += 3;
+                    }
+                }
+            } else if (subencoding == 1) {
+                // Solid
+                if (end - input < 3) {
+                    return false;
+                }
+                this->fillRectangle(tileX, tileY, tileWidth, tileHeight, qRgb(input[2], input[1], input[0]));
+                input += 3;
+            } else if (subencoding <= 16) {
+                // Packed palette, the rows are padded to a byte
+                int bits = paletteSize == 2 ? 1 : (paletteSize <= 4 ? 2 : 4);
+                int rowSize = (tileWidth * bits + 7) / 8;
+                if (end - input < rowSize * tileHeight) {
+                    return false;
+                }
+                for (int row = 0; row < tileHeight; ++row) {
+                    QRgb *line = reinterpret_cast<QRgb *>(this->m_framebuffer.scanLine(tileY + row)) + tileX;
+                    for (int column = 0; column < tileWidth; ++column) {
+                        int bitPosition = column * bits;
+                        int index = (input[bitPosition / 8] >> (8 - bits - bitPosition % 8)) & ((1 << bits) - 1);
+                        if (index >= paletteSize) {
+                            return false;
+                        }
+                        line[column] = palette[index];
+                    }
+                    input += rowSize;
+                }
+            } else {
+                // Plain or palette run-length
+                int pixels = tileWidth * tileHeight;
+                int pixel = 0;
+                while (pixel < pixels) {
+                    QRgb color;
+                    bool run = true;
+
+                    if (paletteSize > 0) {
+                        if (input >= end) {
+                            return false;
+                        }
+                        int index = *input & 0x7f;
+                        run = (*input & 0x80) != 0;
+                        ++input;
+                        if (index >= paletteSize) {
+                            return false;
+                        }
+                        color = palette[index];
+                    } else {
+                        if (end - input < 3) {
+                            return false;
+                        }
+                        color = qRgb(input[2], input[1], input[0]);
+                        input += 3;
+                    }
+
+                    int runLength = 1;
+                    if (run) {
+                        quint8 byte = 0;
+                        do {
+                            if (input >= end) {
+                                return false;
+                            }
+                            byte = *input++;
+                            runLength += byte;
+                        } while (byte == 255);
+                    }
+
+                    if (runLength > pixels - pixel) {
+                        return false;
+                    }
+                    for (; runLength > 0; --runLength, ++pixel) {
+                        QRgb *line = reinterpret_cast<QRgb *>(this->m_framebuffer.scanLine(tileY + pixel / tileWidth));
+                        line[tileX + pixel % tileWidth] = color;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decode a Tight rectangle
+ * @param size, bytes of the rectangle, -1 if invalid
+ * @return true if the rectangle is decoded
+ *
+ * The rectangle is a fill, a JPEG image or the pixels
+ * compressed in one of the four zlib streams, with the
+ * copy, palette or gradient filter. The pixels have
+ * 3 bytes, the red is the first one
+ */
+bool VNCClient::decodeTight(int size)
+{
+    if (size < 0) {
+        return false;
+    }
+
+    int start = this->m_offset;
+    const uchar *data = reinterpret_cast<const uchar *>(this->m_buffer.constData()) + start;
+    this->m_offset += size;
+
+    int width = this->m_rectangle.width;
+    int height = this->m_rectangle.height;
+    quint8 control = data[0];
+
+    // Reset the zlib streams
+    for (int i = 0; i < 4; ++i) {
+        if (control & (1 << i)) {
+            inflateReset(&this->m_tightStreams[i]);
+        }
+    }
+
+    int compression = control >> 4;
+    int length = 0;
+    int lengthSize = 0;
+
+    if (compression == 0x08) {
+        this->fillRectangle(this->m_rectangle.x, this->m_rectangle.y, width, height,
+                            qRgb(data[1], data[2], data[3]));
+        return true;
+    }
+
+    if (compression == 0x09) {
+        this->peekCompactLength(start + 1, &length, &lengthSize);
+
+        QImage image = QImage::fromData(data + 1 + lengthSize, length, "JPEG");
+        if (image.isNull() || image.width() != width || image.height() != height) {
+            return false;
+        }
+
+        image = image.convertToFormat(QImage::Format_RGB32);
+        for (int row = 0; row < height; ++row) {
+            memcpy(this->m_framebuffer.scanLine(this->m_rectangle.y + row) + this->m_rectangle.x * 4,
+                   image.constScanLine(row),
+                   static_cast<size_t>(width) * 4);
+        }
+        return true;
+    }
+
+    const uchar *input = data + 1;
+    quint8 filter = 0;
+    if (control & 0x40) {
+        filter = *input++;
+    }
+
+    QRgb palette[256];
+    int colors = 0;
+    int rowSize = width * 3;
+    if (filter == 1) {
+        colors = *input++ + 1;
+        for (int i = 0; i < colors; ++i) {
+            palette[i] = qRgb(input[0], input[1], input[2]);
+            input += 3;
+        }
+        rowSize = colors == 2 ? (width + 7) / 8 : width;
+    }
+
+    const uchar *pixels = input;
+    int dataSize = rowSize * height;
+    if (dataSize >= 12) {
+        this->peekCompactLength(start + static_cast<int>(input - data), &length, &lengthSize);
+        input += lengthSize;
+
+        int streamId = (control >> 4) & 0x03;
+        if (!this->inflateData(&this->m_tightStreams[streamId], input, length) ||
+            this->m_inflated.size() < dataSize) {
+            return false;
+        }
+        pixels = reinterpret_cast<const uchar *>(this->m_inflated.constData());
+    }
+
+    if (filter == 1) {
+        // Palette, one bit per pixel with two colors
+        for (int row = 0; row < height; ++row) {
+            QRgb *line = reinterpret_cast<QRgb *>(this->m_framebuffer.scanLine(this->m_rectangle.y + row)) +
+                         this->m_rectangle.x;
+            for (int column = 0; column < width; ++column) {
+                int index = colors == 2 ? (pixels[column / 8] >> (7 - column % 8)) & 1 : pixels[column];
+                if (index >= colors) {
+                    return false;
+                }
+                line[column] = palette[index];
+            }
+            pixels += rowSize;
+        }
+    } else if (filter == 2) {
+        // Gradient, the difference with the prediction of the neighbours
+        QVector<int> previousRow(width * 3, 0);
+        QVector<int> currentRow(width * 3, 0);
+        for (int row = 0; row < height; ++row) {
+            QRgb *line = reinterpret_cast<QRgb *>(this->m_framebuffer.scanLine(this->m_rectangle.y + row)) +
+                         this->m_rectangle.x;
+            for (int column = 0; column < width; ++column) {
+                for (int component = 0; component < 3; ++component) {
+                    int position = column * 3 + component;
+                    int left = column > 0 ? currentRow[position - 3] : 0;
+                    int upperLeft = column > 0 ? previousRow[position - 3] : 0;
+                    int prediction = qBound(0, left + previousRow[position] - upperLeft, 255);
+                    currentRow[position] = (prediction + pixels[position]) & 0xff;
+                }
+                line[column] = qRgb(currentRow[column * 3], currentRow[column * 3 + 1], currentRow[column * 3 + 2]);
+            }
+            previousRow.swap(currentRow);
+            pixels += rowSize;
+        }
+    } else {
+        // Copy
+        for (int row = 0; row < height; ++row) {
+            QRgb *line = reinterpret_cast<QRgb *>(this->m_framebuffer.scanLine(this->m_rectangle.y + row)) +
+                         this->m_rectangle.x;
+            for (int column = 0; column < width; ++column) {
+                line[column] = qRgb(pixels[0], pixels[1], pixels[2]);
+                pixels += 3;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Resize the framebuffer
+ * @param width, width of the display
+ * @param height, height of the display
+ *
+ * Create the framebuffer with the new size of the display,
+ * the next update has the full display
+ */
+void VNCClient::resizeFramebuffer(int width, int height)
+{
+    this->m_framebuffer = QImage(width, height, QImage::Format_RGB32);
+    this->m_framebuffer.fill(Qt::black);
+    this->m_framebufferValid = false;
+    this->m_damage = QRegion(this->m_framebuffer.rect());
+
+    emit framebufferResizedSignal(this->m_framebuffer.size());
+}
+
+/**
+ * @brief Fill a rectangle
+ * @param x, horizontal position
+ * @param y, vertical position
+ * @param width, width of the rectangle
+ * @param height, height of the rectangle
+ * @param color, color of the rectangle
+ *
+ * Fill a rectangle of the framebuffer with a color
+ */
+void VNCClient::fillRectangle(int x, int y, int width, int height, QRgb color)
+{
+    for (int row = y; row < y + height; ++row) {
+        QRgb *line = reinterpret_cast<QRgb *>(this->m_framebuffer.scanLine(row)) + x;
+        std::fill(line, line + width, color);
+    }
+}
+
+/**
+ * @brief Init the zlib streams
+ *
+ * Init the stream of ZRLE and the four streams of Tight
+ */
+void VNCClient::initStreams()
+{
+    memset(&this->m_zrleStream, 0, sizeof(z_stream));
+    inflateInit(&this->m_zrleStream);
+
+    for (int i = 0; i < 4; ++i) {
+        memset(&this->m_tightStreams[i], 0, sizeof(z_stream));
+        inflateInit(&this->m_tightStreams[i]);
+    }
+}
+
+/**
+ * @brief End the zlib streams
+ *
+ * Free the memory of the zlib streams
+ */
+void VNCClient::endStreams()
+{
+    inflateEnd(&this->m_zrleStream);
+
+    for (int i = 0; i < 4; ++i) {
+        inflateEnd(&this->m_tightStreams[i]);
+    }
+}
+
+/**
+ * @brief Inflate data
+ * @param stream, zlib stream of the data
+ * @param data, compressed data
+ * @param size, bytes of the compressed data
+ * @return true if the data is inflated
+ *
+ * Inflate the data into m_inflated. The streams keep
+ * their dictionary between the rectangles
+ */
+bool VNCClient::inflateData(z_stream *stream, const uchar *data, int size)
+{
+    this->m_inflated.resize(0);
+
+    stream->next_in = const_cast<Bytef *>(data);
+    stream->avail_in = static_cast<uInt>(size);
+
+    while (true) {
+        int used = this->m_inflated.size();
+        this->m_inflated.resize(used + INFLATE_CHUNK_SIZE);
+        stream->next_out = reinterpret_cast<Bytef *>(this->m_inflated.data()) + used;
+        stream->avail_out = INFLATE_CHUNK_SIZE;
+
+        int result = inflate(stream, Z_SYNC_FLUSH);
+        this->m_inflated.resize(this->m_inflated.size() - static_cast<int>(stream->avail_out));
+
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            return false;
+        }
+
+        // The output has room left, all the input is consumed
+        if (stream->avail_out > 0) {
+            return stream->avail_in == 0;
+        }
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef VNCCLIENT_H
+#define VNCCLIENT_H
+
+// Qt
+#include <QObject>
+#include <QLocalSocket>
+#include <QTimer>
+#include <QImage>
+#include <QRegion>
+#include <QByteArray>
+#include <QDataStream>
+#include <QVector>
+#include <QList>
+
+#include <QDebug>
+
+// zlib
+#include <zlib.h>
+
+class VNCClient : public QObject {
+    Q_OBJECT
+
+    public:
+        explicit VNCClient(QObject *parent = nullptr);
+        ~VNCClient();
+
+        bool isConnected() const;
+        QString serverName() const;
+        QString desktopName() const;
+        const QImage &framebuffer() const;
+
+        void connectToServer(const QString &serverName);
+        void disconnectFromServer();
+
+        void setActive(bool active);
+        void sendPointerEvent(int x, int y, quint8 buttonMask);
+        void sendKeyEvent(quint32 keysym, bool down);
+
+    signals:
+        void connectedSignal();
+        void disconnectedSignal();
+        void framebufferResizedSignal(const QSize &size);
+        void framebufferUpdatedSignal(const QRegion &region);
+
+    public slots:
+
+    private slots:
+        void tryConnect();
+        void socketConnected();
+        void readMessages();
+        void socketDisconnected();
+
+    protected:
+
+    private:
+        enum State {
+            Disconnected, ProtocolVersion, SecurityTypes,
+            SecurityType, SecurityResult, ServerInit, Normal
+        };
+
+        struct FramebufferRectangle {
+            int x;
+            int y;
+            int width;
+            int height;
+            qint32 encoding;
+        };
+
+        QString m_serverName;
+        QString m_desktopName;
+
+        QLocalSocket *m_vncSocket;
+        QTimer *m_connectTimer;
+        int m_connectAttempts;
+
+        State m_state;
+        QByteArray m_buffer;
+        int m_offset;
+
+        QImage m_framebuffer;
+        QRegion m_damage;
+        bool m_active;
+        bool m_updateRequested;
+        bool m_framebufferValid;
+
+        int m_pendingRectangles;
+        bool m_rectangleRead;
+        FramebufferRectangle m_rectangle;
+
+        z_stream m_zrleStream;
+        z_stream m_tightStreams[4];
+        QByteArray m_inflated;
+
+        // Methods
+        bool available(qint64 size) const;
+        quint8 peekU8(int position) const;
+        quint16 peekU16(int position) const;
+        quint32 peekU32(int position) const;
+        bool peekCompactLength(int position, int *length, int *size) const;
+
+        bool processHandshake();
+        bool processMessage();
+        bool processRectangle();
+        void finishUpdate();
+        void requestUpdate();
+        void sendSetup();
+        void protocolError(const QString &error);
+
+        bool tightSize(int *size) const;
+        bool decodeRaw();
+        bool decodeCopyRect();
+        bool decodeZRLE(int size);
+        bool decodeTight(int size);
+        void resizeFramebuffer(int width, int height);
+        void fillRectangle(int x, int y, int width, int height, QRgb color);
+
+        void initStreams();
+        void endStreams();
+        bool inflateData(z_stream *stream, const uchar *data, int size);
+};
+
+#endif // VNCCLIENT_H
@@ -0,0 +1,370 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Local
+#include "vncviewer.h"
+
+// Size of the viewer without display
+static const int EMPTY_WIDTH = 640;
+static const int EMPTY_HEIGHT = 480;
+
+/**
+ * @brief Viewer of the display of a machine
+ * @param parent, widget parent
+ *
+ * Show the display of a machine served with VNC.
+ * Only the damaged regions are painted, and no update
+ * is requested while the viewer is hidden
+ */
+VNCViewer::VNCViewer(QWidget *parent) : QWidget(parent)
+{
+    this->m_buttonMask = 0;
+
+    this->setFixedSize(EMPTY_WIDTH, EMPTY_HEIGHT);
+    this->setFocusPolicy(Qt::StrongFocus);
+    this->setMouseTracking(true);
+
+    // The framebuffer covers the whole widget
+    this->setAttribute(Qt::WA_OpaquePaintEvent);
+
+    this->m_vncClient = new VNCClient(this);
+    connect(m_vncClient, &VNCClient::connectedSignal,
+            this, &VNCViewer::clientConnected);
+    connect(m_vncClient, &VNCClient::disconnectedSignal,
+            this, &VNCViewer::clientDisconnected);
+    connect(m_vncClient, &VNCClient::framebufferResizedSignal,
+            this, &VNCViewer::framebufferResized);
+    connect(m_vncClient, &VNCClient::framebufferUpdatedSignal,
+            this, &VNCViewer::framebufferUpdated);
+
+    qDebug() << "VNCViewer created";
+}
+
+VNCViewer::~VNCViewer()
+{
+    qDebug() << "VNCViewer destroyed";
+}
+
+/**
+ * @brief Connect to a display
+ * @param serverName, local socket of the VNC server
+ *
+ * Connect to the display of a machine, nothing is done
+ * if the viewer already shows it
+ */
+void VNCViewer::connectToServer(const QString &serverName)
+{
+    if (serverName == this->m_vncClient->serverName() && this->m_vncClient->isConnected()) {
+        return;
+    }
+
+    this->releaseKeys();
+    this->m_statusMessage = tr("Connecting to the display of the machine");
+    this->setFixedSize(EMPTY_WIDTH, EMPTY_HEIGHT);
+    this->update();
+
+    this->m_vncClient->connectToServer(serverName);
+}
+
+/**
+ * @brief Disconnect from the display
+ *
+ * Disconnect from the display of the machine
+ */
+void VNCViewer::disconnectFromServer()
+{
+    this->releaseKeys();
+    this->m_vncClient->disconnectFromServer();
+}
+
+/**
+ * @brief Client connected
+ *
+ * The framebuffer is shown
+ */
+void VNCViewer::clientConnected()
+{
+    this->m_statusMessage.clear();
+    this->update();
+}
+
+/**
+ * @brief Client disconnected
+ *
+ * The display of the machine isn't available
+ */
+void VNCViewer::clientDisconnected()
+{
+    this->m_buttonMask = 0;
+    this->m_pressedKeys.clear();
+
+    this->m_statusMessage = tr("The display of the machine is not available");
+    this->setFixedSize(EMPTY_WIDTH, EMPTY_HEIGHT);
+    this->update();
+}
+
+/**
+ * @brief Framebuffer resized
+ * @param size, new size of the display
+ *
+ * The viewer has the size of the display
+ */
+void VNCViewer::framebufferResized(const QSize &size)
+{
+    this->setFixedSize(size);
+    this->update();
+}
+
+/**
+ * @brief Framebuffer updated
+ * @param region, damaged region of the display
+ *
+ * Repaint only the damaged region
+ */
+void VNCViewer::framebufferUpdated(const QRegion &region)
+{
+    this->update(region);
+}
+
+void VNCViewer::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+
+    if (!this->m_vncClient->isConnected()) {
+        painter.fillRect(this->rect(), Qt::black);
+        painter.setPen(Qt::white);
+        painter.drawText(this->rect(), Qt::AlignCenter, this->m_statusMessage);
+        return;
+    }
+
+    // Copy only the rectangles to be repainted
+    const QImage &framebuffer = this->m_vncClient->framebuffer();
+    for (const QRect &rect : event->region()) {
+        painter.drawImage(rect, framebuffer, rect);
+    }
+}
+
+void VNCViewer::showEvent(QShowEvent *event)
+{
+    this->m_vncClient->setActive(true);
+    event->accept();
+}
+
+void VNCViewer::hideEvent(QHideEvent *event)
+{
+    this->releaseKeys();
+    this->m_vncClient->setActive(false);
+    event->accept();
+}
+
+void VNCViewer::mousePressEvent(QMouseEvent *event)
+{
+    this->setFocus();
+
+    this->m_pointerPosition = event->pos();
+    this->m_buttonMask = this->buttonMask(event->buttons());
+    this->m_vncClient->sendPointerEvent(event->x(), event->y(), this->m_buttonMask);
+}
+
+void VNCViewer::mouseReleaseEvent(QMouseEvent *event)
+{
+    this->m_pointerPosition = event->pos();
+    this->m_buttonMask = this->buttonMask(event->buttons());
+    this->m_vncClient->sendPointerEvent(event->x(), event->y(), this->m_buttonMask);
+}
+
+void VNCViewer::mouseMoveEvent(QMouseEvent *event)
+{
+    this->m_pointerPosition = event->pos();
+    this->m_vncClient->sendPointerEvent(event->x(), event->y(), this->m_buttonMask);
+}
+
+void VNCViewer::wheelEvent(QWheelEvent *event)
+{
+    // The wheel is pressed and released as the buttons 4 to 7
+    quint8 wheelButton = 0;
+    if (event->angleDelta().y() > 0) {
+        wheelButton = 8;
+    } else if (event->angleDelta().y() < 0) {
+        wheelButton = 16;
+    } else if (event->angleDelta().x() > 0) {
+        wheelButton = 32;
+    } else if (event->angleDelta().x() < 0) {
+        wheelButton = 64;
+    }
+
+    if (wheelButton != 0) {
+        this->m_vncClient->sendPointerEvent(this->m_pointerPosition.x(), this->m_pointerPosition.y(),
+                                            this->m_buttonMask | wheelButton);
+        this->m_vncClient->sendPointerEvent(this->m_pointerPosition.x(), this->m_pointerPosition.y(),
+                                            this->m_buttonMask);
+    }
+
+    event->accept();
+}
+
+void VNCViewer::keyPressEvent(QKeyEvent *event)
+{
+    quint32 keysym = this->keysym(event);
+    if (keysym == 0) {
+        QWidget::keyPressEvent(event);
+        return;
+    }
+
+    // The release uses the keysym of the press, the modifiers can change between them
+    quint32 keyCode = event->nativeScanCode() != 0 ? event->nativeScanCode() : static_cast<quint32>(event->key());
+    this->m_pressedKeys.insert(keyCode, keysym);
+    this->m_vncClient->sendKeyEvent(keysym, true);
+}
+
+void VNCViewer::keyReleaseEvent(QKeyEvent *event)
+{
+    if (event->isAutoRepeat()) {
+        return;
+    }
+
+    quint32 keyCode = event->nativeScanCode() != 0 ? event->nativeScanCode() : static_cast<quint32>(event->key());
+    if (!this->m_pressedKeys.contains(keyCode)) {
+        QWidget::keyReleaseEvent(event);
+        return;
+    }
+
+    this->m_vncClient->sendKeyEvent(this->m_pressedKeys.take(keyCode), false);
+}
+
+void VNCViewer::focusOutEvent(QFocusEvent *event)
+{
+    this->releaseKeys();
+    QWidget::focusOutEvent(event);
+}
+
+bool VNCViewer::focusNextPrevChild(bool next)
+{
+    // The tab key goes to the machine
+    Q_UNUSED(next);
+    return false;
+}
+
+/**
+ * @brief Get the button mask
+ * @param buttons, pressed buttons
+ * @return mask of the buttons for VNC
+ *
+ * Get the mask of the left, middle and right buttons
+ */
+quint8 VNCViewer::buttonMask(Qt::MouseButtons buttons) const
+{
+    quint8 mask = 0;
+
+    if (buttons & Qt::LeftButton) {
+        mask |= 1;
+    }
+    if (buttons & Qt::MiddleButton) {
+        mask |= 2;
+    }
+    if (buttons & Qt::RightButton) {
+        mask |= 4;
+    }
+
+    return mask;
+}
+
+/**
+ * @brief Get the keysym of a key
+ * @param event, key event
+ * @return X11 keysym, 0 if the key is unknown
+ *
+ * Get the keysym of the special keys, or of the character
+ * of the key. QEMU translates the keysyms to scancodes
+ * with the keyboard layout of the machine
+ */
+quint32 VNCViewer::keysym(const QKeyEvent *event) const
+{
+    switch (event->key()) {
+        case Qt::Key_Backspace:  return 0xff08;
+        case Qt::Key_Tab:        return 0xff09;
+        case Qt::Key_Backtab:    return 0xff09;
+        case Qt::Key_Return:     return 0xff0d;
+        case Qt::Key_Enter:      return 0xff8d;
+        case Qt::Key_Pause:      return 0xff13;
+        case Qt::Key_ScrollLock: return 0xff14;
+        case Qt::Key_SysReq:     return 0xff15;
+        case Qt::Key_Escape:     return 0xff1b;
+        case Qt::Key_Home:       return 0xff50;
+        case Qt::Key_Left:       return 0xff51;
+        case Qt::Key_Up:         return 0xff52;
+        case Qt::Key_Right:      return 0xff53;
+        case Qt::Key_Down:       return 0xff54;
+        case Qt::Key_PageUp:     return 0xff55;
+        case Qt::Key_PageDown:   return 0xff56;
+        case Qt::Key_End:        return 0xff57;
+        case Qt::Key_Print:      return 0xff61;
+        case Qt::Key_Insert:     return 0xff63;
+        case Qt::Key_Menu:       return 0xff67;
+        case Qt::Key_NumLock:    return 0xff7f;
+        case Qt::Key_Shift:      return 0xffe1;
+        case Qt::Key_Control:    return 0xffe3;
+        case Qt::Key_CapsLock:   return 0xffe5;
+        case Qt::Key_Meta:       return 0xffeb;
+        case Qt::Key_Super_L:    return 0xffeb;
+        case Qt::Key_Super_R:    return 0xffec;
+        case Qt::Key_Alt:        return 0xffe9;
+        case Qt::Key_AltGr:      return 0xfe03;
+        case Qt::Key_Delete:     return 0xffff;
+        default:
+            break;
+    }
+
+    // F1 to F12
+    if (event->key() >= Qt::Key_F1 && event->key() <= Qt::Key_F12) {
+        return static_cast<quint32>(0xffbe + event->key() - Qt::Key_F1);
+    }
+
+    // Printable character, the Latin-1 keysyms are the code points
+    QString text = event->text();
+    if (!text.isEmpty() && text.at(0).unicode() >= 0x20 && text.at(0).unicode() != 0x7f) {
+        quint32 unicode = text.at(0).unicode();
+        return unicode < 0x100 ? unicode : 0x01000000 | unicode;
+    }
+
+    // Key with control, the text is a control character
+    if (event->key() >= Qt::Key_Space && event->key() <= Qt::Key_ydiaeresis) {
+        return QChar(event->key()).toLower().unicode();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Release the keys
+ *
+ * Release the pressed keys, the machine would repeat them
+ * after the focus goes to other widget
+ */
+void VNCViewer::releaseKeys()
+{
+    QHashIterator<quint32, quint32> keysIterator(this->m_pressedKeys);
+    while (keysIterator.hasNext()) {
+        keysIterator.next();
+        this->m_vncClient->sendKeyEvent(keysIterator.value(), false);
+    }
+
+    this->m_pressedKeys.clear();
+}
@@ -0,0 +1,88 @@
+/*
+ * This file is part of QtEmu project.
+ * Copyright (C) 2017-2019 Sergio Carlavilla <carlavilla @ mailbox.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef VNCVIEWER_H
+#define VNCVIEWER_H
+
+// Qt
+#include <QWidget>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QKeyEvent>
+#include <QFocusEvent>
+#include <QHash>
+
+#include <QDebug>
+
+// Local
+#include "vncclient.h"
+
+class VNCViewer : public QWidget {
+    Q_OBJECT
+
+    public:
+        explicit VNCViewer(QWidget *parent = nullptr);
+        ~VNCViewer();
+
+        void connectToServer(const QString &serverName);
+        void disconnectFromServer();
+
+    signals:
+
+    public slots:
+
+    private slots:
+        void clientConnected();
+        void clientDisconnected();
+        void framebufferResized(const QSize &size);
+        void framebufferUpdated(const QRegion &region);
+
+    protected:
+        virtual void paintEvent(QPaintEvent *event);
+        virtual void showEvent(QShowEvent *event);
+        virtual void hideEvent(QHideEvent *event);
+        virtual void mousePressEvent(QMouseEvent *event);
+        virtual void mouseReleaseEvent(QMouseEvent *event);
+        virtual void mouseMoveEvent(QMouseEvent *event);
+        virtual void wheelEvent(QWheelEvent *event);
+        virtual void keyPressEvent(QKeyEvent *event);
+        virtual void keyReleaseEvent(QKeyEvent *event);
+        virtual void focusOutEvent(QFocusEvent *event);
+        virtual bool focusNextPrevChild(bool next);
+
+    private:
+        VNCClient *m_vncClient;
+        QString m_statusMessage;
+
+        QPoint m_pointerPosition;
+        quint8 m_buttonMask;
+        QHash<quint32, quint32> m_pressedKeys;
+
+        // Methods
+        quint8 buttonMask(Qt::MouseButtons buttons) const;
+        quint32 keysym(const QKeyEvent *event) const;
+        void releaseKeys();
+};
+
+#endif // VNCVIEWER_H